@@ -0,0 +1,106 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_CPU_H
+#define MINICRT_CPU_H
+
+/**
+ * @file cpu.h
+ * @brief CPU feature detection and kernel tier selection for MiniCRT
+ */
+
+#include "crt.h"
+
+MINICRT_BEGIN
+    /**
+     * @brief CPU feature bits reported by cpu_features()
+     */
+    enum cpu_feature {
+        CPU_FEATURE_SSE2 = 1u << 0,
+        CPU_FEATURE_SSE42 = 1u << 1,
+        CPU_FEATURE_AVX = 1u << 2,
+        CPU_FEATURE_AVX2 = 1u << 3,
+        CPU_FEATURE_BMI2 = 1u << 4,
+        CPU_FEATURE_AVX512F = 1u << 5,
+        CPU_FEATURE_AVX512BW = 1u << 6,
+        CPU_FEATURE_ERMS = 1u << 7, ///< Enhanced REP MOVSB/STOSB
+        CPU_FEATURE_FSRM = 1u << 8, ///< Fast short REP MOVSB
+        CPU_FEATURE_RDTSCP = 1u << 9,
+        CPU_FEATURE_INVARIANT_TSC = 1u << 10, ///< Time stamp counter ticks at a constant rate in all power states
+        CPU_FEATURE_SSSE3 = 1u << 11
+    };
+
+    /**
+     * @brief Kernel tiers, ordered from the most portable to the fastest
+     */
+    enum cpu_tier {
+        CPU_TIER_GENERIC = 0, ///< Portable word-at-a-time code
+        CPU_TIER_SSE2 = 1,    ///< 16-byte vectors, baseline on x86-64
+        CPU_TIER_AVX2 = 2     ///< 32-byte vectors, plus REP MOVSB/STOSB for large blocks with ERMS
+    };
+
+    /**
+     * @brief Get the features of the running CPU
+     *
+     * The CPU is probed once (normally from minicrt_init()); AVX and AVX-512 bits are
+     * only reported when the operating system saves the corresponding register state.
+     *
+     * @return Bitwise OR of cpu_feature values
+     */
+    unsigned int cpu_features(void);
+
+    /**
+     * @brief Check whether the running CPU has a feature
+     *
+     * @param feature One of the cpu_feature values
+     * @return Non-zero if the feature is available, 0 otherwise
+     */
+    int cpu_has(unsigned int feature);
+
+    /**
+     * @brief Get the size of the last-level data cache
+     *
+     * @return Size in bytes, or 0 if the CPU does not report it
+     */
+    size_t cpu_llc_size(void);
+
+    /**
+     * @brief Get the best kernel tier the running CPU supports
+     *
+     * @return The highest usable cpu_tier
+     */
+    cpu_tier cpu_best_tier(void);
+
+    /**
+     * @brief Get the kernel tier currently used by the mem and str functions
+     *
+     * This is the best tier unless cpu_set_tier() or the MINICRT_CPU_TIER environment
+     * variable ("generic", "sse2" or "avx2", read at startup) chose a lower one.
+     *
+     * @return The active cpu_tier
+     */
+    cpu_tier cpu_active_tier(void);
+
+    /**
+     * @brief Force the mem and str functions onto a given kernel tier
+     *
+     * Meant for benchmarking and testing; call it before other threads start using
+     * the library.
+     *
+     * @param tier The tier to switch to
+     * @return 0 on success, -1 if the CPU does not support the tier
+     */
+    int cpu_set_tier(cpu_tier tier);
+
+    /**
+     * @brief Get the printable name of a kernel tier
+     *
+     * @param tier The tier to name
+     * @return A static string such as "avx2", or "unknown"
+     */
+    const char *cpu_tier_name(cpu_tier tier);
+
+MINICRT_END
+
+#endif // MINICRT_CPU_H
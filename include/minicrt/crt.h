@@ -24,10 +24,14 @@
 #endif
 
 // Basic types
+// Prefer the compiler's own definitions so that MiniCRT headers can be mixed with
+// compiler-provided headers (intrinsics, <cstddef>) and stay 64-bit clean on LP64.
 #ifndef _SIZE_T_DEFINED
 #define _SIZE_T_DEFINED
-    #ifdef _WIN64
-        typedef unsigned long long size_t;
+#if defined(__SIZE_TYPE__)
+typedef __SIZE_TYPE__ size_t;
+#elif defined(_WIN64)
+typedef unsigned long long size_t;
 #else
 typedef unsigned int size_t;
 #endif
@@ -35,13 +39,18 @@ typedef unsigned int size_t;
 
 #ifndef _PTRDIFF_T_DEFINED
 #define _PTRDIFF_T_DEFINED
-#ifdef _WIN64
+#if defined(__PTRDIFF_TYPE__)
+typedef __PTRDIFF_TYPE__ ptrdiff_t;
+#elif defined(_WIN64)
 typedef long long ptrdiff_t;
 #else
 typedef int ptrdiff_t;
 #endif
 #endif
 
+static_assert(sizeof(size_t) == sizeof(void *), "size_t must span the address space");
+static_assert(sizeof(ptrdiff_t) == sizeof(void *), "ptrdiff_t must span the address space");
+
 MINICRT_BEGIN
 
 typedef int errno_t;
@@ -55,6 +64,11 @@ typedef int errno_t;
 #error "Unsupported platform"
 #endif
 
+// Architecture detection
+#if defined(__x86_64__) || defined(_M_X64)
+#define MINICRT_X86_64
+#endif
+
 // NULL definition
 #ifndef NULL
 #ifdef __cplusplus
@@ -84,8 +98,87 @@ void minicrt_cleanup(void);
 #define EXIT_FAILURE 1
 void exit(int status);
 
-// Error handling
-extern int errno;
+// Error handling: every thread has its own errno. When a hosted C library's <errno.h>
+// came first, errno is already its macro; the runtime keeps using minicrt::errno.
+#ifndef errno
+extern thread_local int errno;
+#endif
+
+// The calling thread's minicrt::errno, also where errno names the C library's
+int *errno_location(void);
+
+// Error codes stored in errno
+#ifndef ENOENT
+#define ENOENT 2
+#endif
+#ifndef EIO
+#define EIO 5
+#endif
+#ifndef EAGAIN
+#define EAGAIN 11
+#endif
+#ifndef ENOMEM
+#define ENOMEM 12
+#endif
+#ifndef ENODEV
+#define ENODEV 19
+#endif
+#ifndef EINVAL
+#define EINVAL 22
+#endif
+#ifndef ERANGE
+#define ERANGE 34
+#endif
+#ifndef ENOSYS
+#define ENOSYS 38
+#endif
+#ifndef ETIMEDOUT
+#define ETIMEDOUT 110
+#endif
+
+// Process environment, set up by _start from the initial process stack. Hosted
+// builds, which start through the system C library, see an empty environment.
+extern char **environ;
+
+/**
+ * @brief Look up an environment variable
+ *
+ * @param name Variable name, without the '='
+ * @return Pointer to the value inside the environment block, or NULL if unset
+ */
+char *getenv(const char *name);
+
+// ELF auxiliary vector entry types for getauxval()
+#ifndef AT_NULL
+#define AT_NULL 0
+#define AT_PHDR 3
+#define AT_PHNUM 5
+#define AT_PAGESZ 6
+#define AT_ENTRY 9
+#define AT_UID 11
+#define AT_HWCAP 16
+#define AT_CLKTCK 17
+#define AT_SECURE 23
+#define AT_RANDOM 25
+#define AT_HWCAP2 26
+#define AT_EXECFN 31
+#define AT_SYSINFO_EHDR 33
+#define AT_MINSIGSTKSZ 51
+#endif
+
+/**
+ * @brief Look up an entry of the ELF auxiliary vector the kernel passed at startup
+ *
+ * Answered from an index built once by _start, without a system call (hosted
+ * programs, which skip MiniCRT's _start, read /proc/self/auxv on first use). Useful
+ * entries include AT_PAGESZ (page size), AT_HWCAP (CPU capability bits) and
+ * AT_SYSINFO_EHDR (address of the vDSO).
+ *
+ * @param type One of the AT_* constants
+ * @return The entry's value, or 0 with errno set to ENOENT if the kernel did not
+ *         supply it
+ */
+unsigned long getauxval(unsigned long type);
 
 MINICRT_END
 
@@ -0,0 +1,96 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_FILE_H
+#define MINICRT_FILE_H
+
+/**
+ * @file file.h
+ * @brief Read-only memory-mapped files for MiniCRT
+ */
+
+#include "crt.h"
+
+MINICRT_BEGIN
+    /**
+     * @brief Options for map_file() and map_fd(), combined with bitwise OR
+     */
+    enum file_map_flags {
+        FILE_MAP_SEQUENTIAL = 1u << 0, ///< Expect a front-to-back scan: aggressive read-ahead
+        FILE_MAP_RANDOM = 1u << 1,     ///< Expect scattered access: no read-ahead
+        FILE_MAP_WILLNEED = 1u << 2,   ///< Start reading the whole file in the background
+        FILE_MAP_POPULATE = 1u << 3,   ///< Read the file and map every page before returning
+        FILE_MAP_HUGE_PAGES = 1u << 4  ///< Align to 2 MiB and ask for huge pages where the system supports them
+    };
+
+    /**
+     * @brief Access pattern hints for mapped_file_advise()
+     */
+    enum file_advice {
+        FILE_ADVICE_NORMAL = 0,
+        FILE_ADVICE_RANDOM = 1,
+        FILE_ADVICE_SEQUENTIAL = 2,
+        FILE_ADVICE_WILLNEED = 3,
+        FILE_ADVICE_DONTNEED = 4 ///< Drop the pages for now; they are read again on the next access
+    };
+
+    /**
+     * @brief A file mapped into memory
+     *
+     * The bytes are followed by a readable zero byte (data[size] == 0), so the str
+     * functions can run over a text file directly; use the explicit-length variants
+     * such as strntod() when a field may touch the end of the file. Only data and
+     * size are meant to be read; the other fields belong to unmap_file().
+     */
+    struct mapped_file {
+        const char *data; ///< First byte of the file
+        size_t size;      ///< File size in bytes
+        void *mapping;    ///< Start of the mapping, NULL for an empty file
+        size_t length;    ///< Length of the mapping
+    };
+
+    /**
+     * @brief Map a whole file read-only
+     *
+     * @param path Path of a regular file
+     * @param flags Bitwise OR of file_map_flags values, or 0
+     * @param file Receives the mapping
+     * @return 0 on success, -1 with errno set (ENODEV if the file is not a regular
+     *         file, EINVAL where memory-mapped files are not supported)
+     */
+    int map_file(const char *path, unsigned int flags, mapped_file *file);
+
+    /**
+     * @brief Map a whole file read-only from an open descriptor
+     *
+     * The mapping stays valid after fd is closed.
+     *
+     * @param fd Descriptor opened for reading
+     * @param flags Bitwise OR of file_map_flags values, or 0
+     * @param file Receives the mapping
+     * @return 0 on success, -1 with errno set
+     */
+    int map_fd(int fd, unsigned int flags, mapped_file *file);
+
+    /**
+     * @brief Give the system a hint about how part of a mapping will be used
+     *
+     * @param file A mapping from map_file() or map_fd()
+     * @param offset Start of the range; rounded down to a page boundary
+     * @param length Length of the range in bytes
+     * @param advice One of the file_advice values
+     * @return 0 on success, -1 with errno set
+     */
+    int mapped_file_advise(const mapped_file *file, size_t offset, size_t length, file_advice advice);
+
+    /**
+     * @brief Release a mapping
+     *
+     * @param file A mapping from map_file() or map_fd(); cleared on return
+     */
+    void unmap_file(mapped_file *file);
+
+MINICRT_END
+
+#endif // MINICRT_FILE_H
@@ -12,6 +12,10 @@
 
 #include "crt.h"
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 MINICRT_BEGIN
     /**
      * @brief Fill memory with a constant byte
@@ -65,6 +69,569 @@ MINICRT_BEGIN
      */
     int memcmp(const void *lhs, const void *rhs, size_t count);
 
+    /**
+     * @brief Allocate memory
+     *
+     * Requests up to 32 KiB are served from per-size-class slabs owned by the calling
+     * thread, without locking; larger requests get their own mapping. The returned
+     * block is aligned to 16 bytes.
+     *
+     * @param size Number of bytes to allocate
+     * @return Pointer to the allocated memory, or NULL (errno set to ENOMEM) on failure
+     */
+    void *malloc(size_t size);
+
+    /**
+     * @brief Free memory allocated by malloc, calloc or realloc
+     *
+     * Any thread may free any block. Blocks freed by a thread other than the one that
+     * allocated them are handed back to the owner in batches. A few freed large blocks
+     * are kept for reuse, their pages marked for the kernel to reclaim lazily.
+     *
+     * @param ptr Pointer to the block to free; NULL is ignored
+     */
+    void free(void *ptr);
+
+    /**
+     * @brief Allocate zero-initialized memory for an array
+     *
+     * Large blocks on freshly mapped pages are already zero and are not cleared
+     * again; only a recycled block pays for the memset.
+     *
+     * @param count Number of elements
+     * @param size Size of each element
+     * @return Pointer to the allocated memory, or NULL (errno set to ENOMEM) if the
+     *         allocation fails or count * size overflows
+     */
+    void *calloc(size_t count, size_t size);
+
+    /**
+     * @brief Resize a memory block
+     *
+     * Blocks that still fit their size class are returned unchanged. Large blocks are
+     * grown or shrunk in place with mremap where possible, and otherwise moved by
+     * remapping their pages instead of copying them.
+     *
+     * @param ptr Pointer to the block to resize, or NULL to allocate a new block
+     * @param size New size in bytes; 0 frees the block and returns NULL
+     * @return Pointer to the resized block, or NULL (errno set to ENOMEM) on failure,
+     *         in which case the original block is left untouched
+     */
+    void *realloc(void *ptr, size_t size);
+
+    /**
+     * @brief Get the number of usable bytes in an allocated block
+     *
+     * @param ptr Pointer returned by malloc, calloc or realloc
+     * @return Usable size in bytes (at least the requested size), or 0 for NULL
+     */
+    size_t malloc_usable_size(void *ptr);
+
+    /**
+     * @brief How malloc backs large blocks with huge pages
+     */
+    enum malloc_huge_mode {
+        MALLOC_HUGE_OFF = 0,    ///< Plain pages
+        MALLOC_HUGE_THP = 1,    ///< Align blocks of 2 MiB and up to 2 MiB and ask for
+                                ///< transparent huge pages (the default)
+        MALLOC_HUGE_HUGETLB = 2 ///< Try the reserved hugetlb pool first, then as MALLOC_HUGE_THP
+    };
+
+    /**
+     * @brief Choose how large blocks use huge pages
+     *
+     * Huge pages cut the TLB misses of walking a big buffer. Without them, or when
+     * the kernel has none to give, blocks fall back to plain pages. The mode applies
+     * to blocks allocated afterwards.
+     *
+     * @param mode A malloc_huge_mode
+     * @return The previous mode, or -1 (errno set to EINVAL) for an unknown mode
+     */
+    int malloc_set_huge_pages(int mode);
+
+    /**
+     * @brief One mmapped block of arena memory (internal layout, see crt_arena.cpp)
+     */
+    struct arena_chunk;
+
+    /**
+     * @brief Bump-pointer allocator for memory that is released all at once
+     *
+     * Objects are carved from large mmapped chunks by advancing a pointer; they are
+     * never freed one by one. The whole arena is emptied by arena_reset() or rolled
+     * back to an arena_checkpoint. Chunks are kept across resets and reused, so a
+     * steady-state request loop makes no system calls. An arena is not thread-safe.
+     *
+     * The fields are private; treat the structure as opaque.
+     */
+    struct arena {
+        char *ptr;            ///< Next free byte in the current chunk
+        char *end;            ///< End of the current chunk
+        arena_chunk *current; ///< Chunk being allocated from
+        arena_chunk *first;   ///< Oldest chunk; the chunks form a singly linked list
+        size_t chunk_size;    ///< Size of the next chunk to map
+        unsigned int flags;   ///< arena_flags
+        unsigned int epoch;   ///< Number of resets, for cold chunk tracking
+    };
+
+    /**
+     * @brief Saved allocation position of an arena
+     */
+    struct arena_checkpoint {
+        arena_chunk *chunk;
+        char *ptr;
+    };
+
+    /**
+     * @brief Options for arena_create()
+     */
+    enum arena_flags {
+        /// On reset, return the pages of chunks left unused since the previous reset
+        /// to the OS with madvise(MADV_DONTNEED); the chunks stay mapped for reuse
+        ARENA_RELEASE_COLD = 1u << 0
+    };
+
+    /**
+     * @brief Create an arena and map its first chunk
+     *
+     * @param a Arena to initialize
+     * @param initial_size Size of the first chunk in bytes (rounded up to whole pages);
+     *        0 selects a default of 64 KiB. Later chunks double in size.
+     * @param flags Bitwise OR of arena_flags values, or 0
+     * @return 0 on success, -1 (errno set to ENOMEM) if the chunk cannot be mapped
+     */
+    int arena_create(arena *a, size_t initial_size, unsigned int flags);
+
+    /**
+     * @brief Unmap every chunk of an arena
+     *
+     * All memory allocated from the arena becomes invalid.
+     *
+     * @param a Arena to destroy
+     */
+    void arena_destroy(arena *a);
+
+    /**
+     * @brief Allocate memory from an arena
+     *
+     * @param a Arena to allocate from
+     * @param size Number of bytes to allocate
+     * @param align Required alignment, a power of two; 0 means 16
+     * @return Pointer to the allocated memory, or NULL (errno set to ENOMEM) if a new
+     *         chunk cannot be mapped
+     */
+    void *arena_alloc(arena *a, size_t size, size_t align);
+
+    /**
+     * @brief Remember the current allocation position of an arena
+     *
+     * @param a Arena to query
+     * @return Checkpoint to pass to arena_rollback()
+     */
+    arena_checkpoint arena_save(const arena *a);
+
+    /**
+     * @brief Free everything allocated since a checkpoint, in O(1)
+     *
+     * Checkpoints taken after this one become invalid.
+     *
+     * @param a Arena to roll back
+     * @param checkpoint Value returned by arena_save() on the same arena
+     */
+    void arena_rollback(arena *a, arena_checkpoint checkpoint);
+
+    /**
+     * @brief Free everything allocated from an arena, keeping its chunks for reuse
+     *
+     * Runs in O(1) unless ARENA_RELEASE_COLD is set, in which case the chunk list is
+     * walked once to find cold chunks.
+     *
+     * @param a Arena to reset
+     */
+    void arena_reset(arena *a);
+
+    /**
+     * @brief Set the size from which memcpy, memmove and memset bypass the cache
+     *
+     * Blocks at or above the threshold are written with non-temporal stores and the
+     * source is prefetched ahead, so a multi-GiB copy does not evict the working set.
+     * The default is derived from the last-level cache size at startup.
+     *
+     * @param bytes The new threshold in bytes, or 0 to restore the default
+     */
+    void mem_set_nt_threshold(size_t bytes);
+
+    /**
+     * @brief Get the size from which memcpy, memmove and memset bypass the cache
+     *
+     * @return The current threshold in bytes
+     */
+    size_t mem_nt_threshold(void);
+
+namespace detail {
+    /*
+     * Fixed-size kernels behind copy<N>() and friends. N is known at compile time, so
+     * the block is covered by N / W loads and stores of the widest word W <= N the
+     * target has, plus one more word ending exactly at N (overlapping the previous
+     * one) when W does not divide N: copy<24> is two 16-byte moves at offsets 0 and
+     * 8. The sequences are unrolled through template recursion rather than loops,
+     * so that the compiler cannot turn them back into library calls, which a
+     * freestanding program would have no symbol for.
+     */
+
+    // Blocks up to this size are expanded inline; larger ones call the runtime functions
+    static const size_t kFixedInlineMax = 256;
+    static const size_t kFixedCompareInlineMax = 64;
+
+#if defined(__GNUC__) || defined(__clang__)
+    typedef unsigned short __attribute__((aligned(1), may_alias)) fixed_u16;
+    typedef unsigned int __attribute__((aligned(1), may_alias)) fixed_u32;
+    typedef unsigned long long __attribute__((aligned(1), may_alias)) fixed_u64;
+    typedef unsigned long long fixed_v16 __attribute__((vector_size(16)));
+    typedef fixed_v16 __attribute__((aligned(1), may_alias)) fixed_v16_unaligned;
+#if defined(__AVX__)
+    typedef unsigned long long fixed_v32 __attribute__((vector_size(32)));
+    typedef fixed_v32 __attribute__((aligned(1), may_alias)) fixed_v32_unaligned;
+    static const size_t kFixedMaxWidth = 32;
+#else
+    static const size_t kFixedMaxWidth = 16;
+#endif
+#else
+    typedef unsigned short fixed_u16;
+    typedef unsigned int fixed_u32;
+    typedef unsigned long long fixed_u64;
+    static const size_t kFixedMaxWidth = 8;
+#endif
+
+    // True while the compiler evaluates a constant expression (GCC 9, Clang 9, MSVC 19.25)
+#define MINICRT_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+
+    /**
+     * @brief A word of W bytes: its value type, the type it is loaded and stored
+     *        through, a byte broadcast and a non-zero test
+     */
+    template<size_t W> struct fixed_word;
+
+    template<> struct fixed_word<1> {
+        typedef unsigned char value;
+        typedef unsigned char access;
+        static MINICRT_INLINE value splat(unsigned char c) { return c; }
+        static MINICRT_INLINE bool any(value v) { return v != 0; }
+    };
+
+    template<> struct fixed_word<2> {
+        typedef unsigned short value;
+        typedef fixed_u16 access;
+        static MINICRT_INLINE value splat(unsigned char c) { return (value) (c * 0x0101u); }
+        static MINICRT_INLINE bool any(value v) { return v != 0; }
+    };
+
+    template<> struct fixed_word<4> {
+        typedef unsigned int value;
+        typedef fixed_u32 access;
+        static MINICRT_INLINE value splat(unsigned char c) { return c * 0x01010101u; }
+        static MINICRT_INLINE bool any(value v) { return v != 0; }
+    };
+
+    template<> struct fixed_word<8> {
+        typedef unsigned long long value;
+        typedef fixed_u64 access;
+        static MINICRT_INLINE value splat(unsigned char c) { return c * 0x0101010101010101ull; }
+        static MINICRT_INLINE bool any(value v) { return v != 0; }
+    };
+
+#if defined(__GNUC__) || defined(__clang__)
+    template<> struct fixed_word<16> {
+        typedef fixed_v16 value;
+        typedef fixed_v16_unaligned access;
+        static MINICRT_INLINE value splat(unsigned char c) {
+            unsigned long long p = fixed_word<8>::splat(c);
+            value v = {p, p};
+            return v;
+        }
+        static MINICRT_INLINE bool any(value v) { return (v[0] | v[1]) != 0; }
+    };
+
+#if defined(__AVX__)
+    template<> struct fixed_word<32> {
+        typedef fixed_v32 value;
+        typedef fixed_v32_unaligned access;
+        static MINICRT_INLINE value splat(unsigned char c) {
+            unsigned long long p = fixed_word<8>::splat(c);
+            value v = {p, p, p, p};
+            return v;
+        }
+        static MINICRT_INLINE bool any(value v) { return (v[0] | v[1] | v[2] | v[3]) != 0; }
+    };
+#endif
+#endif
+
+    /**
+     * @brief Widest word that fits in N bytes, at most Limit bytes wide
+     */
+    template<size_t N, size_t Limit = kFixedMaxWidth>
+    struct fixed_width {
+        static const size_t value = N >= 32 && Limit >= 32 ? 32
+                                  : N >= 16 && Limit >= 16 ? 16
+                                  : N >= 8 ? 8
+                                  : N >= 4 ? 4
+                                  : N >= 2 ? 2
+                                  : 1;
+    };
+
+    template<size_t W>
+    MINICRT_INLINE typename fixed_word<W>::value fixed_load(const unsigned char *p) {
+        return *(const typename fixed_word<W>::access *) p;
+    }
+
+    template<size_t W>
+    MINICRT_INLINE void fixed_store(unsigned char *p, typename fixed_word<W>::value v) {
+        *(typename fixed_word<W>::access *) p = v;
+    }
+
+    // Bytes in memory order as an integer, so that integer order is memcmp order
+    MINICRT_INLINE unsigned long long fixed_order(unsigned long long v) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return _byteswap_uint64(v);
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return v;
+#else
+        return __builtin_bswap64(v);
+#endif
+    }
+
+    /**
+     * @brief Count words of W bytes starting at the front of the block
+     */
+    template<size_t W, size_t Count>
+    struct fixed_ops {
+        static MINICRT_INLINE void copy(unsigned char *d, const unsigned char *s) {
+            fixed_store<W>(d, fixed_load<W>(s));
+            fixed_ops<W, Count - 1>::copy(d + W, s + W);
+        }
+
+        static MINICRT_INLINE void fill(unsigned char *d, typename fixed_word<W>::value v) {
+            fixed_store<W>(d, v);
+            fixed_ops<W, Count - 1>::fill(d + W, v);
+        }
+
+        static MINICRT_INLINE typename fixed_word<W>::value diff(const unsigned char *a, const unsigned char *b) {
+            return (fixed_load<W>(a) ^ fixed_load<W>(b)) | fixed_ops<W, Count - 1>::diff(a + W, b + W);
+        }
+
+        static MINICRT_INLINE int compare(const unsigned char *a, const unsigned char *b) {
+            typename fixed_word<W>::value x = fixed_load<W>(a), y = fixed_load<W>(b);
+            if (x != y) {
+                // Narrower words are zero-extended; the swap still makes their first byte the highest
+                return fixed_order(x) < fixed_order(y) ? -1 : 1;
+            }
+            return fixed_ops<W, Count - 1>::compare(a + W, b + W);
+        }
+    };
+
+    template<size_t W>
+    struct fixed_ops<W, 0> {
+        static MINICRT_INLINE void copy(unsigned char *, const unsigned char *) {}
+        static MINICRT_INLINE void fill(unsigned char *, typename fixed_word<W>::value) {}
+        static MINICRT_INLINE typename fixed_word<W>::value diff(const unsigned char *, const unsigned char *) {
+            return typename fixed_word<W>::value();
+        }
+        static MINICRT_INLINE int compare(const unsigned char *, const unsigned char *) { return 0; }
+    };
+
+    // N / W whole words plus, if needed, one word ending at N
+    template<size_t N, size_t W = fixed_width<N>::value>
+    struct fixed_block {
+        static const size_t kWords = N / W;
+        static const bool kTail = N % W != 0;
+        typedef fixed_ops<W, kWords> body;
+        typedef fixed_ops<W, kTail ? 1 : 0> tail;
+
+        static MINICRT_INLINE void copy(unsigned char *d, const unsigned char *s) {
+            body::copy(d, s);
+            tail::copy(d + N - W, s + N - W);
+        }
+
+        static MINICRT_INLINE void fill(unsigned char *d, unsigned char c) {
+            typename fixed_word<W>::value v = fixed_word<W>::splat(c);
+            body::fill(d, v);
+            tail::fill(d + N - W, v);
+        }
+
+        static MINICRT_INLINE bool equal(const unsigned char *a, const unsigned char *b) {
+            return !fixed_word<W>::any(body::diff(a, b) | tail::diff(a + N - W, b + N - W));
+        }
+
+        // The tail overlaps bytes already found equal, so its first difference is the block's
+        static MINICRT_INLINE int compare(const unsigned char *a, const unsigned char *b) {
+            int result = body::compare(a, b);
+            return result ? result : tail::compare(a + N - W, b + N - W);
+        }
+    };
+
+    template<size_t W>
+    struct fixed_block<0, W> {
+        static MINICRT_INLINE void copy(unsigned char *, const unsigned char *) {}
+        static MINICRT_INLINE void fill(unsigned char *, unsigned char) {}
+        static MINICRT_INLINE bool equal(const unsigned char *, const unsigned char *) { return true; }
+        static MINICRT_INLINE int compare(const unsigned char *, const unsigned char *) { return 0; }
+    };
+
+    template<size_t N, typename B>
+    constexpr B *fixed_copy(B *dest, const B *src) {
+        if (MINICRT_CONSTANT_EVALUATED()) {
+            for (size_t i = 0; i < N; i++)
+                dest[i] = src[i];
+            return dest;
+        }
+        if constexpr (N <= kFixedInlineMax)
+            fixed_block<N>::copy((unsigned char *) dest, (const unsigned char *) src);
+        else
+            memcpy(dest, src, N);
+        return dest;
+    }
+
+    template<size_t N, typename B>
+    constexpr B *fixed_fill(B *dest, int c) {
+        if (MINICRT_CONSTANT_EVALUATED()) {
+            for (size_t i = 0; i < N; i++)
+                dest[i] = (B) c;
+            return dest;
+        }
+        if constexpr (N <= kFixedInlineMax)
+            fixed_block<N>::fill((unsigned char *) dest, (unsigned char) c);
+        else
+            memset(dest, c, N);
+        return dest;
+    }
+
+    template<size_t N, typename B>
+    constexpr bool fixed_equal(const B *lhs, const B *rhs) {
+        if (MINICRT_CONSTANT_EVALUATED()) {
+            for (size_t i = 0; i < N; i++) {
+                if (lhs[i] != rhs[i])
+                    return false;
+            }
+            return true;
+        }
+        if constexpr (N <= kFixedInlineMax)
+            return fixed_block<N>::equal((const unsigned char *) lhs, (const unsigned char *) rhs);
+        else
+            return memcmp(lhs, rhs, N) == 0;
+    }
+
+    template<size_t N, typename B>
+    constexpr int fixed_compare(const B *lhs, const B *rhs) {
+        if (MINICRT_CONSTANT_EVALUATED()) {
+            for (size_t i = 0; i < N; i++) {
+                if (lhs[i] != rhs[i])
+                    return (unsigned char) lhs[i] < (unsigned char) rhs[i] ? -1 : 1;
+            }
+            return 0;
+        }
+        if constexpr (N <= kFixedCompareInlineMax) {
+            // Integer words only: the first difference is found by byte-swapped comparison
+            return fixed_block<N, fixed_width<N, 8>::value>::compare((const unsigned char *) lhs,
+                                                                     (const unsigned char *) rhs);
+        } else {
+            int result = memcmp(lhs, rhs, N);
+            return result < 0 ? -1 : result > 0;
+        }
+    }
+} // namespace detail
+
+    /**
+     * @brief Copy a block whose size is known at compile time
+     *
+     * Expands to a few wide unaligned loads and stores (the widest the compilation
+     * target supports) for N up to 256 bytes and calls memcpy() above that. The
+     * char overloads are also usable in constant expressions.
+     *
+     * @tparam N Number of bytes to copy
+     * @param dest Destination; must not overlap src
+     * @param src Source
+     * @return dest
+     */
+    template<size_t N>
+    MINICRT_INLINE void *copy(void *dest, const void *src) {
+        return detail::fixed_copy<N>((unsigned char *) dest, (const unsigned char *) src);
+    }
+
+    template<size_t N>
+    constexpr char *copy(char *dest, const char *src) { return detail::fixed_copy<N>(dest, src); }
+
+    template<size_t N>
+    constexpr unsigned char *copy(unsigned char *dest, const unsigned char *src) {
+        return detail::fixed_copy<N>(dest, src);
+    }
+
+    /**
+     * @brief Fill a block whose size is known at compile time
+     *
+     * Inline for N up to 256 bytes, memset() above that; see copy().
+     *
+     * @tparam N Number of bytes to fill
+     * @param dest Destination
+     * @param c Byte value (converted to unsigned char)
+     * @return dest
+     */
+    template<size_t N>
+    MINICRT_INLINE void *fill(void *dest, int c) {
+        return detail::fixed_fill<N>((unsigned char *) dest, c);
+    }
+
+    template<size_t N>
+    constexpr char *fill(char *dest, int c) { return detail::fixed_fill<N>(dest, c); }
+
+    template<size_t N>
+    constexpr unsigned char *fill(unsigned char *dest, int c) { return detail::fixed_fill<N>(dest, c); }
+
+    /**
+     * @brief Check two blocks whose size is known at compile time for equality
+     *
+     * The differences of all words are combined before a single test, so there is
+     * one branch regardless of N. Inline for N up to 256 bytes, memcmp() above that.
+     *
+     * @tparam N Number of bytes to compare
+     * @return true if the blocks hold the same bytes
+     */
+    template<size_t N>
+    MINICRT_INLINE bool equal(const void *lhs, const void *rhs) {
+        return detail::fixed_equal<N>((const unsigned char *) lhs, (const unsigned char *) rhs);
+    }
+
+    template<size_t N>
+    constexpr bool equal(const char *lhs, const char *rhs) { return detail::fixed_equal<N>(lhs, rhs); }
+
+    template<size_t N>
+    constexpr bool equal(const unsigned char *lhs, const unsigned char *rhs) {
+        return detail::fixed_equal<N>(lhs, rhs);
+    }
+
+    /**
+     * @brief Order two blocks whose size is known at compile time, like memcmp()
+     *
+     * Compares 8-byte words and orders the first differing pair by byte-swapping
+     * it, instead of looking for the differing byte. Inline for N up to 64 bytes,
+     * memcmp() above that.
+     *
+     * @tparam N Number of bytes to compare
+     * @return -1, 0 or 1 as the first differing byte (as unsigned char) of lhs is
+     *         less than, absent from or greater than that of rhs
+     */
+    template<size_t N>
+    MINICRT_INLINE int compare(const void *lhs, const void *rhs) {
+        return detail::fixed_compare<N>((const unsigned char *) lhs, (const unsigned char *) rhs);
+    }
+
+    template<size_t N>
+    constexpr int compare(const char *lhs, const char *rhs) { return detail::fixed_compare<N>(lhs, rhs); }
+
+    template<size_t N>
+    constexpr int compare(const unsigned char *lhs, const unsigned char *rhs) {
+        return detail::fixed_compare<N>(lhs, rhs);
+    }
+
 MINICRT_END
 
 
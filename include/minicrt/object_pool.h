@@ -0,0 +1,475 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_OBJECT_POOL_H
+#define MINICRT_OBJECT_POOL_H
+
+/**
+ * @file object_pool.h
+ * @brief Lock-free pool of fixed-size objects for MiniCRT
+ *
+ * object_pool<T, N> hands out slots for objects of type T from slabs of at least
+ * N slots, each slab a separate anonymous mapping. Free slots form lock-free
+ * stacks, so allocate() and deallocate() are one compare-and-swap each from any
+ * thread, and object_pool<T, N>::cache gives a thread a magazine of slots that
+ * it trades with the pool a batch at a time. Only mapping a new slab takes a
+ * lock. Slabs are kept until the pool is destroyed, and a slot can be freed by
+ * any thread.
+ */
+
+#include <new>
+#include "crt.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+MINICRT_BEGIN
+    /**
+     * @brief Flags for object_pool
+     */
+    enum object_pool_flags {
+        /// Have the OS fault in every slab's pages when it is mapped
+        OBJECT_POOL_PREFAULT = 1u << 0
+    };
+
+namespace detail {
+    /*
+     * The free list is a Treiber stack whose head packs a 16-bit tag above a 48-bit
+     * slot address, the user half of the x86-64 and AArch64 address spaces. Every
+     * successful update bumps the tag, so a pop that read a head, was preempted
+     * while the slot was popped, reused and pushed back, fails its compare-and-swap
+     * instead of installing a stale next pointer. Slabs stay mapped for the life of
+     * the pool, so reading the next pointer of a slot another thread has just taken
+     * is harmless: its compare-and-swap fails the same way.
+     *
+     * Next to the free list of single slots is a depot: a stack of the same kind
+     * whose entries are whole batches, chains of slots linked through their next
+     * pointers. Per-thread caches swap a full batch for one compare-and-swap, and
+     * new slabs go straight into the depot.
+     */
+
+    /**
+     * @brief Map a slab for object_pool
+     *
+     * @param size In: bytes needed. Out: bytes mapped, a multiple of the page size.
+     * @param flags object_pool_flags
+     * @return The page-aligned slab, or NULL with errno set to ENOMEM
+     */
+    void *object_pool_map(size_t *size, unsigned int flags);
+
+    /**
+     * @brief Unmap a slab from object_pool_map()
+     */
+    void object_pool_unmap(void *slab, size_t size);
+
+    static MINICRT_INLINE unsigned long long pool_word_load(const volatile unsigned long long *word) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long long value = *word;
+        _ReadWriteBarrier();
+        return value;
+#else
+        return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    static MINICRT_INLINE bool pool_word_cas(volatile unsigned long long *word, unsigned long long *expected,
+                                             unsigned long long desired) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long long seen = (unsigned long long) _InterlockedCompareExchange64(
+            (volatile long long *) word, (long long) desired, (long long) *expected);
+        if (seen == *expected)
+            return true;
+        *expected = seen;
+        return false;
+#else
+        return __atomic_compare_exchange_n(word, expected, desired, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    static MINICRT_INLINE bool pool_lock_try(volatile long *lock) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return _InterlockedExchange(lock, 1) == 0;
+#else
+        return __atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) == 0;
+#endif
+    }
+
+    static MINICRT_INLINE void pool_lock_release(volatile long *lock) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        _InterlockedExchange(lock, 0);
+#else
+        __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+#endif
+    }
+} // namespace detail
+
+    /**
+     * @brief Lock-free pool of fixed-size objects
+     *
+     * Slots are sized so that objects up to a cache line never straddle two lines
+     * (a power of two), and larger ones start on a line of their own (a multiple of
+     * 64 bytes); slots are aligned for T. The free lists and the growth state sit on
+     * separate cache lines, so threads allocating do not contend with one mapping a
+     * slab.
+     *
+     * allocate() and deallocate() cost one compare-and-swap on a shared word each.
+     * Threads that allocate a lot should go through a cache, which moves slots to
+     * and from the pool in batches.
+     *
+     * A new slab's slots are threaded onto the free lists when it is mapped, which
+     * writes to each of its pages. With OBJECT_POOL_PREFAULT the kernel populates
+     * the mapping in the same system call instead of taking one fault per page.
+     * Together with a reserve at construction this keeps both slab mapping and page
+     * faults out of the steady state.
+     *
+     * @tparam T Object type
+     * @tparam N Minimum number of slots per slab; a slab is rounded up to whole
+     *           pages and the slack holds more slots
+     */
+    template <typename T, size_t N = 64>
+    class object_pool {
+        struct free_slot {
+            free_slot *next;       ///< Next slot of the free list or batch
+            free_slot *next_batch; ///< Next batch in the depot, in a batch's first slot
+        };
+
+    public:
+        /**
+         * @brief Create a pool
+         *
+         * @param reserve Number of slots to map right away
+         * @param flags object_pool_flags, applied to every slab
+         */
+        explicit object_pool(size_t reserve = 0, unsigned int flags = 0)
+            : head_(0), depot_(0), lock_(0), slabs_(0), capacity_(0), flags_(flags) {
+            while (capacity_ < reserve && add_slab()) {
+            }
+        }
+
+        /**
+         * @brief Unmap every slab
+         *
+         * Objects still in the pool are not destroyed. Caches must be gone first.
+         */
+        ~object_pool() {
+            slab *s = slabs_;
+            while (s) {
+                slab *next = s->next;
+                detail::object_pool_unmap(s, s->size);
+                s = next;
+            }
+        }
+
+        object_pool(const object_pool &) = delete;
+        object_pool &operator=(const object_pool &) = delete;
+
+        /**
+         * @brief Take an uninitialized slot
+         *
+         * @return Storage for one T, or NULL with errno set to ENOMEM
+         */
+        void *allocate() {
+            for (;;) {
+                free_slot *slot = pop(&head_, &free_slot::next);
+                if (slot)
+                    return slot;
+
+                // Break up a batch: keep its first slot, the rest go to the free list
+                slot = pop(&depot_, &free_slot::next_batch);
+                if (slot) {
+                    if (slot->next) {
+                        free_slot *last = slot->next;
+                        while (last->next)
+                            last = last->next;
+                        push(&head_, slot->next, last, &free_slot::next);
+                    }
+                    return slot;
+                }
+                if (!grow())
+                    return 0;
+            }
+        }
+
+        /**
+         * @brief Return a slot from allocate() or a cache to the pool
+         *
+         * @param ptr Slot to return, NULL is ignored
+         */
+        void deallocate(void *ptr) {
+            if (!ptr)
+                return;
+            free_slot *slot = (free_slot *) ptr;
+            push(&head_, slot, slot, &free_slot::next);
+        }
+
+        /**
+         * @brief Allocate a slot and construct a T in it
+         *
+         * @return The new object, or NULL with errno set to ENOMEM
+         */
+        template <typename... Args>
+        T *create(Args &&... args) {
+            void *slot = allocate();
+            if (!slot)
+                return 0;
+            return ::new(slot) T(static_cast<Args &&>(args)...);
+        }
+
+        /**
+         * @brief Destroy an object from create() and return its slot
+         *
+         * @param object Object to destroy, NULL is ignored
+         */
+        void destroy(T *object) {
+            if (!object)
+                return;
+            object->~T();
+            deallocate(object);
+        }
+
+        /**
+         * @brief Number of slots in the mapped slabs, free or not
+         */
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        /// Bytes from one slot to the next
+        static constexpr size_t slot_size() {
+            size_t size = sizeof(T) < sizeof(free_slot) ? sizeof(free_slot) : sizeof(T);
+            if (size > kCacheLine) {
+                size = (size + kCacheLine - 1) & ~(kCacheLine - 1);
+            } else {
+                size_t power = sizeof(free_slot);
+                while (power < size)
+                    power *= 2;
+                size = power;
+            }
+            return (size + alignof(T) - 1) & ~(alignof(T) - 1);
+        }
+
+        /// Slots a cache moves to or from the pool at a time
+        static constexpr size_t kBatch = 32;
+
+        /**
+         * @brief Per-thread magazine of free slots
+         *
+         * A cache hands out and takes back slots without touching shared memory. It
+         * refills from the pool a batch at a time, and gives a batch back once it
+         * holds two, each for a single compare-and-swap. A cache belongs to one
+         * thread; slots may still be returned through any cache of the same pool or
+         * the pool itself. Destroying the cache returns its slots to the pool.
+         */
+        class cache {
+        public:
+            explicit cache(object_pool &pool) : pool_(pool), count_(0) {}
+
+            ~cache() {
+                flush();
+            }
+
+            cache(const cache &) = delete;
+            cache &operator=(const cache &) = delete;
+
+            /**
+             * @brief Take an uninitialized slot
+             *
+             * @return Storage for one T, or NULL with errno set to ENOMEM
+             */
+            void *allocate() {
+                if (!count_ && !refill())
+                    return 0;
+                return slots_[--count_];
+            }
+
+            /**
+             * @brief Return a slot to the cache
+             *
+             * @param ptr Slot from this pool, NULL is ignored
+             */
+            void deallocate(void *ptr) {
+                if (!ptr)
+                    return;
+                if (count_ == 2 * kBatch)
+                    spill(kBatch);
+                slots_[count_++] = (free_slot *) ptr;
+            }
+
+            /**
+             * @brief Allocate a slot and construct a T in it
+             *
+             * @return The new object, or NULL with errno set to ENOMEM
+             */
+            template <typename... Args>
+            T *create(Args &&... args) {
+                void *slot = allocate();
+                if (!slot)
+                    return 0;
+                return ::new(slot) T(static_cast<Args &&>(args)...);
+            }
+
+            /**
+             * @brief Destroy an object and return its slot to the cache
+             *
+             * @param object Object to destroy, NULL is ignored
+             */
+            void destroy(T *object) {
+                if (!object)
+                    return;
+                object->~T();
+                deallocate(object);
+            }
+
+            /**
+             * @brief Return every cached slot to the pool
+             */
+            void flush() {
+                while (count_)
+                    spill(count_ < kBatch ? count_ : kBatch);
+            }
+
+        private:
+            bool refill() {
+                free_slot *slot = pool_.pop(&pool_.depot_, &free_slot::next_batch);
+                if (!slot) {
+                    // No whole batch left: one slot from the free list, or a new slab
+                    slot = (free_slot *) pool_.allocate();
+                    if (!slot)
+                        return false;
+                    slot->next = 0;
+                }
+                for (; slot; slot = slot->next)
+                    slots_[count_++] = slot;
+                return true;
+            }
+
+            // Hand the oldest count slots to the depot as one batch
+            void spill(size_t count) {
+                for (size_t i = 0; i + 1 < count; i++)
+                    slots_[i]->next = slots_[i + 1];
+                slots_[count - 1]->next = 0;
+                pool_.push(&pool_.depot_, slots_[0], slots_[0], &free_slot::next_batch);
+
+                count_ -= count;
+                for (size_t i = 0; i < count_; i++)
+                    slots_[i] = slots_[count + i];
+            }
+
+            object_pool &pool_;
+            size_t count_;
+            free_slot *slots_[2 * kBatch];
+        };
+
+    private:
+        struct slab {
+            slab *next;
+            size_t size;
+        };
+
+        static constexpr size_t kCacheLine = 64;
+        static constexpr unsigned long long kAddressMask = (1ull << 48) - 1;
+        static constexpr unsigned long long kTagOne = 1ull << 48;
+        // The first slot follows the slab header on a cache line of its own
+        static constexpr size_t kSlotAlign = alignof(T) > kCacheLine ? alignof(T) : kCacheLine;
+        static constexpr size_t kFirstSlot = (sizeof(slab) + kSlotAlign - 1) & ~(kSlotAlign - 1);
+
+        static free_slot *address(unsigned long long word) {
+            return (free_slot *) (size_t) (word & kAddressMask);
+        }
+
+        static unsigned long long tagged(free_slot *slot, unsigned long long old_word) {
+            return (unsigned long long) (size_t) slot | ((old_word + kTagOne) & ~kAddressMask);
+        }
+
+        /**
+         * @brief Pop the top of a tagged stack linked through link
+         */
+        static free_slot *pop(volatile unsigned long long *top, free_slot *free_slot::*link) {
+            unsigned long long word = detail::pool_word_load(top);
+            for (;;) {
+                free_slot *slot = address(word);
+                if (!slot)
+                    return 0;
+                if (detail::pool_word_cas(top, &word, tagged(slot->*link, word)))
+                    return slot;
+            }
+        }
+
+        /**
+         * @brief Push the chain first..last, already linked through link, onto a tagged stack
+         */
+        static void push(volatile unsigned long long *top, free_slot *first, free_slot *last,
+                         free_slot *free_slot::*link) {
+            unsigned long long word = detail::pool_word_load(top);
+            do {
+                last->*link = address(word);
+            } while (!detail::pool_word_cas(top, &word, tagged(first, word)));
+        }
+
+        bool has_free() {
+            return (detail::pool_word_load(&head_) | detail::pool_word_load(&depot_)) & kAddressMask;
+        }
+
+        /**
+         * @brief Make sure a free list has a slot, mapping a slab if both are empty
+         *
+         * @return false with errno set to ENOMEM if the slab cannot be mapped
+         */
+        bool grow() {
+            while (!detail::pool_lock_try(&lock_)) {
+                // Whoever holds the lock is mapping a slab; its slots are as good
+                if (has_free())
+                    return true;
+            }
+            bool grown = has_free() || add_slab();
+            detail::pool_lock_release(&lock_);
+            return grown;
+        }
+
+        /**
+         * @brief Map one more slab and put its slots in the depot as batches
+         *
+         * Called with the lock held, or from the constructor.
+         */
+        bool add_slab() {
+            size_t size = kFirstSlot + N * slot_size();
+            char *base = (char *) detail::object_pool_map(&size, flags_);
+            if (!base)
+                return false;
+            slab *s = (slab *) base;
+            s->size = size;
+            s->next = slabs_;
+            slabs_ = s;
+
+            // Thread the slots in address order, so a fresh slab is handed out sequentially
+            size_t count = (size - kFirstSlot) / slot_size();
+            free_slot *first = (free_slot *) (base + kFirstSlot);
+            free_slot *batch = first;
+            for (size_t i = 0; i < count; i++) {
+                free_slot *slot = (free_slot *) (base + kFirstSlot + i * slot_size());
+                bool batch_end = (i + 1) % kBatch == 0 || i + 1 == count;
+                slot->next = batch_end ? 0 : (free_slot *) ((char *) slot + slot_size());
+                if (batch_end && i + 1 < count) {
+                    batch->next_batch = (free_slot *) ((char *) slot + slot_size());
+                    batch = batch->next_batch;
+                }
+            }
+            push(&depot_, first, batch, &free_slot::next_batch);
+
+            capacity_ += count;
+            return true;
+        }
+
+        alignas(64) volatile unsigned long long head_;  ///< Tagged stack of single slots
+        alignas(64) volatile unsigned long long depot_; ///< Tagged stack of batches
+        alignas(64) volatile long lock_;                 ///< Held while a slab is mapped
+        slab *slabs_;
+        volatile size_t capacity_;
+        unsigned int flags_;
+    };
+
+MINICRT_END
+
+#endif // MINICRT_OBJECT_POOL_H
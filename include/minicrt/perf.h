@@ -0,0 +1,148 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_PERF_H
+#define MINICRT_PERF_H
+
+/**
+ * @file perf.h
+ * @brief Hardware performance counters over Linux perf_event_open for MiniCRT
+ */
+
+#include "crt.h"
+
+MINICRT_BEGIN
+    /**
+     * @brief Events a counter group can measure
+     *
+     * All events count user-space work of the calling thread only.
+     */
+    enum perf_counter {
+        PERF_CYCLES = 0,        ///< Core clock cycles
+        PERF_INSTRUCTIONS,      ///< Instructions retired
+        PERF_L1D_MISSES,        ///< Level 1 data cache read misses
+        PERF_LLC_MISSES,        ///< Last-level cache misses
+        PERF_BRANCH_MISSES,     ///< Mispredicted branches
+        PERF_TASK_CLOCK,        ///< CPU time in nanoseconds; a kernel software event, often
+                                ///< available where the hardware counters are not
+        PERF_DTLB_MISSES,       ///< Data TLB read misses
+        PERF_PAGE_FAULTS,       ///< Page faults taken by user-space accesses (software event)
+        PERF_COUNTER_COUNT
+    };
+
+    /**
+     * @brief Bit for a perf_counter in the masks passed to perf_group_open()
+     */
+#define PERF_MASK(counter) (1u << (counter))
+
+    /**
+     * @brief Every counter
+     */
+#define PERF_MASK_ALL ((1u << minicrt::PERF_COUNTER_COUNT) - 1)
+
+    /**
+     * @brief Counter values, indexed by perf_counter
+     */
+    struct perf_values {
+        unsigned long long counts[PERF_COUNTER_COUNT]; ///< 0 for counters the group does not have
+        unsigned int available;                        ///< PERF_MASK() bits of the valid counts
+        unsigned long long time_enabled;               ///< Nanoseconds the group was enabled
+        unsigned long long time_running;               ///< Nanoseconds it was actually counting
+        int multiplexed;                               ///< Non-zero if time_running is less than
+                                                       ///< time_enabled: the kernel had to share the
+                                                       ///< hardware with other groups
+    };
+
+    /**
+     * @brief Counters that the kernel schedules onto the hardware together
+     *
+     * Opened with perf_group_open() and read with perf_group_read() or the region
+     * functions. Where the kernel allows it, hardware counters are read in user
+     * space with RDPMC, which takes tens of cycles instead of a system call. A group
+     * belongs to the thread that opened it and must not be read from other threads.
+     * The fields are private; treat the structure as opaque.
+     */
+    struct perf_group {
+        int fds[PERF_COUNTER_COUNT];      ///< Event descriptors, -1 when not open
+        void *pages[PERF_COUNTER_COUNT];  ///< Mapped event control pages, or NULL
+        unsigned char order[PERF_COUNTER_COUNT]; ///< Counter of each value in a group read
+        unsigned int count;               ///< Number of open counters
+        unsigned int available;           ///< PERF_MASK() bits of the open counters
+        int leader;                       ///< Descriptor of the group leader, or -1
+    };
+
+    /**
+     * @brief A measured region: the counter values at its start
+     */
+    struct perf_region {
+        perf_values start;
+    };
+
+    /**
+     * @brief Open a counter group
+     *
+     * Each requested event is opened separately, and events the machine or the
+     * security policy does not provide are left out; containers and virtual machines
+     * often expose no hardware counters at all. A group with no counters is still
+     * valid: reads and regions succeed and report nothing available, so callers can
+     * measure unconditionally.
+     *
+     * @param group Group to initialize
+     * @param counters Bitwise OR of PERF_MASK() values, or PERF_MASK_ALL
+     * @return Number of counters opened; 0 with errno set to the reason the first
+     *         event failed (for example ENOENT without a PMU, EACCES under
+     *         perf_event_paranoid, ENOSYS under seccomp, EINVAL on other platforms);
+     *         -1 with errno set to EINVAL if counters is empty
+     */
+    int perf_group_open(perf_group *group, unsigned int counters);
+
+    /**
+     * @brief Close the counters of a group; safe to call on a closed group
+     *
+     * @param group Group from perf_group_open()
+     */
+    void perf_group_close(perf_group *group);
+
+    /**
+     * @brief Read the current counter values
+     *
+     * The counts are cumulative since perf_group_open(); subtract two reads, or use
+     * the region functions, to measure a piece of code.
+     *
+     * @param group Group from perf_group_open()
+     * @param values Receives the values
+     * @return 0 on success, -1 with errno set
+     */
+    int perf_group_read(perf_group *group, perf_values *values);
+
+    /**
+     * @brief Start measuring a region
+     *
+     * Regions may nest and overlap, since each keeps its own starting point.
+     *
+     * @param group Group from perf_group_open()
+     * @param region Region to start
+     * @return 0 on success, -1 with errno set
+     */
+    int perf_region_begin(perf_group *group, perf_region *region);
+
+    /**
+     * @brief Finish a region and compute what it counted
+     *
+     * @param group Group the region was started on
+     * @param region Region from perf_region_begin()
+     * @param delta Receives the counts since perf_region_begin(); multiplexed is set
+     *              if the group was not counting for the whole region
+     * @return 0 on success, -1 with errno set
+     */
+    int perf_region_end(perf_group *group, const perf_region *region, perf_values *delta);
+
+    /**
+     * @brief Get the name of a counter, such as "cycles"
+     */
+    const char *perf_counter_name(perf_counter counter);
+
+MINICRT_END
+
+#endif // MINICRT_PERF_H
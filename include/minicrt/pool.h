@@ -0,0 +1,113 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_POOL_H
+#define MINICRT_POOL_H
+
+/**
+ * @file pool.h
+ * @brief Work-stealing task pool, parallel_for and parallel memcpy/memset for MiniCRT
+ *
+ * The pool keeps one worker thread per additional CPU. Each worker has a Chase-Lev
+ * deque: it pushes and pops tasks at one end without locking, and idle workers
+ * steal from the other end. Tasks spawned by threads outside the pool go to a
+ * shared queue. A thread waiting for a task group runs tasks itself meanwhile, so
+ * fork/join can nest to any depth.
+ *
+ * The pool starts with the first task and runs until pool_stop(). exit(), and so
+ * returning from main(), ends the whole thread group, idle workers included, so a
+ * program does not need to stop the pool before it exits.
+ */
+
+#include "crt.h"
+
+MINICRT_BEGIN
+    /**
+     * @brief Set of tasks to wait for; the fields are private
+     */
+    struct task_group {
+        volatile int state; ///< Tasks not yet finished, and a flag for a sleeping waiter
+    };
+
+#define TASK_GROUP_INIT {0}
+
+    /**
+     * @brief Start the pool's worker threads
+     *
+     * Optional: the first task starts the pool with the default number of workers.
+     *
+     * @param workers Number of worker threads, or -1 for one per CPU the process may
+     *                run on, minus one for the calling thread. 0 runs every task on
+     *                the threads that wait for them.
+     * @return The number of workers running. If the pool was already running, it is
+     *         left as it is.
+     */
+    int pool_start(int workers);
+
+    /**
+     * @brief Stop the worker threads
+     *
+     * No tasks may be pending. A later task or pool_start() starts the pool again.
+     * Not needed before exit(), which ends the workers with the process.
+     */
+    void pool_stop(void);
+
+    /**
+     * @brief Number of worker threads, 0 if the pool is not running
+     */
+    int pool_worker_count(void);
+
+    /**
+     * @brief Run fn(arg) on the pool as part of a group
+     *
+     * @param group Group to add the task to; wait for it with task_wait()
+     * @param fn Task function
+     * @param arg Argument for fn
+     */
+    void task_spawn(task_group *group, void (*fn)(void *), void *arg);
+
+    /**
+     * @brief Wait until every task of a group has finished
+     *
+     * The calling thread runs pool tasks while it waits. Afterwards the group is
+     * empty and can be reused.
+     */
+    void task_wait(task_group *group);
+
+    /**
+     * @brief Run body over [begin, end) split into chunks, in parallel
+     *
+     * Chunks are [begin + k * grain, begin + (k + 1) * grain), the last one shorter.
+     * The calling thread takes part and returns once all chunks are done.
+     *
+     * @param begin Start of the range
+     * @param end End of the range (exclusive)
+     * @param grain Chunk size; 0 picks one that gives every thread a few chunks
+     * @param body Called once per chunk with its bounds
+     * @param arg Argument for body
+     */
+    void parallel_for(size_t begin, size_t end, size_t grain,
+                      void (*body)(size_t chunk_begin, size_t chunk_end, void *arg), void *arg);
+
+    /**
+     * @brief memcpy() across the pool's threads
+     *
+     * The destination is split into chunks that start on page boundaries, so no two
+     * threads write the same page. Copies below a few megabytes, or without worker
+     * threads, are a plain memcpy(). The ranges must not overlap.
+     *
+     * @return dest
+     */
+    void *memcpy_parallel(void *dest, const void *src, size_t count);
+
+    /**
+     * @brief memset() across the pool's threads, split like memcpy_parallel()
+     *
+     * @return dest
+     */
+    void *memset_parallel(void *dest, int value, size_t count);
+
+MINICRT_END
+
+#endif // MINICRT_POOL_H
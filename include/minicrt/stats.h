@@ -0,0 +1,115 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_STATS_H
+#define MINICRT_STATS_H
+
+/**
+ * @file stats.h
+ * @brief Call statistics of the memory and string functions for MiniCRT
+ *
+ * Compiled in only when the library is built with MINI_CRT_ENABLE_LOGGING; other
+ * builds keep the functions below but record nothing, and the entry points carry
+ * no extra code.
+ */
+
+#include "crt.h"
+#include "stdio.h"
+
+MINICRT_BEGIN
+    /**
+     * @brief Functions with statistics
+     */
+    enum stats_function {
+        STATS_MEMCPY = 0,
+        STATS_MEMMOVE,
+        STATS_MEMSET,
+        STATS_MEMCMP,
+        STATS_STRLEN,
+        STATS_STRNLEN,
+        STATS_STRCPY,
+        STATS_STRCMP,
+        STATS_MEMCHR,
+        STATS_MEMRCHR,
+        STATS_RAWMEMCHR,
+        STATS_STRCHR,
+        STATS_STRRCHR,
+        STATS_STRSTR,
+        STATS_MEMMEM,
+        STATS_STRSPN,
+        STATS_STRCSPN,
+        STATS_STRPBRK,
+        STATS_STRSEP,
+        STATS_STRTOK,
+        STATS_FUNCTION_COUNT
+    };
+
+    /**
+     * @brief Number of size classes: 0, then [2^k, 2^(k+1)) for k = 0..63
+     */
+#define STATS_SIZE_CLASSES 65
+
+    /**
+     * @brief Number of alignment classes: the pointers are aligned to 1, 2, 4, 8,
+     *        16, 32 or at least 64 bytes
+     */
+#define STATS_ALIGN_CLASSES 7
+
+    /**
+     * @brief What one function was called with
+     *
+     * The size of a call is the byte count for the mem functions and the length
+     * found for strlen(), strnlen(), strcpy() and the span functions. The searches
+     * record the offset just past the match, 0 when there is none, and strcmp()
+     * always records 0: the entry points only record what the call itself found.
+     * The alignment class is that of the least aligned pointer argument.
+     */
+    struct function_stats {
+        unsigned long long calls;
+        unsigned long long bytes;                          ///< Sum of the sizes
+        unsigned long long sizes[STATS_SIZE_CLASSES];      ///< Calls per size class
+        unsigned long long alignments[STATS_ALIGN_CLASSES]; ///< Calls per alignment class
+    };
+
+    /**
+     * @brief Check whether the library records statistics
+     *
+     * @return Non-zero if it was built with MINI_CRT_ENABLE_LOGGING
+     */
+    int stats_enabled(void);
+
+    /**
+     * @brief Sum the statistics of all threads
+     *
+     * Each thread counts into its own shard, which outlives the thread; this adds
+     * them up. Counts of threads running at the same time may be a few calls behind.
+     *
+     * @param out Receives STATS_FUNCTION_COUNT entries, indexed by stats_function;
+     *            all zero if statistics are not compiled in
+     */
+    void stats_collect(function_stats *out);
+
+    /**
+     * @brief Reset the statistics of all threads to zero
+     */
+    void stats_reset(void);
+
+    /**
+     * @brief Print the statistics as a table
+     *
+     * Called by minicrt_cleanup() with the standard error stream when statistics are
+     * compiled in and anything was recorded.
+     *
+     * @param s Stream to print to
+     */
+    void stats_dump(stream *s);
+
+    /**
+     * @brief Get the name of a function, such as "memcpy"
+     */
+    const char *stats_function_name(stats_function function);
+
+MINICRT_END
+
+#endif // MINICRT_STATS_H
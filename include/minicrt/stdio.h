@@ -0,0 +1,232 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_STDIO_H
+#define MINICRT_STDIO_H
+
+/**
+ * @file stdio.h
+ * @brief Buffered output streams for MiniCRT
+ */
+
+#include "crt.h"
+#include <stdarg.h>
+
+// Lets the compiler check format strings against their arguments
+#if defined(__GNUC__) || defined(__clang__)
+#define MINICRT_PRINTF_FORMAT(format_index, first_arg) __attribute__((format(printf, format_index, first_arg)))
+#else
+#define MINICRT_PRINTF_FORMAT(format_index, first_arg)
+#endif
+
+MINICRT_BEGIN
+    /**
+     * @brief Size of the buffer embedded in every stream
+     */
+    static const size_t STREAM_BUFFER_SIZE = 4096;
+
+    /**
+     * @brief When a stream hands its buffered bytes to the OS
+     */
+    enum buffer_mode {
+        STREAM_UNBUFFERED = 0,     ///< Every write goes straight to the file descriptor
+        STREAM_LINE_BUFFERED = 1,  ///< Flush after each write that contains a newline
+        STREAM_FULLY_BUFFERED = 2  ///< Flush only when the buffer is full or on request
+    };
+
+    /**
+     * @brief One contiguous piece of data for stream_writev()
+     *
+     * Laid out like the POSIX struct iovec.
+     */
+    struct io_vector {
+        const void *base;
+        size_t length;
+    };
+
+    /**
+     * @brief Buffered output stream over a file descriptor
+     *
+     * Streams are safe to share between threads; each write is appended atomically
+     * with respect to other writes on the same stream. The fields are private; treat
+     * the structure as opaque.
+     */
+    struct stream {
+        volatile long lock;              ///< Guards the fields below
+        int fd;                          ///< Destination file descriptor
+        int mode;                        ///< buffer_mode
+        int error;                       ///< Non-zero after a failed write
+        size_t used;                     ///< Bytes waiting in buffer
+        char buffer[STREAM_BUFFER_SIZE]; ///< Pending output
+    };
+
+    /**
+     * @brief Get the stream writing to standard output (file descriptor 1)
+     *
+     * Line-buffered when standard output is a terminal, fully buffered otherwise.
+     *
+     * @return The standard output stream
+     */
+    stream *stdout_stream(void);
+
+    /**
+     * @brief Get the stream writing to standard error (file descriptor 2)
+     *
+     * Line-buffered, so that each diagnostic line costs a single system call.
+     *
+     * @return The standard error stream
+     */
+    stream *stderr_stream(void);
+
+    /**
+     * @brief Set up a stream over an already open file descriptor
+     *
+     * The stream does not own the descriptor and never closes it. Unlike the standard
+     * streams it is not flushed automatically at exit.
+     *
+     * @param s Stream to initialize
+     * @param fd File descriptor to write to
+     * @param mode One of the buffer_mode values
+     */
+    void stream_init(stream *s, int fd, buffer_mode mode);
+
+    /**
+     * @brief Change the buffering mode of a stream
+     *
+     * Pending output is flushed first.
+     *
+     * @param s Stream to change
+     * @param mode One of the buffer_mode values
+     * @return 0 on success, -1 if flushing the pending output failed
+     */
+    int stream_set_mode(stream *s, buffer_mode mode);
+
+    /**
+     * @brief Write bytes to a stream
+     *
+     * Data that fits is copied into the buffer. When it does not, the buffered bytes
+     * and the new data are passed to the OS together in one writev call.
+     *
+     * @param s Stream to write to
+     * @param data Bytes to write
+     * @param size Number of bytes
+     * @return 0 on success, -1 (errno set) if the OS rejected the output
+     */
+    int stream_write(stream *s, const void *data, size_t size);
+
+    /**
+     * @brief Write several pieces of data to a stream as one unit
+     *
+     * Meant for records made of separate parts, such as a header and a payload: the
+     * pieces are buffered together, or handed to the OS in a single writev call.
+     *
+     * @param s Stream to write to
+     * @param vec Pieces to write, in order
+     * @param count Number of pieces
+     * @return 0 on success, -1 (errno set) if the OS rejected the output
+     */
+    int stream_writev(stream *s, const io_vector *vec, int count);
+
+    /**
+     * @brief Write a NUL-terminated string to a stream (no newline is added)
+     *
+     * @param s Stream to write to
+     * @param str String to write
+     * @return 0 on success, -1 (errno set) on failure
+     */
+    int stream_puts(stream *s, const char *str);
+
+    /**
+     * @brief Write a single character to a stream
+     *
+     * @param s Stream to write to
+     * @param c Character to write (converted to unsigned char)
+     * @return 0 on success, -1 (errno set) on failure
+     */
+    int stream_putc(stream *s, int c);
+
+    /**
+     * @brief Hand all buffered bytes of a stream to the OS
+     *
+     * @param s Stream to flush
+     * @return 0 on success, -1 (errno set) on failure
+     */
+    int stream_flush(stream *s);
+
+    /**
+     * @brief Format text into a caller buffer
+     *
+     * Supports the conversions %d %i %u %x %X %s %c %p %f %F %e %E %g %G and %%,
+     * the flags - + space # 0, field width and precision (including *), and the
+     * length modifiers hh h l ll j z t. Floating-point output is correctly rounded and
+     * matches glibc. Nothing is allocated.
+     *
+     * @param buffer Destination; at most size bytes are written, including the
+     *        terminating NUL
+     * @param size Size of the destination buffer; 0 only measures the output
+     * @param format printf-style format string
+     * @return Length of the complete output (excluding the NUL), even if it was
+     *         truncated, or -1 if it exceeds INT_MAX
+     */
+    int snprintf(char *buffer, size_t size, const char *format, ...) MINICRT_PRINTF_FORMAT(3, 4);
+
+    /**
+     * @brief Format text into a caller buffer, taking the arguments as a va_list
+     *
+     * @see snprintf
+     */
+    int vsnprintf(char *buffer, size_t size, const char *format, va_list args) MINICRT_PRINTF_FORMAT(3, 0);
+
+    /**
+     * @brief Format text into a stream
+     *
+     * The output is formatted directly into the stream buffer and follows its
+     * buffering mode.
+     *
+     * @param s Stream to write to
+     * @param format printf-style format string (see snprintf)
+     * @return Number of characters written, or -1 (errno set) on failure
+     */
+    int stream_printf(stream *s, const char *format, ...) MINICRT_PRINTF_FORMAT(2, 3);
+
+    /**
+     * @brief Format text into a stream, taking the arguments as a va_list
+     *
+     * @see stream_printf
+     */
+    int stream_vprintf(stream *s, const char *format, va_list args) MINICRT_PRINTF_FORMAT(2, 0);
+
+    /**
+     * @brief Format text to standard output
+     *
+     * @param format printf-style format string (see snprintf)
+     * @return Number of characters written, or -1 (errno set) on failure
+     */
+    int printf(const char *format, ...) MINICRT_PRINTF_FORMAT(1, 2);
+
+    /**
+     * @brief Write the shortest text that reads back as the same double
+     *
+     * Uses plain notation for decimal exponents from -5 to 16 ("0.1", "123.456",
+     * "1e+17" beyond), "inf" and "nan" for special values. At most 25 characters are
+     * produced.
+     *
+     * @param buffer Destination; at most size bytes are written, including the NUL
+     * @param size Size of the destination buffer
+     * @param value Value to format
+     * @return Length of the complete output (excluding the NUL)
+     */
+    int format_shortest(char *buffer, size_t size, double value);
+
+    /**
+     * @brief Check whether a write to a stream has failed
+     *
+     * @param s Stream to check
+     * @return Non-zero if any write failed since the stream was initialized
+     */
+    int stream_error(const stream *s);
+
+MINICRT_END
+
+#endif // MINICRT_STDIO_H
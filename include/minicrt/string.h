@@ -61,6 +61,446 @@ MINICRT_BEGIN
      */
     int strcmp(const char *lhs, const char *rhs);
 
+    /**
+     * @brief Find the first occurrence of a byte in a memory block
+     *
+     * @param ptr Memory block to search
+     * @param c Byte to find, converted to unsigned char
+     * @param count Number of bytes to search
+     * @return Pointer to the first matching byte, or NULL if none is found
+     */
+    void *memchr(const void *ptr, int c, size_t count);
+
+    /**
+     * @brief Find the last occurrence of a byte in a memory block
+     *
+     * @param ptr Memory block to search
+     * @param c Byte to find, converted to unsigned char
+     * @param count Number of bytes to search
+     * @return Pointer to the last matching byte, or NULL if none is found
+     */
+    void *memrchr(const void *ptr, int c, size_t count);
+
+    /**
+     * @brief Find a byte that is known to be present
+     *
+     * Like memchr() without a length. The behavior is undefined if the byte does not
+     * occur before the end of the mapped memory.
+     *
+     * @param ptr Memory to search
+     * @param c Byte to find, converted to unsigned char
+     * @return Pointer to the first matching byte
+     */
+    void *rawmemchr(const void *ptr, int c);
+
+    /**
+     * @brief Find the first occurrence of a character in a string
+     *
+     * The terminator is part of the string, so strchr(str, '\0') returns its address.
+     *
+     * @param str String to search
+     * @param c Character to find, converted to char
+     * @return Pointer to the first matching character, or NULL if none is found
+     */
+    char *strchr(const char *str, int c);
+
+    /**
+     * @brief Find the last occurrence of a character in a string
+     *
+     * @param str String to search
+     * @param c Character to find, converted to char
+     * @return Pointer to the last matching character, or NULL if none is found
+     * @see strchr
+     */
+    char *strrchr(const char *str, int c);
+
+    /**
+     * @brief Find a substring
+     *
+     * Candidates are filtered on the first and last needle characters with vector
+     * compares; the search falls back to Two-Way matching when the filter stops
+     * paying off, so it runs in linear time on any input.
+     *
+     * @param haystack String to search
+     * @param needle String to find
+     * @return Pointer to the first occurrence of needle in haystack, haystack if needle
+     *         is empty, or NULL if it does not occur
+     */
+    char *strstr(const char *haystack, const char *needle);
+
+    /**
+     * @brief Find a byte sequence in a memory block
+     *
+     * @param haystack Memory block to search
+     * @param haystack_len Size of the memory block in bytes
+     * @param needle Byte sequence to find
+     * @param needle_len Size of the byte sequence in bytes
+     * @return Pointer to the first occurrence of needle in haystack, haystack if
+     *         needle_len is 0, or NULL if it does not occur
+     * @see strstr
+     */
+    void *memmem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len);
+
+    /**
+     * @brief A set of bytes compiled for the span and tokenizer functions
+     *
+     * Holds a 256-bit membership map and the nibble tables used to classify 16 or
+     * 32 bytes at a time with a byte shuffle: low[b & 15] has bit (b >> 4) set for
+     * every member b below 0x80, high[b & 15] bit (b >> 4) - 8 for the others. Build
+     * it once with byteset_init() and reuse it for any number of calls.
+     *
+     * The fields are private; treat the structure as opaque.
+     */
+    struct byteset {
+        unsigned long long bits[4]; ///< Byte b is a member when bit b % 64 of bits[b / 64] is set
+        unsigned char low[16];      ///< Nibble table for members below 0x80
+        unsigned char high[16];     ///< Nibble table for members from 0x80
+        unsigned char members[4];   ///< The first four members, repeating the first to fill
+        unsigned int count;         ///< Number of members
+    };
+
+    /**
+     * @brief Compile a set from the characters of a string
+     *
+     * @param set Set to initialize
+     * @param chars Members of the set; the terminator is not a member
+     */
+    void byteset_init(byteset *set, const char *chars);
+
+    /**
+     * @brief Compile a set from an array of bytes, which may include NUL
+     *
+     * @param set Set to initialize
+     * @param bytes Members of the set; duplicates are allowed
+     * @param count Number of bytes in the array
+     */
+    void byteset_init_bytes(byteset *set, const void *bytes, size_t count);
+
+    /**
+     * @brief Test whether a byte is a member of a set
+     *
+     * @param set Compiled set
+     * @param c Byte to test, converted to unsigned char
+     * @return Non-zero if c is a member
+     */
+    int byteset_contains(const byteset *set, int c);
+
+    /**
+     * @brief Length of the initial segment of a string made of set members
+     *
+     * @param set Compiled set
+     * @param str String to scan; its terminator always ends the segment
+     * @return Number of characters before the first non-member
+     * @see strspn
+     */
+    size_t byteset_span(const byteset *set, const char *str);
+
+    /**
+     * @brief Length of the initial segment of a string made of non-members
+     *
+     * @param set Compiled set
+     * @param str String to scan; its terminator always ends the segment
+     * @return Number of characters before the first member or the terminator
+     * @see strcspn
+     */
+    size_t byteset_cspan(const byteset *set, const char *str);
+
+    /**
+     * @brief Length of the initial segment of a byte range made of set members
+     *
+     * A NUL byte is an ordinary byte, so the range does not need a terminator.
+     *
+     * @param set Compiled set
+     * @param str First byte of the range
+     * @param length Number of bytes available
+     * @return Number of bytes before the first non-member, at most length
+     */
+    size_t byteset_nspan(const byteset *set, const char *str, size_t length);
+
+    /**
+     * @brief Length of the initial segment of a byte range made of non-members
+     *
+     * @param set Compiled set
+     * @param str First byte of the range
+     * @param length Number of bytes available
+     * @return Number of bytes before the first member, at most length
+     * @see byteset_nspan
+     */
+    size_t byteset_ncspan(const byteset *set, const char *str, size_t length);
+
+    /**
+     * @brief Find the first set member in a string
+     *
+     * @param set Compiled set
+     * @param str String to search
+     * @return Pointer to the first member, or NULL if none occurs before the terminator
+     * @see strpbrk
+     */
+    char *byteset_pbrk(const byteset *set, const char *str);
+
+    /**
+     * @brief Split the next field off a string at a set member
+     *
+     * @param set Compiled set of delimiters
+     * @param stringp Address of the string to split; receives the address after the
+     *        delimiter, or NULL when the field runs to the terminator
+     * @return The field, terminated in place, or NULL if *stringp is NULL
+     * @see strsep
+     */
+    char *byteset_sep(const byteset *set, char **stringp);
+
+    /**
+     * @brief Find the next token of a string, skipping runs of set members
+     *
+     * @param set Compiled set of delimiters
+     * @param str String to tokenize on the first call, NULL to continue
+     * @param saveptr State kept between calls
+     * @return The token, terminated in place, or NULL when no token is left
+     * @see strtok_r
+     */
+    char *byteset_tok(const byteset *set, char *str, char **saveptr);
+
+    /**
+     * @brief Find the first set member in a byte range
+     *
+     * @param set Compiled set
+     * @param str First byte of the range
+     * @param length Number of bytes available
+     * @return Pointer to the first member, or NULL if the range has none
+     * @see byteset_pbrk
+     */
+    char *byteset_npbrk(const byteset *set, const char *str, size_t length);
+
+    /**
+     * @brief Split the next field off a byte range at a set member
+     *
+     * Like byteset_sep(), but for text without a terminator: the range is left
+     * unmodified and the field is returned with its length.
+     *
+     * @param set Compiled set of delimiters
+     * @param stringp Address of the rest of the range; receives the address after the
+     *        delimiter, or NULL when the field runs to the end
+     * @param length Bytes left in the range; reduced by the field and its delimiter
+     * @param field_length Receives the length of the field
+     * @return The field, or NULL if *stringp is NULL
+     */
+    const char *byteset_nsep(const byteset *set, const char **stringp, size_t *length, size_t *field_length);
+
+    /**
+     * @brief Find the next token of a byte range, skipping runs of set members
+     *
+     * Like byteset_tok(), but for text without a terminator: the range is left
+     * unmodified and the token is returned with its length.
+     *
+     * @param set Compiled set of delimiters
+     * @param saveptr Address of the rest of the range; advanced past the token and
+     *        the delimiter after it
+     * @param length Bytes left in the range, updated with saveptr
+     * @param token_length Receives the length of the token
+     * @return The token, or NULL when no token is left
+     */
+    const char *byteset_ntok(const byteset *set, const char **saveptr, size_t *length, size_t *token_length);
+
+    /**
+     * @brief Length of the initial segment of a string made of accepted characters
+     *
+     * Compiles accept into a byteset on every call; use byteset_span() to apply one
+     * set many times.
+     *
+     * @param str String to scan
+     * @param accept Characters to accept
+     * @return Number of characters before the first one not in accept
+     */
+    size_t strspn(const char *str, const char *accept);
+
+    /**
+     * @brief Length of the initial segment of a string without rejected characters
+     *
+     * @param str String to scan
+     * @param reject Characters that end the segment
+     * @return Number of characters before the first one in reject or the terminator
+     * @see strspn
+     */
+    size_t strcspn(const char *str, const char *reject);
+
+    /**
+     * @brief Find the first occurrence of any of a set of characters
+     *
+     * @param str String to search
+     * @param accept Characters to find
+     * @return Pointer to the first character of str that is in accept, or NULL
+     * @see strspn
+     */
+    char *strpbrk(const char *str, const char *accept);
+
+    /**
+     * @brief Split the next field off a string at a delimiter
+     *
+     * Unlike strtok_r(), consecutive delimiters produce empty fields, as needed for
+     * CSV and TSV.
+     *
+     * @param stringp Address of the string to split; receives the address after the
+     *        delimiter, or NULL when the field runs to the terminator
+     * @param delim Delimiter characters
+     * @return The field, terminated in place, or NULL if *stringp is NULL
+     */
+    char *strsep(char **stringp, const char *delim);
+
+    /**
+     * @brief Find the next token of a string, skipping runs of delimiters
+     *
+     * @param str String to tokenize on the first call, NULL to continue
+     * @param delim Delimiter characters
+     * @param saveptr State kept between calls
+     * @return The token, terminated in place, or NULL when no token is left
+     */
+    char *strtok_r(char *str, const char *delim, char **saveptr);
+
+    /**
+     * @brief Length of the initial segment of a character range made of accepted characters
+     *
+     * Like strspn(), but examines at most length characters and does not need a NUL
+     * terminator; a NUL byte is an ordinary character.
+     *
+     * @see strspn, byteset_nspan
+     */
+    size_t strnspn(const char *str, size_t length, const char *accept);
+
+    /**
+     * @brief Length of the initial segment of a character range without rejected characters
+     *
+     * @see strcspn, strnspn
+     */
+    size_t strncspn(const char *str, size_t length, const char *reject);
+
+    /**
+     * @brief Find the first occurrence of any of a set of characters in a character range
+     *
+     * @return Pointer to the first character of the range that is in accept, or NULL
+     * @see strpbrk, strnspn
+     */
+    char *strnpbrk(const char *str, size_t length, const char *accept);
+
+    /**
+     * @brief Split the next field off a character range at a delimiter
+     *
+     * The range is not modified, so the field comes with its length.
+     *
+     * @see strsep, byteset_nsep
+     */
+    const char *strnsep(const char **stringp, size_t *length, const char *delim, size_t *field_length);
+
+    /**
+     * @brief Find the next token of a character range, skipping runs of delimiters
+     *
+     * The range is not modified, so the token comes with its length.
+     *
+     * @see strtok_r, byteset_ntok
+     */
+    const char *strntok_r(const char **saveptr, size_t *length, const char *delim, size_t *token_length);
+
+    /**
+     * @brief Convert the initial part of a string to a long
+     *
+     * Skips leading whitespace, accepts an optional sign and, for base 16 or 0, a
+     * "0x" prefix. Base 0 selects octal for a leading 0, hexadecimal for "0x" and
+     * decimal otherwise.
+     *
+     * @param str String to parse
+     * @param end If not NULL, receives the address after the last character used, or
+     *        str when no number was found
+     * @param base Number base, 0 or 2 to 36
+     * @return The parsed value; LONG_MIN or LONG_MAX with errno set to ERANGE when it
+     *         does not fit, 0 with errno set to EINVAL for an unsupported base
+     */
+    long strtol(const char *str, char **end, int base);
+
+    /**
+     * @brief Convert the initial part of a string to an unsigned long
+     *
+     * Same syntax as strtol(). A minus sign negates the result in the unsigned type.
+     *
+     * @return The parsed value, or ULONG_MAX with errno set to ERANGE on overflow
+     * @see strtol
+     */
+    unsigned long strtoul(const char *str, char **end, int base);
+
+    /**
+     * @brief Convert the initial part of a string to a long long
+     *
+     * @see strtol
+     */
+    long long strtoll(const char *str, char **end, int base);
+
+    /**
+     * @brief Convert the initial part of a string to an unsigned long long
+     *
+     * @see strtoul
+     */
+    unsigned long long strtoull(const char *str, char **end, int base);
+
+    /**
+     * @brief Convert the initial part of a string to a double
+     *
+     * Accepts decimal numbers with an optional exponent, hexadecimal numbers with an
+     * optional binary exponent ("0x1.8p3"), "inf", "infinity" and "nan", all with an
+     * optional sign and in any case. The result is correctly rounded (to nearest, ties
+     * to even) for any number of digits.
+     *
+     * @param str String to parse
+     * @param end If not NULL, receives the address after the last character used, or
+     *        str when no number was found
+     * @return The parsed value; +-infinity or +-0 with errno set to ERANGE when a finite
+     *         non-zero number is out of range
+     */
+    double strtod(const char *str, char **end);
+
+    /**
+     * @brief Convert the initial part of a character range to a long
+     *
+     * Like strtol(), but reads at most length characters and does not need a NUL
+     * terminator, so fields can be parsed in place from a larger buffer.
+     *
+     * @param str First character of the range
+     * @param length Number of characters available
+     * @param end If not NULL, receives the address after the last character used
+     * @param base Number base, 0 or 2 to 36
+     * @return The parsed value
+     * @see strtol
+     */
+    long strntol(const char *str, size_t length, char **end, int base);
+
+    /**
+     * @brief Convert the initial part of a character range to an unsigned long
+     *
+     * @see strntol, strtoul
+     */
+    unsigned long strntoul(const char *str, size_t length, char **end, int base);
+
+    /**
+     * @brief Convert the initial part of a character range to a long long
+     *
+     * @see strntol, strtoll
+     */
+    long long strntoll(const char *str, size_t length, char **end, int base);
+
+    /**
+     * @brief Convert the initial part of a character range to an unsigned long long
+     *
+     * @see strntol, strtoull
+     */
+    unsigned long long strntoull(const char *str, size_t length, char **end, int base);
+
+    /**
+     * @brief Convert the initial part of a character range to a double
+     *
+     * Like strtod(), but reads at most length characters and does not need a NUL
+     * terminator.
+     *
+     * @see strtod
+     */
+    double strntod(const char *str, size_t length, char **end);
+
 MINICRT_END
 
 #endif // MINICRT_STRING_H
@@ -0,0 +1,174 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_SYNC_H
+#define MINICRT_SYNC_H
+
+/**
+ * @file sync.h
+ * @brief Mutex, condition variable, once flag and reader-writer lock for MiniCRT
+ *
+ * All primitives are a few 32-bit words that threads sleep on with the Linux futex
+ * system call. Taking and releasing an uncontended lock is a single atomic
+ * instruction with no system call. They need no destruction, and the *_INIT
+ * macros initialize them statically. Other platforms get the same semantics with
+ * spinning in place of sleeping.
+ */
+
+#include "crt.h"
+#include "time.h"
+
+MINICRT_BEGIN
+    /**
+     * @brief Mutual exclusion lock
+     *
+     * A thread that finds the lock taken spins for a while, as long as the lock was
+     * recently released quickly, and then sleeps. Not recursive. The fields are
+     * private.
+     */
+    struct mutex {
+        volatile int state; ///< 0 unlocked, 1 locked, 2 locked and a thread may be sleeping
+        int spins;          ///< Running average of the spins that acquired the lock
+    };
+
+#define MUTEX_INIT {0, 0}
+
+    /**
+     * @brief Initialize a mutex, the same as MUTEX_INIT
+     */
+    void mutex_init(mutex *m);
+
+    /**
+     * @brief Acquire a mutex, waiting as long as necessary
+     */
+    void mutex_lock(mutex *m);
+
+    /**
+     * @brief Acquire a mutex if it is free
+     *
+     * @return Non-zero if the calling thread now holds the mutex
+     */
+    int mutex_trylock(mutex *m);
+
+    /**
+     * @brief Release a mutex held by the calling thread
+     */
+    void mutex_unlock(mutex *m);
+
+    /**
+     * @brief Condition variable, used together with a mutex
+     *
+     * condvar_broadcast() wakes one waiter and moves the others straight onto the
+     * mutex's wait queue (FUTEX_CMP_REQUEUE), so they are woken one at a time as the
+     * mutex is released instead of all at once only to block on it again. All
+     * waiters of a condition variable must use the same mutex. The fields are
+     * private.
+     */
+    struct condvar {
+        volatile int sequence; ///< Bumped by every signal; waiters sleep on it
+        volatile int waiters;  ///< Threads inside condvar_wait()
+        mutex *m;              ///< Mutex of the waiters, for requeueing
+    };
+
+#define CONDVAR_INIT {0, 0, 0}
+
+    /**
+     * @brief Initialize a condition variable, the same as CONDVAR_INIT
+     */
+    void condvar_init(condvar *cv);
+
+    /**
+     * @brief Release a mutex, wait for a signal and reacquire the mutex
+     *
+     * Wakeups can be spurious; check the condition in a loop.
+     *
+     * @param cv Condition variable to wait on
+     * @param m Mutex held by the calling thread
+     */
+    void condvar_wait(condvar *cv, mutex *m);
+
+    /**
+     * @brief Wait like condvar_wait(), for at most a given time
+     *
+     * @param cv Condition variable to wait on
+     * @param m Mutex held by the calling thread; held again on return either way
+     * @param timeout Relative time to wait
+     * @return 0 when woken, -1 with errno set to ETIMEDOUT when the time ran out
+     */
+    int condvar_timedwait(condvar *cv, mutex *m, const timespec *timeout);
+
+    /**
+     * @brief Wake one thread waiting on a condition variable
+     *
+     * Without waiters this is a single load.
+     */
+    void condvar_signal(condvar *cv);
+
+    /**
+     * @brief Wake every thread waiting on a condition variable
+     */
+    void condvar_broadcast(condvar *cv);
+
+    /**
+     * @brief Flag for call_once()
+     */
+    struct once_flag {
+        volatile int state; ///< 0 not run, 1 running, 2 running with waiters, 3 done
+    };
+
+#define ONCE_FLAG_INIT {0}
+
+    /**
+     * @brief Run a function exactly once per flag
+     *
+     * The first caller runs fn(arg); callers arriving meanwhile sleep until it
+     * returns. Once it has, a call is a single load.
+     *
+     * @param flag Flag, initialized with ONCE_FLAG_INIT
+     * @param fn Function to run
+     * @param arg Argument for fn
+     */
+    void call_once(once_flag *flag, void (*fn)(void *), void *arg);
+
+    /**
+     * @brief Reader-writer lock that prefers writers
+     *
+     * Any number of readers or one writer may hold it. As soon as a writer is
+     * waiting, new readers wait too, so a stream of readers cannot starve writers.
+     * Up to 2^20 - 1 readers and 1023 waiting writers. The fields are private.
+     */
+    struct rwlock {
+        volatile int state; ///< Reader count, waiting writers, writer and sleeper bits
+    };
+
+#define RWLOCK_INIT {0}
+
+    /**
+     * @brief Initialize a reader-writer lock, the same as RWLOCK_INIT
+     */
+    void rwlock_init(rwlock *lock);
+
+    /**
+     * @brief Acquire a reader-writer lock for reading
+     */
+    void rwlock_read_lock(rwlock *lock);
+
+    /**
+     * @brief Release a read lock
+     */
+    void rwlock_read_unlock(rwlock *lock);
+
+    /**
+     * @brief Acquire a reader-writer lock for writing
+     */
+    void rwlock_write_lock(rwlock *lock);
+
+    /**
+     * @brief Release a write lock
+     */
+    void rwlock_write_unlock(rwlock *lock);
+
+MINICRT_END
+
+#endif // MINICRT_SYNC_H
@@ -0,0 +1,65 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_THREAD_H
+#define MINICRT_THREAD_H
+
+/**
+ * @file thread.h
+ * @brief Thread creation and joining for MiniCRT
+ *
+ * In a program that starts in MiniCRT's own _start (Linux x86-64), threads are
+ * created with the clone system call on stacks the runtime maps itself, with a
+ * guard page below each stack. Every thread gets its own copy of the program's
+ * thread_local variables, installed as the thread pointer (%fs), so errno, the
+ * allocator's thread cache and the other per-thread state of the runtime are
+ * per-thread as well. Stacks of joined threads are kept for reuse, which makes
+ * creating a thread little more than the clone call itself.
+ *
+ * When the process was started by the system C library, that library owns the
+ * thread pointer, and threads are created with pthread_create() instead.
+ */
+
+#include "crt.h"
+
+MINICRT_BEGIN
+    /**
+     * @brief A thread created by thread_create(); the fields are private
+     */
+    struct thread;
+
+    /**
+     * @brief Function a thread runs; its return value is passed to thread_join()
+     */
+    typedef int (*thread_start)(void *arg);
+
+    /**
+     * @brief Stack size of threads created with a stack_size of 0
+     */
+#define THREAD_DEFAULT_STACK_SIZE (512 * 1024)
+
+    /**
+     * @brief Start a new thread
+     *
+     * @param out Receives the thread, to be passed to thread_join() exactly once
+     * @param start Function the thread runs
+     * @param arg Argument for start
+     * @param stack_size Stack size in bytes, rounded up to whole pages; 0 for
+     *                   THREAD_DEFAULT_STACK_SIZE
+     * @return 0 on success, -1 with errno set on failure
+     */
+    int thread_create(thread **out, thread_start start, void *arg, size_t stack_size);
+
+    /**
+     * @brief Wait for a thread to finish and release it
+     *
+     * @param t Thread from thread_create()
+     * @param result Receives the value start returned; may be NULL
+     * @return 0 on success, -1 with errno set to EINVAL if t is NULL
+     */
+    int thread_join(thread *t, int *result);
+
+MINICRT_END
+
+#endif // MINICRT_THREAD_H
@@ -0,0 +1,119 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_TIME_H
+#define MINICRT_TIME_H
+
+/**
+ * @file time.h
+ * @brief Clocks and a cycle-counter timer for MiniCRT
+ */
+
+#include "crt.h"
+
+// Clock identifiers for clock_gettime(), with the Linux values
+#ifndef CLOCK_REALTIME
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+#define CLOCK_PROCESS_CPUTIME_ID 2
+#define CLOCK_THREAD_CPUTIME_ID 3
+#define CLOCK_MONOTONIC_RAW 4
+#define CLOCK_REALTIME_COARSE 5
+#define CLOCK_MONOTONIC_COARSE 6
+#define CLOCK_BOOTTIME 7
+#endif
+
+MINICRT_BEGIN
+    /**
+     * @brief Time in seconds and nanoseconds
+     *
+     * Laid out like the Linux x86-64 struct timespec.
+     */
+    struct timespec {
+        long tv_sec;
+        long tv_nsec; ///< 0 to 999999999
+    };
+
+    /**
+     * @brief Time in seconds and microseconds
+     *
+     * Laid out like the Linux x86-64 struct timeval.
+     */
+    struct timeval {
+        long tv_sec;
+        long tv_usec; ///< 0 to 999999
+    };
+
+    /**
+     * @brief Read a clock
+     *
+     * Served by the kernel's vDSO when it exports the function, which avoids the
+     * system call for the common clocks; otherwise the system call is made directly.
+     *
+     * @param clock_id One of the CLOCK_* constants
+     * @param ts Receives the time
+     * @return 0 on success, -1 with errno set (EINVAL for an unknown clock)
+     */
+    int clock_gettime(int clock_id, timespec *ts);
+
+    /**
+     * @brief Read the wall clock with microsecond resolution
+     *
+     * @param tv Receives the time since the Unix epoch
+     * @param tz Obsolete time zone output; pass NULL
+     * @return 0 on success, -1 with errno set
+     */
+    int gettimeofday(timeval *tv, void *tz);
+
+    /**
+     * @brief Check whether the clocks are read through the vDSO
+     *
+     * @return Non-zero if clock_gettime() and gettimeofday() avoid the system call
+     */
+    int clock_has_vdso(void);
+
+    /**
+     * @brief Read the CPU's time stamp counter
+     *
+     * The read is not ordered with the surrounding instructions, so the CPU may move
+     * it across neighbouring work; bracket short regions with tsc_read_ordered().
+     *
+     * @return Current counter value, or 0 if the architecture has none
+     */
+    unsigned long long tsc_read(void);
+
+    /**
+     * @brief Read the time stamp counter after all earlier instructions have finished
+     *
+     * Uses RDTSCP where available, with a fence so that later instructions do not
+     * start before the read either.
+     *
+     * @return Current counter value, or 0 if the architecture has none
+     */
+    unsigned long long tsc_read_ordered(void);
+
+    /**
+     * @brief Get the rate of the time stamp counter
+     *
+     * Taken from CPUID when the CPU reports it, otherwise measured against
+     * CLOCK_MONOTONIC from a reference point recorded by minicrt_init(). The
+     * measurement is finished on the first call; if less than a couple of
+     * milliseconds have passed since the reference point, that call waits for
+     * the rest.
+     *
+     * @return Ticks per second, or 0 if the CPU has no invariant time stamp counter
+     */
+    unsigned long long tsc_frequency(void);
+
+    /**
+     * @brief Convert a time stamp counter interval to nanoseconds
+     *
+     * @param ticks Difference of two tsc_read() values
+     * @return The interval in nanoseconds, or 0 if tsc_frequency() is 0
+     */
+    unsigned long long tsc_to_ns(unsigned long long ticks);
+
+MINICRT_END
+
+#endif // MINICRT_TIME_H
@@ -0,0 +1,203 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_URING_H
+#define MINICRT_URING_H
+
+/**
+ * @file uring.h
+ * @brief Asynchronous batched I/O over Linux io_uring for MiniCRT
+ */
+
+#include "crt.h"
+#include "stdio.h"
+#include "time.h"
+
+MINICRT_BEGIN
+    /**
+     * @brief Options for io_ring_init(), combined with bitwise OR
+     */
+    enum io_ring_flags {
+        /**
+         * A kernel thread polls the submission queue, so submitting usually needs no
+         * system call at all. It sleeps after about a second without work and is
+         * woken by the next submission. May need privileges on older kernels.
+         */
+        IO_RING_SQPOLL = 1u << 0
+    };
+
+    /**
+     * @brief Options for io_ring_fsync()
+     */
+    enum io_fsync_flags {
+        IO_FSYNC_DATASYNC = 1u << 0 ///< Like fdatasync(): skip metadata not needed to read the data back
+    };
+
+    /**
+     * @brief One finished operation, as returned by io_ring_peek() and io_ring_wait()
+     */
+    struct io_completion {
+        unsigned long long user_data; ///< Value passed when the operation was queued
+        int result;                   ///< What the system call would return, or -errno on failure
+        unsigned int flags;
+    };
+
+    /**
+     * @brief An io_uring instance: a submission and a completion queue shared with the kernel
+     *
+     * Operations are queued with the io_ring_read() family, which only fill in a slot
+     * of the submission queue; nothing reaches the kernel until io_ring_submit(),
+     * io_ring_submit_and_wait() or io_ring_wait(), which hand over every queued
+     * operation in one system call. A ring is not thread-safe. The fields are
+     * private; treat the structure as opaque.
+     */
+    struct io_ring {
+        int fd;                      ///< Ring file descriptor
+        unsigned int flags;          ///< io_ring_flags given to io_ring_init()
+        unsigned int features;       ///< Feature bits reported by the kernel
+        unsigned int *sq_head;       ///< Advanced by the kernel as it consumes entries
+        unsigned int *sq_tail;       ///< Advanced by us to publish entries
+        unsigned int *sq_flags;
+        unsigned int sq_mask;
+        unsigned int sq_entries;
+        void *sqes;                  ///< Submission queue entries
+        unsigned int sqe_head;       ///< First queued entry not yet published
+        unsigned int sqe_tail;       ///< Next free entry
+        unsigned int *cq_head;       ///< Advanced by us as completions are consumed
+        unsigned int *cq_tail;       ///< Advanced by the kernel
+        unsigned int cq_mask;
+        void *cqes;                  ///< Completion queue entries
+        void *ring_mapping;          ///< Queue indices and submission array (and completions, usually)
+        size_t ring_length;
+        void *cq_mapping;            ///< Completions when the kernel maps them separately, or NULL
+        size_t cq_length;
+        size_t sqes_length;
+    };
+
+    /**
+     * @brief Create a ring
+     *
+     * @param ring Ring to initialize
+     * @param entries Submission queue size, rounded up to a power of two by the
+     *                kernel; the completion queue gets twice as many slots
+     * @param flags Bitwise OR of io_ring_flags values, or 0
+     * @return 0 on success, -1 with errno set (ENOSYS or EPERM where io_uring is
+     *         unavailable or disabled, EINVAL on other platforms)
+     */
+    int io_ring_init(io_ring *ring, unsigned int entries, unsigned int flags);
+
+    /**
+     * @brief Tear down a ring; operations still in flight are cancelled
+     *
+     * @param ring Ring from io_ring_init()
+     */
+    void io_ring_destroy(io_ring *ring);
+
+    /**
+     * @brief Queue a read
+     *
+     * Buffers and vectors must stay valid until the operation completes.
+     *
+     * @param ring Ring to queue on
+     * @param fd File descriptor to read from
+     * @param buf Destination buffer
+     * @param length Number of bytes to read
+     * @param offset File offset, or -1 for the current position (pipes, sockets)
+     * @param user_data Returned with the completion
+     * @return 0 on success, -1 with errno set to EAGAIN if the submission queue is
+     *         full even after submitting what it holds
+     */
+    int io_ring_read(io_ring *ring, int fd, void *buf, unsigned int length, long long offset,
+                     unsigned long long user_data);
+
+    /**
+     * @brief Queue a write; parameters as for io_ring_read()
+     */
+    int io_ring_write(io_ring *ring, int fd, const void *buf, unsigned int length, long long offset,
+                      unsigned long long user_data);
+
+    /**
+     * @brief Queue a scatter read into several buffers; parameters as for io_ring_read()
+     */
+    int io_ring_readv(io_ring *ring, int fd, const io_vector *vec, unsigned int count, long long offset,
+                      unsigned long long user_data);
+
+    /**
+     * @brief Queue a gather write from several buffers; parameters as for io_ring_read()
+     */
+    int io_ring_writev(io_ring *ring, int fd, const io_vector *vec, unsigned int count, long long offset,
+                       unsigned long long user_data);
+
+    /**
+     * @brief Queue an fsync
+     *
+     * It is not ordered after writes queued earlier; wait for those to complete first.
+     *
+     * @param ring Ring to queue on
+     * @param fd File descriptor to flush
+     * @param flags Bitwise OR of io_fsync_flags values, or 0
+     * @param user_data Returned with the completion
+     * @return 0 on success, -1 with errno set to EAGAIN if the queue is full
+     */
+    int io_ring_fsync(io_ring *ring, int fd, unsigned int flags, unsigned long long user_data);
+
+    /**
+     * @brief Queue a timeout
+     *
+     * Completes with -ETIME (-62) once the relative time ts has passed, or with 0 as
+     * soon as count other operations have completed, whichever comes first. Combined
+     * with io_ring_wait() it bounds how long a wait can block.
+     *
+     * @param ring Ring to queue on
+     * @param ts Relative timeout; must stay valid until the operation completes
+     * @param count Number of completions that end the timeout early, 0 for none
+     * @param user_data Returned with the completion
+     * @return 0 on success, -1 with errno set to EAGAIN if the queue is full
+     */
+    int io_ring_timeout(io_ring *ring, const timespec *ts, unsigned int count, unsigned long long user_data);
+
+    /**
+     * @brief Hand all queued operations to the kernel without waiting
+     *
+     * With IO_RING_SQPOLL this only makes a system call when the polling thread
+     * has gone to sleep.
+     *
+     * @param ring Ring to submit
+     * @return Number of operations submitted, or -1 with errno set
+     */
+    int io_ring_submit(io_ring *ring);
+
+    /**
+     * @brief Submit all queued operations and wait for completions, in one system call
+     *
+     * @param ring Ring to submit
+     * @param min_complete Return once this many completions are available
+     * @return Number of operations submitted, or -1 with errno set
+     */
+    int io_ring_submit_and_wait(io_ring *ring, unsigned int min_complete);
+
+    /**
+     * @brief Collect available completions without blocking or a system call
+     *
+     * @param ring Ring to collect from
+     * @param out Receives the completions
+     * @param max Capacity of out
+     * @return Number of completions stored
+     */
+    unsigned int io_ring_peek(io_ring *ring, io_completion *out, unsigned int max);
+
+    /**
+     * @brief Submit queued operations and collect at least min completions
+     *
+     * @param ring Ring to use
+     * @param out Receives the completions
+     * @param max Capacity of out
+     * @param min Number of completions to wait for (at most max)
+     * @return Number of completions stored, or -1 with errno set
+     */
+    int io_ring_wait(io_ring *ring, io_completion *out, unsigned int max, unsigned int min);
+
+MINICRT_END
+
+#endif // MINICRT_URING_H
@@ -0,0 +1,192 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/memory.h"
+#include "crt_internal.h"
+
+MINICRT_BEGIN
+    /*
+     * Arena layout
+     *
+     * An arena is a singly linked list of mmapped chunks, oldest first. Allocation bumps
+     * a pointer through the current chunk; when it runs out the arena moves on to the
+     * next chunk in the list if that one is big enough, and otherwise maps a new chunk
+     * and links it in after the current one. Reset and rollback only move the pointer
+     * back, so every chunk after the current one is kept for the next pass.
+     */
+    struct arena_chunk {
+        arena_chunk *next;
+        char *end;               // one past the last usable byte
+        unsigned int last_epoch; // arena epoch in which the chunk was last allocated from
+        unsigned int released;   // non-zero while its pages are discarded
+    };
+
+namespace detail {
+    static const size_t kArenaPageSize = 4096;
+    static const size_t kArenaHeaderSize = 64;
+    static const size_t kArenaDefaultChunk = 64u << 10;
+    static const size_t kArenaMaxChunk = 64u << 20;
+    static const size_t kArenaDefaultAlign = 16;
+
+    static_assert(sizeof(arena_chunk) <= kArenaHeaderSize, "chunk header must fit before the data");
+
+    static MINICRT_INLINE char *chunk_data(arena_chunk *chunk) {
+        return (char *) chunk + kArenaHeaderSize;
+    }
+
+    static MINICRT_INLINE size_t chunk_map_size(arena_chunk *chunk) {
+        return (size_t) (chunk->end - (char *) chunk);
+    }
+
+    static MINICRT_INLINE size_t align_up(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+    /**
+     * @brief Map a chunk with room for at least size bytes
+     */
+    static arena_chunk *chunk_create(size_t size) {
+        if (size > ~(size_t) 0 - kArenaHeaderSize - kArenaPageSize)
+            return 0;
+
+        size_t map_size = align_up(size + kArenaHeaderSize, kArenaPageSize);
+        arena_chunk *chunk = (arena_chunk *) map_pages(map_size);
+        if (!chunk)
+            return 0;
+
+        chunk->next = 0;
+        chunk->end = (char *) chunk + map_size;
+        chunk->last_epoch = 0;
+        chunk->released = 0;
+        return chunk;
+    }
+
+    static MINICRT_INLINE void enter_chunk(arena *a, arena_chunk *chunk) {
+        a->current = chunk;
+        a->ptr = chunk_data(chunk);
+        a->end = chunk->end;
+        chunk->last_epoch = a->epoch;
+        chunk->released = 0;
+    }
+
+    /**
+     * @brief Move to a chunk that can hold size bytes at the given alignment
+     */
+    static void *arena_alloc_slow(arena *a, size_t size, size_t align) {
+        if (size > ~(size_t) 0 - align)
+            return 0;
+        size_t needed = size + align - 1;
+
+        arena_chunk *chunk = a->current->next;
+        if (!chunk || (size_t) (chunk->end - chunk_data(chunk)) < needed) {
+            chunk = chunk_create(needed > a->chunk_size ? needed : a->chunk_size);
+            if (!chunk)
+                return 0;
+            chunk->next = a->current->next;
+            a->current->next = chunk;
+            if (a->chunk_size < kArenaMaxChunk)
+                a->chunk_size <<= 1;
+        }
+
+        enter_chunk(a, chunk);
+        char *p = (char *) align_up((size_t) a->ptr, align);
+        a->ptr = p + size;
+        return p;
+    }
+} // namespace detail
+
+    /**
+     * @brief Create an arena and map its first chunk
+     */
+    int arena_create(arena *a, size_t initial_size, unsigned int flags) {
+        if (!initial_size)
+            initial_size = detail::kArenaDefaultChunk;
+
+        arena_chunk *chunk = detail::chunk_create(initial_size);
+        if (!chunk) {
+            errno = ENOMEM;
+            return -1;
+        }
+
+        a->first = chunk;
+        a->flags = flags;
+        a->epoch = 0;
+        a->chunk_size = detail::chunk_map_size(chunk) * 2;
+        detail::enter_chunk(a, chunk);
+        return 0;
+    }
+
+    /**
+     * @brief Unmap every chunk of an arena
+     */
+    void arena_destroy(arena *a) {
+        arena_chunk *chunk = a->first;
+        while (chunk) {
+            arena_chunk *next = chunk->next;
+            detail::unmap_pages(chunk, detail::chunk_map_size(chunk));
+            chunk = next;
+        }
+
+        a->ptr = a->end = 0;
+        a->current = a->first = 0;
+    }
+
+    /**
+     * @brief Allocate memory from an arena
+     */
+    void *arena_alloc(arena *a, size_t size, size_t align) {
+        if (!align)
+            align = detail::kArenaDefaultAlign;
+
+        char *p = (char *) detail::align_up((size_t) a->ptr, align);
+        if (MINICRT_LIKELY(p <= a->end && size <= (size_t) (a->end - p))) {
+            a->ptr = p + size;
+            return p;
+        }
+
+        p = (char *) detail::arena_alloc_slow(a, size, align);
+        if (!p)
+            errno = ENOMEM;
+        return p;
+    }
+
+    /**
+     * @brief Remember the current allocation position of an arena
+     */
+    arena_checkpoint arena_save(const arena *a) {
+        arena_checkpoint checkpoint;
+        checkpoint.chunk = a->current;
+        checkpoint.ptr = a->ptr;
+        return checkpoint;
+    }
+
+    /**
+     * @brief Free everything allocated since a checkpoint
+     */
+    void arena_rollback(arena *a, arena_checkpoint checkpoint) {
+        a->current = checkpoint.chunk;
+        a->ptr = checkpoint.ptr;
+        a->end = checkpoint.chunk->end;
+    }
+
+    /**
+     * @brief Free everything allocated from an arena
+     */
+    void arena_reset(arena *a) {
+        if (a->flags & ARENA_RELEASE_COLD) {
+            // A chunk not entered since the previous reset is cold: drop its pages
+            for (arena_chunk *chunk = a->first->next; chunk; chunk = chunk->next) {
+                if (!chunk->released && chunk->last_epoch != a->epoch) {
+                    // The first page holds the header and stays resident
+                    char *start = (char *) chunk + detail::kArenaPageSize;
+                    if (start < chunk->end)
+                        detail::discard_pages(start, (size_t) (chunk->end - start));
+                    chunk->released = 1;
+                }
+            }
+        }
+        a->epoch++;
+        detail::enter_chunk(a, a->first);
+    }
+
+MINICRT_END
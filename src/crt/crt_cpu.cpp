@@ -0,0 +1,346 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/cpu.h"
+#include "minicrt/string.h"
+#include "crt_internal.h"
+
+MINICRT_BEGIN
+namespace detail {
+    // Kernels every CPU of the target architecture can run
+    dispatch_table g_dispatch = {
+#ifdef MINICRT_X86_64
+        memcpy_sse2,
+        memset_sse2,
+        memmove_sse2,
+        memcmp_sse2,
+        strlen_sse2,
+        strnlen_sse2,
+        strcmp_sse2,
+        memchr_sse2,
+        memrchr_sse2,
+        strchr_sse2,
+        strrchr_sse2,
+        memmem_sse2,
+        byteset_scan_sse2,
+#else
+        memcpy_generic,
+        memset_generic,
+        memmove_generic,
+        memcmp_generic,
+        strlen_generic,
+        strnlen_generic,
+        strcmp_generic,
+        memchr_generic,
+        memrchr_generic,
+        strchr_generic,
+        strrchr_generic,
+        memmem_generic,
+        byteset_scan_generic,
+#endif
+    };
+
+    static unsigned int g_features = 0;
+    static size_t g_llc_size = 0;
+    static cpu_tier g_best_tier = CPU_TIER_GENERIC;
+#ifdef MINICRT_X86_64
+    static cpu_tier g_active_tier = CPU_TIER_SSE2;
+#else
+    static cpu_tier g_active_tier = CPU_TIER_GENERIC;
+#endif
+    // cpu_init() progress: the first caller probes, later ones wait for kCpuReady
+    static const int kCpuUnprobed = 0;
+    static const int kCpuProbing = 1;
+    static const int kCpuReady = 2;
+    static volatile int g_cpu_initialized = kCpuUnprobed;
+
+#ifdef MINICRT_X86_64
+    static unsigned long long xgetbv0(void) {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int lo, hi;
+        asm volatile("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+        return ((unsigned long long) hi << 32) | lo;
+#endif
+    }
+
+    /**
+     * @brief Query CPUID and XCR0 for the features the kernels care about
+     */
+    static unsigned int probe_features(void) {
+        unsigned int regs[4];
+        unsigned int features = 0;
+
+        cpuid(0, 0, regs);
+        unsigned int max_leaf = regs[0];
+
+        cpuid(1, 0, regs);
+        if (regs[3] & (1u << 26))
+            features |= CPU_FEATURE_SSE2;
+        if (regs[2] & (1u << 9))
+            features |= CPU_FEATURE_SSSE3;
+        if (regs[2] & (1u << 20))
+            features |= CPU_FEATURE_SSE42;
+
+        // AVX state must be enabled by the OS (OSXSAVE + XCR0 bits for XMM/YMM)
+        int os_avx = 0, os_avx512 = 0;
+        if ((regs[2] & (1u << 27)) && (regs[2] & (1u << 28))) {
+            unsigned long long xcr0 = xgetbv0();
+            os_avx = (xcr0 & 0x6) == 0x6;
+            os_avx512 = os_avx && (xcr0 & 0xE0) == 0xE0;
+            if (os_avx)
+                features |= CPU_FEATURE_AVX;
+        }
+
+        if (max_leaf >= 7) {
+            cpuid(7, 0, regs);
+            if (os_avx && (regs[1] & (1u << 5)))
+                features |= CPU_FEATURE_AVX2;
+            if (regs[1] & (1u << 8))
+                features |= CPU_FEATURE_BMI2;
+            if (os_avx512 && (regs[1] & (1u << 16)))
+                features |= CPU_FEATURE_AVX512F;
+            if (os_avx512 && (regs[1] & (1u << 30)))
+                features |= CPU_FEATURE_AVX512BW;
+            if (regs[1] & (1u << 9))
+                features |= CPU_FEATURE_ERMS;
+            if (regs[3] & (1u << 4))
+                features |= CPU_FEATURE_FSRM;
+        }
+
+        cpuid(0x80000000, 0, regs);
+        unsigned int max_extended = regs[0];
+        if (max_extended >= 0x80000001) {
+            cpuid(0x80000001, 0, regs);
+            if (regs[3] & (1u << 27))
+                features |= CPU_FEATURE_RDTSCP;
+        }
+        if (max_extended >= 0x80000007) {
+            cpuid(0x80000007, 0, regs);
+            if (regs[3] & (1u << 8))
+                features |= CPU_FEATURE_INVARIANT_TSC;
+        }
+
+        return features;
+    }
+
+    /**
+     * @brief Find the size of the largest data or unified cache
+     */
+    static size_t probe_llc_size(void) {
+        unsigned int regs[4];
+        size_t largest = 0;
+
+        cpuid(0, 0, regs);
+        unsigned int max_leaf = regs[0];
+
+        // Intel: deterministic cache parameters, one subleaf per cache
+        if (max_leaf >= 4) {
+            for (unsigned int i = 0; i < 16; i++) {
+                cpuid(4, i, regs);
+                unsigned int type = regs[0] & 0x1F;
+                if (type == 0)
+                    break;
+                if (type == 2) // instruction cache
+                    continue;
+                size_t ways = ((regs[1] >> 22) & 0x3FF) + 1;
+                size_t partitions = ((regs[1] >> 12) & 0x3FF) + 1;
+                size_t line = (regs[1] & 0xFFF) + 1;
+                size_t sets = (size_t) regs[2] + 1;
+                size_t size = ways * partitions * line * sets;
+                if (size > largest)
+                    largest = size;
+            }
+        }
+
+        // AMD: L2/L3 descriptors in the extended leaves
+        if (largest == 0) {
+            cpuid(0x80000000, 0, regs);
+            if (regs[0] >= 0x80000006) {
+                cpuid(0x80000006, 0, regs);
+                size_t l2 = (size_t) (regs[2] >> 16) << 10;
+                size_t l3 = (size_t) (regs[3] >> 18) << 19;
+                largest = l3 > l2 ? l3 : l2;
+            }
+        }
+
+        return largest;
+    }
+#endif
+
+    /**
+     * @brief Point every dispatch table entry at the kernels of a tier
+     */
+    static void install_tier(cpu_tier tier) {
+        switch (tier) {
+#ifdef MINICRT_X86_64
+            case CPU_TIER_AVX2:
+                if (g_features & CPU_FEATURE_ERMS) {
+                    g_dispatch.memcpy = memcpy_avx2_erms;
+                    g_dispatch.memset = memset_avx2_erms;
+                } else {
+                    g_dispatch.memcpy = memcpy_avx2;
+                    g_dispatch.memset = memset_avx2;
+                }
+                g_dispatch.memmove = memmove_avx2;
+                g_dispatch.memcmp = memcmp_avx2;
+                g_dispatch.strlen = strlen_avx2;
+                g_dispatch.strnlen = strnlen_avx2;
+                g_dispatch.strcmp = strcmp_avx2;
+                g_dispatch.memchr = memchr_avx2;
+                g_dispatch.memrchr = memrchr_avx2;
+                g_dispatch.strchr = strchr_avx2;
+                g_dispatch.strrchr = strrchr_avx2;
+                g_dispatch.memmem = memmem_avx2;
+                g_dispatch.byteset_scan = byteset_scan_avx2;
+                break;
+            case CPU_TIER_SSE2:
+                g_dispatch.memcpy = memcpy_sse2;
+                g_dispatch.memset = memset_sse2;
+                g_dispatch.memmove = memmove_sse2;
+                g_dispatch.memcmp = memcmp_sse2;
+                g_dispatch.strlen = strlen_sse2;
+                g_dispatch.strnlen = strnlen_sse2;
+                g_dispatch.strcmp = strcmp_sse2;
+                g_dispatch.memchr = memchr_sse2;
+                g_dispatch.memrchr = memrchr_sse2;
+                g_dispatch.strchr = strchr_sse2;
+                g_dispatch.strrchr = strrchr_sse2;
+                g_dispatch.memmem = memmem_sse2;
+                // Nibble table lookups for sets of any size; SSE2 alone compares members
+                if (g_features & CPU_FEATURE_SSSE3)
+                    g_dispatch.byteset_scan = byteset_scan_ssse3;
+                else
+                    g_dispatch.byteset_scan = byteset_scan_sse2;
+                break;
+#endif
+            default:
+                g_dispatch.memcpy = memcpy_generic;
+                g_dispatch.memset = memset_generic;
+                g_dispatch.memmove = memmove_generic;
+                g_dispatch.memcmp = memcmp_generic;
+                g_dispatch.strlen = strlen_generic;
+                g_dispatch.strnlen = strnlen_generic;
+                g_dispatch.strcmp = strcmp_generic;
+                g_dispatch.memchr = memchr_generic;
+                g_dispatch.memrchr = memrchr_generic;
+                g_dispatch.strchr = strchr_generic;
+                g_dispatch.strrchr = strrchr_generic;
+                g_dispatch.memmem = memmem_generic;
+                g_dispatch.byteset_scan = byteset_scan_generic;
+                break;
+        }
+        g_active_tier = tier;
+    }
+
+    void cpu_init(void) {
+        if (atomic_load_int(&g_cpu_initialized) == kCpuReady)
+            return;
+        if (atomic_cas_int(&g_cpu_initialized, kCpuUnprobed, kCpuProbing) != kCpuUnprobed) {
+            while (atomic_load_int(&g_cpu_initialized) != kCpuReady)
+                cpu_relax();
+            return;
+        }
+
+        unsigned int features = 0;
+        size_t llc_size = 0;
+        cpu_tier best_tier = CPU_TIER_GENERIC;
+#ifdef MINICRT_X86_64
+        features = probe_features();
+        llc_size = probe_llc_size();
+        best_tier = (features & CPU_FEATURE_AVX2) ? CPU_TIER_AVX2 : CPU_TIER_SSE2;
+#endif
+        g_features = features;
+        g_llc_size = llc_size;
+        g_best_tier = best_tier;
+
+        // Stream once a block would take up most of the last-level cache
+        if (g_llc_size) {
+            g_nt_threshold_default = g_llc_size / 4 * 3;
+            g_nt_threshold = g_nt_threshold_default;
+        }
+
+        install_tier(g_best_tier);
+
+        // MINICRT_CPU_TIER=generic|sse2|avx2 caps the tier, e.g. to compare kernels
+        const char *forced = getenv("MINICRT_CPU_TIER");
+        if (forced) {
+            for (int tier = CPU_TIER_GENERIC; tier < g_best_tier; tier++) {
+                if (!strcmp(forced, cpu_tier_name((cpu_tier) tier)))
+                    install_tier((cpu_tier) tier);
+            }
+        }
+
+        // Publish last: a thread that sees kCpuReady also sees the table and features
+        atomic_store_int(&g_cpu_initialized, kCpuReady);
+    }
+} // namespace detail
+
+    /**
+     * @brief Get the features of the running CPU
+     */
+    unsigned int cpu_features(void) {
+        detail::cpu_init();
+        return detail::g_features;
+    }
+
+    /**
+     * @brief Check whether the running CPU has a feature
+     */
+    int cpu_has(unsigned int feature) {
+        return (cpu_features() & feature) == feature;
+    }
+
+    /**
+     * @brief Get the size of the last-level data cache
+     */
+    size_t cpu_llc_size(void) {
+        detail::cpu_init();
+        return detail::g_llc_size;
+    }
+
+    /**
+     * @brief Get the best kernel tier the running CPU supports
+     */
+    cpu_tier cpu_best_tier(void) {
+        detail::cpu_init();
+        return detail::g_best_tier;
+    }
+
+    /**
+     * @brief Get the kernel tier currently in use
+     */
+    cpu_tier cpu_active_tier(void) {
+        detail::cpu_init();
+        return detail::g_active_tier;
+    }
+
+    /**
+     * @brief Force the mem and str functions onto a given kernel tier
+     */
+    int cpu_set_tier(cpu_tier tier) {
+        detail::cpu_init();
+        if (tier < CPU_TIER_GENERIC || tier > detail::g_best_tier)
+            return -1;
+
+        detail::install_tier(tier);
+        return 0;
+    }
+
+    /**
+     * @brief Get the printable name of a kernel tier
+     */
+    const char *cpu_tier_name(cpu_tier tier) {
+        switch (tier) {
+            case CPU_TIER_GENERIC:
+                return "generic";
+            case CPU_TIER_SSE2:
+                return "sse2";
+            case CPU_TIER_AVX2:
+                return "avx2";
+        }
+        return "unknown";
+    }
+
+MINICRT_END
@@ -2,10 +2,23 @@
 // Created by seiftnesse on 3/1/2025.
 //
 #include "minicrt/crt.h"
+#include "minicrt/stats.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
 
 MINICRT_BEGIN
-    // Global error variable
-    int errno = 0;
+    // Error code of the last failed call, one per thread
+    thread_local int errno = 0;
+
+    int *errno_location(void) {
+        return &errno;
+    }
+
+namespace detail {
+    // A hosted process has its thread pointer set up by the system loader; the
+    // freestanding _start clears this until thread_init() installs TLS itself
+    int g_thread_pointer_ready = 1;
+} // namespace detail
 
     /**
      * @brief Initialize CRT before main
@@ -13,8 +26,14 @@ MINICRT_BEGIN
      * This function is called before main() to set up the CRT environment
      */
     void minicrt_init(void) {
-        // This would typically initialize various subsystems
-        // For now, we have a minimal implementation
+        // Pick the fastest mem/str kernels for this CPU
+        detail::cpu_init();
+
+        // Find the vDSO clocks and record the TSC calibration reference point
+        detail::time_init();
+
+        // Fully buffer standard output unless it is a terminal
+        detail::stdio_init();
     }
 
     /**
@@ -23,8 +42,20 @@ MINICRT_BEGIN
      * This function is called when the program exits
      */
     void minicrt_cleanup(void) {
-        // This would typically clean up resources
-        // For now, we have a minimal implementation
+#ifdef MINI_CRT_ENABLE_LOGGING
+        // Report the sizes and alignments the program called the mem/str functions with
+        function_stats totals[STATS_FUNCTION_COUNT];
+        stats_collect(totals);
+        for (int i = 0; i < STATS_FUNCTION_COUNT; i++) {
+            if (totals[i].calls) {
+                stats_dump(stderr_stream());
+                break;
+            }
+        }
+#endif
+
+        // Hand buffered output to the OS before the process goes away
+        detail::stdio_flush_all();
     }
 
     /**
@@ -41,63 +72,14 @@ MINICRT_BEGIN
 #define WIN32_LEAN_AND_MEAN
         /*#include <Windows.h>
         ExitProcess(status);*/
-#else
-    // Unix-like systems
-    asm("movl %0, %%edi\n"
-        "movl $60, %%eax\n"  // syscall: exit
-        "syscall"
-        : : "r" (status) : "edi", "eax");
-
-    // Should never reach here
-    __builtin_unreachable();
-#endif
-    }
-
-    // CRT entry point is defined when compiled with /NoDefaultLib
-#ifdef MINICRT_BUILDING_LIB
-
-    // Forward declaration for user's main function
-    extern int main(int argc, char *argv[]);
-
-#ifdef MINICRT_WINDOWS
-    /**
-     * @brief Entry point for Windows applications
-     *
-     * This is the entry point when using /ENTRY:CustomMainCRTStartup
-     */
-    int CustomMainCRTStartup(void) {
-        // Initialize CRT
-        minicrt_init();
-
-        // Call the main function
-        int exit_code = main(0, NULL); // We don't process command line args yet
-
-        // Exit the program
-        exit(exit_code);
+#elif defined(MINICRT_LINUX_SYSCALLS)
+        // exit_group, not exit: SYS_exit ends only the calling thread, and threads
+        // from thread_create() (and the pool workers) would keep the process alive
+        detail::syscall1(detail::NR_exit_group, status);
 
         // Should never reach here
-        return exit_code;
-    }
-#else
-/**
- * @brief Entry point for Unix-like applications
- */
-void _start(void)
-{
-    // Initialize CRT
-    minicrt_init();
-
-    // Call the main function
-    int exit_code = main(0, NULL);  // We don't process command line args yet
-
-    // Exit the program
-    exit(exit_code);
-
-    // Should never reach here
-    __builtin_unreachable();
-}
+        __builtin_unreachable();
 #endif
-
-#endif // MINICRT_BUILDING_LIB
+    }
 
 MINICRT_END
@@ -0,0 +1,192 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/file.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * A file is mapped read-only and private. The page after the last byte must read
+     * as zero: when the size is not a page multiple the kernel already zero-fills the
+     * tail of the last page, otherwise an anonymous zero page has to follow the file.
+     * In that case, and when huge-page alignment is asked for, an anonymous PROT_READ
+     * range is reserved first and the file is mapped over its start with MAP_FIXED.
+     */
+    static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+    // Returned for empty files, which cannot be mapped
+    static const char kEmptyFile[1] = {0};
+
+    static MINICRT_INLINE size_t round_up(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    /**
+     * @brief Reserve length bytes, aligned to align (a page multiple), reading as zero
+     */
+    static char *reserve_range(size_t length, size_t align) {
+        size_t page = page_size();
+        size_t slack = align > page ? align - page : 0;
+        char *raw = (char *) sys_mmap(NULL, length + slack, kProtRead, kMapPrivate | kMapAnonymous | kMapNoReserve,
+                                      -1, 0);
+        if (syscall_failed((long) raw))
+            return raw;
+
+        char *aligned = (char *) round_up((size_t) raw, align);
+        size_t head = (size_t) (aligned - raw);
+        if (head)
+            sys_munmap(raw, head);
+        if (slack - head)
+            sys_munmap(aligned + length, slack - head);
+        return aligned;
+    }
+#endif
+} // namespace detail
+
+    /**
+     * @brief Map a whole file read-only from an open descriptor
+     */
+    int map_fd(int fd, unsigned int flags, mapped_file *file) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        using namespace detail;
+
+        kernel_stat st;
+        long result = sys_fstat(fd, &st);
+        if (syscall_failed(result)) {
+            errno = (int) -result;
+            return -1;
+        }
+        if ((st.st_mode & kStatTypeMask) != kStatRegular) {
+            errno = ENODEV;
+            return -1;
+        }
+
+        size_t size = (size_t) st.st_size;
+        if (size == 0) {
+            file->data = kEmptyFile;
+            file->size = 0;
+            file->mapping = NULL;
+            file->length = 0;
+            return 0;
+        }
+
+        size_t page = page_size();
+        size_t length = round_up(size, page);
+        int huge = (flags & FILE_MAP_HUGE_PAGES) && size >= kHugePageSize;
+        if (size == length)
+            length += page; // room for the terminating zero page
+
+        long map_flags = kMapPrivate;
+        if (flags & FILE_MAP_POPULATE)
+            map_flags |= kMapPopulate;
+
+        char *base;
+        if (huge || length != round_up(size, page)) {
+            char *range = reserve_range(length, huge ? kHugePageSize : page);
+            if (syscall_failed((long) range)) {
+                errno = (int) -(long) range;
+                return -1;
+            }
+            base = (char *) sys_mmap(range, size, kProtRead, map_flags | kMapFixed, fd, 0);
+            if (syscall_failed((long) base))
+                sys_munmap(range, length);
+        } else {
+            base = (char *) sys_mmap(NULL, size, kProtRead, map_flags, fd, 0);
+        }
+        if (syscall_failed((long) base)) {
+            errno = (int) -(long) base;
+            return -1;
+        }
+
+        // Hints are best effort: kernels without them still give a working mapping
+        if (huge)
+            sys_madvise(base, round_up(size, page), kMadvHugePage);
+        if (flags & FILE_MAP_SEQUENTIAL)
+            sys_madvise(base, size, kMadvSequential);
+        else if (flags & FILE_MAP_RANDOM)
+            sys_madvise(base, size, kMadvRandom);
+        if ((flags & FILE_MAP_WILLNEED) && !(flags & FILE_MAP_POPULATE))
+            sys_madvise(base, size, kMadvWillNeed);
+
+        file->data = base;
+        file->size = size;
+        file->mapping = base;
+        file->length = length;
+        return 0;
+#else
+        (void) fd;
+        (void) flags;
+        (void) file;
+        errno = EINVAL;
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Map a whole file read-only
+     */
+    int map_file(const char *path, unsigned int flags, mapped_file *file) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        long fd = detail::sys_open(path, detail::kOpenReadOnly | detail::kOpenCloseOnExec, 0);
+        if (detail::syscall_failed(fd)) {
+            errno = (int) -fd;
+            return -1;
+        }
+
+        // The mapping holds its own reference to the file
+        int result = map_fd((int) fd, flags, file);
+        detail::sys_close((int) fd);
+        return result;
+#else
+        (void) path;
+        return map_fd(-1, flags, file);
+#endif
+    }
+
+    /**
+     * @brief Pass an access pattern hint for part of a mapping to the kernel
+     */
+    int mapped_file_advise(const mapped_file *file, size_t offset, size_t length, file_advice advice) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (!file->mapping || length == 0 || offset >= file->size)
+            return 0;
+        if (length > file->size - offset)
+            length = file->size - offset;
+
+        // madvise wants a page-aligned start
+        size_t page = detail::page_size();
+        size_t start = offset & ~(page - 1);
+        long result = detail::sys_madvise((char *) file->mapping + start, offset - start + length, (long) advice);
+        if (detail::syscall_failed(result)) {
+            errno = (int) -result;
+            return -1;
+        }
+        return 0;
+#else
+        (void) file;
+        (void) offset;
+        (void) length;
+        (void) advice;
+        errno = EINVAL;
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Unmap a file and clear its descriptor
+     */
+    void unmap_file(mapped_file *file) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (file->mapping)
+            detail::sys_munmap(file->mapping, file->length);
+#endif
+        file->data = NULL;
+        file->size = 0;
+        file->mapping = NULL;
+        file->length = 0;
+    }
+
+MINICRT_END
@@ -0,0 +1,1008 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/stdio.h"
+#include "minicrt/memory.h"
+#include "minicrt/string.h"
+#include "crt_internal.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * Formatting engine behind snprintf and the stream printf family
+     *
+     * Output goes to a format_sink: a window of memory plus an optional flush callback
+     * that makes room when the window is full. snprintf uses a window over the caller's
+     * buffer and no callback (excess output is counted and dropped); the streams use a
+     * window over their own buffer.
+     *
+     * Integers are converted two digits at a time. Floating-point values start from
+     * the shortest decimal that reads back as the same double (Schubfach, see
+     * R. Giulietti, "The Schubfach way to render doubles"), which also answers most
+     * fixed-precision requests directly. The rare requests it cannot settle (more than
+     * 15 significant digits, subnormals, exact ties) fall back to exact big-integer
+     * arithmetic, so every result matches a correctly rounded printf.
+     */
+
+    static const char kDigitPairs[201] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    static const char kHexLower[] = "0123456789abcdef";
+    static const char kHexUpper[] = "0123456789ABCDEF";
+
+    static const unsigned long long kPow10[20] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+        100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+        10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+        100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+    };
+
+    // ---------------------------------------------------------------- sink
+
+    static void sink_write(format_sink *sink, const char *data, size_t size) {
+        sink->total += size;
+        while (size) {
+            if (sink->pos == sink->end) {
+                if (!sink->flush)
+                    return;
+                sink->flush(sink);
+                if (sink->pos == sink->end)
+                    return;
+            }
+            size_t room = (size_t) (sink->end - sink->pos);
+            size_t n = size < room ? size : room;
+            memcpy(sink->pos, data, n);
+            sink->pos += n;
+            data += n;
+            size -= n;
+        }
+    }
+
+    static void sink_fill(format_sink *sink, char c, size_t count) {
+        sink->total += count;
+        while (count) {
+            if (sink->pos == sink->end) {
+                if (!sink->flush)
+                    return;
+                sink->flush(sink);
+                if (sink->pos == sink->end)
+                    return;
+            }
+            size_t room = (size_t) (sink->end - sink->pos);
+            size_t n = count < room ? count : room;
+            memset(sink->pos, c, n);
+            sink->pos += n;
+            count -= n;
+        }
+    }
+
+    // ---------------------------------------------------------------- integers
+
+    // Number of decimal digits in v (1 for 0)
+    static MINICRT_INLINE int count_digits(unsigned long long v) {
+        int t = (int) ((log2_floor64(v | 1) + 1) * 1233 >> 12);
+        return t + (v >= kPow10[t]);
+    }
+
+    // Write v in decimal ending just before end; returns the first character
+    static char *write_decimal(char *end, unsigned long long v) {
+        while (v >= 100) {
+            unsigned int pair = (unsigned int) (v % 100);
+            v /= 100;
+            end -= 2;
+            memcpy(end, kDigitPairs + pair * 2, 2);
+        }
+        if (v >= 10) {
+            end -= 2;
+            memcpy(end, kDigitPairs + v * 2, 2);
+        } else {
+            *--end = (char) ('0' + v);
+        }
+        return end;
+    }
+
+    static char *write_hex(char *end, unsigned long long v, const char *alphabet) {
+        do {
+            *--end = alphabet[v & 15];
+            v >>= 4;
+        } while (v);
+        return end;
+    }
+
+    // ---------------------------------------------------------------- shortest doubles
+
+    static const int kDoubleBias = 1075;   // q = biased exponent - kDoubleBias
+    static const int kDoubleMinQ = -1074;
+    static const unsigned long long kDoubleHidden = 1ull << 52;
+    static const unsigned long long kDoubleTiny = 3; // subnormals below this get an extra digit
+
+    struct decimal64 {
+        unsigned long long digits;
+        int exponent; // value = digits * 10^exponent
+    };
+
+    static MINICRT_INLINE int floor_log10_pow2(int q) {
+        return (int) (((long long) q * 661971961083ll) >> 41);
+    }
+
+    static MINICRT_INLINE int floor_log10_three_quarters_pow2(int q) {
+        return (int) (((long long) q * 661971961083ll - 274743187321ll) >> 41);
+    }
+
+    static MINICRT_INLINE int floor_log2_pow10(int e) {
+        return (int) (((long long) e * 913124641741ll) >> 38);
+    }
+
+    /**
+     * @brief Round-to-odd product of cp and g = g1 * 2^63 + g0, scaled down by 2^127
+     */
+    static MINICRT_INLINE unsigned long long round_to_odd(unsigned long long g1, unsigned long long g0,
+                                                          unsigned long long cp) {
+        unsigned long long x1 = mul128_high(g0, cp);
+        unsigned long long y0;
+        unsigned long long y1 = mul128(g1, cp, &y0);
+        unsigned long long z = (y0 >> 1) + x1;
+        unsigned long long vbp = y1 + (z >> 63);
+        return vbp | (((z & 0x7FFFFFFFFFFFFFFFull) + 0x7FFFFFFFFFFFFFFFull) >> 63);
+    }
+
+    /**
+     * @brief Shortest decimal in the rounding interval of c * 2^q, closest to it on ties
+     */
+    static decimal64 to_decimal(int q, unsigned long long c, int dk) {
+        unsigned long long out = c & 1;
+        unsigned long long cb = c << 2;
+        unsigned long long cbr = cb + 2;
+        unsigned long long cbl;
+        int k;
+        if (c != kDoubleHidden || q == kDoubleMinQ) {
+            cbl = cb - 2;
+            k = floor_log10_pow2(q);
+        } else {
+            // The gap below a power of two is half as wide
+            cbl = cb - 1;
+            k = floor_log10_three_quarters_pow2(q);
+        }
+        int h = q + floor_log2_pow10(-k) + 2;
+
+        // g approximates 10^-k from above with 126 bits: floor(5^-k normalized) + 1
+        const unsigned long long *pow5 = kPow5Table[-k - kPow5MinExponent];
+        unsigned long long g_high = pow5[0] >> 2;
+        unsigned long long g_low = (pow5[0] << 62 | pow5[1] >> 2) + 1;
+        if (!g_low)
+            g_high++;
+        unsigned long long g1 = g_high << 1 | g_low >> 63;
+        unsigned long long g0 = g_low & 0x7FFFFFFFFFFFFFFFull;
+
+        unsigned long long vb = round_to_odd(g1, g0, cb << h);
+        unsigned long long vbl = round_to_odd(g1, g0, cbl << h);
+        unsigned long long vbr = round_to_odd(g1, g0, cbr << h);
+
+        unsigned long long s = vb >> 2;
+        decimal64 result;
+        if (s >= 100) {
+            // Try one digit less first
+            unsigned long long sp10 = s / 10 * 10;
+            unsigned long long tp10 = sp10 + 10;
+            int upin = vbl + out <= sp10 << 2;
+            int wpin = (tp10 << 2) + out <= vbr;
+            if (upin != wpin) {
+                result.digits = upin ? sp10 : tp10;
+                result.exponent = k;
+                return result;
+            }
+        }
+
+        unsigned long long t = s + 1;
+        int uin = vbl + out <= s << 2;
+        int win = (t << 2) + out <= vbr;
+        if (uin != win) {
+            result.digits = uin ? s : t;
+        } else {
+            // Both candidates round-trip: take the closer one, the even one on a tie
+            long long cmp = (long long) (vb - ((s + t) << 1));
+            result.digits = (cmp < 0 || (cmp == 0 && !(s & 1))) ? s : t;
+        }
+        result.exponent = k + dk;
+        return result;
+    }
+
+    /**
+     * @brief Shortest round-trip decimal of a positive finite double, without trailing zeros
+     */
+    static decimal64 shortest_decimal(unsigned long long bits) {
+        unsigned long long t = bits & (kDoubleHidden - 1);
+        int bq = (int) (bits >> 52);
+        decimal64 result;
+
+        if (bq) {
+            int mq = kDoubleBias - bq;
+            unsigned long long c = kDoubleHidden | t;
+            if (0 < mq && mq < 53 && !(c & ((1ull << mq) - 1))) {
+                // Small integers are their own shortest representation
+                result.digits = c >> mq;
+                result.exponent = 0;
+            } else {
+                result = to_decimal(-mq, c, 0);
+            }
+        } else if (t < kDoubleTiny) {
+            // The scaled computation yields two digits (4.9e-324, 9.9e-324); the
+            // rounding interval of these subnormals is wide enough for one
+            result = to_decimal(kDoubleMinQ, 10 * t, -1);
+            result.digits = (result.digits + 5) / 10;
+            result.exponent++;
+        } else {
+            result = to_decimal(kDoubleMinQ, t, 0);
+        }
+
+        while (result.digits % 10 == 0) {
+            result.digits /= 10;
+            result.exponent++;
+        }
+        return result;
+    }
+
+    // ---------------------------------------------------------------- big integers
+
+    void big_mul_small(bigint *b, unsigned int m) {
+        unsigned long long carry = 0;
+        for (int i = 0; i < b->size; i++) {
+            unsigned long long product = (unsigned long long) b->words[i] * m + carry;
+            b->words[i] = (unsigned int) product;
+            carry = product >> 32;
+        }
+        if (carry)
+            b->words[b->size++] = (unsigned int) carry;
+    }
+
+    void big_shift_left(bigint *b, int bits) {
+        int words = bits / 32;
+        bits %= 32;
+        if (bits) {
+            unsigned int carry = 0;
+            for (int i = 0; i < b->size; i++) {
+                unsigned int w = b->words[i];
+                b->words[i] = w << bits | carry;
+                carry = w >> (32 - bits);
+            }
+            if (carry)
+                b->words[b->size++] = carry;
+        }
+        if (words) {
+            for (int i = b->size - 1; i >= 0; i--)
+                b->words[i + words] = b->words[i];
+            for (int i = 0; i < words; i++)
+                b->words[i] = 0;
+            b->size += words;
+        }
+    }
+
+    unsigned int big_div_small(bigint *b, unsigned int d) {
+        unsigned long long rem = 0;
+        for (int i = b->size - 1; i >= 0; i--) {
+            unsigned long long cur = rem << 32 | b->words[i];
+            b->words[i] = (unsigned int) (cur / d);
+            rem = cur % d;
+        }
+        while (b->size && !b->words[b->size - 1])
+            b->size--;
+        return (unsigned int) rem;
+    }
+
+    void big_mul_pow5(bigint *b, int n) {
+        for (; n >= 13; n -= 13)
+            big_mul_small(b, 1220703125u); // 5^13
+        unsigned int rest = 1;
+        while (n--)
+            rest *= 5;
+        big_mul_small(b, rest);
+    }
+
+    int big_compare(const bigint *a, const bigint *b) {
+        if (a->size != b->size)
+            return a->size < b->size ? -1 : 1;
+        for (int i = a->size - 1; i >= 0; i--) {
+            if (a->words[i] != b->words[i])
+                return a->words[i] < b->words[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // ---------------------------------------------------------------- exact digits
+
+    static const int kMaxExactDigits = 800;
+
+    /**
+     * @brief Every decimal digit of a positive finite double
+     *
+     * Stores the digits (no leading zeros) in out and the power of ten of the first
+     * digit in first_exp; returns the number of digits.
+     */
+    static int exact_digits(unsigned long long bits, char *out, int *first_exp) {
+        int bq = (int) (bits >> 52);
+        unsigned long long c = bits & (kDoubleHidden - 1);
+        int q = kDoubleMinQ;
+        if (bq) {
+            c |= kDoubleHidden;
+            q = bq - kDoubleBias;
+        }
+
+        bigint b;
+        b.words[0] = (unsigned int) c;
+        b.words[1] = (unsigned int) (c >> 32);
+        b.size = b.words[1] ? 2 : 1;
+
+        // c * 2^q = c * 5^-q * 10^q for negative q
+        if (q >= 0) {
+            big_shift_left(&b, q);
+        } else {
+            big_mul_pow5(&b, -q);
+        }
+
+        // Peel off nine digits at a time, least significant first
+        unsigned int chunks[kMaxExactDigits / 9 + 2];
+        int chunk_count = 0;
+        while (b.size)
+            chunks[chunk_count++] = big_div_small(&b, 1000000000u);
+
+        char buf[20];
+        char *end = buf + sizeof(buf);
+        char *start = write_decimal(end, chunks[chunk_count - 1]);
+        int len = (int) (end - start);
+        memcpy(out, start, (size_t) len);
+        for (int i = chunk_count - 2; i >= 0; i--) {
+            unsigned int chunk = chunks[i];
+            for (int j = 8; j >= 0; j--) {
+                out[len + j] = (char) ('0' + chunk % 10);
+                chunk /= 10;
+            }
+            len += 9;
+        }
+
+        *first_exp = len - 1 + (q < 0 ? q : 0);
+        return len;
+    }
+
+    // ---------------------------------------------------------------- rounding
+
+    static int round_exact(unsigned long long bits, int lsd, int significant, char *digits, int *first_exp) {
+        char all[kMaxExactDigits];
+        int x;
+        int len = exact_digits(bits, all, &x);
+        if (significant)
+            lsd = x - significant + 1;
+        int keep = x - lsd + 1;
+
+        if (keep >= len) {
+            memcpy(digits, all, (size_t) len);
+            memset(digits + len, '0', (size_t) (keep - len));
+            *first_exp = x;
+            return keep;
+        }
+        if (keep < 0) {
+            *first_exp = lsd;
+            return 0;
+        }
+
+        // Round half to even on the discarded tail
+        int up;
+        if (all[keep] != '5') {
+            up = all[keep] > '5';
+        } else {
+            up = 0;
+            for (int i = keep + 1; i < len && !up; i++)
+                up = all[i] != '0';
+            if (!up)
+                up = keep > 0 && ((all[keep - 1] - '0') & 1);
+        }
+
+        memcpy(digits, all, (size_t) keep);
+        *first_exp = x;
+        if (!up)
+            return keep;
+
+        int i = keep - 1;
+        while (i >= 0 && digits[i] == '9')
+            digits[i--] = '0';
+        if (i >= 0) {
+            digits[i]++;
+            return keep;
+        }
+        // Carried out of the first digit: 99.9 -> 100
+        digits[0] = '1';
+        if (keep)
+            digits[keep] = '0';
+        *first_exp = x + 1;
+        return keep + 1;
+    }
+
+    /**
+     * @brief Round a positive finite double to a multiple of 10^lsd, or to a number of
+     *        significant digits when significant is non-zero
+     *
+     * Writes the digits from the leading one down to the last kept place into digits
+     * and the power of ten of the leading digit into first_exp. Returns the digit
+     * count, 0 when the value rounds to zero. Rounding to significant digits can carry
+     * into one extra digit (9.99 -> 10.0).
+     */
+    static int round_decimal(unsigned long long bits, const decimal64 &shortest, int lsd, int significant,
+                             char *digits, int *first_exp) {
+        char sd[20];
+        char *end = sd + sizeof(sd);
+        char *start = write_decimal(end, shortest.digits);
+        int len = (int) (end - start);
+        int x = shortest.exponent + len - 1;
+        if (significant)
+            lsd = x - significant + 1;
+        int keep = x - lsd + 1;
+
+        if (keep >= len) {
+            // The shortest digits are the nearest keep-digit decimal while keep leaves
+            // room for the binary rounding error of a normal double
+            if (keep > 15 || !(bits >> 52))
+                return round_exact(bits, lsd, significant, digits, first_exp);
+            memcpy(digits, start, (size_t) len);
+            memset(digits + len, '0', (size_t) (keep - len));
+            *first_exp = x;
+            return keep;
+        }
+
+        if (keep < 0) {
+            *first_exp = lsd;
+            return 0;
+        }
+
+        // A tail of exactly "5" does not say which way the true value lies
+        if (keep == len - 1 && start[keep] == '5')
+            return round_exact(bits, lsd, significant, digits, first_exp);
+
+        memcpy(digits, start, (size_t) keep);
+        *first_exp = x;
+        if (start[keep] < '5')
+            return keep;
+
+        int i = keep - 1;
+        while (i >= 0 && digits[i] == '9')
+            digits[i--] = '0';
+        if (i >= 0) {
+            digits[i]++;
+            return keep;
+        }
+        digits[0] = '1';
+        if (keep)
+            digits[keep] = '0';
+        *first_exp = x + 1;
+        return keep + 1;
+    }
+
+    // ---------------------------------------------------------------- fields
+
+    enum format_flags {
+        FLAG_LEFT = 1,
+        FLAG_PLUS = 2,
+        FLAG_SPACE = 4,
+        FLAG_ALT = 8,
+        FLAG_ZERO = 16
+    };
+
+    struct format_spec {
+        unsigned int flags;
+        int width;
+        int precision; // -1 when absent
+        char conversion;
+    };
+
+    // A run of text, or of zeros when data is NULL
+    struct piece {
+        const char *data;
+        size_t size;
+    };
+
+    static void emit_field(format_sink *sink, const format_spec &spec, const char *prefix, size_t prefix_len,
+                           const piece *pieces, int count, int zero_pad) {
+        size_t body = prefix_len;
+        for (int i = 0; i < count; i++)
+            body += pieces[i].size;
+        size_t pad = spec.width > 0 && (size_t) spec.width > body ? (size_t) spec.width - body : 0;
+
+        if (spec.flags & FLAG_LEFT)
+            zero_pad = 0;
+        if (pad && !(spec.flags & FLAG_LEFT) && !zero_pad)
+            sink_fill(sink, ' ', pad);
+        sink_write(sink, prefix, prefix_len);
+        if (pad && zero_pad)
+            sink_fill(sink, '0', pad);
+        for (int i = 0; i < count; i++) {
+            if (pieces[i].data)
+                sink_write(sink, pieces[i].data, pieces[i].size);
+            else
+                sink_fill(sink, '0', pieces[i].size);
+        }
+        if (pad && (spec.flags & FLAG_LEFT))
+            sink_fill(sink, ' ', pad);
+    }
+
+    static void format_integer(format_sink *sink, const format_spec &spec, unsigned long long value, int negative) {
+        char buf[24];
+        char *end = buf + sizeof(buf);
+        char *start;
+        char prefix[2];
+        size_t prefix_len = 0;
+
+        switch (spec.conversion) {
+            case 'x':
+            case 'X':
+                start = write_hex(end, value, spec.conversion == 'x' ? kHexLower : kHexUpper);
+                if ((spec.flags & FLAG_ALT) && value) {
+                    prefix[0] = '0';
+                    prefix[1] = spec.conversion;
+                    prefix_len = 2;
+                }
+                break;
+            case 'p':
+                start = write_hex(end, value, kHexLower);
+                prefix[0] = '0';
+                prefix[1] = 'x';
+                prefix_len = 2;
+                break;
+            default:
+                start = write_decimal(end, value);
+                if (negative)
+                    prefix[prefix_len++] = '-';
+                else if (spec.flags & FLAG_PLUS)
+                    prefix[prefix_len++] = '+';
+                else if (spec.flags & FLAG_SPACE)
+                    prefix[prefix_len++] = ' ';
+                break;
+        }
+
+        size_t len = (size_t) (end - start);
+        if (spec.precision == 0 && value == 0)
+            len = 0; // "%.0d" prints nothing for zero
+
+        piece pieces[2];
+        pieces[0].data = 0;
+        pieces[0].size = spec.precision > 0 && (size_t) spec.precision > len ? (size_t) spec.precision - len : 0;
+        pieces[1].data = start;
+        pieces[1].size = len;
+        emit_field(sink, spec, prefix, prefix_len, pieces, 2, (spec.flags & FLAG_ZERO) && spec.precision < 0);
+    }
+
+    static void format_float(format_sink *sink, const format_spec &spec, double value) {
+        unsigned long long bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        char sign = 0;
+        if (bits >> 63)
+            sign = '-';
+        else if (spec.flags & FLAG_PLUS)
+            sign = '+';
+        else if (spec.flags & FLAG_SPACE)
+            sign = ' ';
+        bits &= ~(1ull << 63);
+
+        char conversion = spec.conversion;
+        int upper = conversion == 'E' || conversion == 'F' || conversion == 'G';
+        if (upper)
+            conversion = (char) (conversion + ('a' - 'A'));
+
+        piece pieces[8];
+        int count = 0;
+
+        if ((bits >> 52) == 0x7FF) {
+            pieces[0].data = (bits << 12) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf");
+            pieces[0].size = 3;
+            emit_field(sink, spec, &sign, sign ? 1 : 0, pieces, 1, 0);
+            return;
+        }
+
+        int precision = spec.precision < 0 ? 6 : spec.precision;
+        int alt = (spec.flags & FLAG_ALT) != 0;
+        char digits[kMaxExactDigits + 2];
+        int n = 0;      // digits produced
+        int x = 0;      // power of ten of digits[0]
+        int use_exp;
+        int frac;       // digits after the point
+
+        decimal64 shortest = {0, 0};
+        if (bits)
+            shortest = shortest_decimal(bits);
+
+        if (conversion == 'f') {
+            if (bits)
+                n = round_decimal(bits, shortest, -precision, 0, digits, &x);
+            use_exp = 0;
+            frac = precision;
+        } else {
+            // Significant digits for %e, and for %g before it picks a style
+            int significant = conversion == 'e' ? precision + 1 : (precision ? precision : 1);
+            if (bits) {
+                n = round_decimal(bits, shortest, 0, significant, digits, &x);
+                if (n > significant) // carried into a new leading digit
+                    n = significant;
+            }
+
+            if (conversion == 'e') {
+                use_exp = 1;
+                frac = precision;
+            } else {
+                use_exp = !(significant > x && x >= -4);
+                frac = use_exp ? significant - 1 : significant - 1 - x;
+                if (!alt) {
+                    // %g drops trailing zeros
+                    while (n > 0 && digits[n - 1] == '0')
+                        n--;
+                    int shown = use_exp ? n - 1 : n - 1 - x;
+                    frac = shown > 0 ? shown : 0;
+                }
+            }
+        }
+
+        char exp_buf[8];
+        static const char point = '.';
+        if (use_exp) {
+            pieces[count].data = n ? digits : "0";
+            pieces[count++].size = 1;
+            if (frac || alt) {
+                pieces[count].data = &point;
+                pieces[count++].size = 1;
+            }
+            int shown = n - 1 < frac ? n - 1 : frac;
+            if (shown > 0) {
+                pieces[count].data = digits + 1;
+                pieces[count++].size = (size_t) shown;
+            }
+            if (frac > (shown > 0 ? shown : 0)) {
+                pieces[count].data = 0;
+                pieces[count++].size = (size_t) (frac - (shown > 0 ? shown : 0));
+            }
+
+            int e = n ? x : 0;
+            char *end = exp_buf + sizeof(exp_buf);
+            char *start = write_decimal(end, (unsigned long long) (e < 0 ? -e : e));
+            if (end - start < 2)
+                *--start = '0';
+            *--start = e < 0 ? '-' : '+';
+            *--start = upper ? 'E' : 'e';
+            pieces[count].data = start;
+            pieces[count++].size = (size_t) (end - start);
+        } else {
+            // Integer part
+            if (n && x >= 0) {
+                int int_digits = n < x + 1 ? n : x + 1;
+                pieces[count].data = digits;
+                pieces[count++].size = (size_t) int_digits;
+                if (x + 1 > int_digits) {
+                    pieces[count].data = 0;
+                    pieces[count++].size = (size_t) (x + 1 - int_digits);
+                }
+            } else {
+                pieces[count].data = "0";
+                pieces[count++].size = 1;
+            }
+
+            if (frac || alt) {
+                pieces[count].data = &point;
+                pieces[count++].size = 1;
+            }
+
+            // Fraction: zeros before the first digit, the digits, then padding
+            int written = 0;
+            if (n && x < -1) {
+                int lead = -x - 1 < frac ? -x - 1 : frac;
+                pieces[count].data = 0;
+                pieces[count++].size = (size_t) lead;
+                written = lead;
+            }
+            int first = x >= 0 ? x + 1 : 0;
+            if (n > first && written < frac) {
+                int take = n - first < frac - written ? n - first : frac - written;
+                pieces[count].data = digits + first;
+                pieces[count++].size = (size_t) take;
+                written += take;
+            }
+            if (written < frac) {
+                pieces[count].data = 0;
+                pieces[count++].size = (size_t) (frac - written);
+            }
+        }
+
+        emit_field(sink, spec, &sign, sign ? 1 : 0, pieces, count, (spec.flags & FLAG_ZERO) != 0);
+    }
+
+    static void format_string(format_sink *sink, const format_spec &spec, const char *str) {
+        if (!str)
+            str = "(null)";
+        piece body;
+        body.data = str;
+        body.size = spec.precision >= 0 ? strnlen(str, (size_t) spec.precision) : strlen(str);
+        emit_field(sink, spec, 0, 0, &body, 1, 0);
+    }
+
+    // ---------------------------------------------------------------- driver
+
+    enum length_modifier {
+        LENGTH_NONE,
+        LENGTH_CHAR,
+        LENGTH_SHORT,
+        LENGTH_LONG,
+        LENGTH_LONG_LONG,
+        LENGTH_SIZE
+    };
+
+    int format_to_sink(format_sink *sink, const char *format, va_list args) {
+        va_list ap;
+        va_copy(ap, args);
+
+        for (;;) {
+            // Copy the literal text up to the next conversion
+            const char *p = format;
+            while (*p && *p != '%')
+                p++;
+            if (p != format)
+                sink_write(sink, format, (size_t) (p - format));
+            if (!*p)
+                break;
+            const char *directive = p++;
+
+            format_spec spec;
+            spec.flags = 0;
+            spec.width = 0;
+            spec.precision = -1;
+
+            for (;; p++) {
+                if (*p == '-')
+                    spec.flags |= FLAG_LEFT;
+                else if (*p == '+')
+                    spec.flags |= FLAG_PLUS;
+                else if (*p == ' ')
+                    spec.flags |= FLAG_SPACE;
+                else if (*p == '#')
+                    spec.flags |= FLAG_ALT;
+                else if (*p == '0')
+                    spec.flags |= FLAG_ZERO;
+                else
+                    break;
+            }
+
+            if (*p == '*') {
+                spec.width = va_arg(ap, int);
+                if (spec.width < 0) {
+                    spec.flags |= FLAG_LEFT;
+                    spec.width = -spec.width;
+                }
+                p++;
+            } else {
+                while (*p >= '0' && *p <= '9')
+                    spec.width = spec.width * 10 + (*p++ - '0');
+            }
+
+            if (*p == '.') {
+                p++;
+                spec.precision = 0;
+                if (*p == '*') {
+                    spec.precision = va_arg(ap, int);
+                    if (spec.precision < 0)
+                        spec.precision = -1;
+                    p++;
+                } else {
+                    while (*p >= '0' && *p <= '9')
+                        spec.precision = spec.precision * 10 + (*p++ - '0');
+                }
+            }
+
+            length_modifier length = LENGTH_NONE;
+            switch (*p) {
+                case 'h':
+                    length = p[1] == 'h' ? LENGTH_CHAR : LENGTH_SHORT;
+                    p += p[1] == 'h' ? 2 : 1;
+                    break;
+                case 'l':
+                    length = p[1] == 'l' ? LENGTH_LONG_LONG : LENGTH_LONG;
+                    p += p[1] == 'l' ? 2 : 1;
+                    break;
+                case 'j':
+                    length = LENGTH_LONG_LONG;
+                    p++;
+                    break;
+                case 'z':
+                case 't':
+                    length = LENGTH_SIZE;
+                    p++;
+                    break;
+                default:
+                    break;
+            }
+
+            spec.conversion = *p;
+            switch (*p) {
+                case 'd':
+                case 'i': {
+                    long long v;
+                    switch (length) {
+                        case LENGTH_CHAR: v = (signed char) va_arg(ap, int); break;
+                        case LENGTH_SHORT: v = (short) va_arg(ap, int); break;
+                        case LENGTH_LONG: v = va_arg(ap, long); break;
+                        case LENGTH_LONG_LONG: v = va_arg(ap, long long); break;
+                        case LENGTH_SIZE: v = va_arg(ap, ptrdiff_t); break;
+                        default: v = va_arg(ap, int); break;
+                    }
+                    unsigned long long magnitude = v < 0 ? 0ull - (unsigned long long) v : (unsigned long long) v;
+                    format_integer(sink, spec, magnitude, v < 0);
+                    break;
+                }
+                case 'u':
+                case 'x':
+                case 'X': {
+                    unsigned long long v;
+                    switch (length) {
+                        case LENGTH_CHAR: v = (unsigned char) va_arg(ap, unsigned int); break;
+                        case LENGTH_SHORT: v = (unsigned short) va_arg(ap, unsigned int); break;
+                        case LENGTH_LONG: v = va_arg(ap, unsigned long); break;
+                        case LENGTH_LONG_LONG: v = va_arg(ap, unsigned long long); break;
+                        case LENGTH_SIZE: v = va_arg(ap, size_t); break;
+                        default: v = va_arg(ap, unsigned int); break;
+                    }
+                    spec.flags &= ~(unsigned int) (FLAG_PLUS | FLAG_SPACE);
+                    format_integer(sink, spec, v, 0);
+                    break;
+                }
+                case 'p': {
+                    void *ptr = va_arg(ap, void *);
+                    if (ptr) {
+                        spec.flags &= ~(unsigned int) (FLAG_PLUS | FLAG_SPACE);
+                        format_integer(sink, spec, (unsigned long long) (size_t) ptr, 0);
+                    } else {
+                        spec.precision = -1;
+                        format_string(sink, spec, "(nil)");
+                    }
+                    break;
+                }
+                case 'c': {
+                    char c = (char) va_arg(ap, int);
+                    piece body = {&c, 1};
+                    emit_field(sink, spec, 0, 0, &body, 1, 0);
+                    break;
+                }
+                case 's':
+                    format_string(sink, spec, va_arg(ap, const char *));
+                    break;
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                    format_float(sink, spec, va_arg(ap, double));
+                    break;
+                case '%':
+                    sink_write(sink, "%", 1);
+                    break;
+                default:
+                    // Unknown conversion: print the directive as it was written
+                    sink_write(sink, directive, (size_t) (p - directive) + (*p ? 1 : 0));
+                    break;
+            }
+
+            if (*p)
+                p++;
+            format = p;
+        }
+
+        va_end(ap);
+        return sink->total > 0x7FFFFFFF ? -1 : (int) sink->total;
+    }
+
+    /**
+     * @brief Shortest text for a double that reads back as the same value
+     */
+    static void format_shortest_to_sink(format_sink *sink, double value) {
+        unsigned long long bits;
+        memcpy(&bits, &value, sizeof(bits));
+        if (bits >> 63)
+            sink_write(sink, "-", 1);
+        bits &= ~(1ull << 63);
+
+        if ((bits >> 52) == 0x7FF) {
+            sink_write(sink, (bits << 12) ? "nan" : "inf", 3);
+            return;
+        }
+        if (!bits) {
+            sink_write(sink, "0", 1);
+            return;
+        }
+
+        decimal64 d = shortest_decimal(bits);
+        char buf[20];
+        char *end = buf + sizeof(buf);
+        char *start = write_decimal(end, d.digits);
+        int len = (int) (end - start);
+        int x = d.exponent + len - 1;
+
+        if (x >= -5 && x < 17) {
+            // Plain notation, as short as %g would be
+            if (x < 0) {
+                sink_write(sink, "0.", 2);
+                sink_fill(sink, '0', (size_t) (-x - 1));
+                sink_write(sink, start, (size_t) len);
+            } else if (len <= x + 1) {
+                sink_write(sink, start, (size_t) len);
+                sink_fill(sink, '0', (size_t) (x + 1 - len));
+            } else {
+                sink_write(sink, start, (size_t) (x + 1));
+                sink_write(sink, ".", 1);
+                sink_write(sink, start + x + 1, (size_t) (len - x - 1));
+            }
+            return;
+        }
+
+        sink_write(sink, start, 1);
+        if (len > 1) {
+            sink_write(sink, ".", 1);
+            sink_write(sink, start + 1, (size_t) (len - 1));
+        }
+        char exp_buf[8];
+        char *exp_end = exp_buf + sizeof(exp_buf);
+        char *exp_start = write_decimal(exp_end, (unsigned long long) (x < 0 ? -x : x));
+        if (exp_end - exp_start < 2)
+            *--exp_start = '0';
+        *--exp_start = x < 0 ? '-' : '+';
+        *--exp_start = 'e';
+        sink_write(sink, exp_start, (size_t) (exp_end - exp_start));
+    }
+
+    // Bounded sink over a caller buffer, always leaving room for the terminator
+    static void buffer_sink_init(format_sink *sink, char *buffer, size_t size) {
+        sink->pos = buffer;
+        sink->end = size ? buffer + size - 1 : buffer;
+        sink->total = 0;
+        sink->flush = 0;
+        sink->context = 0;
+    }
+} // namespace detail
+
+    /**
+     * @brief Format into a caller buffer
+     */
+    int vsnprintf(char *buffer, size_t size, const char *format, va_list args) {
+        detail::format_sink sink;
+        detail::buffer_sink_init(&sink, buffer, size);
+        int result = detail::format_to_sink(&sink, format, args);
+        if (size)
+            *sink.pos = '\0';
+        return result;
+    }
+
+    /**
+     * @brief Format into a caller buffer
+     */
+    int snprintf(char *buffer, size_t size, const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        int result = vsnprintf(buffer, size, format, args);
+        va_end(args);
+        return result;
+    }
+
+    /**
+     * @brief Write the shortest round-trip text of a double
+     */
+    int format_shortest(char *buffer, size_t size, double value) {
+        detail::format_sink sink;
+        detail::buffer_sink_init(&sink, buffer, size);
+        detail::format_shortest_to_sink(&sink, value);
+        if (size)
+            *sink.pos = '\0';
+        return (int) sink.total;
+    }
+
+MINICRT_END
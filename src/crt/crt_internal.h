@@ -0,0 +1,478 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_CRT_INTERNAL_H
+#define MINICRT_CRT_INTERNAL_H
+
+/**
+ * @file crt_internal.h
+ * @brief Private helpers shared by the MiniCRT translation units (not installed)
+ */
+
+#include "minicrt/crt.h"
+
+#ifdef MINICRT_X86_64
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <stdarg.h>
+
+// Per-function instruction set selection, so that AVX2 kernels can live next to the
+// SSE2 baseline without compiling the whole library for a newer CPU
+#if defined(__GNUC__) || defined(__clang__)
+#define MINICRT_TARGET(isa) __attribute__((target(isa)))
+#define MINICRT_LIKELY(x) __builtin_expect(!!(x), 1)
+#define MINICRT_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define MINICRT_TARGET(isa)
+#define MINICRT_LIKELY(x) (x)
+#define MINICRT_UNLIKELY(x) (x)
+#endif
+
+MINICRT_BEGIN
+    struct timespec; // see time.h
+    struct byteset;  // see string.h
+
+namespace detail {
+    // Unaligned, aliasing-safe scalar access used by the word-at-a-time kernels
+#if defined(__GNUC__) || defined(__clang__)
+    typedef unsigned long long __attribute__((aligned(1), may_alias)) u64_unaligned;
+    typedef unsigned int __attribute__((aligned(1), may_alias)) u32_unaligned;
+    typedef unsigned short __attribute__((aligned(1), may_alias)) u16_unaligned;
+#else
+    typedef unsigned long long u64_unaligned;
+    typedef unsigned int u32_unaligned;
+    typedef unsigned short u16_unaligned;
+#endif
+
+    MINICRT_INLINE unsigned long long load64(const void *p) { return *(const u64_unaligned *) p; }
+    MINICRT_INLINE unsigned int load32(const void *p) { return *(const u32_unaligned *) p; }
+    MINICRT_INLINE unsigned short load16(const void *p) { return *(const u16_unaligned *) p; }
+
+    MINICRT_INLINE void store64(void *p, unsigned long long v) { *(u64_unaligned *) p = v; }
+    MINICRT_INLINE void store32(void *p, unsigned int v) { *(u32_unaligned *) p = v; }
+    MINICRT_INLINE void store16(void *p, unsigned short v) { *(u16_unaligned *) p = v; }
+
+    // Index of the lowest set bit; x must be non-zero
+    MINICRT_INLINE unsigned int ctz32(unsigned int x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return (unsigned int) __builtin_ctz(x);
+#else
+        unsigned long index;
+        _BitScanForward(&index, x);
+        return (unsigned int) index;
+#endif
+    }
+
+    MINICRT_INLINE unsigned int ctz64(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return (unsigned int) __builtin_ctzll(x);
+#else
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return (unsigned int) index;
+#endif
+    }
+
+    // Full 64x64 -> 128-bit product; returns the high half and stores the low half
+    MINICRT_INLINE unsigned long long mul128(unsigned long long a, unsigned long long b, unsigned long long *low) {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = (unsigned __int128) a * b;
+        *low = (unsigned long long) product;
+        return (unsigned long long) (product >> 64);
+#else
+        unsigned long long high;
+        *low = _umul128(a, b, &high);
+        return high;
+#endif
+    }
+
+    MINICRT_INLINE unsigned long long mul128_high(unsigned long long a, unsigned long long b) {
+        unsigned long long low;
+        return mul128(a, b, &low);
+    }
+
+#ifdef MINICRT_X86_64
+    MINICRT_INLINE void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+        __cpuidex((int *) regs, (int) leaf, (int) subleaf);
+#else
+        asm volatile("cpuid"
+            : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+            : "a" (leaf), "c" (subleaf));
+#endif
+    }
+#endif
+
+    // Powers of five for decimal conversions (see crt_tables.cpp)
+    static const int kPow5MinExponent = -342;
+    static const int kPow5MaxExponent = 324;
+    extern const unsigned long long kPow5Table[kPow5MaxExponent - kPow5MinExponent + 1][2];
+
+    /**
+     * @brief Unsigned big integer for exact decimal conversions (see crt_format.cpp)
+     *
+     * Little-endian 32-bit words; size is the number of words in use, 0 for zero. The
+     * capacity covers the largest values the conversions build: c * 5^1074 when
+     * printing every digit of a double, and about 2800 bits when parsing compares a
+     * long decimal input with a halfway point.
+     */
+    static const int kBigWords = 96;
+
+    struct bigint {
+        unsigned int words[kBigWords];
+        int size;
+    };
+
+    void big_mul_small(bigint *b, unsigned int m);
+    void big_mul_pow5(bigint *b, int n);
+    void big_shift_left(bigint *b, int bits);
+    unsigned int big_div_small(bigint *b, unsigned int d); // returns the remainder
+    int big_compare(const bigint *a, const bigint *b);
+
+    // Size from which the vector kernels use non-temporal stores (see crt_memory.cpp)
+    extern size_t g_nt_threshold;
+    extern size_t g_nt_threshold_default;
+
+    /**
+     * @brief Minimal test-and-set lock for short runtime-internal critical sections
+     */
+    struct spinlock {
+        volatile long locked;
+    };
+
+    MINICRT_INLINE void cpu_relax(void) {
+#ifdef MINICRT_X86_64
+        _mm_pause();
+#endif
+    }
+
+    MINICRT_INLINE void spin_lock(volatile long *word) {
+#if defined(_MSC_VER)
+        while (_InterlockedExchange(word, 1))
+            while (*word)
+                cpu_relax();
+#else
+        while (__atomic_exchange_n(word, 1, __ATOMIC_ACQUIRE))
+            while (__atomic_load_n(word, __ATOMIC_RELAXED))
+                cpu_relax();
+#endif
+    }
+
+    MINICRT_INLINE void spin_unlock(volatile long *word) {
+#if defined(_MSC_VER)
+        _InterlockedExchange(word, 0);
+#else
+        __atomic_store_n(word, 0, __ATOMIC_RELEASE);
+#endif
+    }
+
+    MINICRT_INLINE void spin_lock(spinlock *lock) { spin_lock(&lock->locked); }
+    MINICRT_INLINE void spin_unlock(spinlock *lock) { spin_unlock(&lock->locked); }
+
+    // Flags published by one thread and polled by others
+    MINICRT_INLINE int atomic_load_int(const volatile int *p) {
+#if defined(_MSC_VER)
+        int value = *p;
+        _ReadWriteBarrier();
+        return value;
+#else
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    MINICRT_INLINE void atomic_store_int(volatile int *p, int value) {
+#if defined(_MSC_VER)
+        _ReadWriteBarrier();
+        *p = value;
+#else
+        __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+    }
+
+    // Read-modify-write on the 32-bit futex words of the synchronization primitives.
+    // atomic_cas_int returns the value it found, which equals expected on success.
+    MINICRT_INLINE int atomic_cas_int(volatile int *p, int expected, int desired) {
+#if defined(_MSC_VER)
+        return (int) _InterlockedCompareExchange((volatile long *) p, desired, expected);
+#else
+        __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+        return expected;
+#endif
+    }
+
+    MINICRT_INLINE int atomic_exchange_int(volatile int *p, int value) {
+#if defined(_MSC_VER)
+        return (int) _InterlockedExchange((volatile long *) p, value);
+#else
+        return __atomic_exchange_n(p, value, __ATOMIC_ACQ_REL);
+#endif
+    }
+
+    // Returns the previous value
+    MINICRT_INLINE int atomic_fetch_add_int(volatile int *p, int value) {
+#if defined(_MSC_VER)
+        return (int) _InterlockedExchangeAdd((volatile long *) p, value);
+#else
+        return __atomic_fetch_add(p, value, __ATOMIC_ACQ_REL);
+#endif
+    }
+
+    // 64-bit indices of the work-stealing deques (see crt_pool.cpp)
+    MINICRT_INLINE long long atomic_load_long(const volatile long long *p) {
+#if defined(_MSC_VER)
+        long long value = *p;
+        _ReadWriteBarrier();
+        return value;
+#else
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    MINICRT_INLINE void atomic_store_long(volatile long long *p, long long value) {
+#if defined(_MSC_VER)
+        _ReadWriteBarrier();
+        *p = value;
+#else
+        __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+    }
+
+    // Returns non-zero if *p held expected and now holds desired
+    MINICRT_INLINE int atomic_cas_long(volatile long long *p, long long expected, long long desired) {
+#if defined(_MSC_VER)
+        return _InterlockedCompareExchange64(p, desired, expected) == expected;
+#else
+        return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+#endif
+    }
+
+    // Full memory barrier: all earlier loads and stores complete before any later one
+    MINICRT_INLINE void atomic_fence(void) {
+#if defined(_MSC_VER)
+        _mm_mfence();
+#else
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+    }
+
+    // Pointer-sized atomics for the lock-free allocator paths
+    template<typename T>
+    MINICRT_INLINE T *atomic_load_ptr(T *const *p) {
+#if defined(_MSC_VER)
+        T *value = *(T *volatile const *) p;
+        _ReadWriteBarrier();
+        return value;
+#else
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    // On failure *expected receives the current value
+    template<typename T>
+    MINICRT_INLINE bool atomic_cas_ptr(T **p, T **expected, T *desired) {
+#if defined(_MSC_VER)
+        T *seen = (T *) _InterlockedCompareExchangePointer((void *volatile *) p, desired, *expected);
+        if (seen == *expected)
+            return true;
+        *expected = seen;
+        return false;
+#else
+        return __atomic_compare_exchange_n(p, expected, desired, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+#endif
+    }
+
+    template<typename T>
+    MINICRT_INLINE T *atomic_exchange_ptr(T **p, T *desired) {
+#if defined(_MSC_VER)
+        return (T *) _InterlockedExchangePointer((void *volatile *) p, desired);
+#else
+        return __atomic_exchange_n(p, desired, __ATOMIC_ACQ_REL);
+#endif
+    }
+
+    // Index of the highest set bit; x must be non-zero
+    MINICRT_INLINE unsigned int log2_floor64(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - (unsigned int) __builtin_clzll(x);
+#else
+        unsigned long index;
+        _BitScanReverse64(&index, x);
+        return (unsigned int) index;
+#endif
+    }
+
+    // Memory kernels, one per instruction set tier (see crt_memory.cpp)
+    void *memcpy_generic(void *dest, const void *src, size_t count);
+    void *memset_generic(void *dest, int c, size_t count);
+    void *memmove_generic(void *dest, const void *src, size_t count);
+    int memcmp_generic(const void *lhs, const void *rhs, size_t count);
+#ifdef MINICRT_X86_64
+    void *memcpy_sse2(void *dest, const void *src, size_t count);
+    void *memset_sse2(void *dest, int c, size_t count);
+    void *memmove_sse2(void *dest, const void *src, size_t count);
+    int memcmp_sse2(const void *lhs, const void *rhs, size_t count);
+    void *memcpy_avx2(void *dest, const void *src, size_t count);
+    void *memset_avx2(void *dest, int c, size_t count);
+    void *memmove_avx2(void *dest, const void *src, size_t count);
+    int memcmp_avx2(const void *lhs, const void *rhs, size_t count);
+    void *memcpy_avx2_erms(void *dest, const void *src, size_t count);
+    void *memset_avx2_erms(void *dest, int c, size_t count);
+#endif
+
+    // String kernels (see crt_string.cpp)
+    size_t strlen_generic(const char *str);
+    size_t strnlen_generic(const char *str, size_t max_len);
+    int strcmp_generic(const char *lhs, const char *rhs);
+    void *memchr_generic(const void *ptr, int c, size_t count);
+    void *memrchr_generic(const void *ptr, int c, size_t count);
+    char *strchr_generic(const char *str, int c);
+    char *strrchr_generic(const char *str, int c);
+    const char *memmem_generic(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len);
+    size_t byteset_scan_generic(const char *str, size_t length, const byteset *set, unsigned int mode);
+#ifdef MINICRT_X86_64
+    size_t strlen_sse2(const char *str);
+    size_t strnlen_sse2(const char *str, size_t max_len);
+    int strcmp_sse2(const char *lhs, const char *rhs);
+    void *memchr_sse2(const void *ptr, int c, size_t count);
+    void *memrchr_sse2(const void *ptr, int c, size_t count);
+    char *strchr_sse2(const char *str, int c);
+    char *strrchr_sse2(const char *str, int c);
+    const char *memmem_sse2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len);
+    size_t byteset_scan_sse2(const char *str, size_t length, const byteset *set, unsigned int mode);
+    size_t byteset_scan_ssse3(const char *str, size_t length, const byteset *set, unsigned int mode);
+    size_t strlen_avx2(const char *str);
+    size_t strnlen_avx2(const char *str, size_t max_len);
+    int strcmp_avx2(const char *lhs, const char *rhs);
+    void *memchr_avx2(const void *ptr, int c, size_t count);
+    void *memrchr_avx2(const void *ptr, int c, size_t count);
+    char *strchr_avx2(const char *str, int c);
+    char *strrchr_avx2(const char *str, int c);
+    const char *memmem_avx2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len);
+    size_t byteset_scan_avx2(const char *str, size_t length, const byteset *set, unsigned int mode);
+#endif
+
+    // byteset_scan modes: stop at members instead of non-members, and stop at a NUL byte
+    // (the length is then unbounded)
+    static const unsigned int kScanReject = 1u << 0;
+    static const unsigned int kScanString = 1u << 1;
+
+    // Page-granular OS memory (see crt_malloc.cpp); sizes are multiples of the page size
+    void *map_pages(size_t size);
+    void unmap_pages(void *addr, size_t size);
+    void discard_pages(void *addr, size_t size);
+
+    // Non-zero once thread_local storage is usable (see crt_entry.cpp)
+    extern int g_thread_pointer_ready;
+
+    // Record the argument block the kernel passed to _start (see crt_process.cpp)
+    void process_init(int argc, char **argv, char **envp);
+
+    // Install the main thread's TLS block and thread pointer; needs process_init() (see crt_thread.cpp)
+    void thread_init(void);
+
+    // ELF program header, as found through AT_PHDR and in the vDSO
+    struct elf64_phdr {
+        unsigned int p_type;
+        unsigned int p_flags;
+        unsigned long long p_offset;
+        unsigned long long p_vaddr;
+        unsigned long long p_paddr;
+        unsigned long long p_filesz;
+        unsigned long long p_memsz;
+        unsigned long long p_align;
+    };
+
+    // System page size from the aux vector, 4096 until process_init() has run
+    size_t page_size(void);
+
+    /**
+     * @brief Destination of the formatting engine (see crt_format.cpp)
+     *
+     * Output is written to [pos, end). When the window is full, flush is called to
+     * make room; without a flush callback further output is only counted.
+     */
+    struct format_sink {
+        char *pos;
+        char *end;
+        size_t total;                     // characters produced, written or not
+        void (*flush)(format_sink *sink);
+        void *context;
+    };
+
+    // Format into a sink; returns the number of characters produced, or -1 on overflow
+    int format_to_sink(format_sink *sink, const char *format, va_list args);
+
+    // Pick the standard output buffering mode and flush the standard streams (see crt_stdio.cpp)
+    void stdio_init(void);
+    void stdio_flush_all(void);
+
+    // Flush the calling thread's allocator state and let a new thread adopt its heap
+    void heap_thread_exit(void);
+
+    // Per-function call statistics (see crt_stats.cpp). Without MINI_CRT_ENABLE_LOGGING
+    // the hook expands to nothing and its arguments are not evaluated.
+#ifdef MINI_CRT_ENABLE_LOGGING
+    void stats_record(unsigned int function, size_t address_bits, size_t size);
+#define MINICRT_STATS_RECORD(function, a, b, size) \
+    detail::stats_record(function, (size_t) (a) | (size_t) (b), size)
+#else
+#define MINICRT_STATS_RECORD(function, a, b, size) ((void) 0)
+#endif
+
+    // Let a new thread adopt the calling thread's statistics shard
+    void stats_thread_exit(void);
+
+    /**
+     * @brief Sleep while *word equals expected (see crt_sync.cpp)
+     *
+     * Returns early on a wake, a signal or a spurious wakeup, so callers re-check
+     * their condition in a loop. Where futexes are not available this only pauses
+     * the CPU briefly.
+     *
+     * @param timeout Relative timeout, or NULL to wait indefinitely
+     * @return 0, or -ETIMEDOUT once the timeout has passed
+     */
+    int futex_wait(volatile int *word, int expected, const timespec *timeout);
+
+    // Wake up to count threads sleeping on word
+    void futex_wake(volatile int *word, int count);
+
+    /**
+     * @brief Function table behind the public mem and str entry points
+     *
+     * Statically initialized to kernels every CPU of the target architecture can run
+     * (no constructors run in a freestanding binary), then upgraded by cpu_init().
+     */
+    struct dispatch_table {
+        void *(*memcpy)(void *dest, const void *src, size_t count);
+        void *(*memset)(void *dest, int c, size_t count);
+        void *(*memmove)(void *dest, const void *src, size_t count);
+        int (*memcmp)(const void *lhs, const void *rhs, size_t count);
+        size_t (*strlen)(const char *str);
+        size_t (*strnlen)(const char *str, size_t max_len);
+        int (*strcmp)(const char *lhs, const char *rhs);
+        void *(*memchr)(const void *ptr, int c, size_t count);
+        void *(*memrchr)(const void *ptr, int c, size_t count);
+        char *(*strchr)(const char *str, int c);
+        char *(*strrchr)(const char *str, int c);
+        // Needles of at least two bytes, no longer than the haystack
+        const char *(*memmem)(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len);
+        // Index of the first byte that ends the span, or length
+        size_t (*byteset_scan)(const char *str, size_t length, const byteset *set, unsigned int mode);
+    };
+
+    extern dispatch_table g_dispatch;
+
+    // Probe the CPU and fill g_dispatch with the best kernels; safe to call repeatedly
+    void cpu_init(void);
+
+    // Resolve the vDSO clocks and start TSC calibration (see crt_time.cpp); safe to call repeatedly
+    void time_init(void);
+} // namespace detail
+MINICRT_END
+
+#endif // MINICRT_CRT_INTERNAL_H
@@ -0,0 +1,790 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/memory.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+#ifdef MINICRT_WINDOWS
+extern "C" {
+__declspec(dllimport) void *__stdcall VirtualAlloc(void *address, size_t size, unsigned long type,
+                                                   unsigned long protect);
+__declspec(dllimport) int __stdcall VirtualFree(void *address, size_t size, unsigned long type);
+}
+#endif
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * Heap layout
+     *
+     * All memory comes from the OS in spans aligned to kSpanSize, so free() finds the
+     * header of any block by masking its address:
+     *   - small spans (kSpanSize bytes) hold objects of one size class; objects are
+     *     carved from a bump pointer first and recycled through a per-span free list
+     *   - a large block gets a span of its own, rounded up to whole pages
+     *
+     * Small spans belong to a thread_heap. Each thread allocates from and frees into
+     * the spans of its own heap without locks or atomic read-modify-writes. A block
+     * freed by a thread other than the owner is collected into a batch of same-owner
+     * blocks, and the whole batch is pushed onto the owner's lock-free remote_free
+     * stack with a single compare-and-swap. The owner drains that stack when it runs
+     * out of room in a size class.
+     *
+     * Completely free spans go to a small global cache (under g_global_lock) before
+     * they are returned to the OS. Heaps are never unmapped; a heap whose thread has
+     * exited is marked abandoned and adopted, together with its spans, by the next new
+     * thread. Until the runtime has a thread pointer (a freestanding binary before TLS
+     * is installed, or Windows) every thread shares g_shared_heap under g_shared_lock.
+     *
+     * Large blocks of 2 MiB and up start on a 2 MiB boundary and are madvised for
+     * transparent huge pages, or come from the hugetlb pool if asked for. Blocks are
+     * mapped fresh, so calloc knows them to be zero. A freed large block is kept in
+     * a small cache with MADV_FREE on its pages: the kernel takes them back only
+     * under memory pressure, and a later allocation of about the same size reuses
+     * the mapping without a system call. Such a block is marked recycled, and
+     * calloc clears it.
+     */
+
+    static const size_t kPageSize = 4096;
+    static const size_t kSpanSize = 256u << 10;
+    static const size_t kSpanHeaderSize = 64;
+    static const size_t kMaxSmallSize = 32u << 10;
+    static const unsigned int kNumClasses = 40;
+    static const unsigned int kMaxCachedSpans = 8;
+    static const size_t kHugePageSize = 2u << 20;
+    static const unsigned int kMaxCachedLarge = 4;
+    static const size_t kMaxCachedLargeSize = 64u << 20;
+
+    // Flags in the size_class field of a large span
+    static const unsigned int kLargeHugeTlb = 1u << 0;   // mapped from the hugetlb pool
+    static const unsigned int kLargeRecycled = 1u << 1;  // reused from the cache, not zeroed
+
+    static const unsigned int kSmallMagic = 0x534D4C4Cu; // "SMLL"
+    static const unsigned int kLargeMagic = 0x4C524745u; // "LRGE"
+
+    struct free_object {
+        free_object *next;
+    };
+
+    struct thread_heap;
+
+    struct span {
+        unsigned int magic;
+        unsigned int size_class;   // kLarge* flags for large spans
+        size_t object_size;     // usable bytes per object (the whole block for large spans)
+        free_object *free_list; // recycled objects
+        char *bump;             // first never-used object
+        thread_heap *owner;     // heap whose thread may touch free_list/bump/live
+        unsigned int live;      // objects handed out
+        unsigned int listed;    // non-zero while linked into its class list
+        span *next;
+        span *prev;
+    };
+
+    static_assert(sizeof(span) <= kSpanHeaderSize, "span header must fit before the first object");
+
+    // Remote frees are handed to the owner once this many have piled up
+    static const unsigned int kRemoteBatch = 32;
+
+    struct thread_heap {
+        span *partial[kNumClasses]; // spans with at least one free object
+        free_object *remote_free;   // blocks freed by other threads (atomic stack)
+        thread_heap *next_heap;     // registry of all heaps
+        int in_use;                 // 0 once the thread is gone and the heap can be adopted
+
+        // Outgoing batch of blocks owned by pending_owner
+        thread_heap *pending_owner;
+        free_object *pending_head;
+        free_object *pending_tail;
+        unsigned int pending_count;
+    };
+
+    // Guards the span cache and the heap registry
+    static spinlock g_global_lock;
+    static spinlock g_shared_lock;
+    static span *g_cached_spans;
+    static unsigned int g_cached_count;
+    static thread_heap *g_heaps;
+    static thread_heap g_shared_heap;
+    static span *g_cached_large;       // freed large blocks, under g_global_lock
+    static unsigned int g_cached_large_count;
+    static volatile int g_huge_mode = MALLOC_HUGE_THP;
+    static int g_madv_free_unsupported;
+
+#ifdef MINICRT_UNIX
+    static thread_local thread_heap *t_heap;
+    static thread_local int t_heap_retired; // heap_thread_exit() ran; use the shared heap
+
+#if __STDC_HOSTED__
+    // Under a hosted C++ runtime threads are not started by MiniCRT, so hand the heap
+    // over from a thread_local destructor instead
+    struct heap_reaper {
+        ~heap_reaper() { heap_thread_exit(); }
+    };
+
+    static thread_local heap_reaper t_reaper;
+#endif
+#endif
+
+    // 16-byte steps up to 128, then four classes per power of two up to kMaxSmallSize
+    static MINICRT_INLINE unsigned int size_to_class(size_t size) {
+        if (size <= 128)
+            return size ? (unsigned int) ((size + 15) >> 4) - 1 : 0;
+
+        unsigned int log2 = log2_floor64(size - 1);
+        unsigned int shift = log2 - 2;
+        return 8 + (log2 - 7) * 4 + (unsigned int) (((size - 1) >> shift) & 3);
+    }
+
+    static MINICRT_INLINE size_t class_to_size(unsigned int size_class) {
+        if (size_class < 8)
+            return (size_t) (size_class + 1) << 4;
+
+        unsigned int log2 = 7 + (size_class - 8) / 4;
+        return ((size_t) 1 << log2) + ((size_t) ((size_class - 8) % 4 + 1) << (log2 - 2));
+    }
+
+    static MINICRT_INLINE span *span_of(const void *ptr) {
+        return (span *) ((size_t) ptr & ~(kSpanSize - 1));
+    }
+
+    static MINICRT_INLINE size_t round_up(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+    /**
+     * @brief Map size bytes (a page multiple) at an address aligned to align
+     *
+     * @param align A power of two, at least kSpanSize
+     */
+    static void *map_aligned(size_t size, size_t align) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        // Over-map by one alignment unit and trim the misaligned ends
+        char *raw = (char *) sys_mmap(0, size + align, kProtRead | kProtWrite,
+                                      kMapPrivate | kMapAnonymous, -1, 0);
+        if (syscall_failed((long) raw))
+            return 0;
+
+        char *aligned = (char *) round_up((size_t) raw, align);
+        size_t head = (size_t) (aligned - raw);
+        if (head)
+            sys_munmap(raw, head);
+        if (align - head)
+            sys_munmap(aligned + size, align - head);
+        return aligned;
+#elif defined(MINICRT_WINDOWS)
+        // Windows cannot release part of a reservation: find an aligned hole instead
+        for (int attempt = 0; attempt < 8; attempt++) {
+            char *raw = (char *) VirtualAlloc(0, size + align, 0x2000 /* MEM_RESERVE */, 0x04);
+            if (!raw)
+                return 0;
+            char *aligned = (char *) round_up((size_t) raw, align);
+            VirtualFree(raw, 0, 0x8000 /* MEM_RELEASE */);
+            void *p = VirtualAlloc(aligned, size, 0x3000 /* MEM_RESERVE | MEM_COMMIT */, 0x04 /* PAGE_READWRITE */);
+            if (p)
+                return p;
+        }
+        return 0;
+#else
+        (void) size;
+        (void) align;
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Map size bytes (a page multiple) of zeroed read-write memory
+     */
+    void *map_pages(size_t size) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        void *p = sys_mmap(0, size, kProtRead | kProtWrite, kMapPrivate | kMapAnonymous, -1, 0);
+        return syscall_failed((long) p) ? 0 : p;
+#elif defined(MINICRT_WINDOWS)
+        return VirtualAlloc(0, size, 0x3000 /* MEM_RESERVE | MEM_COMMIT */, 0x04 /* PAGE_READWRITE */);
+#else
+        (void) size;
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Unmap memory obtained from map_pages or map_aligned
+     */
+    void unmap_pages(void *addr, size_t size) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        sys_munmap(addr, size);
+#elif defined(MINICRT_WINDOWS)
+        (void) size;
+        VirtualFree(addr, 0, 0x8000 /* MEM_RELEASE */);
+#else
+        (void) addr;
+        (void) size;
+#endif
+    }
+
+    /**
+     * @brief Give the physical pages behind a mapped range back to the OS
+     *
+     * The range stays mapped; on Linux it reads back as zeroes, on Windows its contents
+     * become undefined.
+     */
+    void discard_pages(void *addr, size_t size) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        sys_madvise(addr, size, kMadvDontNeed);
+#elif defined(MINICRT_WINDOWS)
+        VirtualAlloc(addr, size, 0x80000 /* MEM_RESET */, 0x04 /* PAGE_READWRITE */);
+#else
+        (void) addr;
+        (void) size;
+#endif
+    }
+
+    static MINICRT_INLINE void list_push(span **head, span *s) {
+        s->prev = 0;
+        s->next = *head;
+        if (*head)
+            (*head)->prev = s;
+        *head = s;
+        s->listed = 1;
+    }
+
+    static MINICRT_INLINE void list_remove(span **head, span *s) {
+        if (s->prev)
+            s->prev->next = s->next;
+        else
+            *head = s->next;
+        if (s->next)
+            s->next->prev = s->prev;
+        s->next = s->prev = 0;
+        s->listed = 0;
+    }
+
+    /**
+     * @brief Get an empty span for a size class from the cache or the OS
+     */
+    static span *span_create(thread_heap *heap, unsigned int size_class) {
+        spin_lock(&g_global_lock);
+        span *s = g_cached_spans;
+        if (s) {
+            g_cached_spans = s->next;
+            g_cached_count--;
+        }
+        spin_unlock(&g_global_lock);
+
+        if (!s) {
+            s = (span *) map_aligned(kSpanSize, kSpanSize);
+            if (!s)
+                return 0;
+        }
+
+        s->magic = kSmallMagic;
+        s->size_class = size_class;
+        s->object_size = class_to_size(size_class);
+        s->free_list = 0;
+        s->bump = (char *) s + kSpanHeaderSize;
+        s->owner = heap;
+        s->live = 0;
+        list_push(&heap->partial[size_class], s);
+        return s;
+    }
+
+    /**
+     * @brief Hand an empty, unlisted span back to the cache or the OS
+     */
+    static void span_release(span *s) {
+        spin_lock(&g_global_lock);
+        if (g_cached_count < kMaxCachedSpans) {
+            s->next = g_cached_spans;
+            g_cached_spans = s;
+            g_cached_count++;
+            s = 0;
+        }
+        spin_unlock(&g_global_lock);
+
+        if (s)
+            unmap_pages(s, kSpanSize);
+    }
+
+    /**
+     * @brief Return a block to its span; only the owning thread may call this
+     */
+    static void local_free(thread_heap *heap, span *s, free_object *obj) {
+        obj->next = s->free_list;
+        s->free_list = obj;
+        s->live--;
+
+        span **head = &heap->partial[s->size_class];
+        if (!s->listed) {
+            list_push(head, s);
+        } else if (s->live == 0 && (s->prev || s->next)) {
+            // Keep the last span of a class around; release the others once empty
+            list_remove(head, s);
+            span_release(s);
+        }
+    }
+
+    /**
+     * @brief Push the outgoing batch onto its owner's remote_free stack
+     */
+    static void flush_pending(thread_heap *heap) {
+        thread_heap *owner = heap->pending_owner;
+        if (!heap->pending_head)
+            return;
+
+        free_object *old_head = atomic_load_ptr(&owner->remote_free);
+        do {
+            heap->pending_tail->next = old_head;
+        } while (!atomic_cas_ptr(&owner->remote_free, &old_head, heap->pending_head));
+
+        heap->pending_head = heap->pending_tail = 0;
+        heap->pending_count = 0;
+    }
+
+    /**
+     * @brief Queue a block owned by another heap
+     */
+    static void remote_free(thread_heap *heap, span *s, free_object *obj) {
+        if (heap->pending_owner != s->owner) {
+            flush_pending(heap);
+            heap->pending_owner = s->owner;
+        }
+
+        obj->next = heap->pending_head;
+        heap->pending_head = obj;
+        if (!heap->pending_tail)
+            heap->pending_tail = obj;
+        if (++heap->pending_count >= kRemoteBatch)
+            flush_pending(heap);
+    }
+
+    /**
+     * @brief Take back every block other threads have freed into this heap
+     */
+    static void drain_remote(thread_heap *heap) {
+        if (!atomic_load_ptr(&heap->remote_free))
+            return;
+
+        free_object *obj = atomic_exchange_ptr(&heap->remote_free, (free_object *) 0);
+        while (obj) {
+            free_object *next = obj->next;
+            local_free(heap, span_of(obj), obj);
+            obj = next;
+        }
+    }
+
+    static void *heap_alloc(thread_heap *heap, size_t size) {
+        unsigned int size_class = size_to_class(size);
+        span *s = heap->partial[size_class];
+
+        if (MINICRT_UNLIKELY(!s)) {
+            // Slow path: settle our own debts, collect blocks freed remotely, then map
+            flush_pending(heap);
+            drain_remote(heap);
+            s = heap->partial[size_class];
+            if (!s && !(s = span_create(heap, size_class)))
+                return 0;
+        }
+
+        void *obj;
+        if (s->free_list) {
+            obj = s->free_list;
+            s->free_list = s->free_list->next;
+        } else {
+            obj = s->bump;
+            s->bump += s->object_size;
+        }
+        s->live++;
+
+        // Full spans leave the list until one of their objects is freed
+        if (!s->free_list && s->bump + s->object_size > (char *) s + kSpanSize)
+            list_remove(&heap->partial[size_class], s);
+        return obj;
+    }
+
+    static void heap_free(thread_heap *heap, span *s, void *ptr) {
+        if (MINICRT_LIKELY(s->owner == heap))
+            local_free(heap, s, (free_object *) ptr);
+        else
+            remote_free(heap, s, (free_object *) ptr);
+    }
+
+#ifdef MINICRT_UNIX
+    /**
+     * @brief Give the calling thread a heap: adopt an abandoned one or map a new one
+     */
+    static thread_heap *heap_attach(void) {
+        thread_heap *heap;
+
+        spin_lock(&g_global_lock);
+        for (heap = g_heaps; heap; heap = heap->next_heap) {
+            if (!heap->in_use)
+                break;
+        }
+        if (heap)
+            heap->in_use = 1;
+        spin_unlock(&g_global_lock);
+
+        if (!heap) {
+            heap = (thread_heap *) map_aligned(round_up(sizeof(thread_heap), kPageSize), kSpanSize);
+            if (!heap)
+                return 0;
+            heap->in_use = 1;
+
+            spin_lock(&g_global_lock);
+            heap->next_heap = g_heaps;
+            g_heaps = heap;
+            spin_unlock(&g_global_lock);
+        }
+
+#if __STDC_HOSTED__
+        (void) &t_reaper;
+#endif
+        t_heap = heap;
+        return heap;
+    }
+#endif
+
+    /**
+     * @brief Get the calling thread's heap, or NULL to use the shared heap
+     */
+    static MINICRT_INLINE thread_heap *current_heap(void) {
+#ifdef MINICRT_UNIX
+        if (MINICRT_LIKELY(g_thread_pointer_ready)) {
+            thread_heap *heap = t_heap;
+            if (MINICRT_LIKELY(heap != 0))
+                return heap;
+            return t_heap_retired ? 0 : heap_attach();
+        }
+#endif
+        return 0;
+    }
+
+    static void *small_alloc(size_t size) {
+        thread_heap *heap = current_heap();
+        if (MINICRT_LIKELY(heap != 0))
+            return heap_alloc(heap, size);
+
+        spin_lock(&g_shared_lock);
+        void *obj = heap_alloc(&g_shared_heap, size);
+        spin_unlock(&g_shared_lock);
+        return obj;
+    }
+
+    static void small_free(span *s, void *ptr) {
+        // Blocks of the shared heap are always freed under its lock
+        if (s->owner != &g_shared_heap) {
+            thread_heap *heap = current_heap();
+            if (MINICRT_LIKELY(heap != 0)) {
+                heap_free(heap, s, ptr);
+                return;
+            }
+        }
+
+        spin_lock(&g_shared_lock);
+        heap_free(&g_shared_heap, s, ptr);
+        spin_unlock(&g_shared_lock);
+    }
+
+    void heap_thread_exit(void) {
+#ifdef MINICRT_UNIX
+        thread_heap *heap = g_thread_pointer_ready ? t_heap : 0;
+        if (!heap)
+            return;
+
+        flush_pending(heap);
+        drain_remote(heap);
+        t_heap = 0;
+        t_heap_retired = 1;
+
+        spin_lock(&g_global_lock);
+        heap->in_use = 0;
+        spin_unlock(&g_global_lock);
+#endif
+    }
+
+    /**
+     * @brief Map pages for a large block, with huge pages as g_huge_mode asks
+     *
+     * @param map_size In: bytes needed, a page multiple. Out: bytes mapped.
+     * @param flags Set to the kLarge* flags of the mapping
+     */
+    static void *map_large(size_t *map_size, unsigned int *flags) {
+        *flags = 0;
+        int mode = atomic_load_int(&g_huge_mode);
+        if (mode == MALLOC_HUGE_OFF || *map_size < kHugePageSize)
+            return map_aligned(*map_size, kSpanSize);
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (mode == MALLOC_HUGE_HUGETLB) {
+            // Fails unless the administrator has reserved huge pages
+            size_t huge_size = round_up(*map_size, kHugePageSize);
+            void *p = sys_mmap(0, huge_size, kProtRead | kProtWrite,
+                               kMapPrivate | kMapAnonymous | kMapHugeTlb | kMapHuge2Mb, -1, 0);
+            if (!syscall_failed((long) p)) {
+                *map_size = huge_size;
+                *flags = kLargeHugeTlb;
+                return p;
+            }
+        }
+
+        // Transparent huge pages can only back the 2 MiB-aligned extents of a range
+        void *p = map_aligned(*map_size, kHugePageSize);
+        if (p)
+            sys_madvise(p, *map_size, kMadvHugePage);
+        return p;
+#else
+        return map_aligned(*map_size, kSpanSize);
+#endif
+    }
+
+    /**
+     * @brief Let the OS reclaim a range whenever it needs the memory
+     *
+     * Until then the pages keep their contents and cost nothing to touch again.
+     */
+    static void free_pages_lazily(void *addr, size_t size) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        // MADV_FREE needs Linux 4.5; older kernels drop the pages right away
+        if (!g_madv_free_unsupported && sys_madvise(addr, size, kMadvFree) == -kErrInval)
+            g_madv_free_unsupported = 1;
+        if (g_madv_free_unsupported)
+            sys_madvise(addr, size, kMadvDontNeed);
+#else
+        discard_pages(addr, size);
+#endif
+    }
+
+    /**
+     * @brief Take the best-fitting cached large block of at least map_size bytes
+     */
+    static span *large_cache_take(size_t map_size) {
+        if (!atomic_load_ptr(&g_cached_large))
+            return 0;
+
+        span **best = 0;
+        spin_lock(&g_global_lock);
+        for (span **link = &g_cached_large; *link; link = &(*link)->next) {
+            // A block more than a quarter too big is left for a better match
+            size_t cached = (*link)->object_size + kSpanHeaderSize;
+            if (cached >= map_size && cached - map_size <= map_size / 4 &&
+                (!best || cached < (*best)->object_size + kSpanHeaderSize))
+                best = link;
+        }
+        span *s = 0;
+        if (best) {
+            s = *best;
+            *best = s->next;
+            g_cached_large_count--;
+        }
+        spin_unlock(&g_global_lock);
+        return s;
+    }
+
+    static void *large_alloc(size_t size) {
+        if (size > ~(size_t) 0 - kSpanHeaderSize - kHugePageSize)
+            return 0;
+
+        size_t map_size = round_up(size + kSpanHeaderSize, kPageSize);
+        span *s = large_cache_take(map_size);
+        if (s) {
+            s->size_class |= kLargeRecycled;
+            return (char *) s + kSpanHeaderSize;
+        }
+
+        unsigned int flags;
+        s = (span *) map_large(&map_size, &flags);
+        if (!s)
+            return 0;
+
+        s->magic = kLargeMagic;
+        s->size_class = flags;
+        s->object_size = map_size - kSpanHeaderSize;
+        return (char *) s + kSpanHeaderSize;
+    }
+
+    static void large_free(span *s) {
+        size_t map_size = s->object_size + kSpanHeaderSize;
+
+        // Keep the block if there looks to be room (checked again under the lock);
+        // hugetlb pages go back to their pool at once
+        if (!(s->size_class & kLargeHugeTlb) && map_size <= kMaxCachedLargeSize &&
+            g_cached_large_count < kMaxCachedLarge) {
+            // The header page stays resident, the rest is the kernel's to take
+            free_pages_lazily((char *) s + kPageSize, map_size - kPageSize);
+
+            spin_lock(&g_global_lock);
+            if (g_cached_large_count < kMaxCachedLarge) {
+                s->next = g_cached_large;
+                g_cached_large = s;
+                g_cached_large_count++;
+                s = 0;
+            }
+            spin_unlock(&g_global_lock);
+            if (!s)
+                return;
+        }
+        unmap_pages(s, map_size);
+    }
+
+    /**
+     * @brief Resize a large block by allocating a new one and copying
+     */
+    static void *large_move(span *s, size_t size) {
+        void *ptr = large_alloc(size);
+        if (!ptr)
+            return 0;
+        size_t keep = s->object_size < size ? s->object_size : size;
+        memcpy(ptr, (char *) s + kSpanHeaderSize, keep);
+        large_free(s);
+        return ptr;
+    }
+
+    /**
+     * @brief Resize a large block without copying its contents
+     */
+    static void *large_realloc(span *s, size_t size) {
+        size_t old_map = s->object_size + kSpanHeaderSize;
+        if (size > ~(size_t) 0 - kSpanHeaderSize - kHugePageSize)
+            return 0;
+        size_t new_map = round_up(size + kSpanHeaderSize, kPageSize);
+
+        if (new_map == old_map)
+            return (char *) s + kSpanHeaderSize;
+
+        // hugetlb mappings only resize in whole huge pages: keep one that still
+        // fits reasonably, copy otherwise
+        if (s->size_class & kLargeHugeTlb) {
+            if (size <= s->object_size && size > s->object_size / 2)
+                return (char *) s + kSpanHeaderSize;
+            return large_move(s, size);
+        }
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (new_map < old_map) {
+            sys_munmap((char *) s + new_map, old_map - new_map);
+            s->object_size = new_map - kSpanHeaderSize;
+            return (char *) s + kSpanHeaderSize;
+        }
+
+        bool huge = new_map >= kHugePageSize && atomic_load_int(&g_huge_mode) != MALLOC_HUGE_OFF;
+
+        // Grow in place if the pages after the block are free
+        void *moved = sys_mremap(s, old_map, new_map, 0, 0);
+        if (syscall_failed((long) moved)) {
+            // Otherwise move the page mappings to a fresh aligned range (no data copy)
+            void *target = map_aligned(new_map, huge ? kHugePageSize : kSpanSize);
+            if (!target)
+                return 0;
+            moved = sys_mremap(s, old_map, new_map, kMremapMayMove | kMremapFixed, target);
+            if (syscall_failed((long) moved)) {
+                sys_munmap(target, new_map);
+                return 0;
+            }
+        }
+        if (huge)
+            sys_madvise(moved, new_map, kMadvHugePage);
+
+        s = (span *) moved;
+        s->object_size = new_map - kSpanHeaderSize;
+        return (char *) s + kSpanHeaderSize;
+#else
+        return large_move(s, size);
+#endif
+    }
+} // namespace detail
+
+    /**
+     * @brief Allocate memory
+     */
+    void *malloc(size_t size) {
+        void *ptr = size <= detail::kMaxSmallSize ? detail::small_alloc(size) : detail::large_alloc(size);
+        if (!ptr)
+            errno = ENOMEM;
+        return ptr;
+    }
+
+    /**
+     * @brief Free allocated memory
+     */
+    void free(void *ptr) {
+        if (!ptr)
+            return;
+
+        detail::span *s = detail::span_of(ptr);
+        if (s->magic == detail::kLargeMagic)
+            detail::large_free(s);
+        else
+            detail::small_free(s, ptr);
+    }
+
+    /**
+     * @brief Allocate zero-initialized memory
+     */
+    void *calloc(size_t count, size_t size) {
+        if (size && count > ~(size_t) 0 / size) {
+            errno = ENOMEM;
+            return 0;
+        }
+
+        size_t total = count * size;
+        void *ptr = malloc(total);
+        if (!ptr)
+            return 0;
+
+        // A large block on pages fresh from the kernel is zero already
+        detail::span *s = detail::span_of(ptr);
+        if (s->magic != detail::kLargeMagic || (s->size_class & detail::kLargeRecycled))
+            memset(ptr, 0, total);
+        return ptr;
+    }
+
+    /**
+     * @brief Resize an allocated block
+     */
+    void *realloc(void *ptr, size_t size) {
+        if (!ptr)
+            return malloc(size);
+        if (size == 0) {
+            free(ptr);
+            return 0;
+        }
+
+        detail::span *s = detail::span_of(ptr);
+        void *result;
+        if (s->magic == detail::kLargeMagic) {
+            result = detail::large_realloc(s, size);
+        } else if (size <= s->object_size) {
+            result = ptr;
+        } else {
+            result = malloc(size);
+            if (result) {
+                memcpy(result, ptr, s->object_size);
+                detail::small_free(s, ptr);
+            }
+        }
+
+        if (!result)
+            errno = ENOMEM;
+        return result;
+    }
+
+    /**
+     * @brief Get the usable size of an allocated block
+     */
+    size_t malloc_usable_size(void *ptr) {
+        return ptr ? detail::span_of(ptr)->object_size : 0;
+    }
+
+    /**
+     * @brief Choose how large blocks use huge pages
+     */
+    int malloc_set_huge_pages(int mode) {
+        if (mode < MALLOC_HUGE_OFF || mode > MALLOC_HUGE_HUGETLB) {
+            errno = EINVAL;
+            return -1;
+        }
+        return detail::atomic_exchange_int(&detail::g_huge_mode, mode);
+    }
+
+MINICRT_END
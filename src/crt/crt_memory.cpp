@@ -3,45 +3,141 @@
 //
 
 #include "minicrt/memory.h"
+#include "minicrt/stats.h"
+#include "crt_internal.h"
 
 MINICRT_BEGIN
-    // For Windows platform-specific memory operations
+namespace detail {
+    // Non-temporal store threshold; cpu_init() derives the default from the LLC size
+    size_t g_nt_threshold_default = 4u << 20;
+    size_t g_nt_threshold = 4u << 20;
+
+    /*
+     * Kernel layout shared by every tier:
+     *   - tiny (<= 16 bytes): two possibly overlapping scalar loads/stores, no loop
+     *   - medium: head and tail vectors that overlap in the middle, no loop either
+     *   - large: unaligned head, destination-aligned main loop, unaligned tail
+     * All loads of a block are issued before its stores, so the tiny/medium paths
+     * are also safe for overlapping buffers (memmove relies on that).
+     */
+
+    static MINICRT_INLINE void copy_tiny(unsigned char *d, const unsigned char *s, size_t n) {
+        if (n >= 8) {
+            unsigned long long a = load64(s), b = load64(s + n - 8);
+            store64(d, a);
+            store64(d + n - 8, b);
+        } else if (n >= 4) {
+            unsigned int a = load32(s), b = load32(s + n - 4);
+            store32(d, a);
+            store32(d + n - 4, b);
+        } else if (n >= 2) {
+            unsigned short a = load16(s), b = load16(s + n - 2);
+            store16(d, a);
+            store16(d + n - 2, b);
+        } else if (n) {
+            *d = *s;
+        }
+    }
+
+    static MINICRT_INLINE void fill_tiny(unsigned char *d, unsigned long long v, size_t n) {
+        if (n >= 8) {
+            store64(d, v);
+            store64(d + n - 8, v);
+        } else if (n >= 4) {
+            store32(d, (unsigned int) v);
+            store32(d + n - 4, (unsigned int) v);
+        } else if (n >= 2) {
+            store16(d, (unsigned short) v);
+            store16(d + n - 2, (unsigned short) v);
+        } else if (n) {
+            *d = (unsigned char) v;
+        }
+    }
+
     /**
-     * @brief Fill a block of memory with a value
+     * @brief Portable word-at-a-time copy
      */
-    void *memset(void *dest, int c, size_t count) {
-        unsigned char *p = (unsigned char *) dest;
-        unsigned char value = (unsigned char) c;
+    void *memcpy_generic(void *dest, const void *src, size_t count) {
+        unsigned char *d = (unsigned char *) dest;
+        const unsigned char *s = (const unsigned char *) src;
+
+        if (count <= 16) {
+            copy_tiny(d, s, count);
+            return dest;
+        }
 
-        while (count--)
-            *p++ = value;
+        unsigned long long head = load64(s);
+        unsigned long long tail = load64(s + count - 8);
+
+        // Align the destination to 8 bytes; the head word covers the skipped bytes
+        size_t skew = 8 - ((size_t) d & 7);
+        unsigned char *end = d + count - 8;
+        unsigned char *p = d + skew;
+        s += skew;
+
+        while (p + 32 <= end) {
+            unsigned long long w0 = load64(s), w1 = load64(s + 8);
+            unsigned long long w2 = load64(s + 16), w3 = load64(s + 24);
+            store64(p, w0);
+            store64(p + 8, w1);
+            store64(p + 16, w2);
+            store64(p + 24, w3);
+            p += 32;
+            s += 32;
+        }
+        while (p < end) {
+            store64(p, load64(s));
+            p += 8;
+            s += 8;
+        }
 
+        store64(end, tail);
+        store64(d, head);
         return dest;
     }
 
     /**
-     * @brief Copy memory from one location to another
+     * @brief Portable word-at-a-time fill
      */
-    void *memcpy(void *dest, const void *src, size_t count) {
+    void *memset_generic(void *dest, int c, size_t count) {
         unsigned char *d = (unsigned char *) dest;
-        const unsigned char *s = (const unsigned char *) src;
+        unsigned long long v = 0x0101010101010101ULL * (unsigned char) c;
+
+        if (count <= 16) {
+            fill_tiny(d, v, count);
+            return dest;
+        }
 
-        while (count--)
-            *d++ = *s++;
+        unsigned char *end = d + count - 8;
+        unsigned char *p = (unsigned char *) (((size_t) d + 8) & ~(size_t) 7);
 
+        store64(d, v);
+        while (p + 32 <= end) {
+            store64(p, v);
+            store64(p + 8, v);
+            store64(p + 16, v);
+            store64(p + 24, v);
+            p += 32;
+        }
+        while (p < end) {
+            store64(p, v);
+            p += 8;
+        }
+        store64(end, v);
         return dest;
     }
 
     /**
-     * @brief Copy memory, handling overlapping regions
+     * @brief Portable memmove: the tiny copy path is overlap-safe, larger overlapping
+     * ranges fall back to byte loops in the safe direction
      */
-    void *memmove(void *dest, const void *src, size_t count) {
+    void *memmove_generic(void *dest, const void *src, size_t count) {
         unsigned char *d = (unsigned char *) dest;
         const unsigned char *s = (const unsigned char *) src;
 
         // If source and destination don't overlap, use simple copy
-        if (d >= s + count || s >= d + count)
-            return memcpy(dest, src, count);
+        if (count <= 16 || d >= s + count || s >= d + count)
+            return memcpy_generic(dest, src, count);
 
         // If source is before destination, copy backwards to avoid overwriting source
         if (d > s) {
@@ -60,12 +156,19 @@ MINICRT_BEGIN
     }
 
     /**
-     * @brief Compare two memory regions
+     * @brief Portable memcmp comparing a 64-bit word at a time
      */
-    int memcmp(const void *lhs, const void *rhs, size_t count) {
+    int memcmp_generic(const void *lhs, const void *rhs, size_t count) {
         const unsigned char *l = (const unsigned char *) lhs;
         const unsigned char *r = (const unsigned char *) rhs;
 
+        // Skip equal words; the first differing byte is then found in the byte loop
+        while (count >= 8 && load64(l) == load64(r)) {
+            l += 8;
+            r += 8;
+            count -= 8;
+        }
+
         while (count--) {
             if (*l != *r)
                 return *l - *r;
@@ -76,4 +179,611 @@ MINICRT_BEGIN
         return 0;
     }
 
+#ifdef MINICRT_X86_64
+    /*
+     * Blocks of at least g_nt_threshold bytes would evict the whole last-level cache
+     * for data the caller is unlikely to touch again soon, so the main loops switch to
+     * non-temporal (streaming) stores and prefetch the source ahead of the loads. The
+     * head and tail are still written with regular stores; an sfence after the loop
+     * orders the streaming stores before anything that follows.
+     */
+    static const size_t kPrefetchDistance = 512;
+
+    /**
+     * @brief SSE2 copy: 16-byte vectors, 64 bytes per main-loop iteration
+     */
+    void *memcpy_sse2(void *dest, const void *src, size_t count) {
+        unsigned char *d = (unsigned char *) dest;
+        const unsigned char *s = (const unsigned char *) src;
+
+        if (count <= 16) {
+            copy_tiny(d, s, count);
+            return dest;
+        }
+        if (count <= 32) {
+            __m128i a = _mm_loadu_si128((const __m128i *) s);
+            __m128i b = _mm_loadu_si128((const __m128i *) (s + count - 16));
+            _mm_storeu_si128((__m128i *) d, a);
+            _mm_storeu_si128((__m128i *) (d + count - 16), b);
+            return dest;
+        }
+        if (count <= 64) {
+            __m128i a = _mm_loadu_si128((const __m128i *) s);
+            __m128i b = _mm_loadu_si128((const __m128i *) (s + 16));
+            __m128i c = _mm_loadu_si128((const __m128i *) (s + count - 32));
+            __m128i e = _mm_loadu_si128((const __m128i *) (s + count - 16));
+            _mm_storeu_si128((__m128i *) d, a);
+            _mm_storeu_si128((__m128i *) (d + 16), b);
+            _mm_storeu_si128((__m128i *) (d + count - 32), c);
+            _mm_storeu_si128((__m128i *) (d + count - 16), e);
+            return dest;
+        }
+
+        // Tail (last 64 bytes) and head (first 16 bytes) are loaded up front and
+        // stored last; the main loop then only has to cover the aligned middle
+        __m128i head = _mm_loadu_si128((const __m128i *) s);
+        __m128i t0 = _mm_loadu_si128((const __m128i *) (s + count - 64));
+        __m128i t1 = _mm_loadu_si128((const __m128i *) (s + count - 48));
+        __m128i t2 = _mm_loadu_si128((const __m128i *) (s + count - 32));
+        __m128i t3 = _mm_loadu_si128((const __m128i *) (s + count - 16));
+
+        size_t skew = 16 - ((size_t) d & 15);
+        unsigned char *p = d + skew;
+        const unsigned char *q = s + skew;
+        size_t remaining = count - skew;
+
+        if (MINICRT_UNLIKELY(count >= g_nt_threshold)) {
+            while (remaining > 64) {
+                _mm_prefetch((const char *) q + kPrefetchDistance, _MM_HINT_NTA);
+                __m128i a = _mm_loadu_si128((const __m128i *) q);
+                __m128i b = _mm_loadu_si128((const __m128i *) (q + 16));
+                __m128i c = _mm_loadu_si128((const __m128i *) (q + 32));
+                __m128i e = _mm_loadu_si128((const __m128i *) (q + 48));
+                _mm_stream_si128((__m128i *) p, a);
+                _mm_stream_si128((__m128i *) (p + 16), b);
+                _mm_stream_si128((__m128i *) (p + 32), c);
+                _mm_stream_si128((__m128i *) (p + 48), e);
+                p += 64;
+                q += 64;
+                remaining -= 64;
+            }
+            _mm_sfence();
+        } else {
+            while (remaining > 64) {
+                __m128i a = _mm_loadu_si128((const __m128i *) q);
+                __m128i b = _mm_loadu_si128((const __m128i *) (q + 16));
+                __m128i c = _mm_loadu_si128((const __m128i *) (q + 32));
+                __m128i e = _mm_loadu_si128((const __m128i *) (q + 48));
+                _mm_store_si128((__m128i *) p, a);
+                _mm_store_si128((__m128i *) (p + 16), b);
+                _mm_store_si128((__m128i *) (p + 32), c);
+                _mm_store_si128((__m128i *) (p + 48), e);
+                p += 64;
+                q += 64;
+                remaining -= 64;
+            }
+        }
+
+        _mm_storeu_si128((__m128i *) (d + count - 64), t0);
+        _mm_storeu_si128((__m128i *) (d + count - 48), t1);
+        _mm_storeu_si128((__m128i *) (d + count - 32), t2);
+        _mm_storeu_si128((__m128i *) (d + count - 16), t3);
+        _mm_storeu_si128((__m128i *) d, head);
+        return dest;
+    }
+
+    /**
+     * @brief SSE2 fill: 16-byte vectors, 64 bytes per main-loop iteration
+     */
+    void *memset_sse2(void *dest, int c, size_t count) {
+        unsigned char *d = (unsigned char *) dest;
+
+        if (count <= 16) {
+            fill_tiny(d, 0x0101010101010101ULL * (unsigned char) c, count);
+            return dest;
+        }
+
+        __m128i v = _mm_set1_epi8((char) c);
+        if (count <= 32) {
+            _mm_storeu_si128((__m128i *) d, v);
+            _mm_storeu_si128((__m128i *) (d + count - 16), v);
+            return dest;
+        }
+        if (count <= 64) {
+            _mm_storeu_si128((__m128i *) d, v);
+            _mm_storeu_si128((__m128i *) (d + 16), v);
+            _mm_storeu_si128((__m128i *) (d + count - 32), v);
+            _mm_storeu_si128((__m128i *) (d + count - 16), v);
+            return dest;
+        }
+
+        _mm_storeu_si128((__m128i *) d, v);
+        unsigned char *p = (unsigned char *) (((size_t) d + 16) & ~(size_t) 15);
+        unsigned char *end = d + count - 64;
+
+        if (MINICRT_UNLIKELY(count >= g_nt_threshold)) {
+            while (p < end) {
+                _mm_stream_si128((__m128i *) p, v);
+                _mm_stream_si128((__m128i *) (p + 16), v);
+                _mm_stream_si128((__m128i *) (p + 32), v);
+                _mm_stream_si128((__m128i *) (p + 48), v);
+                p += 64;
+            }
+            _mm_sfence();
+        } else {
+            while (p < end) {
+                _mm_store_si128((__m128i *) p, v);
+                _mm_store_si128((__m128i *) (p + 16), v);
+                _mm_store_si128((__m128i *) (p + 32), v);
+                _mm_store_si128((__m128i *) (p + 48), v);
+                p += 64;
+            }
+        }
+
+        _mm_storeu_si128((__m128i *) end, v);
+        _mm_storeu_si128((__m128i *) (end + 16), v);
+        _mm_storeu_si128((__m128i *) (end + 32), v);
+        _mm_storeu_si128((__m128i *) (end + 48), v);
+        return dest;
+    }
+
+    /**
+     * @brief SSE2 memmove
+     *
+     * Blocks of up to 64 bytes and forward-safe overlaps reuse memcpy_sse2; otherwise
+     * the destination end is aligned and the loop walks backwards.
+     */
+    void *memmove_sse2(void *dest, const void *src, size_t count) {
+        unsigned char *d = (unsigned char *) dest;
+        const unsigned char *s = (const unsigned char *) src;
+
+        // Unsigned distance: a destination below the source wraps to a huge value
+        if (count <= 64 || (size_t) (d - s) >= count)
+            return memcpy_sse2(dest, src, count);
+
+        __m128i h0 = _mm_loadu_si128((const __m128i *) s);
+        __m128i h1 = _mm_loadu_si128((const __m128i *) (s + 16));
+        __m128i h2 = _mm_loadu_si128((const __m128i *) (s + 32));
+        __m128i h3 = _mm_loadu_si128((const __m128i *) (s + 48));
+        __m128i tail = _mm_loadu_si128((const __m128i *) (s + count - 16));
+
+        size_t skew = (size_t) (d + count) & 15;
+        unsigned char *p = d + count - skew;
+        const unsigned char *q = s + count - skew;
+        size_t remaining = count - skew;
+
+        if (MINICRT_UNLIKELY(count >= g_nt_threshold)) {
+            while (remaining > 64) {
+                p -= 64;
+                q -= 64;
+                _mm_prefetch((const char *) q - kPrefetchDistance, _MM_HINT_NTA);
+                __m128i a = _mm_loadu_si128((const __m128i *) q);
+                __m128i b = _mm_loadu_si128((const __m128i *) (q + 16));
+                __m128i c = _mm_loadu_si128((const __m128i *) (q + 32));
+                __m128i e = _mm_loadu_si128((const __m128i *) (q + 48));
+                _mm_stream_si128((__m128i *) p, a);
+                _mm_stream_si128((__m128i *) (p + 16), b);
+                _mm_stream_si128((__m128i *) (p + 32), c);
+                _mm_stream_si128((__m128i *) (p + 48), e);
+                remaining -= 64;
+            }
+            _mm_sfence();
+        } else {
+            while (remaining > 64) {
+                p -= 64;
+                q -= 64;
+                __m128i a = _mm_loadu_si128((const __m128i *) q);
+                __m128i b = _mm_loadu_si128((const __m128i *) (q + 16));
+                __m128i c = _mm_loadu_si128((const __m128i *) (q + 32));
+                __m128i e = _mm_loadu_si128((const __m128i *) (q + 48));
+                _mm_store_si128((__m128i *) p, a);
+                _mm_store_si128((__m128i *) (p + 16), b);
+                _mm_store_si128((__m128i *) (p + 32), c);
+                _mm_store_si128((__m128i *) (p + 48), e);
+                remaining -= 64;
+            }
+        }
+
+        _mm_storeu_si128((__m128i *) (d + count - 16), tail);
+        _mm_storeu_si128((__m128i *) d, h0);
+        _mm_storeu_si128((__m128i *) (d + 16), h1);
+        _mm_storeu_si128((__m128i *) (d + 32), h2);
+        _mm_storeu_si128((__m128i *) (d + 48), h3);
+        return dest;
+    }
+
+    /**
+     * @brief SSE2 memcmp: compare 16 bytes at a time, locate the first difference with movemask
+     */
+    int memcmp_sse2(const void *lhs, const void *rhs, size_t count) {
+        const unsigned char *l = (const unsigned char *) lhs;
+        const unsigned char *r = (const unsigned char *) rhs;
+        size_t i = 0;
+
+        if (count >= 16) {
+            for (; i + 16 <= count; i += 16) {
+                __m128i a = _mm_loadu_si128((const __m128i *) (l + i));
+                __m128i b = _mm_loadu_si128((const __m128i *) (r + i));
+                unsigned int diff = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xFFFFu;
+                if (diff) {
+                    i += ctz32(diff);
+                    return l[i] - r[i];
+                }
+            }
+            if (i == count)
+                return 0;
+
+            // Overlapping final block
+            i = count - 16;
+            __m128i a = _mm_loadu_si128((const __m128i *) (l + i));
+            __m128i b = _mm_loadu_si128((const __m128i *) (r + i));
+            unsigned int diff = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xFFFFu;
+            if (diff) {
+                i += ctz32(diff);
+                return l[i] - r[i];
+            }
+            return 0;
+        }
+
+        if (count >= 8) {
+            unsigned long long a = load64(l), b = load64(r);
+            if (a == b) {
+                i = count - 8;
+                a = load64(l + i);
+                b = load64(r + i);
+                if (a == b)
+                    return 0;
+            }
+            i += ctz64(a ^ b) >> 3;
+            return l[i] - r[i];
+        }
+
+        for (; i < count; i++) {
+            if (l[i] != r[i])
+                return l[i] - r[i];
+        }
+        return 0;
+    }
+
+    /**
+     * @brief AVX2 copy: 32-byte vectors, 128 bytes per main-loop iteration
+     */
+    MINICRT_TARGET("avx2")
+    void *memcpy_avx2(void *dest, const void *src, size_t count) {
+        unsigned char *d = (unsigned char *) dest;
+        const unsigned char *s = (const unsigned char *) src;
+
+        if (count <= 16) {
+            copy_tiny(d, s, count);
+            return dest;
+        }
+        if (count <= 32) {
+            __m128i a = _mm_loadu_si128((const __m128i *) s);
+            __m128i b = _mm_loadu_si128((const __m128i *) (s + count - 16));
+            _mm_storeu_si128((__m128i *) d, a);
+            _mm_storeu_si128((__m128i *) (d + count - 16), b);
+            return dest;
+        }
+        if (count <= 64) {
+            __m256i a = _mm256_loadu_si256((const __m256i *) s);
+            __m256i b = _mm256_loadu_si256((const __m256i *) (s + count - 32));
+            _mm256_storeu_si256((__m256i *) d, a);
+            _mm256_storeu_si256((__m256i *) (d + count - 32), b);
+            return dest;
+        }
+        if (count <= 128) {
+            __m256i a = _mm256_loadu_si256((const __m256i *) s);
+            __m256i b = _mm256_loadu_si256((const __m256i *) (s + 32));
+            __m256i c = _mm256_loadu_si256((const __m256i *) (s + count - 64));
+            __m256i e = _mm256_loadu_si256((const __m256i *) (s + count - 32));
+            _mm256_storeu_si256((__m256i *) d, a);
+            _mm256_storeu_si256((__m256i *) (d + 32), b);
+            _mm256_storeu_si256((__m256i *) (d + count - 64), c);
+            _mm256_storeu_si256((__m256i *) (d + count - 32), e);
+            return dest;
+        }
+
+        __m256i head = _mm256_loadu_si256((const __m256i *) s);
+        __m256i t0 = _mm256_loadu_si256((const __m256i *) (s + count - 128));
+        __m256i t1 = _mm256_loadu_si256((const __m256i *) (s + count - 96));
+        __m256i t2 = _mm256_loadu_si256((const __m256i *) (s + count - 64));
+        __m256i t3 = _mm256_loadu_si256((const __m256i *) (s + count - 32));
+
+        size_t skew = 32 - ((size_t) d & 31);
+        unsigned char *p = d + skew;
+        const unsigned char *q = s + skew;
+        size_t remaining = count - skew;
+
+        if (MINICRT_UNLIKELY(count >= g_nt_threshold)) {
+            while (remaining > 128) {
+                _mm_prefetch((const char *) q + kPrefetchDistance, _MM_HINT_NTA);
+                _mm_prefetch((const char *) q + kPrefetchDistance + 64, _MM_HINT_NTA);
+                __m256i a = _mm256_loadu_si256((const __m256i *) q);
+                __m256i b = _mm256_loadu_si256((const __m256i *) (q + 32));
+                __m256i c = _mm256_loadu_si256((const __m256i *) (q + 64));
+                __m256i e = _mm256_loadu_si256((const __m256i *) (q + 96));
+                _mm256_stream_si256((__m256i *) p, a);
+                _mm256_stream_si256((__m256i *) (p + 32), b);
+                _mm256_stream_si256((__m256i *) (p + 64), c);
+                _mm256_stream_si256((__m256i *) (p + 96), e);
+                p += 128;
+                q += 128;
+                remaining -= 128;
+            }
+            _mm_sfence();
+        } else {
+            while (remaining > 128) {
+                __m256i a = _mm256_loadu_si256((const __m256i *) q);
+                __m256i b = _mm256_loadu_si256((const __m256i *) (q + 32));
+                __m256i c = _mm256_loadu_si256((const __m256i *) (q + 64));
+                __m256i e = _mm256_loadu_si256((const __m256i *) (q + 96));
+                _mm256_store_si256((__m256i *) p, a);
+                _mm256_store_si256((__m256i *) (p + 32), b);
+                _mm256_store_si256((__m256i *) (p + 64), c);
+                _mm256_store_si256((__m256i *) (p + 96), e);
+                p += 128;
+                q += 128;
+                remaining -= 128;
+            }
+        }
+
+        _mm256_storeu_si256((__m256i *) (d + count - 128), t0);
+        _mm256_storeu_si256((__m256i *) (d + count - 96), t1);
+        _mm256_storeu_si256((__m256i *) (d + count - 64), t2);
+        _mm256_storeu_si256((__m256i *) (d + count - 32), t3);
+        _mm256_storeu_si256((__m256i *) d, head);
+        return dest;
+    }
+
+    /**
+     * @brief AVX2 fill: 32-byte vectors, 128 bytes per main-loop iteration
+     */
+    MINICRT_TARGET("avx2")
+    void *memset_avx2(void *dest, int c, size_t count) {
+        unsigned char *d = (unsigned char *) dest;
+
+        if (count <= 16) {
+            fill_tiny(d, 0x0101010101010101ULL * (unsigned char) c, count);
+            return dest;
+        }
+        if (count <= 32) {
+            __m128i v = _mm_set1_epi8((char) c);
+            _mm_storeu_si128((__m128i *) d, v);
+            _mm_storeu_si128((__m128i *) (d + count - 16), v);
+            return dest;
+        }
+
+        __m256i v = _mm256_set1_epi8((char) c);
+        if (count <= 64) {
+            _mm256_storeu_si256((__m256i *) d, v);
+            _mm256_storeu_si256((__m256i *) (d + count - 32), v);
+            return dest;
+        }
+        if (count <= 128) {
+            _mm256_storeu_si256((__m256i *) d, v);
+            _mm256_storeu_si256((__m256i *) (d + 32), v);
+            _mm256_storeu_si256((__m256i *) (d + count - 64), v);
+            _mm256_storeu_si256((__m256i *) (d + count - 32), v);
+            return dest;
+        }
+
+        _mm256_storeu_si256((__m256i *) d, v);
+        unsigned char *p = (unsigned char *) (((size_t) d + 32) & ~(size_t) 31);
+        unsigned char *end = d + count - 128;
+
+        if (MINICRT_UNLIKELY(count >= g_nt_threshold)) {
+            while (p < end) {
+                _mm256_stream_si256((__m256i *) p, v);
+                _mm256_stream_si256((__m256i *) (p + 32), v);
+                _mm256_stream_si256((__m256i *) (p + 64), v);
+                _mm256_stream_si256((__m256i *) (p + 96), v);
+                p += 128;
+            }
+            _mm_sfence();
+        } else {
+            while (p < end) {
+                _mm256_store_si256((__m256i *) p, v);
+                _mm256_store_si256((__m256i *) (p + 32), v);
+                _mm256_store_si256((__m256i *) (p + 64), v);
+                _mm256_store_si256((__m256i *) (p + 96), v);
+                p += 128;
+            }
+        }
+
+        _mm256_storeu_si256((__m256i *) end, v);
+        _mm256_storeu_si256((__m256i *) (end + 32), v);
+        _mm256_storeu_si256((__m256i *) (end + 64), v);
+        _mm256_storeu_si256((__m256i *) (end + 96), v);
+        return dest;
+    }
+    /**
+     * @brief AVX2 memmove, same structure as memmove_sse2 with 128-byte blocks
+     */
+    MINICRT_TARGET("avx2")
+    void *memmove_avx2(void *dest, const void *src, size_t count) {
+        unsigned char *d = (unsigned char *) dest;
+        const unsigned char *s = (const unsigned char *) src;
+
+        if (count <= 128 || (size_t) (d - s) >= count)
+            return memcpy_avx2(dest, src, count);
+
+        __m256i h0 = _mm256_loadu_si256((const __m256i *) s);
+        __m256i h1 = _mm256_loadu_si256((const __m256i *) (s + 32));
+        __m256i h2 = _mm256_loadu_si256((const __m256i *) (s + 64));
+        __m256i h3 = _mm256_loadu_si256((const __m256i *) (s + 96));
+        __m256i tail = _mm256_loadu_si256((const __m256i *) (s + count - 32));
+
+        size_t skew = (size_t) (d + count) & 31;
+        unsigned char *p = d + count - skew;
+        const unsigned char *q = s + count - skew;
+        size_t remaining = count - skew;
+
+        if (MINICRT_UNLIKELY(count >= g_nt_threshold)) {
+            while (remaining > 128) {
+                p -= 128;
+                q -= 128;
+                _mm_prefetch((const char *) q - kPrefetchDistance, _MM_HINT_NTA);
+                _mm_prefetch((const char *) q - kPrefetchDistance + 64, _MM_HINT_NTA);
+                __m256i a = _mm256_loadu_si256((const __m256i *) q);
+                __m256i b = _mm256_loadu_si256((const __m256i *) (q + 32));
+                __m256i c = _mm256_loadu_si256((const __m256i *) (q + 64));
+                __m256i e = _mm256_loadu_si256((const __m256i *) (q + 96));
+                _mm256_stream_si256((__m256i *) p, a);
+                _mm256_stream_si256((__m256i *) (p + 32), b);
+                _mm256_stream_si256((__m256i *) (p + 64), c);
+                _mm256_stream_si256((__m256i *) (p + 96), e);
+                remaining -= 128;
+            }
+            _mm_sfence();
+        } else {
+            while (remaining > 128) {
+                p -= 128;
+                q -= 128;
+                __m256i a = _mm256_loadu_si256((const __m256i *) q);
+                __m256i b = _mm256_loadu_si256((const __m256i *) (q + 32));
+                __m256i c = _mm256_loadu_si256((const __m256i *) (q + 64));
+                __m256i e = _mm256_loadu_si256((const __m256i *) (q + 96));
+                _mm256_store_si256((__m256i *) p, a);
+                _mm256_store_si256((__m256i *) (p + 32), b);
+                _mm256_store_si256((__m256i *) (p + 64), c);
+                _mm256_store_si256((__m256i *) (p + 96), e);
+                remaining -= 128;
+            }
+        }
+
+        _mm256_storeu_si256((__m256i *) (d + count - 32), tail);
+        _mm256_storeu_si256((__m256i *) d, h0);
+        _mm256_storeu_si256((__m256i *) (d + 32), h1);
+        _mm256_storeu_si256((__m256i *) (d + 64), h2);
+        _mm256_storeu_si256((__m256i *) (d + 96), h3);
+        return dest;
+    }
+
+    /**
+     * @brief AVX2 memcmp: 32-byte blocks, short inputs go through memcmp_sse2
+     */
+    MINICRT_TARGET("avx2")
+    int memcmp_avx2(const void *lhs, const void *rhs, size_t count) {
+        const unsigned char *l = (const unsigned char *) lhs;
+        const unsigned char *r = (const unsigned char *) rhs;
+
+        if (count < 32)
+            return memcmp_sse2(lhs, rhs, count);
+
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i a = _mm256_loadu_si256((const __m256i *) (l + i));
+            __m256i b = _mm256_loadu_si256((const __m256i *) (r + i));
+            unsigned int diff = ~(unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+            if (diff) {
+                i += ctz32(diff);
+                return l[i] - r[i];
+            }
+        }
+        if (i == count)
+            return 0;
+
+        i = count - 32;
+        __m256i a = _mm256_loadu_si256((const __m256i *) (l + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (r + i));
+        unsigned int diff = ~(unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+        if (diff) {
+            i += ctz32(diff);
+            return l[i] - r[i];
+        }
+        return 0;
+    }
+
+    // Sizes from which REP MOVSB/STOSB beats the vector loops on ERMS hardware
+    static const size_t kErmsCopyThreshold = 4096;
+    static const size_t kErmsFillThreshold = 2048;
+
+    /**
+     * @brief AVX2 copy that hands large blocks to REP MOVSB (CPUs with ERMS)
+     */
+    MINICRT_TARGET("avx2")
+    void *memcpy_avx2_erms(void *dest, const void *src, size_t count) {
+        if (count < kErmsCopyThreshold || count >= g_nt_threshold)
+            return memcpy_avx2(dest, src, count);
+
+#if defined(_MSC_VER)
+        __movsb((unsigned char *) dest, (const unsigned char *) src, count);
+#else
+        void *d = dest;
+        asm volatile("rep movsb" : "+D" (d), "+S" (src), "+c" (count) : : "memory");
+#endif
+        return dest;
+    }
+
+    /**
+     * @brief AVX2 fill that hands large blocks to REP STOSB (CPUs with ERMS)
+     */
+    MINICRT_TARGET("avx2")
+    void *memset_avx2_erms(void *dest, int c, size_t count) {
+        if (count < kErmsFillThreshold || count >= g_nt_threshold)
+            return memset_avx2(dest, c, count);
+
+#if defined(_MSC_VER)
+        __stosb((unsigned char *) dest, (unsigned char) c, count);
+#else
+        void *d = dest;
+        asm volatile("rep stosb" : "+D" (d), "+c" (count) : "a" (c) : "memory");
+#endif
+        return dest;
+    }
+#endif // MINICRT_X86_64
+} // namespace detail
+
+    // For Windows platform-specific memory operations
+    // The public entry points forward to the kernels selected by cpu_init() (crt_cpu.cpp)
+
+    /**
+     * @brief Fill a block of memory with a value
+     */
+    void *memset(void *dest, int c, size_t count) {
+        MINICRT_STATS_RECORD(STATS_MEMSET, dest, 0, count);
+        return detail::g_dispatch.memset(dest, c, count);
+    }
+
+    /**
+     * @brief Copy memory from one location to another
+     */
+    void *memcpy(void *dest, const void *src, size_t count) {
+        MINICRT_STATS_RECORD(STATS_MEMCPY, dest, src, count);
+        return detail::g_dispatch.memcpy(dest, src, count);
+    }
+
+    /**
+     * @brief Copy memory, handling overlapping regions
+     */
+    void *memmove(void *dest, const void *src, size_t count) {
+        MINICRT_STATS_RECORD(STATS_MEMMOVE, dest, src, count);
+        return detail::g_dispatch.memmove(dest, src, count);
+    }
+
+    /**
+     * @brief Compare two memory regions
+     */
+    int memcmp(const void *lhs, const void *rhs, size_t count) {
+        MINICRT_STATS_RECORD(STATS_MEMCMP, lhs, rhs, count);
+        return detail::g_dispatch.memcmp(lhs, rhs, count);
+    }
+
+    /**
+     * @brief Set the non-temporal store threshold
+     */
+    void mem_set_nt_threshold(size_t bytes) {
+        // Make sure a later cpu_init() does not overwrite the caller's choice
+        detail::cpu_init();
+        detail::g_nt_threshold = bytes ? bytes : detail::g_nt_threshold_default;
+    }
+
+    /**
+     * @brief Get the non-temporal store threshold
+     */
+    size_t mem_nt_threshold(void) {
+        detail::cpu_init();
+        return detail::g_nt_threshold;
+    }
+
 MINICRT_END
@@ -0,0 +1,53 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/object_pool.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /**
+     * @brief Map a page-rounded slab for object_pool, populated on request
+     */
+    void *object_pool_map(size_t *size, unsigned int flags) {
+        size_t page = page_size();
+        if (*size > ~(size_t) 0 - page) {
+            errno = ENOMEM;
+            return 0;
+        }
+        size_t map_size = (*size + page - 1) & ~(page - 1);
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        long map_flags = kMapPrivate | kMapAnonymous;
+        if (flags & OBJECT_POOL_PREFAULT)
+            map_flags |= kMapPopulate;
+        void *slab = sys_mmap(0, map_size, kProtRead | kProtWrite, map_flags, -1, 0);
+        if (syscall_failed((long) slab)) {
+            errno = ENOMEM;
+            return 0;
+        }
+#else
+        void *slab = map_pages(map_size);
+        if (!slab) {
+            errno = ENOMEM;
+            return 0;
+        }
+        if (flags & OBJECT_POOL_PREFAULT) {
+            for (size_t offset = 0; offset < map_size; offset += page)
+                ((volatile char *) slab)[offset] = 0;
+        }
+#endif
+        *size = map_size;
+        return slab;
+    }
+
+    /**
+     * @brief Unmap a slab from object_pool_map()
+     */
+    void object_pool_unmap(void *slab, size_t size) {
+        unmap_pages(slab, size);
+    }
+} // namespace detail
+
+MINICRT_END
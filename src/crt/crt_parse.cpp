@@ -0,0 +1,757 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/string.h"
+#include "minicrt/memory.h"
+#include "crt_internal.h"
+
+// The exact small-input path needs double arithmetic without excess precision
+#if !defined(__FLT_EVAL_METHOD__) || __FLT_EVAL_METHOD__ == 0
+#define MINICRT_CLINGER_FAST_PATH
+#endif
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * Number parsing behind the strto* family
+     *
+     * Every parser reads a window [p, end). The NUL-terminated entry points pass an
+     * unbounded window and rely on the terminator, which is never part of a number;
+     * eight-byte loads are then only made when they stay within one page, like the
+     * string kernels. The explicit-length entry points never look past end.
+     *
+     * Decimal digit runs are consumed eight at a time with SWAR arithmetic. Doubles are
+     * converted with the Eisel-Lemire algorithm (D. Lemire, "Number Parsing at a
+     * Gigabyte per Second"), after Clinger's exact fast path for short inputs. The few
+     * inputs it cannot settle (long digit strings close to a rounding boundary) are
+     * decided by comparing the decimal value with the halfway point between two
+     * neighbouring doubles in exact big-integer arithmetic.
+     */
+
+    struct input {
+        const char *p;
+        const char *end;
+        bool terminated; // no end: the text stops at a NUL
+    };
+
+    static MINICRT_INLINE void input_init(input *in, const char *str, size_t length, bool terminated) {
+        in->p = str;
+        in->end = str + length;
+        in->terminated = terminated;
+    }
+
+    // Character at p + offset, or 0 past the end of the window
+    static MINICRT_INLINE int peek(const input *in, size_t offset = 0) {
+        if (!in->terminated && (size_t) (in->end - in->p) <= offset)
+            return 0;
+        return (unsigned char) in->p[offset];
+    }
+
+    static MINICRT_INLINE bool can_load8(const input *in) {
+        if (in->terminated)
+            return ((size_t) in->p & 4095) <= 4096 - 8;
+        return in->end - in->p >= 8;
+    }
+
+    static MINICRT_INLINE unsigned int digit_value(int c) {
+        if ((unsigned int) (c - '0') < 10)
+            return (unsigned int) (c - '0');
+        if ((unsigned int) ((c | 0x20) - 'a') < 26)
+            return (unsigned int) ((c | 0x20) - 'a' + 10);
+        return 99;
+    }
+
+    static MINICRT_INLINE bool is_space(int c) {
+        return c == ' ' || (unsigned int) (c - '\t') < 5;
+    }
+
+    static void skip_space_and_sign(input *in, bool *negative) {
+        while (is_space(peek(in)))
+            in->p++;
+        *negative = false;
+        if (peek(in) == '-' || peek(in) == '+') {
+            *negative = peek(in) == '-';
+            in->p++;
+        }
+    }
+
+    // Eight ASCII digits, little-endian in v
+    static MINICRT_INLINE bool is_eight_digits(unsigned long long v) {
+        return ((v & 0xF0F0F0F0F0F0F0F0ull) | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+               0x3333333333333333ull;
+    }
+
+    static MINICRT_INLINE unsigned int parse_eight_digits(unsigned long long v) {
+        v -= 0x3030303030303030ull;
+        v = v * 10 + (v >> 8); // digit pairs in bytes 0, 2, 4, 6
+        v = ((v & 0x000000FF000000FFull) * (100 + (1000000ull << 32)) +
+             ((v >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32))) >> 32;
+        return (unsigned int) v;
+    }
+
+    // Append a run of decimal digits to *value (wrapping on overflow); returns the count
+    static size_t consume_digits(input *in, unsigned long long *value) {
+        const char *start = in->p;
+        unsigned long long v = *value;
+        while (can_load8(in)) {
+            unsigned long long chunk = load64(in->p);
+            if (!is_eight_digits(chunk))
+                break;
+            v = v * 100000000 + parse_eight_digits(chunk);
+            in->p += 8;
+        }
+        while ((unsigned int) (peek(in) - '0') < 10) {
+            v = v * 10 + (unsigned int) (peek(in) - '0');
+            in->p++;
+        }
+        *value = v;
+        return (size_t) (in->p - start);
+    }
+
+    /**
+     * @brief Parse an exponent part introduced by marker ('e' or 'p', any case)
+     *
+     * Only consumed when at least one digit follows the marker and optional sign.
+     * Huge exponents saturate, which still rounds the number to zero or infinity.
+     */
+    static long long parse_exponent(input *in, int marker) {
+        if ((peek(in) | 0x20) != marker)
+            return 0;
+        int sign = peek(in, 1);
+        size_t skip = (sign == '-' || sign == '+') ? 2 : 1;
+        if ((unsigned int) (peek(in, skip) - '0') >= 10)
+            return 0;
+
+        in->p += skip;
+        long long value = 0;
+        for (; (unsigned int) (peek(in) - '0') < 10; in->p++) {
+            if (value < 100000000)
+                value = value * 10 + (peek(in) - '0');
+        }
+        return sign == '-' ? -value : value;
+    }
+
+    // ---------------------------------------------------------------- integers
+
+    struct integer_result {
+        unsigned long long value;
+        bool negative;
+        bool overflow;
+    };
+
+    /**
+     * @brief Parse an integer in base 2..36, or 0 to pick 8, 10 or 16 from its prefix
+     *
+     * On success in->p is left after the last digit. Returns false when there are no
+     * digits; in->p is then unspecified.
+     */
+    static bool parse_integer(input *in, int base, integer_result *out) {
+        skip_space_and_sign(in, &out->negative);
+        out->overflow = false;
+
+        if ((base == 0 || base == 16) && peek(in) == '0' && (peek(in, 1) | 0x20) == 'x' &&
+            digit_value(peek(in, 2)) < 16) {
+            in->p += 2;
+            base = 16;
+        } else if (base == 0) {
+            base = peek(in) == '0' ? 8 : 10;
+        }
+
+        const char *start = in->p;
+        unsigned long long value = 0;
+        if (base == 10) {
+            // Sixteen digits always fit; the rest go through the checked loop
+            for (int i = 0; i < 2 && can_load8(in); i++) {
+                unsigned long long chunk = load64(in->p);
+                if (!is_eight_digits(chunk))
+                    break;
+                value = value * 100000000 + parse_eight_digits(chunk);
+                in->p += 8;
+            }
+        }
+
+        unsigned long long limit = ~0ull / (unsigned int) base;
+        for (;;) {
+            unsigned int digit = digit_value(peek(in));
+            if (digit >= (unsigned int) base)
+                break;
+            if (value > limit || value * (unsigned int) base > ~0ull - digit)
+                out->overflow = true;
+            else
+                value = value * (unsigned int) base + digit;
+            in->p++;
+        }
+
+        out->value = value;
+        return in->p != start;
+    }
+
+    static unsigned long long parse_unsigned(const char *str, size_t length, bool terminated, char **end,
+                                             int base, unsigned long long max_value) {
+        if (base < 0 || base == 1 || base > 36) {
+            errno = EINVAL;
+            if (end)
+                *end = (char *) str;
+            return 0;
+        }
+
+        input in;
+        integer_result r;
+        input_init(&in, str, length, terminated);
+        if (!parse_integer(&in, base, &r)) {
+            if (end)
+                *end = (char *) str;
+            return 0;
+        }
+        if (end)
+            *end = (char *) in.p;
+
+        if (r.overflow || r.value > max_value) {
+            errno = ERANGE;
+            return max_value;
+        }
+        // Like strtoul, a minus sign negates in the unsigned type
+        return r.negative ? (0 - r.value) & max_value : r.value;
+    }
+
+    static long long parse_signed(const char *str, size_t length, bool terminated, char **end, int base,
+                                  unsigned long long max_value) {
+        if (base < 0 || base == 1 || base > 36) {
+            errno = EINVAL;
+            if (end)
+                *end = (char *) str;
+            return 0;
+        }
+
+        input in;
+        integer_result r;
+        input_init(&in, str, length, terminated);
+        if (!parse_integer(&in, base, &r)) {
+            if (end)
+                *end = (char *) str;
+            return 0;
+        }
+        if (end)
+            *end = (char *) in.p;
+
+        unsigned long long limit = r.negative ? max_value + 1 : max_value;
+        if (r.overflow || r.value > limit) {
+            errno = ERANGE;
+            return r.negative ? -(long long) max_value - 1 : (long long) max_value;
+        }
+        return r.negative ? (long long) (0 - r.value) : (long long) r.value;
+    }
+
+    // ---------------------------------------------------------------- doubles
+
+    static const unsigned long long kSignBit = 1ull << 63;
+    static const unsigned long long kInfinityBits = 0x7FF0000000000000ull;
+    static const unsigned long long kQuietNanBits = 0x7FF8000000000000ull;
+    static const unsigned long long kMantissaMask = (1ull << 52) - 1;
+
+    // Significant digits kept by the exact comparison; beyond it only "non-zero" matters
+    static const int kMaxParseDigits = 780;
+
+    static double bits_to_double(unsigned long long bits) {
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    /**
+     * @brief Digits of a decimal number as found in the input
+     *
+     * The first 19 significant digits are in w; the value is w * 10^exponent when
+     * nothing was dropped.
+     */
+    struct decimal_input {
+        unsigned long long w;
+        long long exponent;
+        bool truncated;
+        const char *int_start, *int_end;   // integer digits, leading zeros included
+        const char *frac_start, *frac_end; // fraction digits
+        long long explicit_exponent;       // the e part
+    };
+
+    /**
+     * @brief Eisel-Lemire: w * 10^q rounded to the nearest double
+     *
+     * Always stores a result that is correct or one unit off; returns false when the
+     * 128-bit product was not precise enough to be sure.
+     */
+    static bool eisel_lemire(unsigned long long w, long long q, unsigned long long *bits) {
+        if (!w || q < kPow5MinExponent) {
+            *bits = 0;
+            return true;
+        }
+        if (q > 308) {
+            *bits = kInfinityBits;
+            return true;
+        }
+
+        int lz = 63 - (int) log2_floor64(w);
+        w <<= lz;
+        // The algorithm wants negative powers rounded up; the shared table truncates
+        const unsigned long long *entry = kPow5Table[q - kPow5MinExponent];
+        unsigned long long pow5_low = entry[1] + (q < 0);
+        unsigned long long pow5_high = entry[0] + (q < 0 && !pow5_low);
+        unsigned long long low;
+        unsigned long long high = mul128(w, pow5_high, &low);
+        bool exact = true;
+        if ((high & 0x1FF) == 0x1FF) {
+            // The bits that decide the rounding may still change: add the next word
+            unsigned long long low2;
+            unsigned long long high2 = mul128(w, pow5_low, &low2);
+            low += high2;
+            if (high2 > low)
+                high++;
+            if (low == ~0ull && (q < -27 || q > 55))
+                exact = false;
+        }
+
+        int upper = (int) (high >> 63);
+        int shift = upper + 9;
+        unsigned long long mantissa = high >> shift;
+        // floor(log2(10^q)) + 63 = position of the leading product bit
+        int power2 = (int) (((152170 + 65536) * q) >> 16) + 63 + upper - lz + 1023;
+
+        if (power2 <= 0) {
+            // Subnormal: round at the fixed position of 2^-1074
+            if (1 - power2 >= 64) {
+                *bits = 0;
+                return exact;
+            }
+            mantissa >>= 1 - power2;
+            mantissa += mantissa & 1;
+            mantissa >>= 1;
+            *bits = mantissa; // a carry into bit 52 is exactly the smallest normal
+            return exact;
+        }
+
+        // A product with nothing below the kept bits is an exact tie: round to even
+        if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high)
+            mantissa &= ~1ull;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        if (mantissa >= (2ull << 52)) {
+            mantissa = 1ull << 52;
+            power2++;
+        }
+        if (power2 >= 0x7FF) {
+            *bits = kInfinityBits;
+            return exact;
+        }
+        *bits = (unsigned long long) power2 << 52 | (mantissa & kMantissaMask);
+        return exact;
+    }
+
+    static void big_mul_add(bigint *b, unsigned int m, unsigned int add) {
+        big_mul_small(b, m);
+        for (int i = 0; add; i++) {
+            if (i == b->size)
+                b->words[b->size++] = 0;
+            unsigned long long sum = (unsigned long long) b->words[i] + add;
+            b->words[i] = (unsigned int) sum;
+            add = (unsigned int) (sum >> 32);
+        }
+    }
+
+    /**
+     * @brief Compare n * 10^e10 with the point halfway between bits and the next double
+     */
+    static int compare_halfway(const bigint *n, long long e10, unsigned long long bits) {
+        int biased = (int) (bits >> 52);
+        unsigned long long m = bits & kMantissaMask;
+        int e2 = -1074;
+        if (biased) {
+            m |= 1ull << 52;
+            e2 = biased - 1075;
+        }
+        // halfway = (2m + 1) * 2^(e2 - 1)
+        unsigned long long h = 2 * m + 1;
+        long long k = e2 - 1;
+
+        bigint lhs = *n;
+        bigint rhs;
+        rhs.words[0] = (unsigned int) h;
+        rhs.words[1] = (unsigned int) (h >> 32);
+        rhs.size = rhs.words[1] ? 2 : 1;
+
+        if (e10 >= 0)
+            big_mul_pow5(&lhs, (int) e10);
+        else
+            big_mul_pow5(&rhs, (int) -e10);
+        long long low = e10 < k ? e10 : k;
+        big_shift_left(&lhs, (int) (e10 - low));
+        big_shift_left(&rhs, (int) (k - low));
+        return big_compare(&lhs, &rhs);
+    }
+
+    /**
+     * @brief Correctly rounded value of a long decimal, starting from a close guess
+     */
+    static unsigned long long slow_decimal(const decimal_input *d, unsigned long long guess) {
+        bigint n;
+        n.size = 0;
+        long long e10 = d->explicit_exponent - (d->frac_end - d->frac_start);
+        int kept = 0;
+        bool sticky = false;
+        unsigned int chunk = 0, scale = 1;
+
+        // Walk the digits from the first significant one; the digits after the
+        // kMaxParseDigits-th only decide whether a trailing 1 is appended
+        for (const char *p = d->int_start; p != d->frac_end; p++) {
+            if (p == d->int_end) {
+                p = d->frac_start;
+                if (p == d->frac_end)
+                    break;
+            }
+            unsigned int digit = (unsigned int) (*p - '0');
+            if (!kept && !digit)
+                continue; // leading zero
+            if (kept == kMaxParseDigits) {
+                sticky |= digit != 0;
+                e10++;
+                continue;
+            }
+            chunk = chunk * 10 + digit;
+            scale *= 10;
+            kept++;
+            if (scale == 1000000000u) {
+                big_mul_add(&n, scale, chunk);
+                chunk = 0;
+                scale = 1;
+            }
+        }
+        if (scale > 1)
+            big_mul_add(&n, scale, chunk);
+        if (sticky) {
+            big_mul_add(&n, 10, 1);
+            e10--;
+        }
+
+        unsigned long long bits = guess;
+        for (;;) {
+            if (bits < kInfinityBits) {
+                int c = compare_halfway(&n, e10, bits);
+                if (c > 0 || (c == 0 && (bits & 1))) {
+                    bits++;
+                    continue;
+                }
+            }
+            if (bits) {
+                int c = compare_halfway(&n, e10, bits - 1);
+                if (c < 0 || (c == 0 && (bits & 1))) {
+                    bits--;
+                    continue;
+                }
+            }
+            return bits;
+        }
+    }
+
+#ifdef MINICRT_CLINGER_FAST_PATH
+    static const double kExactPow10[23] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+#endif
+
+    static unsigned long long decimal_to_bits(const decimal_input *d) {
+#ifdef MINICRT_CLINGER_FAST_PATH
+        // Both operands exact, so one correctly rounded operation gives the answer
+        if (!d->truncated && d->w <= (1ull << 53) && d->exponent >= -22 && d->exponent <= 22) {
+            double value = (double) d->w;
+            if (d->exponent < 0)
+                value /= kExactPow10[-d->exponent];
+            else
+                value *= kExactPow10[d->exponent];
+            unsigned long long bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+#endif
+
+        unsigned long long bits;
+        bool exact = eisel_lemire(d->w, d->exponent, &bits);
+        if (exact && d->truncated) {
+            // The dropped digits lie between w and w + 1 units
+            unsigned long long upper;
+            exact = eisel_lemire(d->w + 1, d->exponent, &upper) && upper == bits;
+        }
+        return exact ? bits : slow_decimal(d, bits);
+    }
+
+    /**
+     * @brief Parse a hexadecimal floating-point number from its first digit after "0x"
+     *
+     * Rounds to nearest, ties to even. Returns whether any digit was non-zero.
+     */
+    static bool parse_hex_double(input *in, unsigned long long *bits) {
+        unsigned long long mantissa = 0;
+        long long exp2 = 0;
+        bool sticky = false;
+
+        for (int fraction = 0; fraction < 2; fraction++) {
+            if (fraction) {
+                if (peek(in) != '.')
+                    break;
+                in->p++;
+            }
+            for (unsigned int digit; (digit = digit_value(peek(in))) < 16; in->p++) {
+                if (!(mantissa >> 60)) {
+                    mantissa = mantissa * 16 + digit;
+                    exp2 -= fraction * 4;
+                } else {
+                    sticky |= digit != 0;
+                    exp2 += (1 - fraction) * 4;
+                }
+            }
+        }
+        exp2 += parse_exponent(in, 'p');
+        if (!mantissa) {
+            *bits = 0;
+            return false;
+        }
+
+        int lz = 63 - (int) log2_floor64(mantissa);
+        mantissa <<= lz;
+        exp2 -= lz;
+        long long biased = exp2 + 63 + 1023;
+        if (biased >= 0x7FF) {
+            *bits = kInfinityBits;
+            return true;
+        }
+
+        long long shift = 11;
+        if (biased <= 0) {
+            shift += 1 - biased;
+            biased = 0;
+        }
+        if (shift > 64) {
+            *bits = 0; // below half the smallest subnormal
+            return true;
+        }
+
+        unsigned long long q, rem, half;
+        if (shift == 64) {
+            q = 0;
+            rem = mantissa;
+            half = 1ull << 63;
+        } else {
+            q = mantissa >> shift;
+            rem = mantissa & ((1ull << shift) - 1);
+            half = 1ull << (shift - 1);
+        }
+        if (rem > half || (rem == half && (sticky || (q & 1))))
+            q++;
+
+        if (!biased) {
+            *bits = q; // a carry into bit 52 is exactly the smallest normal
+            return true;
+        }
+        if (q >> 53) {
+            q >>= 1;
+            if (++biased >= 0x7FF) {
+                *bits = kInfinityBits;
+                return true;
+            }
+        }
+        *bits = (unsigned long long) biased << 52 | (q & kMantissaMask);
+        return true;
+    }
+
+    // Case-insensitive match of a lowercase word at the current position
+    static bool match_word(const input *in, const char *word) {
+        for (size_t i = 0; word[i]; i++) {
+            if ((peek(in, i) | 0x20) != word[i])
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Parse a decimal or hexadecimal floating-point number, inf or nan
+     *
+     * Returns false when no number was found. Sets *range_error when a finite
+     * non-zero input rounded to zero or to infinity.
+     */
+    static bool parse_double(input *in, unsigned long long *bits, bool *range_error) {
+        bool negative;
+        skip_space_and_sign(in, &negative);
+        unsigned long long sign = negative ? kSignBit : 0;
+        *range_error = false;
+
+        int c = peek(in) | 0x20;
+        if (c == 'i' || c == 'n') {
+            if (match_word(in, "inf")) {
+                in->p += match_word(in, "infinity") ? 8 : 3;
+                *bits = sign | kInfinityBits;
+                return true;
+            }
+            if (match_word(in, "nan")) {
+                in->p += 3;
+                if (peek(in) == '(') {
+                    // nan(n-char-sequence); the sequence itself is ignored
+                    size_t i = 1;
+                    while (digit_value(peek(in, i)) < 36 || peek(in, i) == '_')
+                        i++;
+                    if (peek(in, i) == ')')
+                        in->p += i + 1;
+                }
+                *bits = sign | kQuietNanBits;
+                return true;
+            }
+            return false;
+        }
+
+        if (peek(in) == '0' && (peek(in, 1) | 0x20) == 'x' &&
+            (digit_value(peek(in, 2)) < 16 || (peek(in, 2) == '.' && digit_value(peek(in, 3)) < 16))) {
+            in->p += 2;
+            bool nonzero = parse_hex_double(in, bits);
+            *range_error = (!*bits && nonzero) || *bits == kInfinityBits;
+            *bits |= sign;
+            return true;
+        }
+
+        decimal_input d;
+        d.w = 0;
+        d.int_start = in->p;
+        size_t int_digits = consume_digits(in, &d.w);
+        d.int_end = in->p;
+        size_t frac_digits = 0;
+        d.frac_start = d.frac_end = in->p;
+        if (peek(in) == '.') {
+            in->p++;
+            d.frac_start = in->p;
+            frac_digits = consume_digits(in, &d.w);
+            d.frac_end = in->p;
+        }
+        if (!int_digits && !frac_digits)
+            return false;
+
+        d.explicit_exponent = parse_exponent(in, 'e');
+        d.exponent = d.explicit_exponent - (long long) frac_digits;
+        d.truncated = false;
+
+        if (int_digits + frac_digits > 19) {
+            // Leading zeros are not significant
+            const char *p = d.int_start;
+            size_t significant = int_digits + frac_digits;
+            while (p != d.frac_end && (*p == '0' || *p == '.')) {
+                significant -= *p == '0';
+                p++;
+            }
+            if (significant > 19) {
+                // Keep the first 19 significant digits; the rest only mark truncation
+                d.truncated = true;
+                d.w = 0;
+                size_t taken = 0;
+                for (; taken < 19; p++) {
+                    if (*p == '.')
+                        continue;
+                    d.w = d.w * 10 + (unsigned int) (*p - '0');
+                    taken++;
+                }
+                if (p <= d.int_end)
+                    d.exponent = d.explicit_exponent + (d.int_end - p);
+                else
+                    d.exponent = d.explicit_exponent - (p - d.frac_start);
+            }
+        }
+
+        *bits = decimal_to_bits(&d);
+        *range_error = (!*bits && d.w) || *bits == kInfinityBits;
+        *bits |= sign;
+        return true;
+    }
+
+    static double parse_double_field(const char *str, size_t length, bool terminated, char **end) {
+        input in;
+        unsigned long long bits;
+        bool range_error;
+        input_init(&in, str, length, terminated);
+        if (!parse_double(&in, &bits, &range_error)) {
+            if (end)
+                *end = (char *) str;
+            return 0.0;
+        }
+        if (end)
+            *end = (char *) in.p;
+        if (range_error)
+            errno = ERANGE;
+        return bits_to_double(bits);
+    }
+} // namespace detail
+
+    /**
+     * @brief Convert the initial part of a string to a long
+     */
+    long strtol(const char *str, char **end, int base) {
+        return (long) detail::parse_signed(str, 0, true, end, base, ~0ul >> 1);
+    }
+
+    /**
+     * @brief Convert the initial part of a string to an unsigned long
+     */
+    unsigned long strtoul(const char *str, char **end, int base) {
+        return (unsigned long) detail::parse_unsigned(str, 0, true, end, base, ~0ul);
+    }
+
+    /**
+     * @brief Convert the initial part of a string to a long long
+     */
+    long long strtoll(const char *str, char **end, int base) {
+        return detail::parse_signed(str, 0, true, end, base, ~0ull >> 1);
+    }
+
+    /**
+     * @brief Convert the initial part of a string to an unsigned long long
+     */
+    unsigned long long strtoull(const char *str, char **end, int base) {
+        return detail::parse_unsigned(str, 0, true, end, base, ~0ull);
+    }
+
+    /**
+     * @brief Convert the initial part of a string to a double
+     */
+    double strtod(const char *str, char **end) {
+        return detail::parse_double_field(str, 0, true, end);
+    }
+
+    /**
+     * @brief Convert the initial part of a character range to a long
+     */
+    long strntol(const char *str, size_t length, char **end, int base) {
+        return (long) detail::parse_signed(str, length, false, end, base, ~0ul >> 1);
+    }
+
+    /**
+     * @brief Convert the initial part of a character range to an unsigned long
+     */
+    unsigned long strntoul(const char *str, size_t length, char **end, int base) {
+        return (unsigned long) detail::parse_unsigned(str, length, false, end, base, ~0ul);
+    }
+
+    /**
+     * @brief Convert the initial part of a character range to a long long
+     */
+    long long strntoll(const char *str, size_t length, char **end, int base) {
+        return detail::parse_signed(str, length, false, end, base, ~0ull >> 1);
+    }
+
+    /**
+     * @brief Convert the initial part of a character range to an unsigned long long
+     */
+    unsigned long long strntoull(const char *str, size_t length, char **end, int base) {
+        return detail::parse_unsigned(str, length, false, end, base, ~0ull);
+    }
+
+    /**
+     * @brief Convert the initial part of a character range to a double
+     */
+    double strntod(const char *str, size_t length, char **end) {
+        return detail::parse_double_field(str, length, false, end);
+    }
+
+MINICRT_END
@@ -0,0 +1,333 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/perf.h"
+#include "minicrt/memory.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * Every counter is a perf event of the calling thread; the first one opened
+     * becomes the group leader and the rest join its group, so the kernel puts them
+     * on the PMU together and their counts cover the same intervals. Hardware events
+     * are opened before the task clock so that a hardware event leads when there is
+     * one.
+     *
+     * Reading the leader with PERF_FORMAT_GROUP returns all counts in one system
+     * call. The faster path maps each event's control page: when the kernel sets
+     * cap_user_rdpmc and the event is live on the PMU (index != 0), the count is the
+     * page's offset plus the hardware counter read with RDPMC, under the page's
+     * sequence lock. The enabled and running times are extrapolated from the TSC
+     * with the conversion the page publishes. Whenever any part of that is
+     * unavailable, the read falls back to the system call.
+     */
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    static const long NR_perf_event_open = 298;
+
+    // struct perf_event_attr up to config2 (PERF_ATTR_SIZE_VER1)
+    struct perf_event_attr {
+        unsigned int type;
+        unsigned int size;
+        unsigned long long config;
+        unsigned long long sample_period;
+        unsigned long long sample_type;
+        unsigned long long read_format;
+        unsigned long long flags;
+        unsigned int wakeup_events;
+        unsigned int bp_type;
+        unsigned long long config1;
+        unsigned long long config2;
+    };
+
+    static const unsigned int kPerfTypeHardware = 0;
+    static const unsigned int kPerfTypeSoftware = 1;
+    static const unsigned int kPerfTypeHwCache = 3;
+
+    static const unsigned long long kAttrExcludeKernel = 1ull << 5;
+    static const unsigned long long kAttrExcludeHv = 1ull << 6;
+
+    static const unsigned long long kFormatTotalTimeEnabled = 1 << 0;
+    static const unsigned long long kFormatTotalTimeRunning = 1 << 1;
+    static const unsigned long long kFormatGroup = 1 << 3;
+
+    static const long kPerfFlagFdCloexec = 1 << 3;
+
+    // Fields of struct perf_event_mmap_page
+    struct perf_event_page {
+        unsigned int version;
+        unsigned int compat_version;
+        unsigned int lock;
+        unsigned int index;
+        long long offset;
+        unsigned long long time_enabled;
+        unsigned long long time_running;
+        unsigned long long capabilities;
+        unsigned short pmc_width;
+        unsigned short time_shift;
+        unsigned int time_mult;
+        unsigned long long time_offset;
+    };
+
+    static const unsigned long long kCapUserRdpmc = 1ull << 2;
+    static const unsigned long long kCapUserTime = 1ull << 3;
+
+    struct perf_event_config {
+        unsigned int type;
+        unsigned long long config;
+    };
+
+    // Indexed by perf_counter
+    static const perf_event_config kEvents[PERF_COUNTER_COUNT] = {
+        {kPerfTypeHardware, 0},       // PERF_COUNT_HW_CPU_CYCLES
+        {kPerfTypeHardware, 1},       // PERF_COUNT_HW_INSTRUCTIONS
+        {kPerfTypeHwCache, 0x10000},  // L1D | OP_READ << 8 | RESULT_MISS << 16
+        {kPerfTypeHardware, 3},       // PERF_COUNT_HW_CACHE_MISSES
+        {kPerfTypeHardware, 5},       // PERF_COUNT_HW_BRANCH_MISSES
+        {kPerfTypeSoftware, 1},       // PERF_COUNT_SW_TASK_CLOCK
+        {kPerfTypeHwCache, 0x10003},  // DTLB | OP_READ << 8 | RESULT_MISS << 16
+        {kPerfTypeSoftware, 2},       // PERF_COUNT_SW_PAGE_FAULTS
+    };
+
+    static long sys_perf_event_open(const perf_event_attr *attr, int pid, int cpu, int group_fd, long flags) {
+        return syscall5(NR_perf_event_open, (long) attr, pid, cpu, group_fd, flags);
+    }
+
+    MINICRT_INLINE unsigned long long rdpmc(unsigned int counter) {
+        unsigned int low, high;
+        asm volatile("rdpmc" : "=a" (low), "=d" (high) : "c" (counter));
+        return ((unsigned long long) high << 32) | low;
+    }
+
+    MINICRT_INLINE unsigned int load_lock(const perf_event_page *page) {
+        return __atomic_load_n(&page->lock, __ATOMIC_ACQUIRE);
+    }
+
+    /**
+     * @brief Read one count from its control page; 0 if the event is not on the PMU
+     */
+    static int read_page_count(const perf_event_page *page, unsigned long long *count) {
+        unsigned int sequence;
+        do {
+            sequence = load_lock(page);
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+            unsigned int index = page->index;
+            if (!(page->capabilities & kCapUserRdpmc) || index == 0)
+                return 0;
+
+            // The hardware counter is pmc_width bits wide; sign-extend it
+            unsigned int shift = 64 - page->pmc_width;
+            long long pmc = (long long) (rdpmc(index - 1) << shift) >> shift;
+            *count = (unsigned long long) (page->offset + pmc);
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        } while (load_lock(page) != sequence);
+        return 1;
+    }
+
+    /**
+     * @brief Read the enabled and running times of the group leader from its page
+     */
+    static int read_page_times(const perf_event_page *page, unsigned long long *enabled,
+                               unsigned long long *running) {
+        unsigned int sequence;
+        do {
+            sequence = load_lock(page);
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+            if (!(page->capabilities & kCapUserTime) || page->index == 0)
+                return 0;
+
+            // Time since the kernel last updated the page, from the TSC
+            unsigned long long cycles = __rdtsc();
+            unsigned long long quotient = cycles >> page->time_shift;
+            unsigned long long remainder = cycles & ((1ull << page->time_shift) - 1);
+            unsigned long long delta = page->time_offset + quotient * page->time_mult +
+                                       ((remainder * page->time_mult) >> page->time_shift);
+            *enabled = page->time_enabled + delta;
+            *running = page->time_running + delta;
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        } while (load_lock(page) != sequence);
+        return 1;
+    }
+
+    /**
+     * @brief Read every counter in user space; 0 if any of them needs the system call
+     */
+    static int read_user_space(const perf_group *group, perf_values *values) {
+        const perf_event_page *leader = (const perf_event_page *) group->pages[group->order[0]];
+        if (!leader || !read_page_times(leader, &values->time_enabled, &values->time_running))
+            return 0;
+        for (unsigned int i = 0; i < group->count; i++) {
+            unsigned int counter = group->order[i];
+            const perf_event_page *page = (const perf_event_page *) group->pages[counter];
+            if (!page || !read_page_count(page, &values->counts[counter]))
+                return 0;
+        }
+        return 1;
+    }
+
+    /**
+     * @brief Read every counter with one read() of the group leader
+     */
+    static int read_syscall(const perf_group *group, perf_values *values) {
+        // nr, time_enabled, time_running, then one value per event
+        unsigned long long buffer[3 + PERF_COUNTER_COUNT];
+        long result = sys_read(group->leader, buffer, sizeof(buffer));
+        if (syscall_failed(result)) {
+            errno = (int) -result;
+            return -1;
+        }
+        if (result < (long) (3 * sizeof(unsigned long long)) || buffer[0] != group->count) {
+            errno = EIO;
+            return -1;
+        }
+
+        values->time_enabled = buffer[1];
+        values->time_running = buffer[2];
+        for (unsigned int i = 0; i < group->count; i++)
+            values->counts[group->order[i]] = buffer[3 + i];
+        return 0;
+    }
+#endif
+} // namespace detail
+
+    /**
+     * @brief Open the available counters of a group
+     */
+    int perf_group_open(perf_group *group, unsigned int counters) {
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            group->fds[i] = -1;
+            group->pages[i] = NULL;
+            group->order[i] = 0;
+        }
+        group->count = 0;
+        group->available = 0;
+        group->leader = -1;
+
+        if ((counters & PERF_MASK_ALL) == 0) {
+            errno = EINVAL;
+            return -1;
+        }
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        int first_error = 0;
+        for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++) {
+            if (!(counters & PERF_MASK(counter)))
+                continue;
+
+            detail::perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = detail::kEvents[counter].type;
+            attr.size = sizeof(attr);
+            attr.config = detail::kEvents[counter].config;
+            attr.read_format = detail::kFormatGroup | detail::kFormatTotalTimeEnabled |
+                               detail::kFormatTotalTimeRunning;
+            attr.flags = detail::kAttrExcludeKernel | detail::kAttrExcludeHv;
+
+            long fd = detail::sys_perf_event_open(&attr, 0, -1, group->leader, detail::kPerfFlagFdCloexec);
+            if (detail::syscall_failed(fd)) {
+                if (!first_error)
+                    first_error = (int) -fd;
+                continue;
+            }
+
+            group->fds[counter] = (int) fd;
+            group->order[group->count++] = (unsigned char) counter;
+            group->available |= PERF_MASK(counter);
+            if (group->leader < 0)
+                group->leader = (int) fd;
+
+            // The control page is optional; without it reads take the system call
+            void *page = detail::sys_mmap(NULL, detail::page_size(), detail::kProtRead, detail::kMapShared,
+                                          (int) fd, 0);
+            if (!detail::syscall_failed((long) page))
+                group->pages[counter] = page;
+        }
+
+        if (group->count == 0)
+            errno = first_error;
+        return (int) group->count;
+#else
+        errno = EINVAL;
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Close the counters of a group
+     */
+    void perf_group_close(perf_group *group) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        // Members first, then the leader
+        for (int i = (int) group->count - 1; i >= 0; i--) {
+            unsigned int counter = group->order[i];
+            if (group->pages[counter])
+                detail::sys_munmap(group->pages[counter], detail::page_size());
+            if (group->fds[counter] >= 0)
+                detail::sys_close(group->fds[counter]);
+            group->pages[counter] = NULL;
+            group->fds[counter] = -1;
+        }
+#endif
+        group->count = 0;
+        group->available = 0;
+        group->leader = -1;
+    }
+
+    /**
+     * @brief Read the counters of a group, in user space when possible
+     */
+    int perf_group_read(perf_group *group, perf_values *values) {
+        memset(values, 0, sizeof(*values));
+        values->available = group->available;
+        if (group->count == 0)
+            return 0;
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (!detail::read_user_space(group, values) && detail::read_syscall(group, values) != 0)
+            return -1;
+        values->multiplexed = values->time_running < values->time_enabled;
+        return 0;
+#else
+        errno = EINVAL;
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Record the starting counts of a region
+     */
+    int perf_region_begin(perf_group *group, perf_region *region) {
+        return perf_group_read(group, &region->start);
+    }
+
+    /**
+     * @brief Compute the counts of a region
+     */
+    int perf_region_end(perf_group *group, const perf_region *region, perf_values *delta) {
+        if (perf_group_read(group, delta) != 0)
+            return -1;
+
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+            delta->counts[i] -= region->start.counts[i];
+        delta->time_enabled -= region->start.time_enabled;
+        delta->time_running -= region->start.time_running;
+        delta->multiplexed = delta->time_running < delta->time_enabled;
+        return 0;
+    }
+
+    /**
+     * @brief Get the name of a counter
+     */
+    const char *perf_counter_name(perf_counter counter) {
+        static const char *const kNames[PERF_COUNTER_COUNT] = {
+            "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "task_clock_ns",
+            "dtlb_misses", "page_faults"
+        };
+        if ((unsigned int) counter >= PERF_COUNTER_COUNT)
+            return "unknown";
+        return kNames[counter];
+    }
+
+MINICRT_END
@@ -0,0 +1,556 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/pool.h"
+#include "minicrt/memory.h"
+#include "minicrt/sync.h"
+#include "minicrt/thread.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * Each worker owns a Chase-Lev deque ("Dynamic Circular Work-Stealing Deque",
+     * with the memory orderings of Le et al., "Correct and Efficient Work-Stealing
+     * for Weak Memory Models"). The owner pushes and takes at the bottom with plain
+     * stores and one fence; thieves take from the top with a compare-and-swap, and
+     * the owner only races them for the last task. The ring has a fixed size: a
+     * task spawned into a full deque runs at once instead, which is always correct
+     * for fork/join. Tasks spawned from outside the pool go to a mutex-protected
+     * queue that everybody polls.
+     *
+     * Idle workers spin for a while, then sleep on g_epoch. They count themselves
+     * in g_sleepers before their last look for work, and a spawner checks
+     * g_sleepers after publishing its task, with full barriers on both sides, so
+     * either the worker sees the task or the spawner sees the sleeper and wakes it.
+     *
+     * A task group counts unfinished tasks in its state word. A waiter that runs
+     * out of tasks to help with sets a flag bit and sleeps on the word; the task
+     * that brings the count to zero sees the flag in the value its decrement
+     * returned, so it never reads the group again, which may already be gone.
+     */
+
+    static const long long kDequeSize = 1024; // tasks per worker, a power of two
+    static const int kInjectSize = 4096;
+    static const int kMaxWorkers = 256;
+    static const int kIdleSpins = 64;         // looks for work before a worker sleeps
+    static const int kWaitSpins = 256;        // the same for task_wait()
+    static const int kGroupSleeping = 1 << 30;
+    static const int kGroupCountMask = kGroupSleeping - 1;
+    static const int kWakeAll = 0x7FFFFFFF;
+    static const size_t kMaxChunks = (size_t) 1 << 30;
+
+    // memcpy_parallel/memset_parallel: smallest size to split, and smallest chunk
+    static const size_t kParallelMin = 4 * 1024 * 1024;
+    static const size_t kParallelChunkMin = 256 * 1024;
+
+    struct task_slot {
+        void (*fn)(void *);
+        void *arg;
+        task_group *group;
+    };
+
+    struct work_deque {
+        volatile long long top;    // thieves take here
+        char pad0[56];
+        volatile long long bottom; // the owner pushes and takes here
+        char pad1[56];
+        task_slot slots[kDequeSize];
+    };
+
+    struct pool_worker {
+        work_deque deque;
+        thread *handle;
+    };
+
+    static mutex g_pool_lock = MUTEX_INIT;  // pool_start()/pool_stop()
+    static pool_worker *g_workers = NULL;
+    static size_t g_workers_size = 0;
+    static volatile int g_worker_count = 0;
+    static volatile int g_pool_running = 0;
+    static volatile int g_stop = 0;
+    static volatile int g_sleepers = 0;
+    static volatile int g_epoch = 0;
+
+    static mutex g_inject_lock = MUTEX_INIT;
+    static task_slot g_inject[kInjectSize];
+    static int g_inject_head = 0;
+    static volatile int g_inject_count = 0;
+
+    static thread_local pool_worker *t_worker;
+    static thread_local unsigned int t_seed;
+
+    /**
+     * @brief Number of CPUs the process may run on
+     */
+    static int online_cpus(void) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        unsigned long long mask[16] = {0};
+        long bytes = syscall3(NR_sched_getaffinity, 0, sizeof(mask), (long) mask);
+        if (!syscall_failed(bytes)) {
+            int count = 0;
+            for (long i = 0; i < bytes / 8; i++) {
+                for (unsigned long long bits = mask[i]; bits; bits &= bits - 1)
+                    count++;
+            }
+            return count > 0 ? count : 1;
+        }
+#endif
+        return 1;
+    }
+
+    // ---- Chase-Lev deque
+
+    static bool deque_push(work_deque *d, const task_slot &task) {
+        long long bottom = d->bottom;
+        long long top = atomic_load_long(&d->top);
+        if (bottom - top >= kDequeSize)
+            return false;
+        d->slots[bottom & (kDequeSize - 1)] = task;
+        atomic_store_long(&d->bottom, bottom + 1); // release: publishes the slot
+        return true;
+    }
+
+    static bool deque_take(work_deque *d, task_slot *out) {
+        long long bottom = d->bottom - 1;
+        atomic_store_long(&d->bottom, bottom);
+        atomic_fence();
+        long long top = atomic_load_long(&d->top);
+        if (top > bottom) {
+            atomic_store_long(&d->bottom, bottom + 1);
+            return false;
+        }
+
+        *out = d->slots[bottom & (kDequeSize - 1)];
+        if (top < bottom)
+            return true;
+
+        // The last task: whoever moves top first gets it
+        bool won = atomic_cas_long(&d->top, top, top + 1) != 0;
+        atomic_store_long(&d->bottom, bottom + 1);
+        return won;
+    }
+
+    /**
+     * @brief Take the oldest task of another thread's deque
+     *
+     * @return 1 with a task, 0 if the deque was empty, -1 if another thread won the race
+     */
+    static int deque_steal(work_deque *d, task_slot *out) {
+        long long top = atomic_load_long(&d->top);
+        atomic_fence();
+        long long bottom = atomic_load_long(&d->bottom);
+        if (top >= bottom)
+            return 0;
+
+        // The slot may be overwritten once top moves on; the CAS then fails and the copy is dropped
+        const volatile task_slot *slot = &d->slots[top & (kDequeSize - 1)];
+        out->fn = slot->fn;
+        out->arg = slot->arg;
+        out->group = slot->group;
+        return atomic_cas_long(&d->top, top, top + 1) ? 1 : -1;
+    }
+
+    // ---- Queue for tasks spawned outside the pool
+
+    static bool inject_push(const task_slot &task) {
+        mutex_lock(&g_inject_lock);
+        int count = g_inject_count;
+        if (count == kInjectSize) {
+            mutex_unlock(&g_inject_lock);
+            return false;
+        }
+        g_inject[(g_inject_head + count) % kInjectSize] = task;
+        atomic_store_int(&g_inject_count, count + 1);
+        mutex_unlock(&g_inject_lock);
+        return true;
+    }
+
+    static bool inject_pop(task_slot *out) {
+        if (!atomic_load_int(&g_inject_count))
+            return false;
+        mutex_lock(&g_inject_lock);
+        int count = g_inject_count;
+        if (count) {
+            *out = g_inject[g_inject_head];
+            g_inject_head = (g_inject_head + 1) % kInjectSize;
+            atomic_store_int(&g_inject_count, count - 1);
+        }
+        mutex_unlock(&g_inject_lock);
+        return count != 0;
+    }
+
+    // ---- Scheduling
+
+    static unsigned int next_random(void) {
+        unsigned int x = t_seed;
+        if (MINICRT_UNLIKELY(!x))
+            x = (unsigned int) (size_t) &x | 1;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        t_seed = x;
+        return x;
+    }
+
+    /**
+     * @brief Find a task: the own deque first, then the shared queue, then other workers
+     */
+    static bool find_task(task_slot *out) {
+        pool_worker *self = t_worker;
+        if (self && deque_take(&self->deque, out))
+            return true;
+        if (inject_pop(out))
+            return true;
+
+        int count = atomic_load_int(&g_worker_count);
+        if (count == 0)
+            return false;
+        int start = (int) (next_random() % (unsigned int) count);
+        for (int i = 0; i < count; i++) {
+            pool_worker *victim = &g_workers[(start + i) % count];
+            if (victim == self)
+                continue;
+            int result;
+            while ((result = deque_steal(&victim->deque, out)) < 0)
+                cpu_relax();
+            if (result)
+                return true;
+        }
+        return false;
+    }
+
+    static void run_task(const task_slot *task) {
+        task->fn(task->arg);
+        int state = atomic_fetch_add_int(&task->group->state, -1);
+        if (state == (kGroupSleeping | 1))
+            futex_wake(&task->group->state, kWakeAll);
+    }
+
+    // Called after publishing a task
+    static void wake_worker(void) {
+        atomic_fence();
+        if (atomic_load_int(&g_sleepers)) {
+            atomic_fetch_add_int(&g_epoch, 1);
+            futex_wake(&g_epoch, 1);
+        }
+    }
+
+    static int worker_main(void *arg) {
+        t_worker = (pool_worker *) arg;
+        task_slot task;
+        for (;;) {
+            bool found = false;
+            for (int i = 0; i < kIdleSpins && !found; i++) {
+                found = find_task(&task);
+                if (!found)
+                    cpu_relax();
+            }
+            if (found) {
+                run_task(&task);
+                continue;
+            }
+
+            // Announce the sleep, then look once more; see the comment at the top
+            atomic_fetch_add_int(&g_sleepers, 1);
+            int epoch = atomic_load_int(&g_epoch);
+            if (atomic_load_int(&g_stop)) {
+                atomic_fetch_add_int(&g_sleepers, -1);
+                break;
+            }
+            if (find_task(&task)) {
+                atomic_fetch_add_int(&g_sleepers, -1);
+                run_task(&task);
+                continue;
+            }
+            futex_wait(&g_epoch, epoch, NULL);
+            atomic_fetch_add_int(&g_sleepers, -1);
+        }
+        t_worker = NULL;
+        return 0;
+    }
+
+    static void pool_ensure_started(void) {
+        if (MINICRT_UNLIKELY(!atomic_load_int(&g_pool_running)))
+            pool_start(-1);
+    }
+
+    // ---- parallel_for and the parallel memory kernels
+
+    struct for_job {
+        size_t begin;
+        size_t end;
+        size_t grain;
+        int chunks;
+        volatile int next; // next chunk to hand out
+        void (*body)(size_t, size_t, void *);
+        void *arg;
+    };
+
+    // Each participating thread claims chunks until none are left
+    static void for_run(void *arg) {
+        for_job *job = (for_job *) arg;
+        for (;;) {
+            int chunk = atomic_fetch_add_int(&job->next, 1);
+            if (chunk >= job->chunks)
+                return;
+            size_t begin = job->begin + (size_t) chunk * job->grain;
+            size_t end = job->end - begin > job->grain ? begin + job->grain : job->end;
+            job->body(begin, end, job->arg);
+        }
+    }
+
+    /**
+     * @brief A memcpy/memset split into page-aligned chunks of the destination
+     *
+     * Offsets run from the page boundary at or below dest; [first, last) is the part
+     * that belongs to the call.
+     */
+    struct memory_job {
+        unsigned char *dest;
+        const unsigned char *src;
+        int value;
+        size_t first;
+        size_t last;
+    };
+
+    static void copy_chunk(size_t begin, size_t end, void *arg) {
+        memory_job *job = (memory_job *) arg;
+        if (begin < job->first)
+            begin = job->first;
+        if (end > job->last)
+            end = job->last;
+        memcpy(job->dest + (begin - job->first), job->src + (begin - job->first), end - begin);
+    }
+
+    static void set_chunk(size_t begin, size_t end, void *arg) {
+        memory_job *job = (memory_job *) arg;
+        if (begin < job->first)
+            begin = job->first;
+        if (end > job->last)
+            end = job->last;
+        memset(job->dest + (begin - job->first), job->value, end - begin);
+    }
+
+    static void memory_parallel(memory_job *job, size_t count, void (*body)(size_t, size_t, void *)) {
+        size_t page = page_size();
+        size_t threads = (size_t) atomic_load_int(&g_worker_count) + 1;
+        size_t grain = count / (threads * 4);
+        if (grain < kParallelChunkMin)
+            grain = kParallelChunkMin;
+        grain = (grain + page - 1) & ~(page - 1);
+
+        job->first = (size_t) job->dest & (page - 1);
+        job->last = job->first + count;
+        parallel_for(0, job->last, grain, body, job);
+    }
+} // namespace detail
+
+    /**
+     * @brief Start the pool's worker threads
+     */
+    int pool_start(int workers) {
+        mutex_lock(&detail::g_pool_lock);
+        if (detail::g_pool_running) {
+            int count = detail::g_worker_count;
+            mutex_unlock(&detail::g_pool_lock);
+            return count;
+        }
+
+        if (workers < 0)
+            workers = detail::online_cpus() - 1;
+        if (workers > detail::kMaxWorkers)
+            workers = detail::kMaxWorkers;
+        detail::g_stop = 0;
+
+        int started = 0;
+        if (workers > 0) {
+            size_t page = detail::page_size();
+            size_t size = ((size_t) workers * sizeof(detail::pool_worker) + page - 1) & ~(page - 1);
+            // Fresh pages are zero: empty deques
+            detail::g_workers = (detail::pool_worker *) detail::map_pages(size);
+            if (detail::g_workers) {
+                detail::g_workers_size = size;
+                for (; started < workers; started++) {
+                    detail::pool_worker *w = &detail::g_workers[started];
+                    if (thread_create(&w->handle, detail::worker_main, w, 0) != 0)
+                        break;
+                }
+                if (started == 0) {
+                    detail::unmap_pages(detail::g_workers, size);
+                    detail::g_workers = NULL;
+                    detail::g_workers_size = 0;
+                }
+            }
+        }
+
+        // Workers that are already running steal only from the ones counted here
+        detail::atomic_store_int(&detail::g_worker_count, started);
+        detail::atomic_store_int(&detail::g_pool_running, 1);
+        mutex_unlock(&detail::g_pool_lock);
+        return started;
+    }
+
+    /**
+     * @brief Stop the worker threads
+     */
+    void pool_stop(void) {
+        mutex_lock(&detail::g_pool_lock);
+        if (!detail::g_pool_running) {
+            mutex_unlock(&detail::g_pool_lock);
+            return;
+        }
+
+        detail::atomic_store_int(&detail::g_stop, 1);
+        detail::atomic_fetch_add_int(&detail::g_epoch, 1);
+        detail::futex_wake(&detail::g_epoch, detail::kWakeAll);
+
+        int count = detail::g_worker_count;
+        for (int i = 0; i < count; i++)
+            thread_join(detail::g_workers[i].handle, NULL);
+        if (detail::g_workers)
+            detail::unmap_pages(detail::g_workers, detail::g_workers_size);
+
+        detail::g_workers = NULL;
+        detail::g_workers_size = 0;
+        detail::atomic_store_int(&detail::g_worker_count, 0);
+        detail::atomic_store_int(&detail::g_pool_running, 0);
+        mutex_unlock(&detail::g_pool_lock);
+    }
+
+    /**
+     * @brief Number of worker threads
+     */
+    int pool_worker_count(void) {
+        return detail::atomic_load_int(&detail::g_worker_count);
+    }
+
+    /**
+     * @brief Run a task on the pool as part of a group
+     */
+    void task_spawn(task_group *group, void (*fn)(void *), void *arg) {
+        detail::pool_ensure_started();
+        detail::atomic_fetch_add_int(&group->state, 1);
+        detail::task_slot task = {fn, arg, group};
+
+        // Without workers, or with a full queue, the spawning thread runs the task itself
+        detail::pool_worker *self = detail::t_worker;
+        bool queued;
+        if (self)
+            queued = detail::deque_push(&self->deque, task);
+        else
+            queued = detail::atomic_load_int(&detail::g_worker_count) && detail::inject_push(task);
+        if (!queued) {
+            detail::run_task(&task);
+            return;
+        }
+        detail::wake_worker();
+    }
+
+    /**
+     * @brief Wait for a group, running tasks meanwhile
+     */
+    void task_wait(task_group *group) {
+        int spins = 0;
+        for (;;) {
+            int state = detail::atomic_load_int(&group->state);
+            if ((state & detail::kGroupCountMask) == 0)
+                break;
+
+            detail::task_slot task;
+            if (detail::find_task(&task)) {
+                detail::run_task(&task);
+                spins = 0;
+                continue;
+            }
+            if (++spins < detail::kWaitSpins) {
+                detail::cpu_relax();
+                continue;
+            }
+
+            // The remaining tasks are running elsewhere: sleep until the last one ends
+            if (!(state & detail::kGroupSleeping)) {
+                if (detail::atomic_cas_int(&group->state, state, state | detail::kGroupSleeping) != state)
+                    continue;
+                state |= detail::kGroupSleeping;
+            }
+            detail::futex_wait(&group->state, state, NULL);
+        }
+        detail::atomic_store_int(&group->state, 0);
+    }
+
+    /**
+     * @brief Run a function over a range in parallel chunks
+     */
+    void parallel_for(size_t begin, size_t end, size_t grain,
+                      void (*body)(size_t chunk_begin, size_t chunk_end, void *arg), void *arg) {
+        if (end <= begin)
+            return;
+        detail::pool_ensure_started();
+
+        size_t count = end - begin;
+        int threads = detail::atomic_load_int(&detail::g_worker_count) + 1;
+        if (grain == 0) {
+            grain = count / ((size_t) threads * 4);
+            if (grain == 0)
+                grain = 1;
+        }
+        if (count / grain >= detail::kMaxChunks)
+            grain = count / detail::kMaxChunks + 1;
+
+        detail::for_job job;
+        job.begin = begin;
+        job.end = end;
+        job.grain = grain;
+        job.chunks = (int) (count / grain + (count % grain != 0));
+        job.next = 0;
+        job.body = body;
+        job.arg = arg;
+
+        // One task per helping thread; each claims chunks until they run out
+        int helpers = threads - 1 < job.chunks - 1 ? threads - 1 : job.chunks - 1;
+        task_group group = TASK_GROUP_INIT;
+        for (int i = 0; i < helpers; i++)
+            task_spawn(&group, detail::for_run, &job);
+        detail::for_run(&job);
+        task_wait(&group);
+    }
+
+    /**
+     * @brief memcpy() across the pool's threads
+     */
+    void *memcpy_parallel(void *dest, const void *src, size_t count) {
+        if (count < detail::kParallelMin)
+            return memcpy(dest, src, count);
+        detail::pool_ensure_started();
+        if (!detail::atomic_load_int(&detail::g_worker_count))
+            return memcpy(dest, src, count);
+
+        detail::memory_job job;
+        job.dest = (unsigned char *) dest;
+        job.src = (const unsigned char *) src;
+        job.value = 0;
+        detail::memory_parallel(&job, count, detail::copy_chunk);
+        return dest;
+    }
+
+    /**
+     * @brief memset() across the pool's threads
+     */
+    void *memset_parallel(void *dest, int value, size_t count) {
+        if (count < detail::kParallelMin)
+            return memset(dest, value, count);
+        detail::pool_ensure_started();
+        if (!detail::atomic_load_int(&detail::g_worker_count))
+            return memset(dest, value, count);
+
+        detail::memory_job job;
+        job.dest = (unsigned char *) dest;
+        job.src = NULL;
+        job.value = value;
+        detail::memory_parallel(&job, count, detail::set_chunk);
+        return dest;
+    }
+
+MINICRT_END
@@ -0,0 +1,156 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/crt.h"
+#include "minicrt/string.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+MINICRT_BEGIN
+    // Environment block handed to the process; NULL until _start has run
+    char **environ = NULL;
+
+namespace detail {
+    /*
+     * The kernel starts a process with this block at the stack pointer:
+     *
+     *   argc, argv[0..argc-1], NULL, envp[0..], NULL, {type, value} pairs..., {AT_NULL, 0}
+     *
+     * process_init() keeps pointers into it instead of copying anything. The aux vector
+     * entries with small type numbers (all that the runtime asks for) are indexed into
+     * g_aux_values so getauxval() is a load; others are found by a scan.
+     *
+     * A process that started in the system C library never runs process_init(). On
+     * Linux the vector is then read once from /proc/self/auxv into g_aux_copy.
+     */
+    static const unsigned long kAuxIndexed = 64;
+    static const size_t kAuxCopyEntries = 128;
+
+    struct aux_entry {
+        unsigned long type;
+        unsigned long value;
+    };
+
+    static const aux_entry *g_aux_vector = NULL;
+    static unsigned long g_aux_values[kAuxIndexed];
+    static unsigned long long g_aux_present = 0;
+    static size_t g_page_size = 4096;
+
+    /**
+     * @brief Index an aux vector and make it the one getauxval() answers from
+     */
+    static void index_aux_vector(const aux_entry *vector) {
+        for (const aux_entry *aux = vector; aux->type != AT_NULL; aux++) {
+            if (aux->type < kAuxIndexed) {
+                g_aux_values[aux->type] = aux->value;
+                g_aux_present |= 1ull << aux->type;
+            }
+        }
+
+        if (g_aux_present & (1ull << AT_PAGESZ))
+            g_page_size = g_aux_values[AT_PAGESZ];
+        atomic_exchange_ptr(&g_aux_vector, vector);
+    }
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    static aux_entry g_aux_copy[kAuxCopyEntries];
+    static spinlock g_aux_lock = {0};
+    static volatile int g_aux_loaded = 0;
+
+    /**
+     * @brief Read the aux vector from procfs when _start did not see it
+     */
+    static void load_aux_vector(void) {
+        spin_lock(&g_aux_lock);
+        if (!g_aux_loaded && !g_aux_vector) {
+            // The last slot stays zero, so a truncated read still ends in AT_NULL
+            long fd = sys_open("/proc/self/auxv", kOpenReadOnly | kOpenCloseOnExec, 0);
+            if (!syscall_failed(fd)) {
+                char *buf = (char *) g_aux_copy;
+                size_t used = 0;
+                size_t capacity = sizeof(g_aux_copy) - sizeof(aux_entry);
+                while (used < capacity) {
+                    long n = sys_read((int) fd, buf + used, capacity - used);
+                    if (syscall_failed(n) || n == 0)
+                        break;
+                    used += (size_t) n;
+                }
+                sys_close((int) fd);
+                if (used >= sizeof(aux_entry))
+                    index_aux_vector(g_aux_copy);
+            }
+            atomic_store_int(&g_aux_loaded, 1);
+        }
+        spin_unlock(&g_aux_lock);
+    }
+#endif
+
+    /**
+     * @brief The aux vector getauxval() answers from, or NULL if there is none
+     */
+    static const aux_entry *aux_vector(void) {
+        const aux_entry *vector = atomic_load_ptr(&g_aux_vector);
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (MINICRT_UNLIKELY(!vector && !atomic_load_int(&g_aux_loaded))) {
+            load_aux_vector();
+            vector = atomic_load_ptr(&g_aux_vector);
+        }
+#endif
+        return vector;
+    }
+
+    void process_init(int argc, char **argv, char **envp) {
+        (void) argc;
+        (void) argv;
+        environ = envp;
+
+        char **p = envp;
+        while (*p)
+            p++;
+        index_aux_vector((const aux_entry *) (p + 1));
+    }
+
+    size_t page_size(void) {
+        aux_vector();
+        return g_page_size;
+    }
+} // namespace detail
+
+    /**
+     * @brief Look up an entry of the ELF auxiliary vector
+     */
+    unsigned long getauxval(unsigned long type) {
+        const detail::aux_entry *vector = detail::aux_vector();
+        if (type < detail::kAuxIndexed) {
+            if (detail::g_aux_present & (1ull << type))
+                return detail::g_aux_values[type];
+        } else if (vector) {
+            for (const detail::aux_entry *aux = vector; aux->type != AT_NULL; aux++) {
+                if (aux->type == type)
+                    return aux->value;
+            }
+        }
+        errno = ENOENT;
+        return 0;
+    }
+
+    /**
+     * @brief Look up an environment variable
+     */
+    char *getenv(const char *name) {
+        if (!environ || !name)
+            return NULL;
+
+        size_t length = strlen(name);
+        for (char **entry = environ; *entry; entry++) {
+            const char *e = *entry;
+            size_t i = 0;
+            while (i < length && e[i] == name[i])
+                i++;
+            if (i == length && e[length] == '=')
+                return (char *) e + length + 1;
+        }
+        return NULL;
+    }
+
+MINICRT_END
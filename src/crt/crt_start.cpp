@@ -0,0 +1,84 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/crt.h"
+#include "crt_internal.h"
+
+// Program entry points live in their own translation unit so that code using only the
+// runtime services (errno, exit, the heap) does not drag in a reference to main()
+
+#ifdef MINICRT_BUILDING_LIB
+
+// The program's main; only the symbol name matters, so int main() and
+// int main(int, char **) work as well
+int main(int argc, char *argv[], char *envp[]);
+
+MINICRT_BEGIN
+
+#ifdef MINICRT_WINDOWS
+    /**
+     * @brief Entry point for Windows applications
+     *
+     * This is the entry point when using /ENTRY:CustomMainCRTStartup
+     */
+    int CustomMainCRTStartup(void) {
+        // Initialize CRT
+        minicrt_init();
+
+        // Call the main function
+        int exit_code = main(0, NULL, NULL); // We don't process command line args yet
+
+        // Exit the program
+        exit(exit_code);
+
+        // Should never reach here
+        return exit_code;
+    }
+#elif defined(MINICRT_X86_64)
+    /**
+     * @brief C half of the Unix entry point
+     *
+     * @param stack Initial stack pointer: argc, then the argv, envp and auxv arrays
+     */
+    extern "C" __attribute__((noreturn, used)) void minicrt_start(long *stack) {
+        // Nothing has set up FS yet, so thread_local variables (errno included) are off limits
+        detail::g_thread_pointer_ready = 0;
+
+        int argc = (int) stack[0];
+        char **argv = (char **) (stack + 1);
+        char **envp = argv + argc + 1;
+        detail::process_init(argc, argv, envp);
+
+        // Give the main thread its TLS block; from here on errno and thread_local work
+        detail::thread_init();
+
+        // Initialize CRT
+        minicrt_init();
+
+        exit(main(argc, argv, envp));
+        __builtin_unreachable();
+    }
+#endif
+
+MINICRT_END
+
+#if defined(MINICRT_UNIX) && defined(MINICRT_X86_64)
+/*
+ * Unix entry point. The kernel jumps here with the argument block at %rsp rather
+ * than calling it, so there is no return address: clear %rbp to end frame-pointer
+ * walks, pass the block to minicrt_start and give the call a 16-byte aligned stack
+ * as the ABI requires.
+ */
+asm(".text\n"
+    ".globl _start\n"
+    ".type _start, @function\n"
+    "_start:\n"
+    "    xorl %ebp, %ebp\n"
+    "    movq %rsp, %rdi\n"
+    "    andq $-16, %rsp\n"
+    "    call minicrt_start\n"
+    "    hlt\n"
+    ".size _start, . - _start\n");
+#endif
+
+#endif // MINICRT_BUILDING_LIB
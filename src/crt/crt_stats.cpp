@@ -0,0 +1,257 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/stats.h"
+#include "crt_internal.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * Each thread counts into a shard of its own with plain increments, so recording
+     * a call costs a few adds and no atomic operations. Shards are page-allocated,
+     * linked into a registry and never freed: when a thread exits its shard is only
+     * marked unused and handed to the next new thread, counts included, so nothing
+     * has to be merged at thread exit. Readers sum the registry under a lock; they
+     * read counters other threads may be writing, which can leave the total a few
+     * calls behind but never tears a 64-bit value on the supported targets.
+     *
+     * Calls made before thread_local storage is usable go to a shared shard with
+     * atomic adds.
+     */
+
+#ifdef MINI_CRT_ENABLE_LOGGING
+    struct stats_shard {
+        function_stats functions[STATS_FUNCTION_COUNT];
+        stats_shard *next;
+        int in_use;
+    };
+
+    static spinlock g_stats_lock;
+    static stats_shard *g_shards;
+    static stats_shard g_shared_shard;
+
+#ifdef MINICRT_UNIX
+    static thread_local stats_shard *t_shard;
+    static thread_local int t_shard_retired; // stats_thread_exit() ran; use the shared shard
+
+#if __STDC_HOSTED__
+    // Under a hosted C++ runtime threads are not started by MiniCRT, so release the
+    // shard from a thread_local destructor instead
+    struct shard_reaper {
+        ~shard_reaper() { stats_thread_exit(); }
+    };
+
+    static thread_local shard_reaper t_reaper;
+#endif
+#endif
+
+    MINICRT_INLINE void atomic_add(unsigned long long *p, unsigned long long value) {
+#if defined(_MSC_VER)
+        _InterlockedExchangeAdd64((volatile long long *) p, (long long) value);
+#else
+        __atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+#endif
+    }
+
+    static MINICRT_INLINE unsigned int size_class(size_t size) {
+        return size ? log2_floor64(size) + 1 : 0;
+    }
+
+    static MINICRT_INLINE unsigned int align_class(size_t address_bits) {
+        unsigned int shift = ctz64(address_bits | 64);
+        return shift < STATS_ALIGN_CLASSES ? shift : STATS_ALIGN_CLASSES - 1;
+    }
+
+#ifdef MINICRT_UNIX
+    /**
+     * @brief Give the calling thread a shard, reusing one left by an exited thread
+     */
+    static stats_shard *shard_attach(void) {
+        spin_lock(&g_stats_lock);
+        stats_shard *shard = g_shards;
+        while (shard && shard->in_use)
+            shard = shard->next;
+        if (shard) {
+            shard->in_use = 1;
+        } else {
+            // Fresh pages are zero, which is an empty shard
+            shard = (stats_shard *) map_pages((sizeof(stats_shard) + page_size() - 1) & ~(page_size() - 1));
+            if (shard) {
+                shard->in_use = 1;
+                shard->next = g_shards;
+                g_shards = shard;
+            }
+        }
+        spin_unlock(&g_stats_lock);
+
+#if __STDC_HOSTED__
+        (void) &t_reaper;
+#endif
+        t_shard = shard;
+        return shard;
+    }
+#endif
+
+    void stats_record(unsigned int function, size_t address_bits, size_t size) {
+#ifdef MINICRT_UNIX
+        if (MINICRT_LIKELY(g_thread_pointer_ready)) {
+            stats_shard *shard = t_shard;
+            if (MINICRT_UNLIKELY(!shard) && !t_shard_retired)
+                shard = shard_attach();
+            if (MINICRT_LIKELY(shard != 0)) {
+                function_stats *f = &shard->functions[function];
+                f->calls++;
+                f->bytes += size;
+                f->sizes[size_class(size)]++;
+                f->alignments[align_class(address_bits)]++;
+                return;
+            }
+        }
+#endif
+        function_stats *f = &g_shared_shard.functions[function];
+        atomic_add(&f->calls, 1);
+        atomic_add(&f->bytes, size);
+        atomic_add(&f->sizes[size_class(size)], 1);
+        atomic_add(&f->alignments[align_class(address_bits)], 1);
+    }
+
+    static void shard_add(function_stats *out, const stats_shard *shard) {
+        for (int i = 0; i < STATS_FUNCTION_COUNT; i++) {
+            const volatile function_stats *f = &shard->functions[i];
+            out[i].calls += f->calls;
+            out[i].bytes += f->bytes;
+            for (int k = 0; k < STATS_SIZE_CLASSES; k++)
+                out[i].sizes[k] += f->sizes[k];
+            for (int k = 0; k < STATS_ALIGN_CLASSES; k++)
+                out[i].alignments[k] += f->alignments[k];
+        }
+    }
+
+    static void shard_clear(stats_shard *shard) {
+        for (int i = 0; i < STATS_FUNCTION_COUNT; i++) {
+            volatile function_stats *f = &shard->functions[i];
+            f->calls = 0;
+            f->bytes = 0;
+            for (int k = 0; k < STATS_SIZE_CLASSES; k++)
+                f->sizes[k] = 0;
+            for (int k = 0; k < STATS_ALIGN_CLASSES; k++)
+                f->alignments[k] = 0;
+        }
+    }
+#endif
+
+    void stats_thread_exit(void) {
+#if defined(MINI_CRT_ENABLE_LOGGING) && defined(MINICRT_UNIX)
+        stats_shard *shard = g_thread_pointer_ready ? t_shard : 0;
+        if (!shard)
+            return;
+
+        t_shard = 0;
+        t_shard_retired = 1;
+        spin_lock(&g_stats_lock);
+        shard->in_use = 0;
+        spin_unlock(&g_stats_lock);
+#endif
+    }
+} // namespace detail
+
+    /**
+     * @brief Check whether statistics are compiled in
+     */
+    int stats_enabled(void) {
+#ifdef MINI_CRT_ENABLE_LOGGING
+        return 1;
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Sum the statistics of all threads
+     */
+    void stats_collect(function_stats *out) {
+        // Cleared by hand: memset would record itself, and may need the lock taken below
+        for (int i = 0; i < STATS_FUNCTION_COUNT; i++) {
+            out[i].calls = 0;
+            out[i].bytes = 0;
+            for (int k = 0; k < STATS_SIZE_CLASSES; k++)
+                out[i].sizes[k] = 0;
+            for (int k = 0; k < STATS_ALIGN_CLASSES; k++)
+                out[i].alignments[k] = 0;
+        }
+
+#ifdef MINI_CRT_ENABLE_LOGGING
+        detail::spin_lock(&detail::g_stats_lock);
+        detail::shard_add(out, &detail::g_shared_shard);
+        for (const detail::stats_shard *shard = detail::g_shards; shard; shard = shard->next)
+            detail::shard_add(out, shard);
+        detail::spin_unlock(&detail::g_stats_lock);
+#endif
+    }
+
+    /**
+     * @brief Reset the statistics of all threads
+     */
+    void stats_reset(void) {
+#ifdef MINI_CRT_ENABLE_LOGGING
+        detail::spin_lock(&detail::g_stats_lock);
+        detail::shard_clear(&detail::g_shared_shard);
+        for (detail::stats_shard *shard = detail::g_shards; shard; shard = shard->next)
+            detail::shard_clear(shard);
+        detail::spin_unlock(&detail::g_stats_lock);
+#endif
+    }
+
+    /**
+     * @brief Print the statistics as a table
+     */
+    void stats_dump(stream *s) {
+        static const char *const kAlignNames[STATS_ALIGN_CLASSES] = {"1", "2", "4", "8", "16", "32", "64+"};
+
+        // Taken before printing, which itself calls memcpy
+        function_stats totals[STATS_FUNCTION_COUNT];
+        stats_collect(totals);
+
+        stream_printf(s, "minicrt call statistics\n");
+        for (int i = 0; i < STATS_FUNCTION_COUNT; i++) {
+            const function_stats &f = totals[i];
+            if (f.calls == 0)
+                continue;
+
+            stream_printf(s, "%-8s %llu calls, %llu bytes, %.1f bytes/call\n",
+                          stats_function_name((stats_function) i), f.calls, f.bytes,
+                          (double) f.bytes / (double) f.calls);
+            stream_printf(s, "  size     ");
+            for (int k = 0; k < STATS_SIZE_CLASSES; k++) {
+                if (f.sizes[k] == 0)
+                    continue;
+                if (k == 0)
+                    stream_printf(s, " 0:%llu", f.sizes[k]);
+                else
+                    stream_printf(s, " %llu+:%llu", 1ull << (k - 1), f.sizes[k]);
+            }
+            stream_printf(s, "\n  alignment");
+            for (int k = 0; k < STATS_ALIGN_CLASSES; k++) {
+                if (f.alignments[k])
+                    stream_printf(s, " %s:%llu", kAlignNames[k], f.alignments[k]);
+            }
+            stream_printf(s, "\n");
+        }
+        stream_flush(s);
+    }
+
+    /**
+     * @brief Get the name of a function
+     */
+    const char *stats_function_name(stats_function function) {
+        static const char *const kNames[STATS_FUNCTION_COUNT] = {
+            "memcpy", "memmove", "memset", "memcmp", "strlen", "strnlen", "strcpy", "strcmp",
+            "memchr", "memrchr", "rawmemchr", "strchr", "strrchr", "strstr", "memmem",
+            "strspn", "strcspn", "strpbrk", "strsep", "strtok"
+        };
+        if ((unsigned int) function >= STATS_FUNCTION_COUNT)
+            return "unknown";
+        return kNames[function];
+    }
+
+MINICRT_END
@@ -0,0 +1,304 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/stdio.h"
+#include "minicrt/memory.h"
+#include "minicrt/string.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+#ifdef MINICRT_WINDOWS
+extern "C" {
+__declspec(dllimport) void *__stdcall GetStdHandle(unsigned long std_handle);
+__declspec(dllimport) int __stdcall WriteFile(void *file, const void *buffer, unsigned long bytes_to_write,
+                                              unsigned long *bytes_written, void *overlapped);
+}
+#endif
+
+MINICRT_BEGIN
+    // Standard streams; constant-initialized so they work before minicrt_init()
+    static stream g_stdout = {0, 1, STREAM_LINE_BUFFERED, 0, 0, {0}};
+    static stream g_stderr = {0, 2, STREAM_LINE_BUFFERED, 0, 0, {0}};
+
+namespace detail {
+    // Pieces handed to a single writev call (the buffer plus the caller's vectors)
+    static const int kMaxWriteVectors = 16;
+
+    /**
+     * @brief Write every byte described by vec, retrying short and interrupted writes
+     *
+     * The vectors are consumed in place. Returns 0 or -errno.
+     */
+    static long write_fully(int fd, io_vector *vec, int count) {
+        while (count > 0) {
+            if (!vec->length) {
+                vec++;
+                count--;
+                continue;
+            }
+
+#ifdef MINICRT_LINUX_SYSCALLS
+            long written = sys_writev(fd, vec, count);
+            if (syscall_failed(written)) {
+                if (written == -kErrIntr)
+                    continue;
+                return written;
+            }
+#elif defined(MINICRT_WINDOWS)
+            void *handle = GetStdHandle(fd == 2 ? (unsigned long) -12 : (unsigned long) -11);
+            unsigned long done = 0;
+            unsigned long chunk = vec->length > 0x40000000u ? 0x40000000u : (unsigned long) vec->length;
+            if (!WriteFile(handle, vec->base, chunk, &done, 0))
+                return -EIO;
+            long written = (long) done;
+#else
+            (void) fd;
+            return -EIO;
+#endif
+
+            while (count > 0 && (size_t) written >= vec->length) {
+                written -= (long) vec->length;
+                vec++;
+                count--;
+            }
+            if (count > 0 && written) {
+                vec->base = (const char *) vec->base + written;
+                vec->length -= (size_t) written;
+            }
+        }
+        return 0;
+    }
+
+    static int stream_fail(stream *s, long error) {
+        s->error = 1;
+        errno = (int) -error;
+        return -1;
+    }
+
+    /**
+     * @brief Write the buffered bytes followed by vec, batching them into writev calls
+     *
+     * The caller holds the stream lock.
+     */
+    static int write_through(stream *s, const io_vector *vec, int count) {
+        io_vector batch[kMaxWriteVectors];
+        int used = 0;
+
+        if (s->used) {
+            batch[0].base = s->buffer;
+            batch[0].length = s->used;
+            used = 1;
+            s->used = 0;
+        }
+
+        for (;;) {
+            while (count > 0 && used < kMaxWriteVectors) {
+                batch[used++] = *vec++;
+                count--;
+            }
+            long result = write_fully(s->fd, batch, used);
+            if (result < 0)
+                return stream_fail(s, result);
+            if (!count)
+                return 0;
+            used = 0;
+        }
+    }
+
+    static int flush_locked(stream *s) {
+        return s->used ? write_through(s, 0, 0) : 0;
+    }
+
+    static MINICRT_INLINE int has_newline(const void *data, size_t size) {
+        const char *p = (const char *) data;
+        while (size--) {
+            if (p[size] == '\n')
+                return 1;
+        }
+        return 0;
+    }
+
+    // format_sink callback: push the formatted bytes out and reopen the whole buffer
+    static void stream_sink_flush(format_sink *sink) {
+        stream *s = (stream *) sink->context;
+        s->used = (size_t) (sink->pos - s->buffer);
+        flush_locked(s);
+        sink->pos = s->buffer;
+    }
+
+    void stdio_init(void) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        // struct termios is 60 bytes on Linux; TCGETS only succeeds on a terminal
+        unsigned int termios[16];
+        if (syscall_failed(sys_ioctl(1, kTcGets, termios)))
+            g_stdout.mode = STREAM_FULLY_BUFFERED;
+#endif
+    }
+
+    void stdio_flush_all(void) {
+        stream_flush(&g_stdout);
+        stream_flush(&g_stderr);
+    }
+} // namespace detail
+
+    /**
+     * @brief Get the standard output stream
+     */
+    stream *stdout_stream(void) {
+        return &g_stdout;
+    }
+
+    /**
+     * @brief Get the standard error stream
+     */
+    stream *stderr_stream(void) {
+        return &g_stderr;
+    }
+
+    /**
+     * @brief Set up a stream over a file descriptor
+     */
+    void stream_init(stream *s, int fd, buffer_mode mode) {
+        s->lock = 0;
+        s->fd = fd;
+        s->mode = mode;
+        s->error = 0;
+        s->used = 0;
+    }
+
+    /**
+     * @brief Change the buffering mode of a stream
+     */
+    int stream_set_mode(stream *s, buffer_mode mode) {
+        detail::spin_lock(&s->lock);
+        int result = detail::flush_locked(s);
+        s->mode = mode;
+        detail::spin_unlock(&s->lock);
+        return result;
+    }
+
+    /**
+     * @brief Write several pieces of data to a stream as one unit
+     */
+    int stream_writev(stream *s, const io_vector *vec, int count) {
+        size_t total = 0;
+        for (int i = 0; i < count; i++)
+            total += vec[i].length;
+
+        detail::spin_lock(&s->lock);
+        int result = 0;
+        if (s->mode != STREAM_UNBUFFERED && total <= STREAM_BUFFER_SIZE - s->used) {
+            int newline = 0;
+            for (int i = 0; i < count; i++) {
+                memcpy(s->buffer + s->used, vec[i].base, vec[i].length);
+                s->used += vec[i].length;
+                if (s->mode == STREAM_LINE_BUFFERED && !newline)
+                    newline = detail::has_newline(vec[i].base, vec[i].length);
+            }
+            if (newline || s->used == STREAM_BUFFER_SIZE)
+                result = detail::flush_locked(s);
+        } else {
+            // Too big to buffer: one writev carries the pending bytes and the new data
+            result = detail::write_through(s, vec, count);
+        }
+        detail::spin_unlock(&s->lock);
+        return result;
+    }
+
+    /**
+     * @brief Write bytes to a stream
+     */
+    int stream_write(stream *s, const void *data, size_t size) {
+        io_vector vec = {data, size};
+        return stream_writev(s, &vec, 1);
+    }
+
+    /**
+     * @brief Write a NUL-terminated string to a stream
+     */
+    int stream_puts(stream *s, const char *str) {
+        return stream_write(s, str, strlen(str));
+    }
+
+    /**
+     * @brief Write a single character to a stream
+     */
+    int stream_putc(stream *s, int c) {
+        char ch = (char) c;
+        return stream_write(s, &ch, 1);
+    }
+
+    /**
+     * @brief Hand all buffered bytes of a stream to the OS
+     */
+    int stream_flush(stream *s) {
+        detail::spin_lock(&s->lock);
+        int result = detail::flush_locked(s);
+        detail::spin_unlock(&s->lock);
+        return result;
+    }
+
+    /**
+     * @brief Format text into a stream
+     */
+    int stream_vprintf(stream *s, const char *format, va_list args) {
+        detail::spin_lock(&s->lock);
+        int failed_before = s->error;
+        s->error = 0;
+
+        detail::format_sink sink;
+        sink.pos = s->buffer + s->used;
+        sink.end = s->buffer + STREAM_BUFFER_SIZE;
+        sink.total = 0;
+        sink.flush = detail::stream_sink_flush;
+        sink.context = s;
+
+        char *start = sink.pos;
+        int result = detail::format_to_sink(&sink, format, args);
+        s->used = (size_t) (sink.pos - s->buffer);
+
+        // Bytes still in the buffer from this call decide line flushing; if the sink
+        // flushed midway, they start at the beginning of the buffer
+        if (sink.total != (size_t) (sink.pos - start))
+            start = s->buffer;
+        if (s->mode == STREAM_UNBUFFERED ||
+            (s->mode == STREAM_LINE_BUFFERED && detail::has_newline(start, (size_t) (sink.pos - start))))
+            detail::flush_locked(s);
+
+        if (s->error)
+            result = -1;
+        s->error |= failed_before;
+        detail::spin_unlock(&s->lock);
+        return result;
+    }
+
+    /**
+     * @brief Format text into a stream
+     */
+    int stream_printf(stream *s, const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        int result = stream_vprintf(s, format, args);
+        va_end(args);
+        return result;
+    }
+
+    /**
+     * @brief Format text to standard output
+     */
+    int printf(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        int result = stream_vprintf(&g_stdout, format, args);
+        va_end(args);
+        return result;
+    }
+
+    /**
+     * @brief Check whether a write to a stream has failed
+     */
+    int stream_error(const stream *s) {
+        return s->error;
+    }
+
+MINICRT_END
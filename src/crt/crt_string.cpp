@@ -2,9 +2,12 @@
 // Created by seiftnesse on 3/1/2025.
 //
 #include "minicrt/string.h"
+#include "minicrt/stats.h"
+#include "crt_internal.h"
 
 
 MINICRT_BEGIN
+namespace detail {
     /**
      * @brief Calculates the length of a string
      *
@@ -13,7 +16,7 @@ MINICRT_BEGIN
      * @param str The string to measure
      * @return The number of characters in the string (excluding null terminator)
      */
-    size_t strlen(const char *str) {
+    size_t strlen_generic(const char *str) {
         /* Implementation notes:
          * 1. We use a simple approach for our first function
          * 2. No check for NULL because that is undefined behavior in standard C
@@ -40,7 +43,7 @@ MINICRT_BEGIN
      * @param max_len The maximum number of characters to examine
      * @return The number of characters in the string (excluding null terminator) or max_len
      */
-    size_t strnlen(const char *str, size_t max_len) {
+    size_t strnlen_generic(const char *str, size_t max_len) {
         size_t i;
 
         /* Count characters until we find the null terminator or reach max_len */
@@ -52,6 +55,1048 @@ MINICRT_BEGIN
         return i;
     }
 
+    /**
+     * @brief Compares two strings lexicographically
+     *
+     * This function compares two strings character by character.
+     *
+     * @param lhs The first string
+     * @param rhs The second string
+     * @return <0 if lhs < rhs, 0 if lhs == rhs, >0 if lhs > rhs
+     */
+    int strcmp_generic(const char *lhs, const char *rhs) {
+        /* Compare characters until we find a difference or reach the end */
+        while (*lhs && (*lhs == *rhs)) {
+            lhs++;
+            rhs++;
+        }
+
+        /* Return the difference between the characters */
+        return (int) (unsigned char) *lhs - (int) (unsigned char) *rhs;
+    }
+
+    /**
+     * @brief Find the first occurrence of a byte in a memory block
+     */
+    void *memchr_generic(const void *ptr, int c, size_t count) {
+        const unsigned char *p = (const unsigned char *) ptr;
+        unsigned char value = (unsigned char) c;
+
+        for (size_t i = 0; i < count; i++) {
+            if (p[i] == value)
+                return (void *) (p + i);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Find the last occurrence of a byte in a memory block
+     */
+    void *memrchr_generic(const void *ptr, int c, size_t count) {
+        const unsigned char *p = (const unsigned char *) ptr;
+        unsigned char value = (unsigned char) c;
+
+        while (count--) {
+            if (p[count] == value)
+                return (void *) (p + count);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Find the first occurrence of a character in a string
+     */
+    char *strchr_generic(const char *str, int c) {
+        for (;; str++) {
+            if (*str == (char) c)
+                return (char *) str;
+            if (*str == '\0')
+                return 0;
+        }
+    }
+
+    /**
+     * @brief Find the last occurrence of a character in a string
+     */
+    char *strrchr_generic(const char *str, int c) {
+        const char *last = 0;
+        for (;; str++) {
+            if (*str == (char) c)
+                last = str;
+            if (*str == '\0')
+                return (char *) last;
+        }
+    }
+
+    /*
+     * Two-Way string matching (Crochemore and Perrin, "Two-way string-matching",
+     * J. ACM 38(3), 1991). The needle is split at a critical factorization u v.
+     * Each attempt matches v left to right, then u right to left, and a mismatch
+     * shifts the window by an amount that cannot skip an occurrence. The search
+     * takes O(n + m) time and O(1) space on any input. The vector kernels use it
+     * as the fallback once their first/last-byte filter stops paying off.
+     */
+
+    /**
+     * @brief Start of the maximal suffix of a needle under one of the two byte orders
+     *
+     * @param reversed Non-zero to order bytes from high to low
+     * @param period Receives the period of the suffix
+     */
+    static size_t maximal_suffix(const unsigned char *needle, size_t length, int reversed, size_t *period) {
+        size_t suffix = (size_t) -1; // one before the suffix
+        size_t j = 0;
+        size_t k = 1;
+        size_t p = 1;
+
+        while (j + k < length) {
+            unsigned char a = needle[j + k];
+            unsigned char b = needle[suffix + k];
+            if (reversed ? a > b : a < b) {
+                j += k;
+                k = 1;
+                p = j - suffix;
+            } else if (a == b) {
+                if (k != p) {
+                    k++;
+                } else {
+                    j += p;
+                    k = 1;
+                }
+            } else {
+                suffix = j++;
+                k = p = 1;
+            }
+        }
+        *period = p;
+        return suffix + 1;
+    }
+
+    /**
+     * @brief Two-Way search for a needle of at least one byte
+     */
+    static const char *two_way_search(const char *haystack, size_t haystack_len, const char *needle,
+                                      size_t needle_len) {
+        if (needle_len > haystack_len)
+            return 0;
+
+        const unsigned char *h = (const unsigned char *) haystack;
+        const unsigned char *n = (const unsigned char *) needle;
+        size_t period, reversed_period;
+        size_t split = maximal_suffix(n, needle_len, 0, &period);
+        size_t reversed_split = maximal_suffix(n, needle_len, 1, &reversed_period);
+        if (reversed_split > split) {
+            split = reversed_split;
+            period = reversed_period;
+        }
+
+        size_t last = haystack_len - needle_len;
+        if (memcmp_generic(n, n + period, split) == 0) {
+            // Periodic needle: after a shift by the period, the first needle_len - period
+            // bytes are known to match
+            size_t memory = 0;
+            for (size_t j = 0; j <= last;) {
+                size_t i = split > memory ? split : memory;
+                while (i < needle_len && n[i] == h[i + j])
+                    i++;
+                if (i < needle_len) {
+                    j += i - split + 1;
+                    memory = 0;
+                    continue;
+                }
+
+                i = split;
+                while (i > memory && n[i - 1] == h[i - 1 + j])
+                    i--;
+                if (i <= memory)
+                    return haystack + j;
+                j += period;
+                memory = needle_len - period;
+            }
+        } else {
+            // Otherwise every full match of the right part allows a shift past the longer half
+            period = (split > needle_len - split ? split : needle_len - split) + 1;
+            for (size_t j = 0; j <= last;) {
+                size_t i = split;
+                while (i < needle_len && n[i] == h[i + j])
+                    i++;
+                if (i < needle_len) {
+                    j += i - split + 1;
+                    continue;
+                }
+
+                i = split;
+                while (i > 0 && n[i - 1] == h[i - 1 + j])
+                    i--;
+                if (i == 0)
+                    return haystack + j;
+                j += period;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Find a needle in a memory block with Two-Way
+     */
+    const char *memmem_generic(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+        return two_way_search(haystack, haystack_len, needle, needle_len);
+    }
+
+    // Building a byteset, also once per call of strspn() and the like
+
+    static void byteset_clear(byteset *set) {
+        for (int i = 0; i < 4; i++)
+            set->bits[i] = 0;
+        store64(set->low, 0);
+        store64(set->low + 8, 0);
+        store64(set->high, 0);
+        store64(set->high + 8, 0);
+        set->count = 0;
+    }
+
+    static MINICRT_INLINE void byteset_add(byteset *set, unsigned char c) {
+        unsigned long long bit = 1ull << (c & 63);
+        if (set->bits[c >> 6] & bit)
+            return;
+        set->bits[c >> 6] |= bit;
+        (c < 0x80 ? set->low : set->high)[c & 15] |= (unsigned char) (1u << ((c >> 4) & 7));
+        if (set->count < 4)
+            set->members[set->count] = c;
+        set->count++;
+    }
+
+    // Fill the unused member slots with the first member (0 for an empty set)
+    static void byteset_finish(byteset *set) {
+        if (set->count == 0)
+            set->members[0] = 0;
+        for (unsigned int i = set->count; i < 4; i++)
+            set->members[i] = set->members[0];
+    }
+
+    /**
+     * @brief Scan bytes against a set, testing the membership map one byte at a time
+     */
+    size_t byteset_scan_generic(const char *str, size_t length, const byteset *set, unsigned int mode) {
+        const unsigned char *p = (const unsigned char *) str;
+        unsigned long long stop_on = (mode & kScanReject) ? 1 : 0;
+
+        for (size_t i = 0; i < length; i++) {
+            unsigned char b = p[i];
+            if (((set->bits[b >> 6] >> (b & 63)) & 1) == stop_on || (b == 0 && (mode & kScanString)))
+                return i;
+        }
+        return length;
+    }
+
+#ifdef MINICRT_X86_64
+    /*
+     * Vector string kernels.
+     *
+     * A string has no known length, so reading ahead of the terminator is only safe
+     * while the read stays inside a page that is known to be mapped. strlen/strnlen
+     * round the first load down to the vector size: an aligned vector never straddles
+     * a page, and the bytes before the string are masked out of the result. strcmp
+     * has two independently aligned inputs, so it uses unaligned loads and drops to a
+     * single byte step whenever either load would cross into the next page.
+     */
+
+    static const size_t kPageSize = 4096;
+
+    // Non-zero when a width-byte load at p stays within p's page
+    static MINICRT_INLINE int load_in_page(const char *p, size_t width) {
+        return ((size_t) p & (kPageSize - 1)) <= kPageSize - width;
+    }
+
+    /**
+     * @brief SSE2 strlen scanning aligned 16-byte blocks
+     */
+    size_t strlen_sse2(const char *str) {
+        const __m128i zero = _mm_setzero_si128();
+        size_t offset = (size_t) str & 15;
+        const char *p = str - offset;
+
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), zero));
+        mask >>= offset;
+        if (mask)
+            return ctz32(mask);
+
+        for (;;) {
+            p += 16;
+            mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), zero));
+            if (mask)
+                return (size_t) (p - str) + ctz32(mask);
+        }
+    }
+
+    /**
+     * @brief SSE2 strnlen scanning aligned 16-byte blocks
+     */
+    size_t strnlen_sse2(const char *str, size_t max_len) {
+        if (max_len == 0)
+            return 0;
+
+        const __m128i zero = _mm_setzero_si128();
+        size_t offset = (size_t) str & 15;
+        const char *p = str - offset;
+
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), zero));
+        mask >>= offset;
+        if (mask) {
+            size_t len = ctz32(mask);
+            return len < max_len ? len : max_len;
+        }
+
+        // Bytes examined so far; the block holding str[max_len - 1] is the last one read
+        size_t scanned = 16 - offset;
+        while (scanned < max_len) {
+            p += 16;
+            mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), zero));
+            if (mask) {
+                size_t len = scanned + ctz32(mask);
+                return len < max_len ? len : max_len;
+            }
+            scanned += 16;
+        }
+        return max_len;
+    }
+
+    /**
+     * @brief SSE2 strcmp comparing 16 bytes per step
+     */
+    int strcmp_sse2(const char *lhs, const char *rhs) {
+        const __m128i zero = _mm_setzero_si128();
+
+        for (;;) {
+            if (MINICRT_LIKELY(load_in_page(lhs, 16) && load_in_page(rhs, 16))) {
+                __m128i a = _mm_loadu_si128((const __m128i *) lhs);
+                __m128i b = _mm_loadu_si128((const __m128i *) rhs);
+                // Stop at the first byte that differs or terminates lhs
+                unsigned int mask = ((unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xFFFFu)
+                                    | (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(a, zero));
+                if (mask) {
+                    unsigned int i = ctz32(mask);
+                    return (int) (unsigned char) lhs[i] - (int) (unsigned char) rhs[i];
+                }
+                lhs += 16;
+                rhs += 16;
+            } else {
+                if (*lhs != *rhs || *lhs == '\0')
+                    return (int) (unsigned char) *lhs - (int) (unsigned char) *rhs;
+                lhs++;
+                rhs++;
+            }
+        }
+    }
+
+    /**
+     * @brief AVX2 strlen scanning aligned 32-byte blocks
+     */
+    MINICRT_TARGET("avx2")
+    size_t strlen_avx2(const char *str) {
+        const __m256i zero = _mm256_setzero_si256();
+        size_t offset = (size_t) str & 31;
+        const char *p = str - offset;
+
+        unsigned int mask = (unsigned int) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), zero));
+        mask >>= offset;
+        if (mask)
+            return ctz32(mask);
+
+        for (;;) {
+            p += 32;
+            mask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), zero));
+            if (mask)
+                return (size_t) (p - str) + ctz32(mask);
+        }
+    }
+
+    /**
+     * @brief AVX2 strnlen scanning aligned 32-byte blocks
+     */
+    MINICRT_TARGET("avx2")
+    size_t strnlen_avx2(const char *str, size_t max_len) {
+        if (max_len == 0)
+            return 0;
+
+        const __m256i zero = _mm256_setzero_si256();
+        size_t offset = (size_t) str & 31;
+        const char *p = str - offset;
+
+        unsigned int mask = (unsigned int) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), zero));
+        mask >>= offset;
+        if (mask) {
+            size_t len = ctz32(mask);
+            return len < max_len ? len : max_len;
+        }
+
+        size_t scanned = 32 - offset;
+        while (scanned < max_len) {
+            p += 32;
+            mask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), zero));
+            if (mask) {
+                size_t len = scanned + ctz32(mask);
+                return len < max_len ? len : max_len;
+            }
+            scanned += 32;
+        }
+        return max_len;
+    }
+
+    /**
+     * @brief AVX2 strcmp comparing 32 bytes per step
+     */
+    MINICRT_TARGET("avx2")
+    int strcmp_avx2(const char *lhs, const char *rhs) {
+        const __m256i zero = _mm256_setzero_si256();
+
+        for (;;) {
+            if (MINICRT_LIKELY(load_in_page(lhs, 32) && load_in_page(rhs, 32))) {
+                __m256i a = _mm256_loadu_si256((const __m256i *) lhs);
+                __m256i b = _mm256_loadu_si256((const __m256i *) rhs);
+                unsigned int mask = ~(unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b))
+                                    | (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, zero));
+                if (mask) {
+                    unsigned int i = ctz32(mask);
+                    return (int) (unsigned char) lhs[i] - (int) (unsigned char) rhs[i];
+                }
+                lhs += 32;
+                rhs += 32;
+            } else {
+                if (*lhs != *rhs || *lhs == '\0')
+                    return (int) (unsigned char) *lhs - (int) (unsigned char) *rhs;
+                lhs++;
+                rhs++;
+            }
+        }
+    }
+
+    /*
+     * Byte search kernels. memchr/memrchr/strchr/strrchr read aligned vectors only,
+     * like strlen, so every block read holds at least one byte of the input and
+     * rawmemchr can pass an unbounded count. memmem compares the first and last
+     * needle bytes against two unaligned haystack windows and verifies only the
+     * positions where both match. Adversarial inputs make nearly every position a
+     * candidate, so the filter counts the bytes spent verifying and hands the rest
+     * of the haystack to Two-Way once that exceeds two per haystack byte.
+     */
+
+    // Verification bytes the memmem filter may spend before it is held to the per-byte budget
+    static const size_t kFilterSlack = 4096;
+
+    /**
+     * @brief SSE2 memchr scanning aligned 16-byte blocks, four per step
+     */
+    void *memchr_sse2(const void *ptr, int c, size_t count) {
+        if (count == 0)
+            return 0;
+
+        const char *str = (const char *) ptr;
+        const __m128i value = _mm_set1_epi8((char) c);
+        size_t offset = (size_t) str & 15;
+        const char *p = str - offset;
+
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), value));
+        mask >>= offset;
+        if (mask) {
+            size_t i = ctz32(mask);
+            return i < count ? (void *) (str + i) : 0;
+        }
+
+        // p + 16 == str + scanned from here on
+        size_t scanned = 16 - offset;
+        p += 16;
+        while (scanned < count) {
+            // Four blocks per step once p is aligned to all four, so no step crosses a page
+            if (((size_t) p & 63) == 0 && scanned + 64 <= count) {
+                __m128i e0 = _mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), value);
+                __m128i e1 = _mm_cmpeq_epi8(_mm_load_si128((const __m128i *) (p + 16)), value);
+                __m128i e2 = _mm_cmpeq_epi8(_mm_load_si128((const __m128i *) (p + 32)), value);
+                __m128i e3 = _mm_cmpeq_epi8(_mm_load_si128((const __m128i *) (p + 48)), value);
+                if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(e0, e1), _mm_or_si128(e2, e3)))) {
+                    if ((mask = (unsigned int) _mm_movemask_epi8(e0)) != 0)
+                        return (void *) (p + ctz32(mask));
+                    if ((mask = (unsigned int) _mm_movemask_epi8(e1)) != 0)
+                        return (void *) (p + 16 + ctz32(mask));
+                    if ((mask = (unsigned int) _mm_movemask_epi8(e2)) != 0)
+                        return (void *) (p + 32 + ctz32(mask));
+                    return (void *) (p + 48 + ctz32((unsigned int) _mm_movemask_epi8(e3)));
+                }
+                p += 64;
+                scanned += 64;
+                continue;
+            }
+            mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), value));
+            if (mask) {
+                size_t i = scanned + ctz32(mask);
+                return i < count ? (void *) (str + i) : 0;
+            }
+            p += 16;
+            scanned += 16;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief SSE2 memrchr scanning aligned 16-byte blocks from the end
+     */
+    void *memrchr_sse2(const void *ptr, int c, size_t count) {
+        if (count == 0)
+            return 0;
+
+        const char *str = (const char *) ptr;
+        const char *end = str + count;
+        const __m128i value = _mm_set1_epi8((char) c);
+        const char *p = (const char *) ((size_t) (end - 1) & ~(size_t) 15);
+
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), value));
+        mask &= 0xFFFFu >> (16 - (size_t) (end - p));
+        for (;;) {
+            if (p <= str) {
+                mask &= ~0u << (size_t) (str - p);
+                return mask ? (void *) (p + log2_floor64(mask)) : 0;
+            }
+            if (mask)
+                return (void *) (p + log2_floor64(mask));
+            p -= 16;
+            mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) p), value));
+        }
+    }
+
+    /**
+     * @brief SSE2 strchr scanning aligned 16-byte blocks for the character or the terminator
+     */
+    char *strchr_sse2(const char *str, int c) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i value = _mm_set1_epi8((char) c);
+        size_t offset = (size_t) str & 15;
+        const char *p = str - offset;
+
+        // min(x ^ c, x) is zero exactly where x is c or the terminator
+        __m128i block = _mm_load_si128((const __m128i *) p);
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_min_epu8(_mm_xor_si128(block, value), block), zero));
+        mask &= ~0u << offset;
+        for (;;) {
+            if (mask) {
+                const char *hit = p + ctz32(mask);
+                return *hit == (char) c ? (char *) hit : 0;
+            }
+            p += 16;
+            block = _mm_load_si128((const __m128i *) p);
+            mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(_mm_xor_si128(block, value), block), zero));
+        }
+    }
+
+    /**
+     * @brief SSE2 strrchr remembering the last block with a match until the terminator
+     */
+    char *strrchr_sse2(const char *str, int c) {
+        if ((char) c == '\0')
+            return (char *) str + strlen_sse2(str);
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i value = _mm_set1_epi8((char) c);
+        size_t offset = (size_t) str & 15;
+        const char *p = str - offset;
+        const char *last = 0;
+
+        __m128i block = _mm_load_si128((const __m128i *) p);
+        unsigned int zeros = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(block, zero)) & (~0u << offset);
+        unsigned int hits = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(block, value)) & (~0u << offset);
+        for (;;) {
+            if (zeros) {
+                // Only matches before the terminator count
+                hits &= zeros ^ (zeros - 1);
+                if (hits)
+                    last = p + log2_floor64(hits);
+                return (char *) last;
+            }
+            if (hits)
+                last = p + log2_floor64(hits);
+            p += 16;
+            block = _mm_load_si128((const __m128i *) p);
+            zeros = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(block, zero));
+            hits = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(block, value));
+        }
+    }
+
+    /**
+     * @brief SSE2 memmem filtering 16 positions per step on the first and last needle bytes
+     */
+    const char *memmem_sse2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+        size_t positions = haystack_len - needle_len + 1;
+        const char *tail = haystack + needle_len - 1;
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+        size_t work = 0;
+        size_t i = 0;
+
+        for (; i + 16 <= positions; i += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i *) (haystack + i));
+            __m128i b = _mm_loadu_si128((const __m128i *) (tail + i));
+            unsigned int mask = (unsigned int) _mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+            if (MINICRT_LIKELY(mask == 0))
+                continue;
+
+            do {
+                size_t j = i + ctz32(mask);
+                if (memcmp_sse2(haystack + j + 1, needle + 1, needle_len - 2) == 0)
+                    return haystack + j;
+                work += needle_len;
+                mask &= mask - 1;
+            } while (mask);
+            if (MINICRT_UNLIKELY(work > 2 * i + kFilterSlack)) {
+                i += 16;
+                return two_way_search(haystack + i, haystack_len - i, needle, needle_len);
+            }
+        }
+        for (; i < positions; i++) {
+            if (haystack[i] == needle[0] && tail[i] == needle[needle_len - 1]
+                && memcmp_sse2(haystack + i + 1, needle + 1, needle_len - 2) == 0)
+                return haystack + i;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief AVX2 memchr scanning aligned 32-byte blocks, four per step
+     */
+    MINICRT_TARGET("avx2")
+    void *memchr_avx2(const void *ptr, int c, size_t count) {
+        if (count == 0)
+            return 0;
+
+        const char *str = (const char *) ptr;
+        const __m256i value = _mm256_set1_epi8((char) c);
+        size_t offset = (size_t) str & 31;
+        const char *p = str - offset;
+
+        unsigned int mask = (unsigned int) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), value));
+        mask >>= offset;
+        if (mask) {
+            size_t i = ctz32(mask);
+            return i < count ? (void *) (str + i) : 0;
+        }
+
+        size_t scanned = 32 - offset;
+        p += 32;
+        while (scanned < count) {
+            // Four blocks per step once p is aligned to all four, so no step crosses a page
+            if (((size_t) p & 127) == 0 && scanned + 128 <= count) {
+                __m256i e0 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), value);
+                __m256i e1 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) (p + 32)), value);
+                __m256i e2 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) (p + 64)), value);
+                __m256i e3 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) (p + 96)), value);
+                if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3)))) {
+                    if ((mask = (unsigned int) _mm256_movemask_epi8(e0)) != 0)
+                        return (void *) (p + ctz32(mask));
+                    if ((mask = (unsigned int) _mm256_movemask_epi8(e1)) != 0)
+                        return (void *) (p + 32 + ctz32(mask));
+                    if ((mask = (unsigned int) _mm256_movemask_epi8(e2)) != 0)
+                        return (void *) (p + 64 + ctz32(mask));
+                    return (void *) (p + 96 + ctz32((unsigned int) _mm256_movemask_epi8(e3)));
+                }
+                p += 128;
+                scanned += 128;
+                continue;
+            }
+            mask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), value));
+            if (mask) {
+                size_t i = scanned + ctz32(mask);
+                return i < count ? (void *) (str + i) : 0;
+            }
+            p += 32;
+            scanned += 32;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief AVX2 memrchr scanning aligned 32-byte blocks from the end, four per step
+     */
+    MINICRT_TARGET("avx2")
+    void *memrchr_avx2(const void *ptr, int c, size_t count) {
+        if (count == 0)
+            return 0;
+
+        const char *str = (const char *) ptr;
+        const char *end = str + count;
+        const __m256i value = _mm256_set1_epi8((char) c);
+        const char *p = (const char *) ((size_t) (end - 1) & ~(size_t) 31);
+
+        unsigned int mask = (unsigned int) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), value));
+        mask &= ~0u >> (32 - (size_t) (end - p));
+        for (;;) {
+            if (p <= str) {
+                mask &= ~0u << (size_t) (str - p);
+                return mask ? (void *) (p + log2_floor64(mask)) : 0;
+            }
+            if (mask)
+                return (void *) (p + log2_floor64(mask));
+
+            // Four blocks below p per step once p is aligned to all four
+            if (((size_t) p & 127) == 0 && (size_t) (p - str) >= 128) {
+                p -= 128;
+                __m256i e0 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), value);
+                __m256i e1 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) (p + 32)), value);
+                __m256i e2 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) (p + 64)), value);
+                __m256i e3 = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) (p + 96)), value);
+                if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3)))) {
+                    if ((mask = (unsigned int) _mm256_movemask_epi8(e3)) != 0)
+                        return (void *) (p + 96 + log2_floor64(mask));
+                    if ((mask = (unsigned int) _mm256_movemask_epi8(e2)) != 0)
+                        return (void *) (p + 64 + log2_floor64(mask));
+                    if ((mask = (unsigned int) _mm256_movemask_epi8(e1)) != 0)
+                        return (void *) (p + 32 + log2_floor64(mask));
+                    return (void *) (p + log2_floor64((unsigned int) _mm256_movemask_epi8(e0)));
+                }
+                mask = 0;
+                continue;
+            }
+            p -= 32;
+            mask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) p), value));
+        }
+    }
+
+    /**
+     * @brief AVX2 strchr scanning aligned 32-byte blocks for the character or the terminator, four per step
+     */
+    MINICRT_TARGET("avx2")
+    char *strchr_avx2(const char *str, int c) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i value = _mm256_set1_epi8((char) c);
+        size_t offset = (size_t) str & 31;
+        const char *p = str - offset;
+
+        // min(x ^ c, x) is zero exactly where x is c or the terminator
+        __m256i block = _mm256_load_si256((const __m256i *) p);
+        unsigned int mask = (unsigned int) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_xor_si256(block, value), block), zero));
+        mask &= ~0u << offset;
+        for (;;) {
+            if (mask) {
+                const char *hit = p + ctz32(mask);
+                return *hit == (char) c ? (char *) hit : 0;
+            }
+            p += 32;
+            if (((size_t) p & 127) == 0) {
+                // Four blocks per step, all in one page, until a group holds a hit
+                for (;;) {
+                    __m256i b0 = _mm256_load_si256((const __m256i *) p);
+                    __m256i b1 = _mm256_load_si256((const __m256i *) (p + 32));
+                    __m256i b2 = _mm256_load_si256((const __m256i *) (p + 64));
+                    __m256i b3 = _mm256_load_si256((const __m256i *) (p + 96));
+                    __m256i z0 = _mm256_min_epu8(_mm256_xor_si256(b0, value), b0);
+                    __m256i z1 = _mm256_min_epu8(_mm256_xor_si256(b1, value), b1);
+                    __m256i z2 = _mm256_min_epu8(_mm256_xor_si256(b2, value), b2);
+                    __m256i z3 = _mm256_min_epu8(_mm256_xor_si256(b3, value), b3);
+                    __m256i z = _mm256_min_epu8(_mm256_min_epu8(z0, z1), _mm256_min_epu8(z2, z3));
+                    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(z, zero)))
+                        break;
+                    p += 128;
+                }
+            }
+            block = _mm256_load_si256((const __m256i *) p);
+            mask = (unsigned int) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_xor_si256(block, value), block), zero));
+        }
+    }
+
+    /**
+     * @brief AVX2 strrchr remembering the last block with a match until the terminator, two per step
+     */
+    MINICRT_TARGET("avx2")
+    char *strrchr_avx2(const char *str, int c) {
+        if ((char) c == '\0')
+            return (char *) str + strlen_avx2(str);
+
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i value = _mm256_set1_epi8((char) c);
+        size_t offset = (size_t) str & 31;
+        const char *p = str - offset;
+        const char *last = 0;
+
+        __m256i block = _mm256_load_si256((const __m256i *) p);
+        unsigned int zeros = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, zero)) & (~0u << offset);
+        unsigned int hits = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, value)) & (~0u << offset);
+        for (;;) {
+            if (zeros) {
+                hits &= zeros ^ (zeros - 1);
+                if (hits)
+                    last = p + log2_floor64(hits);
+                return (char *) last;
+            }
+            if (hits)
+                last = p + log2_floor64(hits);
+            p += 32;
+            if (((size_t) p & 63) == 0) {
+                // Two blocks per step until a pair holds the terminator
+                for (;;) {
+                    __m256i b0 = _mm256_load_si256((const __m256i *) p);
+                    __m256i b1 = _mm256_load_si256((const __m256i *) (p + 32));
+                    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(b0, b1), zero)))
+                        break;
+                    __m256i e0 = _mm256_cmpeq_epi8(b0, value);
+                    __m256i e1 = _mm256_cmpeq_epi8(b1, value);
+                    if (_mm256_movemask_epi8(_mm256_or_si256(e0, e1))) {
+                        unsigned long long pair = (unsigned long long) (unsigned int) _mm256_movemask_epi8(e0)
+                                                  | (unsigned long long) (unsigned int) _mm256_movemask_epi8(e1) << 32;
+                        last = p + log2_floor64(pair);
+                    }
+                    p += 64;
+                }
+            }
+            block = _mm256_load_si256((const __m256i *) p);
+            zeros = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, zero));
+            hits = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, value));
+        }
+    }
+
+    /**
+     * @brief AVX2 memmem filtering 64 positions per step on the first and last needle bytes
+     */
+    MINICRT_TARGET("avx2")
+    const char *memmem_avx2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+        size_t positions = haystack_len - needle_len + 1;
+        const char *tail = haystack + needle_len - 1;
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+        size_t work = 0;
+        size_t i = 0;
+
+        for (; i + 64 <= positions; i += 64) {
+            __m256i m0 = _mm256_and_si256(
+                _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (haystack + i)), first),
+                _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (tail + i)), last));
+            __m256i m1 = _mm256_and_si256(
+                _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (haystack + i + 32)), first),
+                _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (tail + i + 32)), last));
+            if (MINICRT_LIKELY(_mm256_testz_si256(_mm256_or_si256(m0, m1), _mm256_or_si256(m0, m1))))
+                continue;
+
+            unsigned long long mask = (unsigned long long) (unsigned int) _mm256_movemask_epi8(m0)
+                                      | (unsigned long long) (unsigned int) _mm256_movemask_epi8(m1) << 32;
+            do {
+                size_t j = i + ctz64(mask);
+                if (memcmp_avx2(haystack + j + 1, needle + 1, needle_len - 2) == 0)
+                    return haystack + j;
+                work += needle_len;
+                mask &= mask - 1;
+            } while (mask);
+            if (MINICRT_UNLIKELY(work > 2 * i + kFilterSlack)) {
+                i += 64;
+                return two_way_search(haystack + i, haystack_len - i, needle, needle_len);
+            }
+        }
+        // Fewer than 64 positions left
+        return i < positions ? memmem_sse2(haystack + i, haystack_len - i, needle, needle_len) : 0;
+    }
+
+    /*
+     * Byte set kernels. A span stops at the first byte that is not a member (or, with
+     * kScanReject, that is one), and with kScanString also at a NUL byte. Like memchr
+     * they read aligned vectors only, so string scans pass an unbounded length.
+     *
+     * SSSE3 and AVX2 classify any set with two byte shuffles on the low nibble, one
+     * for members below 0x80 and one for the rest, tested against the bit a third
+     * shuffle selects for the high nibble. Plain SSE2 has no byte shuffle; it compares
+     * against each member of sets up to four bytes, which covers the usual delimiters,
+     * and leaves larger sets to the membership map. The SSE2 tier only falls back to
+     * it on CPUs without SSSE3.
+     */
+
+    /**
+     * @brief SSE2 stop mask of 16 bytes: member compares, flipped and joined with NUL
+     */
+    static MINICRT_INLINE unsigned int byteset_stop_sse2(__m128i block, const __m128i *members, __m128i any,
+                                                         __m128i flip, __m128i nul) {
+        __m128i in = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, members[0]), _mm_cmpeq_epi8(block, members[1])),
+                                  _mm_or_si128(_mm_cmpeq_epi8(block, members[2]), _mm_cmpeq_epi8(block, members[3])));
+        __m128i stop = _mm_or_si128(_mm_xor_si128(_mm_and_si128(in, any), flip),
+                                    _mm_and_si128(_mm_cmpeq_epi8(block, _mm_setzero_si128()), nul));
+        return (unsigned int) _mm_movemask_epi8(stop);
+    }
+
+    /**
+     * @brief SSE2 byte set scan comparing 16 bytes against up to four members
+     */
+    size_t byteset_scan_sse2(const char *str, size_t length, const byteset *set, unsigned int mode) {
+        if (set->count > 4)
+            return byteset_scan_generic(str, length, set, mode);
+        if (length == 0)
+            return 0;
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i members[4] = {
+            _mm_set1_epi8((char) set->members[0]), _mm_set1_epi8((char) set->members[1]),
+            _mm_set1_epi8((char) set->members[2]), _mm_set1_epi8((char) set->members[3])
+        };
+        // An empty set has no members to compare against
+        const __m128i any = set->count ? _mm_set1_epi8(-1) : zero;
+        const __m128i flip = (mode & kScanReject) ? zero : _mm_set1_epi8(-1);
+        const __m128i nul = (mode & kScanString) ? _mm_set1_epi8(-1) : zero;
+        size_t offset = (size_t) str & 15;
+        const char *p = str - offset;
+
+        unsigned int mask = byteset_stop_sse2(_mm_load_si128((const __m128i *) p), members, any, flip, nul);
+        mask >>= offset;
+        if (mask) {
+            size_t i = ctz32(mask);
+            return i < length ? i : length;
+        }
+
+        size_t scanned = 16 - offset;
+        while (scanned < length) {
+            p += 16;
+            mask = byteset_stop_sse2(_mm_load_si128((const __m128i *) p), members, any, flip, nul);
+            if (mask) {
+                size_t i = scanned + ctz32(mask);
+                return i < length ? i : length;
+            }
+            scanned += 16;
+        }
+        return length;
+    }
+
+    // Low nibble table of a scan: a string scan folds the terminator into it, as bit 0
+    // of row 0, a member when rejecting and a non-member when accepting
+    static MINICRT_INLINE __m128i byteset_low_row(const byteset *set, unsigned int mode) {
+        __m128i low_row = _mm_loadu_si128((const __m128i *) set->low);
+        if (mode & kScanString) {
+            low_row = (mode & kScanReject) ? _mm_or_si128(low_row, _mm_cvtsi32_si128(1))
+                                           : _mm_andnot_si128(_mm_cvtsi32_si128(1), low_row);
+        }
+        return low_row;
+    }
+
+    /**
+     * @brief SSSE3 mask of the bytes of a 16-byte block that are not in the nibble tables
+     */
+    MINICRT_TARGET("ssse3")
+    static MINICRT_INLINE unsigned int byteset_misses_ssse3(__m128i block, __m128i low, __m128i high, __m128i bits) {
+        __m128i row = _mm_or_si128(_mm_shuffle_epi8(low, block),
+                                   _mm_shuffle_epi8(high, _mm_xor_si128(block, _mm_set1_epi8(-128))));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(block, 4), _mm_set1_epi8(0x0F));
+        __m128i bit = _mm_shuffle_epi8(bits, hi);
+        return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128()));
+    }
+
+    /**
+     * @brief SSSE3 byte set scan classifying 16 bytes per step with nibble tables
+     */
+    MINICRT_TARGET("ssse3")
+    size_t byteset_scan_ssse3(const char *str, size_t length, const byteset *set, unsigned int mode) {
+        if (length == 0)
+            return 0;
+
+        const __m128i low = byteset_low_row(set, mode);
+        const __m128i high = _mm_loadu_si128((const __m128i *) set->high);
+        const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        const unsigned int flip = (mode & kScanReject) ? 0xFFFFu : 0u;
+        size_t offset = (size_t) str & 15;
+        const char *p = str - offset;
+
+        unsigned int mask = byteset_misses_ssse3(_mm_load_si128((const __m128i *) p), low, high, bits) ^ flip;
+        mask >>= offset;
+        if (mask) {
+            size_t i = ctz32(mask);
+            return i < length ? i : length;
+        }
+
+        size_t scanned = 16 - offset;
+        while (scanned < length) {
+            p += 16;
+            mask = byteset_misses_ssse3(_mm_load_si128((const __m128i *) p), low, high, bits) ^ flip;
+            if (mask) {
+                size_t i = scanned + ctz32(mask);
+                return i < length ? i : length;
+            }
+            scanned += 16;
+        }
+        return length;
+    }
+
+    /**
+     * @brief AVX2 mask of the bytes of a 32-byte block that are not in the nibble tables
+     */
+    MINICRT_TARGET("avx2")
+    static MINICRT_INLINE unsigned int byteset_misses_avx2(__m256i block, __m256i low, __m256i high, __m256i bits) {
+        // A shuffle index with the high bit set yields zero, so each table only
+        // answers for its own half of the byte values
+        __m256i row = _mm256_or_si256(_mm256_shuffle_epi8(low, block),
+                                      _mm256_shuffle_epi8(high, _mm256_xor_si256(block, _mm256_set1_epi8(-128))));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(block, 4), _mm256_set1_epi8(0x0F));
+        __m256i bit = _mm256_shuffle_epi8(bits, hi);
+        return (unsigned int) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), _mm256_setzero_si256()));
+    }
+
+    /**
+     * @brief AVX2 byte set scan classifying 32 bytes per step with nibble tables
+     */
+    MINICRT_TARGET("avx2")
+    size_t byteset_scan_avx2(const char *str, size_t length, const byteset *set, unsigned int mode) {
+        if (length == 0)
+            return 0;
+
+        // vpshufb looks up within each 128-bit lane, so every table is repeated in both
+        const __m256i low = _mm256_broadcastsi128_si256(byteset_low_row(set, mode));
+        const __m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) set->high));
+        const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                              1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        // Accepting stops at misses, rejecting at hits
+        const unsigned int flip = (mode & kScanReject) ? ~0u : 0u;
+        size_t offset = (size_t) str & 31;
+        const char *p = str - offset;
+
+        unsigned int mask = byteset_misses_avx2(_mm256_load_si256((const __m256i *) p), low, high, bits) ^ flip;
+        mask >>= offset;
+        if (mask) {
+            size_t i = ctz32(mask);
+            return i < length ? i : length;
+        }
+
+        size_t scanned = 32 - offset;
+        while (scanned < length) {
+            p += 32;
+            mask = byteset_misses_avx2(_mm256_load_si256((const __m256i *) p), low, high, bits) ^ flip;
+            if (mask) {
+                size_t i = scanned + ctz32(mask);
+                return i < length ? i : length;
+            }
+            scanned += 32;
+        }
+        return length;
+    }
+#endif // MINICRT_X86_64
+} // namespace detail
+
+    // The public entry points forward to the kernels selected by cpu_init() (crt_cpu.cpp)
+
+    /**
+     * @brief Calculates the length of a string
+     */
+    size_t strlen(const char *str) {
+        size_t length = detail::g_dispatch.strlen(str);
+        MINICRT_STATS_RECORD(STATS_STRLEN, str, 0, length);
+        return length;
+    }
+
+    /**
+     * @brief Calculates the length of a string with a maximum limit
+     */
+    size_t strnlen(const char *str, size_t max_len) {
+        size_t length = detail::g_dispatch.strnlen(str, max_len);
+        MINICRT_STATS_RECORD(STATS_STRNLEN, str, 0, length);
+        return length;
+    }
+
     /**
      * @brief Copies a string to a destination buffer
      *
@@ -64,9 +1109,11 @@ MINICRT_BEGIN
      */
     char *strcpy(char *dest, const char *src) {
         char *d = dest;
+        const char *s = src;
 
         /* Copy characters until we encounter the null terminator */
-        while ((*d++ = *src++) != '\0');
+        while ((*d++ = *s++) != '\0');
+        MINICRT_STATS_RECORD(STATS_STRCPY, dest, src, (size_t) (d - dest - 1));
 
         /* Return the destination buffer */
         return dest;
@@ -74,22 +1121,395 @@ MINICRT_BEGIN
 
     /**
      * @brief Compares two strings lexicographically
-     *
-     * This function compares two strings character by character.
-     *
-     * @param lhs The first string
-     * @param rhs The second string
-     * @return <0 if lhs < rhs, 0 if lhs == rhs, >0 if lhs > rhs
      */
     int strcmp(const char *lhs, const char *rhs) {
-        /* Compare characters until we find a difference or reach the end */
-        while (*lhs && (*lhs == *rhs)) {
-            lhs++;
-            rhs++;
+        // The kernels return only the sign, so no length is at hand without another pass
+        MINICRT_STATS_RECORD(STATS_STRCMP, lhs, rhs, 0);
+        return detail::g_dispatch.strcmp(lhs, rhs);
+    }
+
+    /**
+     * @brief Find the first occurrence of a byte in a memory block
+     */
+    void *memchr(const void *ptr, int c, size_t count) {
+        MINICRT_STATS_RECORD(STATS_MEMCHR, ptr, 0, count);
+        return detail::g_dispatch.memchr(ptr, c, count);
+    }
+
+    /**
+     * @brief Find the last occurrence of a byte in a memory block
+     */
+    void *memrchr(const void *ptr, int c, size_t count) {
+        MINICRT_STATS_RECORD(STATS_MEMRCHR, ptr, 0, count);
+        return detail::g_dispatch.memrchr(ptr, c, count);
+    }
+
+    /**
+     * @brief Find a byte that is known to be present
+     */
+    void *rawmemchr(const void *ptr, int c) {
+        // The kernels read whole aligned blocks only, so an unbounded count is safe
+        void *found = detail::g_dispatch.memchr(ptr, c, ~(size_t) 0 - (size_t) ptr);
+        MINICRT_STATS_RECORD(STATS_RAWMEMCHR, ptr, 0, (size_t) ((const char *) found - (const char *) ptr) + 1);
+        return found;
+    }
+
+    /**
+     * @brief Find the first occurrence of a character in a string
+     */
+    char *strchr(const char *str, int c) {
+        char *found = detail::g_dispatch.strchr(str, c);
+        MINICRT_STATS_RECORD(STATS_STRCHR, str, 0, found ? (size_t) (found - str) + 1 : 0);
+        return found;
+    }
+
+    /**
+     * @brief Find the last occurrence of a character in a string
+     */
+    char *strrchr(const char *str, int c) {
+        char *found = detail::g_dispatch.strrchr(str, c);
+        MINICRT_STATS_RECORD(STATS_STRRCHR, str, 0, found ? (size_t) (found - str) + 1 : 0);
+        return found;
+    }
+
+    /**
+     * @brief Find a byte sequence in a memory block
+     */
+    void *memmem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len) {
+        MINICRT_STATS_RECORD(STATS_MEMMEM, haystack, needle, haystack_len);
+        if (needle_len == 0)
+            return (void *) haystack;
+        if (needle_len > haystack_len)
+            return 0;
+        if (needle_len == 1)
+            return detail::g_dispatch.memchr(haystack, *(const unsigned char *) needle, haystack_len);
+        return (void *) detail::g_dispatch.memmem((const char *) haystack, haystack_len, (const char *) needle,
+                                                  needle_len);
+    }
+
+    /**
+     * @brief Find a non-empty needle of known length in a string
+     *
+     * The haystack length is not known up front, and measuring all of it first would
+     * cost a full pass when the needle occurs early. The search instead runs memmem
+     * over windows found with strnlen, doubling in size up to kStrstrWindow; windows
+     * overlap by needle_len - 1 bytes so no occurrence is split.
+     */
+    static const char *strstr_search(const char *haystack, const char *needle, size_t needle_len) {
+        static const size_t kStrstrWindow = 1 << 20;
+
+        // Skip to the first candidate; a needle whose first character never occurs costs one strchr pass
+        haystack = detail::g_dispatch.strchr(haystack, *needle);
+        if (!haystack || needle_len == 1)
+            return haystack;
+
+        size_t size = needle_len > 1024 ? needle_len : 1024;
+        for (const char *window = haystack;;) {
+            size_t length = detail::g_dispatch.strnlen(window, needle_len + size);
+            if (length < needle_len)
+                return 0;
+            const char *found = detail::g_dispatch.memmem(window, length, needle, needle_len);
+            if (found)
+                return found;
+            if (length < needle_len + size)
+                return 0;
+            window += length - needle_len + 1;
+            if (size < kStrstrWindow)
+                size *= 2;
         }
+    }
 
-        /* Return the difference between the characters */
-        return (int) (unsigned char) *lhs - (int) (unsigned char) *rhs;
+    /**
+     * @brief Find a substring
+     */
+    char *strstr(const char *haystack, const char *needle) {
+        size_t needle_len = detail::g_dispatch.strlen(needle);
+        const char *found = needle_len ? strstr_search(haystack, needle, needle_len) : haystack;
+        MINICRT_STATS_RECORD(STATS_STRSTR, haystack, needle, found ? (size_t) (found - haystack) + needle_len : 0);
+        return (char *) found;
+    }
+
+    /**
+     * @brief Compile a set from the characters of a string
+     */
+    void byteset_init(byteset *set, const char *chars) {
+        detail::byteset_clear(set);
+        for (; *chars; chars++)
+            detail::byteset_add(set, (unsigned char) *chars);
+        detail::byteset_finish(set);
+    }
+
+    /**
+     * @brief Compile a set from an array of bytes
+     */
+    void byteset_init_bytes(byteset *set, const void *bytes, size_t count) {
+        const unsigned char *b = (const unsigned char *) bytes;
+        detail::byteset_clear(set);
+        for (size_t i = 0; i < count; i++)
+            detail::byteset_add(set, b[i]);
+        detail::byteset_finish(set);
+    }
+
+    /**
+     * @brief Test whether a byte is a member of a set
+     */
+    int byteset_contains(const byteset *set, int c) {
+        unsigned char b = (unsigned char) c;
+        return (int) ((set->bits[b >> 6] >> (b & 63)) & 1);
+    }
+
+    /**
+     * @brief Length of the initial segment of a string made of set members
+     */
+    size_t byteset_span(const byteset *set, const char *str) {
+        size_t length = detail::g_dispatch.byteset_scan(str, ~(size_t) 0 - (size_t) str, set, detail::kScanString);
+        MINICRT_STATS_RECORD(STATS_STRSPN, str, 0, length);
+        return length;
+    }
+
+    /**
+     * @brief Length of the initial segment of a string made of non-members
+     */
+    size_t byteset_cspan(const byteset *set, const char *str) {
+        size_t length = detail::g_dispatch.byteset_scan(str, ~(size_t) 0 - (size_t) str, set,
+                                                        detail::kScanString | detail::kScanReject);
+        MINICRT_STATS_RECORD(STATS_STRCSPN, str, 0, length);
+        return length;
+    }
+
+    /**
+     * @brief Length of the initial segment of a byte range made of set members
+     */
+    size_t byteset_nspan(const byteset *set, const char *str, size_t length) {
+        size_t span = detail::g_dispatch.byteset_scan(str, length, set, 0);
+        MINICRT_STATS_RECORD(STATS_STRSPN, str, 0, span);
+        return span;
+    }
+
+    /**
+     * @brief Length of the initial segment of a byte range made of non-members
+     */
+    size_t byteset_ncspan(const byteset *set, const char *str, size_t length) {
+        size_t span = detail::g_dispatch.byteset_scan(str, length, set, detail::kScanReject);
+        MINICRT_STATS_RECORD(STATS_STRCSPN, str, 0, span);
+        return span;
+    }
+
+    /**
+     * @brief Find the first set member in a string
+     */
+    char *byteset_pbrk(const byteset *set, const char *str) {
+        size_t span = detail::g_dispatch.byteset_scan(str, ~(size_t) 0 - (size_t) str, set,
+                                                      detail::kScanString | detail::kScanReject);
+        MINICRT_STATS_RECORD(STATS_STRPBRK, str, 0, span);
+        return str[span] ? (char *) str + span : 0;
+    }
+
+    /**
+     * @brief Split the next field off a string at a set member
+     */
+    char *byteset_sep(const byteset *set, char **stringp) {
+        char *field = *stringp;
+        if (!field)
+            return 0;
+
+        char *end = field + detail::g_dispatch.byteset_scan(field, ~(size_t) 0 - (size_t) field, set,
+                                                            detail::kScanString | detail::kScanReject);
+        MINICRT_STATS_RECORD(STATS_STRSEP, field, 0, (size_t) (end - field));
+        if (*end) {
+            *end = '\0';
+            *stringp = end + 1;
+        } else {
+            *stringp = 0;
+        }
+        return field;
+    }
+
+    /**
+     * @brief Find the next token of a string, skipping runs of set members
+     */
+    char *byteset_tok(const byteset *set, char *str, char **saveptr) {
+        if (!str)
+            str = *saveptr;
+
+        str += detail::g_dispatch.byteset_scan(str, ~(size_t) 0 - (size_t) str, set, detail::kScanString);
+        if (*str == '\0') {
+            *saveptr = str;
+            return 0;
+        }
+
+        char *end = str + detail::g_dispatch.byteset_scan(str, ~(size_t) 0 - (size_t) str, set,
+                                                          detail::kScanString | detail::kScanReject);
+        MINICRT_STATS_RECORD(STATS_STRTOK, str, 0, (size_t) (end - str));
+        if (*end) {
+            *end = '\0';
+            *saveptr = end + 1;
+        } else {
+            *saveptr = end;
+        }
+        return str;
+    }
+
+    /**
+     * @brief Find the first set member in a byte range
+     */
+    char *byteset_npbrk(const byteset *set, const char *str, size_t length) {
+        size_t span = detail::g_dispatch.byteset_scan(str, length, set, detail::kScanReject);
+        MINICRT_STATS_RECORD(STATS_STRPBRK, str, 0, span);
+        return span < length ? (char *) str + span : 0;
+    }
+
+    /**
+     * @brief Split the next field off a byte range at a set member
+     */
+    const char *byteset_nsep(const byteset *set, const char **stringp, size_t *length, size_t *field_length) {
+        const char *field = *stringp;
+        if (!field)
+            return 0;
+
+        size_t span = detail::g_dispatch.byteset_scan(field, *length, set, detail::kScanReject);
+        MINICRT_STATS_RECORD(STATS_STRSEP, field, 0, span);
+        *field_length = span;
+        if (span < *length) {
+            *stringp = field + span + 1;
+            *length -= span + 1;
+        } else {
+            *stringp = 0;
+            *length = 0;
+        }
+        return field;
+    }
+
+    /**
+     * @brief Find the next token of a byte range, skipping runs of set members
+     */
+    const char *byteset_ntok(const byteset *set, const char **saveptr, size_t *length, size_t *token_length) {
+        const char *str = *saveptr;
+        size_t left = *length;
+
+        size_t skip = detail::g_dispatch.byteset_scan(str, left, set, 0);
+        str += skip;
+        left -= skip;
+        if (left == 0) {
+            *saveptr = str;
+            *length = 0;
+            return 0;
+        }
+
+        size_t span = detail::g_dispatch.byteset_scan(str, left, set, detail::kScanReject);
+        MINICRT_STATS_RECORD(STATS_STRTOK, str, 0, span);
+        *token_length = span;
+        // Step over the delimiter that ended the token, if any
+        size_t used = span < left ? span + 1 : span;
+        *saveptr = str + used;
+        *length = left - used;
+        return str;
+    }
+
+    // The classic interfaces compile their set on every call
+
+    /**
+     * @brief Length of the initial segment of a string made of accepted characters
+     */
+    size_t strspn(const char *str, const char *accept) {
+        byteset set;
+        byteset_init(&set, accept);
+        return byteset_span(&set, str);
+    }
+
+    /**
+     * @brief Length of the initial segment of a string without rejected characters
+     */
+    size_t strcspn(const char *str, const char *reject) {
+        // A single delimiter needs no table
+        if (reject[0] == '\0' || reject[1] == '\0') {
+            const char *found = reject[0] ? detail::g_dispatch.strchr(str, reject[0]) : 0;
+            size_t length = found ? (size_t) (found - str) : detail::g_dispatch.strlen(str);
+            MINICRT_STATS_RECORD(STATS_STRCSPN, str, 0, length);
+            return length;
+        }
+
+        byteset set;
+        byteset_init(&set, reject);
+        return byteset_cspan(&set, str);
+    }
+
+    /**
+     * @brief Find the first occurrence of any of a set of characters
+     */
+    char *strpbrk(const char *str, const char *accept) {
+        if (accept[0] == '\0' || accept[1] == '\0') {
+            char *found = accept[0] ? detail::g_dispatch.strchr(str, accept[0]) : 0;
+            MINICRT_STATS_RECORD(STATS_STRPBRK, str, 0, found ? (size_t) (found - str) : 0);
+            return found;
+        }
+
+        byteset set;
+        byteset_init(&set, accept);
+        return byteset_pbrk(&set, str);
+    }
+
+    /**
+     * @brief Split the next field off a string at a delimiter
+     */
+    char *strsep(char **stringp, const char *delim) {
+        byteset set;
+        byteset_init(&set, delim);
+        return byteset_sep(&set, stringp);
+    }
+
+    /**
+     * @brief Find the next token of a string, skipping runs of delimiters
+     */
+    char *strtok_r(char *str, const char *delim, char **saveptr) {
+        byteset set;
+        byteset_init(&set, delim);
+        return byteset_tok(&set, str, saveptr);
+    }
+
+    /**
+     * @brief Length of the initial segment of a character range made of accepted characters
+     */
+    size_t strnspn(const char *str, size_t length, const char *accept) {
+        byteset set;
+        byteset_init(&set, accept);
+        return byteset_nspan(&set, str, length);
+    }
+
+    /**
+     * @brief Length of the initial segment of a character range without rejected characters
+     */
+    size_t strncspn(const char *str, size_t length, const char *reject) {
+        byteset set;
+        byteset_init(&set, reject);
+        return byteset_ncspan(&set, str, length);
+    }
+
+    /**
+     * @brief Find the first occurrence of any of a set of characters in a character range
+     */
+    char *strnpbrk(const char *str, size_t length, const char *accept) {
+        byteset set;
+        byteset_init(&set, accept);
+        return byteset_npbrk(&set, str, length);
+    }
+
+    /**
+     * @brief Split the next field off a character range at a delimiter
+     */
+    const char *strnsep(const char **stringp, size_t *length, const char *delim, size_t *field_length) {
+        byteset set;
+        byteset_init(&set, delim);
+        return byteset_nsep(&set, stringp, length, field_length);
+    }
+
+    /**
+     * @brief Find the next token of a character range, skipping runs of delimiters
+     */
+    const char *strntok_r(const char **saveptr, size_t *length, const char *delim, size_t *token_length) {
+        byteset set;
+        byteset_init(&set, delim);
+        return byteset_ntok(&set, saveptr, length, token_length);
     }
 
 MINICRT_END
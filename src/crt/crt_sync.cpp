@@ -0,0 +1,363 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/sync.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * The mutex follows "Futexes Are Tricky" (Drepper): the state is 0 when free, 1
+     * when held and 2 when held with possible sleepers. Locking is a compare-and-swap
+     * from 0 to 1 and unlocking a decrement; only when the decrement does not leave 0
+     * can a thread be asleep, so only then is FUTEX_WAKE called. A thread that gives
+     * up spinning swaps in 2 before it sleeps, and keeps 2 once it owns the lock,
+     * since it cannot know whether others are still waiting.
+     *
+     * Condition variable waiters sleep on a sequence number that every signal
+     * increments, so a signal between unlocking the mutex and going to sleep is not
+     * lost: the futex sees a different value and returns at once. Broadcast wakes
+     * one waiter and requeues the rest onto the mutex word. Threads return from a
+     * wait by locking the mutex in state 2, so each unlock along the chain wakes the
+     * next requeued thread.
+     *
+     * The rwlock packs everything into one word: the reader count (bits 0-19), the
+     * number of waiting writers (bits 20-29), the writer bit and a sleeper bit.
+     * Readers and writers sleep on the whole word; whoever clears the sleeper bit
+     * wakes them all and they re-evaluate. Readers do not enter while the waiting
+     * writer count is non-zero, which is what prefers writers.
+     */
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    static const long kFutexWait = 0;
+    static const long kFutexWake = 1;
+    static const long kFutexCmpRequeue = 4;
+    static const long kFutexPrivate = 128; // the word is not shared with other processes
+#endif
+
+    static const int kWakeAll = 0x7FFFFFFF;
+
+    // Spins before a contended mutex_lock() sleeps, at most
+    static const int kMutexMaxSpins = 100;
+
+    static const int kRwReaderMask = 0x000FFFFF;
+    static const int kRwWriterWaiting = 0x00100000;      // one waiting writer
+    static const int kRwWriterWaitingMask = 0x3FF00000;
+    static const int kRwWriter = 0x40000000;
+    static const int kRwSleepers = (int) 0x80000000u;
+
+    int futex_wait(volatile int *word, int expected, const timespec *timeout) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        long result = syscall4(NR_futex, (long) word, kFutexWait | kFutexPrivate, expected, (long) timeout);
+        return result == -kErrTimedOut ? -ETIMEDOUT : 0;
+#else
+        // No way to sleep on an address; let the caller spin
+        (void) word;
+        (void) expected;
+        (void) timeout;
+        cpu_relax();
+        return 0;
+#endif
+    }
+
+    void futex_wake(volatile int *word, int count) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        syscall3(NR_futex, (long) word, kFutexWake | kFutexPrivate, count);
+#else
+        (void) word;
+        (void) count;
+#endif
+    }
+
+    /**
+     * @brief Wake one thread on from and move the others to to, if *from still equals expected
+     *
+     * @return 0 on success, -1 if *from had changed and nothing was done
+     */
+    static int futex_requeue(volatile int *from, volatile int *to, int expected) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        long result = syscall6(NR_futex, (long) from, kFutexCmpRequeue | kFutexPrivate, 1, kWakeAll, (long) to,
+                               expected);
+        return syscall_failed(result) ? -1 : 0;
+#else
+        (void) from;
+        (void) to;
+        (void) expected;
+        return -1;
+#endif
+    }
+
+    static void mutex_lock_slow(mutex *m) {
+        // Spin while the lock tends to be released quickly; adapt to the spins that paid off
+        int max_spins = m->spins * 2 + 10;
+        if (max_spins > kMutexMaxSpins)
+            max_spins = kMutexMaxSpins;
+        for (int i = 0; i < max_spins; i++) {
+            cpu_relax();
+            if (atomic_load_int(&m->state) == 0 && atomic_cas_int(&m->state, 0, 1) == 0) {
+                m->spins += (i - m->spins) / 8;
+                return;
+            }
+        }
+        m->spins += (max_spins - m->spins) / 8;
+
+        // Announce a sleeper and wait until the swap finds the lock free
+        int c = atomic_exchange_int(&m->state, 2);
+        while (c != 0) {
+            futex_wait(&m->state, 2, NULL);
+            c = atomic_exchange_int(&m->state, 2);
+        }
+    }
+
+    // Lock after a wait; requeued threads may be sleeping on the mutex behind us
+    static void mutex_lock_contended(mutex *m) {
+        while (atomic_exchange_int(&m->state, 2) != 0)
+            futex_wait(&m->state, 2, NULL);
+    }
+
+    static int condvar_wait_until_woken(condvar *cv, mutex *m, const timespec *timeout) {
+        cv->m = m;
+        atomic_fetch_add_int(&cv->waiters, 1);
+        int sequence = atomic_load_int(&cv->sequence);
+        mutex_unlock(m);
+
+        int result = futex_wait(&cv->sequence, sequence, timeout);
+
+        atomic_fetch_add_int(&cv->waiters, -1);
+        mutex_lock_contended(m);
+        return result;
+    }
+
+    static void once_wait(once_flag *flag, int state) {
+        for (;;) {
+            if (state == 3)
+                return;
+            if (state == 1) {
+                state = atomic_cas_int(&flag->state, 1, 2);
+                if (state != 1)
+                    continue;
+                state = 2;
+            }
+            futex_wait(&flag->state, 2, NULL);
+            state = atomic_load_int(&flag->state);
+        }
+    }
+
+    /**
+     * @brief Sleep on the rwlock word, setting the sleeper bit first
+     *
+     * @return The state to re-evaluate
+     */
+    static int rwlock_sleep(rwlock *lock, int state) {
+        if (!(state & kRwSleepers)) {
+            int seen = atomic_cas_int(&lock->state, state, state | kRwSleepers);
+            if (seen != state)
+                return seen;
+            state |= kRwSleepers;
+        }
+        futex_wait(&lock->state, state, NULL);
+        return atomic_load_int(&lock->state);
+    }
+
+    // Clear the sleeper bit and wake everyone who was sleeping
+    static void rwlock_wake(rwlock *lock) {
+        int state = atomic_load_int(&lock->state);
+        while (state & kRwSleepers) {
+            int seen = atomic_cas_int(&lock->state, state, state & ~kRwSleepers);
+            if (seen == state) {
+                futex_wake(&lock->state, kWakeAll);
+                return;
+            }
+            state = seen;
+        }
+    }
+
+    static void rwlock_read_lock_slow(rwlock *lock, int state) {
+        for (;;) {
+            if (!(state & (kRwWriter | kRwWriterWaitingMask))) {
+                int seen = atomic_cas_int(&lock->state, state, state + 1);
+                if (seen == state)
+                    return;
+                state = seen;
+                continue;
+            }
+            state = rwlock_sleep(lock, state);
+        }
+    }
+
+    static void rwlock_write_lock_slow(rwlock *lock) {
+        // Registering as a waiting writer holds off new readers
+        int state = atomic_fetch_add_int(&lock->state, kRwWriterWaiting) + kRwWriterWaiting;
+        for (;;) {
+            if (!(state & (kRwWriter | kRwReaderMask))) {
+                int seen = atomic_cas_int(&lock->state, state, state - kRwWriterWaiting + kRwWriter);
+                if (seen == state)
+                    return;
+                state = seen;
+                continue;
+            }
+            state = rwlock_sleep(lock, state);
+        }
+    }
+} // namespace detail
+
+    /**
+     * @brief Initialize a mutex
+     */
+    void mutex_init(mutex *m) {
+        m->state = 0;
+        m->spins = 0;
+    }
+
+    /**
+     * @brief Acquire a mutex
+     */
+    void mutex_lock(mutex *m) {
+        if (MINICRT_LIKELY(detail::atomic_cas_int(&m->state, 0, 1) == 0))
+            return;
+        detail::mutex_lock_slow(m);
+    }
+
+    /**
+     * @brief Acquire a mutex if it is free
+     */
+    int mutex_trylock(mutex *m) {
+        return detail::atomic_cas_int(&m->state, 0, 1) == 0;
+    }
+
+    /**
+     * @brief Release a mutex
+     */
+    void mutex_unlock(mutex *m) {
+        if (MINICRT_LIKELY(detail::atomic_fetch_add_int(&m->state, -1) == 1))
+            return;
+
+        // The state was 2: somebody may be asleep
+        detail::atomic_store_int(&m->state, 0);
+        detail::futex_wake(&m->state, 1);
+    }
+
+    /**
+     * @brief Initialize a condition variable
+     */
+    void condvar_init(condvar *cv) {
+        cv->sequence = 0;
+        cv->waiters = 0;
+        cv->m = NULL;
+    }
+
+    /**
+     * @brief Wait for a signal
+     */
+    void condvar_wait(condvar *cv, mutex *m) {
+        detail::condvar_wait_until_woken(cv, m, NULL);
+    }
+
+    /**
+     * @brief Wait for a signal or a timeout
+     */
+    int condvar_timedwait(condvar *cv, mutex *m, const timespec *timeout) {
+        if (detail::condvar_wait_until_woken(cv, m, timeout) == -ETIMEDOUT) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Wake one waiter
+     */
+    void condvar_signal(condvar *cv) {
+        if (detail::atomic_load_int(&cv->waiters) == 0)
+            return;
+        detail::atomic_fetch_add_int(&cv->sequence, 1);
+        detail::futex_wake(&cv->sequence, 1);
+    }
+
+    /**
+     * @brief Wake all waiters, moving all but one onto the mutex
+     */
+    void condvar_broadcast(condvar *cv) {
+        if (detail::atomic_load_int(&cv->waiters) == 0)
+            return;
+        int sequence = detail::atomic_fetch_add_int(&cv->sequence, 1) + 1;
+        mutex *m = cv->m;
+        if (!m || detail::futex_requeue(&cv->sequence, &m->state, sequence) != 0)
+            detail::futex_wake(&cv->sequence, detail::kWakeAll);
+    }
+
+    /**
+     * @brief Run a function exactly once
+     */
+    void call_once(once_flag *flag, void (*fn)(void *), void *arg) {
+        if (MINICRT_LIKELY(detail::atomic_load_int(&flag->state) == 3))
+            return;
+
+        int state = detail::atomic_cas_int(&flag->state, 0, 1);
+        if (state != 0) {
+            detail::once_wait(flag, state);
+            return;
+        }
+
+        fn(arg);
+        if (detail::atomic_exchange_int(&flag->state, 3) == 2)
+            detail::futex_wake(&flag->state, detail::kWakeAll);
+    }
+
+    /**
+     * @brief Initialize a reader-writer lock
+     */
+    void rwlock_init(rwlock *lock) {
+        lock->state = 0;
+    }
+
+    /**
+     * @brief Acquire a read lock
+     */
+    void rwlock_read_lock(rwlock *lock) {
+        // Uncontended: no readers, no writers, so the state goes from 0 to 1
+        int state = detail::atomic_cas_int(&lock->state, 0, 1);
+        if (MINICRT_LIKELY(state == 0))
+            return;
+        detail::rwlock_read_lock_slow(lock, state);
+    }
+
+    /**
+     * @brief Release a read lock
+     */
+    void rwlock_read_unlock(rwlock *lock) {
+        int state = detail::atomic_fetch_add_int(&lock->state, -1);
+        if (MINICRT_UNLIKELY((state & detail::kRwSleepers) && (state & detail::kRwReaderMask) == 1))
+            detail::rwlock_wake(lock);
+    }
+
+    /**
+     * @brief Acquire a write lock
+     */
+    void rwlock_write_lock(rwlock *lock) {
+        if (MINICRT_LIKELY(detail::atomic_cas_int(&lock->state, 0, detail::kRwWriter) == 0))
+            return;
+        detail::rwlock_write_lock_slow(lock);
+    }
+
+    /**
+     * @brief Release a write lock
+     */
+    void rwlock_write_unlock(rwlock *lock) {
+        int state = detail::atomic_cas_int(&lock->state, detail::kRwWriter, 0);
+        if (MINICRT_LIKELY(state == detail::kRwWriter))
+            return;
+
+        // Waiting writers or sleepers: drop the writer bit, then wake any sleepers
+        for (;;) {
+            int seen = detail::atomic_cas_int(&lock->state, state, state & ~detail::kRwWriter);
+            if (seen == state)
+                break;
+            state = seen;
+        }
+        if (state & detail::kRwSleepers)
+            detail::rwlock_wake(lock);
+    }
+
+MINICRT_END
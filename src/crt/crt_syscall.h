@@ -0,0 +1,228 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#ifndef MINICRT_CRT_SYSCALL_H
+#define MINICRT_CRT_SYSCALL_H
+
+/**
+ * @file crt_syscall.h
+ * @brief Raw Linux x86-64 system calls used by the runtime (not installed)
+ *
+ * Every wrapper returns the raw kernel result: a non-negative value on success or
+ * -errno on failure. Callers translate failures into errno themselves.
+ */
+
+#include "minicrt/crt.h"
+
+#if defined(MINICRT_UNIX) && defined(MINICRT_X86_64)
+#define MINICRT_LINUX_SYSCALLS
+
+MINICRT_BEGIN
+namespace detail {
+    // System call numbers (arch/x86/entry/syscalls/syscall_64.tbl)
+    enum syscall_number {
+        NR_read = 0,
+        NR_write = 1,
+        NR_open = 2,
+        NR_close = 3,
+        NR_fstat = 5,
+        NR_mmap = 9,
+        NR_mprotect = 10,
+        NR_munmap = 11,
+        NR_mremap = 25,
+        NR_ioctl = 16,
+        NR_writev = 20,
+        NR_madvise = 28,
+        NR_getpid = 39,
+        NR_clone = 56,
+        NR_exit = 60,
+        NR_gettimeofday = 96,
+        NR_arch_prctl = 158,
+        NR_gettid = 186,
+        NR_futex = 202,
+        NR_sched_getaffinity = 204,
+        NR_clock_gettime = 228,
+        NR_exit_group = 231,
+        NR_io_uring_setup = 425,
+        NR_io_uring_enter = 426
+    };
+
+    // mmap/mremap/madvise arguments
+    static const long kProtNone = 0x0;
+    static const long kProtRead = 0x1;
+    static const long kProtWrite = 0x2;
+    static const long kMapShared = 0x01;
+    static const long kMapPrivate = 0x02;
+    static const long kMapFixed = 0x10;
+    static const long kMapAnonymous = 0x20;
+    static const long kMapNoReserve = 0x4000;
+    static const long kMapPopulate = 0x8000;
+    static const long kMapStack = 0x20000;
+    static const long kMapHugeTlb = 0x40000;
+    static const long kMapHuge2Mb = 21 << 26; // log2(2 MiB) << MAP_HUGE_SHIFT
+    static const long kMremapMayMove = 0x1;
+    static const long kMremapFixed = 0x2;
+    static const long kMadvNormal = 0;
+    static const long kMadvRandom = 1;
+    static const long kMadvSequential = 2;
+    static const long kMadvWillNeed = 3;
+    static const long kMadvDontNeed = 4;
+    static const long kMadvFree = 8;
+    static const long kMadvHugePage = 14;
+
+    // open flags
+    static const long kOpenReadOnly = 0;
+    static const long kOpenCloseOnExec = 0x80000;
+
+    // struct stat as filled in by fstat on x86-64
+    struct kernel_stat {
+        unsigned long st_dev;
+        unsigned long st_ino;
+        unsigned long st_nlink;
+        unsigned int st_mode;
+        unsigned int st_uid;
+        unsigned int st_gid;
+        int pad0;
+        unsigned long st_rdev;
+        long st_size;
+        long st_blksize;
+        long st_blocks;
+        unsigned long st_atime_sec;
+        unsigned long st_atime_nsec;
+        unsigned long st_mtime_sec;
+        unsigned long st_mtime_nsec;
+        unsigned long st_ctime_sec;
+        unsigned long st_ctime_nsec;
+        long unused[3];
+    };
+
+    static const unsigned int kStatTypeMask = 0170000;
+    static const unsigned int kStatRegular = 0100000;
+
+    // ioctl requests
+    static const long kTcGets = 0x5401;
+
+    // Error numbers returned (negated) by the kernel
+    static const long kErrIntr = 4;
+    static const long kErrAgain = 11;
+    static const long kErrNoMem = 12;
+    static const long kErrInval = 22;
+    static const long kErrTimedOut = 110;
+
+    MINICRT_INLINE long syscall0(long n) {
+        long ret;
+        asm volatile("syscall" : "=a" (ret) : "a" (n) : "rcx", "r11", "memory");
+        return ret;
+    }
+
+    MINICRT_INLINE long syscall1(long n, long a1) {
+        long ret;
+        asm volatile("syscall" : "=a" (ret) : "a" (n), "D" (a1) : "rcx", "r11", "memory");
+        return ret;
+    }
+
+    MINICRT_INLINE long syscall2(long n, long a1, long a2) {
+        long ret;
+        asm volatile("syscall" : "=a" (ret) : "a" (n), "D" (a1), "S" (a2) : "rcx", "r11", "memory");
+        return ret;
+    }
+
+    MINICRT_INLINE long syscall3(long n, long a1, long a2, long a3) {
+        long ret;
+        asm volatile("syscall" : "=a" (ret) : "a" (n), "D" (a1), "S" (a2), "d" (a3) : "rcx", "r11", "memory");
+        return ret;
+    }
+
+    MINICRT_INLINE long syscall4(long n, long a1, long a2, long a3, long a4) {
+        long ret;
+        register long r10 asm("r10") = a4;
+        asm volatile("syscall"
+            : "=a" (ret)
+            : "a" (n), "D" (a1), "S" (a2), "d" (a3), "r" (r10)
+            : "rcx", "r11", "memory");
+        return ret;
+    }
+
+    MINICRT_INLINE long syscall5(long n, long a1, long a2, long a3, long a4, long a5) {
+        long ret;
+        register long r10 asm("r10") = a4;
+        register long r8 asm("r8") = a5;
+        asm volatile("syscall"
+            : "=a" (ret)
+            : "a" (n), "D" (a1), "S" (a2), "d" (a3), "r" (r10), "r" (r8)
+            : "rcx", "r11", "memory");
+        return ret;
+    }
+
+    MINICRT_INLINE long syscall6(long n, long a1, long a2, long a3, long a4, long a5, long a6) {
+        long ret;
+        register long r10 asm("r10") = a4;
+        register long r8 asm("r8") = a5;
+        register long r9 asm("r9") = a6;
+        asm volatile("syscall"
+            : "=a" (ret)
+            : "a" (n), "D" (a1), "S" (a2), "d" (a3), "r" (r10), "r" (r8), "r" (r9)
+            : "rcx", "r11", "memory");
+        return ret;
+    }
+
+    // True for the -4095..-1 range the kernel uses to report errors
+    MINICRT_INLINE int syscall_failed(long ret) {
+        return (unsigned long) ret > (unsigned long) -4096L;
+    }
+
+    MINICRT_INLINE long sys_open(const char *path, long flags, long mode) {
+        return syscall3(NR_open, (long) path, flags, mode);
+    }
+
+    MINICRT_INLINE long sys_read(int fd, void *buf, size_t count) {
+        return syscall3(NR_read, fd, (long) buf, (long) count);
+    }
+
+    MINICRT_INLINE long sys_close(int fd) {
+        return syscall1(NR_close, fd);
+    }
+
+    MINICRT_INLINE long sys_fstat(int fd, kernel_stat *st) {
+        return syscall2(NR_fstat, fd, (long) st);
+    }
+
+    MINICRT_INLINE long sys_write(int fd, const void *buf, size_t count) {
+        return syscall3(NR_write, fd, (long) buf, (long) count);
+    }
+
+    // vec points to an array of struct iovec compatible records
+    MINICRT_INLINE long sys_writev(int fd, const void *vec, int count) {
+        return syscall3(NR_writev, fd, (long) vec, count);
+    }
+
+    MINICRT_INLINE long sys_ioctl(int fd, unsigned long request, void *arg) {
+        return syscall3(NR_ioctl, fd, (long) request, (long) arg);
+    }
+
+    MINICRT_INLINE void *sys_mmap(void *addr, size_t length, long prot, long flags, int fd, long offset) {
+        return (void *) syscall6(NR_mmap, (long) addr, (long) length, prot, flags, fd, offset);
+    }
+
+    MINICRT_INLINE long sys_munmap(void *addr, size_t length) {
+        return syscall2(NR_munmap, (long) addr, (long) length);
+    }
+
+    MINICRT_INLINE long sys_mprotect(void *addr, size_t length, long prot) {
+        return syscall3(NR_mprotect, (long) addr, (long) length, prot);
+    }
+
+    MINICRT_INLINE void *sys_mremap(void *old_addr, size_t old_size, size_t new_size, long flags, void *new_addr) {
+        return (void *) syscall5(NR_mremap, (long) old_addr, (long) old_size, (long) new_size, flags, (long) new_addr);
+    }
+
+    MINICRT_INLINE long sys_madvise(void *addr, size_t length, long advice) {
+        return syscall3(NR_madvise, (long) addr, (long) length, advice);
+    }
+} // namespace detail
+MINICRT_END
+
+#endif // MINICRT_UNIX && MINICRT_X86_64
+
+#endif // MINICRT_CRT_SYSCALL_H
@@ -0,0 +1,376 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/thread.h"
+#include "minicrt/memory.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+#if __STDC_HOSTED__ && defined(MINICRT_UNIX)
+#include <pthread.h>
+#define MINICRT_HOSTED_THREADS
+#endif
+
+MINICRT_BEGIN
+    struct thread {
+        thread *self;         // the word at the thread pointer points to itself
+        volatile int tid;     // kernel thread id, cleared and futex-woken by the kernel at exit
+        int result;
+        thread_start start;
+        void *arg;
+        void *map;            // mapping holding the stack, TLS block and this structure
+        size_t map_size;
+        thread *next;         // stack cache link
+#ifdef MINICRT_HOSTED_THREADS
+        pthread_t handle;
+#endif
+    };
+
+namespace detail {
+    /*
+     * A thread lives in a single mapping, from low to high addresses:
+     *
+     *   [guard page][stack, growing down][TLS block][struct thread]
+     *                                               ^ thread pointer (%fs base)
+     *
+     * This is the x86-64 TLS layout ("variant II"): the linker resolves every
+     * thread_local of the executable to a fixed negative offset from the thread
+     * pointer, and the first word at the thread pointer holds its own address. The
+     * TLS block is a fresh copy of the PT_TLS segment: the initialized bytes from the
+     * file, then zeroes. thread_init() builds the main thread's block the same way,
+     * in a static buffer when it fits, and points %fs at it with arch_prctl.
+     *
+     * The kernel sets and clears tid (CLONE_PARENT_SETTID, CLONE_CHILD_CLEARTID) and
+     * wakes the futex on it when the thread has exited, which is what thread_join()
+     * waits for. That wakeup is a shared futex, so the wait must not be private.
+     * Afterwards the whole mapping goes to a small cache, and the next thread of the
+     * same stack size only needs a new TLS copy and the clone call.
+     */
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    static const long kCloneVm = 0x100;
+    static const long kCloneFs = 0x200;
+    static const long kCloneFiles = 0x400;
+    static const long kCloneSighand = 0x800;
+    static const long kCloneThread = 0x10000;
+    static const long kCloneSysvsem = 0x40000;
+    static const long kCloneSettls = 0x80000;
+    static const long kCloneParentSettid = 0x100000;
+    static const long kCloneChildCleartid = 0x200000;
+    static const long kCloneFlags = kCloneVm | kCloneFs | kCloneFiles | kCloneSighand | kCloneThread |
+                                    kCloneSysvsem | kCloneSettls | kCloneParentSettid | kCloneChildCleartid;
+
+    static const long kArchSetFs = 0x1002;
+    static const long kFutexWait = 0;
+
+    static const unsigned int kPtPhdr = 6;
+    static const unsigned int kPtTls = 7;
+
+    // Thread pointers are at least cache-line aligned
+    static const size_t kThreadAlign = 64;
+
+    // Mappings of joined threads kept for reuse, at most
+    static const int kMaxCachedStacks = 16;
+
+    struct tls_template {
+        const unsigned char *image; // initialized part of the segment
+        size_t file_size;
+        size_t mem_size;
+        size_t offset;              // from the start of the block to the thread pointer
+        size_t align;               // of the thread pointer
+    };
+
+    static tls_template g_tls = {NULL, 0, 0, 0, kThreadAlign};
+    static int g_tls_installed = 0; // thread_init() owns the thread pointer: create threads with clone
+
+    static spinlock g_stack_lock;
+    static thread *g_stack_cache = NULL;
+    static int g_stack_cache_count = 0;
+
+    // The main thread's TLS block, unless the program's thread_local data needs more
+    static unsigned char g_main_tls[1024];
+
+    /**
+     * @brief Find the PT_TLS segment of the executable
+     */
+    static void tls_find_template(void) {
+        // The kernel's ELF loader always supplies these two
+        const elf64_phdr *segments = (const elf64_phdr *) getauxval(AT_PHDR);
+        size_t count = getauxval(AT_PHNUM);
+        size_t bias = 0;
+        const elf64_phdr *tls = NULL;
+        for (size_t i = 0; segments && i < count; i++) {
+            if (segments[i].p_type == kPtPhdr)
+                bias = (size_t) segments - (size_t) segments[i].p_vaddr;
+            else if (segments[i].p_type == kPtTls)
+                tls = &segments[i];
+        }
+        if (!tls)
+            return;
+
+        size_t align = tls->p_align ? (size_t) tls->p_align : 1;
+        if (align > g_tls.align)
+            g_tls.align = align;
+        g_tls.image = (const unsigned char *) (bias + (size_t) tls->p_vaddr);
+        g_tls.file_size = (size_t) tls->p_filesz;
+        g_tls.mem_size = (size_t) tls->p_memsz;
+        // Keep the segment's alignment relative to the thread pointer
+        g_tls.offset = g_tls.mem_size + ((0 - g_tls.mem_size - (size_t) g_tls.image) & (align - 1));
+    }
+
+    // Bytes the TLS block and struct thread need, including room to align the thread pointer
+    static size_t tls_area_size(void) {
+        return g_tls.offset + sizeof(thread) + g_tls.align;
+    }
+
+    /**
+     * @brief Build a TLS block at the top of [area, area + size)
+     *
+     * @return The thread pointer, with self set; the other fields are untouched
+     */
+    static thread *tls_build(unsigned char *area, size_t size) {
+        size_t pointer = ((size_t) area + size - sizeof(thread)) & ~(g_tls.align - 1);
+        unsigned char *block = (unsigned char *) pointer - g_tls.offset;
+        memcpy(block, g_tls.image, g_tls.file_size);
+        memset(block + g_tls.file_size, 0, g_tls.mem_size - g_tls.file_size);
+
+        thread *t = (thread *) pointer;
+        t->self = t;
+        return t;
+    }
+
+    /**
+     * @brief Take a cached thread mapping of the given size
+     */
+    static thread *stack_acquire(size_t map_size) {
+        spin_lock(&g_stack_lock);
+        thread **link = &g_stack_cache;
+        while (*link && (*link)->map_size != map_size)
+            link = &(*link)->next;
+        thread *t = *link;
+        if (t) {
+            *link = t->next;
+            g_stack_cache_count--;
+        }
+        spin_unlock(&g_stack_lock);
+        return t;
+    }
+
+    /**
+     * @brief Cache the mapping of a finished thread, or unmap it if the cache is full
+     */
+    static void stack_release(thread *t) {
+        spin_lock(&g_stack_lock);
+        if (g_stack_cache_count < kMaxCachedStacks) {
+            t->next = g_stack_cache;
+            g_stack_cache = t;
+            g_stack_cache_count++;
+            spin_unlock(&g_stack_lock);
+            return;
+        }
+        spin_unlock(&g_stack_lock);
+        sys_munmap(t->map, t->map_size);
+    }
+#endif
+
+    void thread_init(void) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        tls_find_template();
+
+        unsigned char *area = g_main_tls;
+        size_t size = sizeof(g_main_tls);
+        if (tls_area_size() > size) {
+            size = (tls_area_size() + page_size() - 1) & ~(page_size() - 1);
+            area = (unsigned char *) sys_mmap(0, size, kProtRead | kProtWrite, kMapPrivate | kMapAnonymous, -1, 0);
+            // Nothing can run without errno, and errno needs the thread pointer
+            if (syscall_failed((long) area))
+                syscall1(NR_exit_group, 127);
+        }
+
+        thread *t = tls_build(area, size);
+        t->tid = (int) syscall0(NR_gettid);
+        syscall2(NR_arch_prctl, kArchSetFs, (long) t);
+        g_tls_installed = 1;
+        g_thread_pointer_ready = 1;
+#endif
+    }
+} // namespace detail
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    // Assembly half of thread_create() below: the clone call and the child's first frame
+    extern "C" long minicrt_thread_clone(long flags, void *stack, volatile int *parent_tid,
+                                         volatile int *child_tid, void *tls);
+
+    /**
+     * @brief First C function of a cloned thread
+     *
+     * Runs on the new stack with the thread pointer already installed, so the thread
+     * finds its struct thread at %fs:0.
+     */
+    extern "C" __attribute__((noreturn, used)) void minicrt_thread_start(void) {
+        thread *self;
+        asm volatile("movq %%fs:0, %0" : "=r" (self));
+
+        int result = self->start(self->arg);
+
+        // Give the allocator cache and statistics shard to the next thread
+        detail::heap_thread_exit();
+        detail::stats_thread_exit();
+        self->result = result;
+
+        // Ends only this thread; the kernel then clears tid and wakes thread_join()
+        for (;;)
+            detail::syscall1(detail::NR_exit, 0);
+    }
+#endif
+
+#ifdef MINICRT_HOSTED_THREADS
+namespace detail {
+    static void *hosted_thread_start(void *arg) {
+        thread *t = (thread *) arg;
+        t->result = t->start(t->arg);
+        return NULL;
+    }
+} // namespace detail
+#endif
+
+    /**
+     * @brief Start a new thread
+     */
+    int thread_create(thread **out, thread_start start, void *arg, size_t stack_size) {
+        if (!out || !start) {
+            errno = EINVAL;
+            return -1;
+        }
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (detail::g_tls_installed) {
+            size_t page = detail::page_size();
+            size_t stack = stack_size ? (stack_size + page - 1) & ~(page - 1) : THREAD_DEFAULT_STACK_SIZE;
+            size_t map_size = page + stack + ((detail::tls_area_size() + 16 + page - 1) & ~(page - 1));
+
+            thread *t = detail::stack_acquire(map_size);
+            unsigned char *map = t ? (unsigned char *) t->map : NULL;
+            if (!map) {
+                map = (unsigned char *) detail::sys_mmap(0, map_size, detail::kProtRead | detail::kProtWrite,
+                                                         detail::kMapPrivate | detail::kMapAnonymous |
+                                                         detail::kMapStack, -1, 0);
+                if (detail::syscall_failed((long) map)) {
+                    errno = (int) -(long) map;
+                    return -1;
+                }
+                // The lowest page turns a stack overflow into a fault
+                long result = detail::sys_mprotect(map, page, detail::kProtNone);
+                if (detail::syscall_failed(result)) {
+                    detail::sys_munmap(map, map_size);
+                    errno = (int) -result;
+                    return -1;
+                }
+            }
+
+            t = detail::tls_build(map, map_size);
+            t->map = map;
+            t->map_size = map_size;
+            t->start = start;
+            t->arg = arg;
+            t->result = 0;
+
+            void *stack_top = (void *) (((size_t) t - detail::g_tls.offset) & ~(size_t) 15);
+            long tid = minicrt_thread_clone(detail::kCloneFlags, stack_top, &t->tid, &t->tid, t);
+            if (detail::syscall_failed(tid)) {
+                detail::stack_release(t);
+                errno = (int) -tid;
+                return -1;
+            }
+            *out = t;
+            return 0;
+        }
+#endif
+
+#ifdef MINICRT_HOSTED_THREADS
+        thread *t = (thread *) malloc(sizeof(thread));
+        if (!t) {
+            errno = ENOMEM;
+            return -1;
+        }
+        t->map = NULL;
+        t->start = start;
+        t->arg = arg;
+        t->result = 0;
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        int rc = stack_size ? pthread_attr_setstacksize(&attr, stack_size) : 0;
+        if (rc == 0)
+            rc = pthread_create(&t->handle, &attr, detail::hosted_thread_start, t);
+        pthread_attr_destroy(&attr);
+        if (rc != 0) {
+            free(t);
+            errno = rc;
+            return -1;
+        }
+        *out = t;
+        return 0;
+#else
+        (void) arg;
+        (void) stack_size;
+        errno = ENOSYS;
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Wait for a thread to finish and release it
+     */
+    int thread_join(thread *t, int *result) {
+        if (!t) {
+            errno = EINVAL;
+            return -1;
+        }
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (t->map) {
+            int tid;
+            while ((tid = detail::atomic_load_int(&t->tid)) != 0)
+                detail::syscall4(detail::NR_futex, (long) &t->tid, detail::kFutexWait, tid, 0);
+            if (result)
+                *result = t->result;
+            detail::stack_release(t);
+            return 0;
+        }
+#endif
+
+#ifdef MINICRT_HOSTED_THREADS
+        pthread_join(t->handle, NULL);
+        if (result)
+            *result = t->result;
+        free(t);
+#endif
+        return 0;
+    }
+
+MINICRT_END
+
+#ifdef MINICRT_LINUX_SYSCALLS
+/*
+ * clone(flags, stack, parent_tid, child_tid, tls) with the fourth argument moved to
+ * %r10 for the system call. The parent returns the new thread id or -errno. The
+ * child wakes up on its new stack with nothing to return to: like _start, it clears
+ * %rbp to end frame-pointer walks and calls minicrt_thread_start, which never
+ * returns. The stack is 16-byte aligned, so the call leaves the ABI's alignment.
+ */
+asm(".text\n"
+    ".globl minicrt_thread_clone\n"
+    ".type minicrt_thread_clone, @function\n"
+    "minicrt_thread_clone:\n"
+    "    movq %rcx, %r10\n"
+    "    movl $56, %eax\n"
+    "    syscall\n"
+    "    testq %rax, %rax\n"
+    "    jnz 1f\n"
+    "    xorl %ebp, %ebp\n"
+    "    call minicrt_thread_start\n"
+    "    hlt\n"
+    "1:  ret\n"
+    ".size minicrt_thread_clone, . - minicrt_thread_clone\n");
+#endif
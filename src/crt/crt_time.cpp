@@ -0,0 +1,447 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/time.h"
+#include "minicrt/cpu.h"
+#include "minicrt/string.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * Linux maps a small shared object, the vDSO, into every process and passes its
+     * address as AT_SYSINFO_EHDR. Its clock functions read the kernel's timekeeping
+     * page and the TSC directly, so a clock read costs a few tens of nanoseconds
+     * instead of a system call. time_init() walks just enough of the ELF image to find
+     * them: the dynamic section gives the symbol, string, hash and version tables, and
+     * the symbols are scanned linearly (there are only a few dozen).
+     *
+     * The TSC timer converts ticks with a 32.32 fixed-point multiplier. The reference
+     * pair (TSC, CLOCK_MONOTONIC) is recorded by time_init(); the rate is computed on
+     * first use, so startup does not wait for a measurement interval to pass.
+     */
+
+    // ------------------------------------------------------------------ vDSO
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    struct elf64_ehdr {
+        unsigned char e_ident[16];
+        unsigned short e_type;
+        unsigned short e_machine;
+        unsigned int e_version;
+        unsigned long long e_entry;
+        unsigned long long e_phoff;
+        unsigned long long e_shoff;
+        unsigned int e_flags;
+        unsigned short e_ehsize;
+        unsigned short e_phentsize;
+        unsigned short e_phnum;
+        unsigned short e_shentsize;
+        unsigned short e_shnum;
+        unsigned short e_shstrndx;
+    };
+
+    struct elf64_dyn {
+        long long d_tag;
+        unsigned long long d_val;
+    };
+
+    struct elf64_sym {
+        unsigned int st_name;
+        unsigned char st_info;
+        unsigned char st_other;
+        unsigned short st_shndx;
+        unsigned long long st_value;
+        unsigned long long st_size;
+    };
+
+    struct elf64_verdef {
+        unsigned short vd_version;
+        unsigned short vd_flags;
+        unsigned short vd_ndx;
+        unsigned short vd_cnt;
+        unsigned int vd_hash;
+        unsigned int vd_aux;
+        unsigned int vd_next;
+    };
+
+    struct elf64_verdaux {
+        unsigned int vda_name;
+        unsigned int vda_next;
+    };
+
+    static const unsigned int kPtLoad = 1;
+    static const unsigned int kPtDynamic = 2;
+    static const long long kDtNull = 0;
+    static const long long kDtHash = 4;
+    static const long long kDtStrtab = 5;
+    static const long long kDtSymtab = 6;
+    static const long long kDtGnuHash = 0x6FFFFEF5;
+    static const long long kDtVersym = 0x6FFFFFF0;
+    static const long long kDtVerdef = 0x6FFFFFFC;
+    static const unsigned short kVerFlagBase = 1;
+    static const unsigned char kSttFunc = 2;
+    static const unsigned char kStbGlobal = 1;
+    static const unsigned char kStbWeak = 2;
+
+    // Version the x86-64 kernel gives its clock functions
+    static const char kVdsoVersion[] = "LINUX_2.6";
+
+    struct vdso_image {
+        unsigned long long bias; // added to a virtual address in the image to get a pointer
+        const elf64_sym *symbols;
+        size_t symbol_count;
+        const char *strings;
+        const unsigned short *versions;
+        const elf64_verdef *definitions;
+    };
+
+    /**
+     * @brief Count the symbols of a GNU-style hash table
+     *
+     * The table has no count field: the last symbol is the end of the chain that
+     * starts at the highest bucket.
+     */
+    static size_t gnu_hash_symbol_count(const unsigned int *table) {
+        unsigned int bucket_count = table[0];
+        unsigned int first = table[1];
+        unsigned int bloom_words = table[2];
+        const unsigned int *buckets = table + 4 + bloom_words * 2; // 64-bit bloom words
+        const unsigned int *chains = buckets + bucket_count;
+
+        unsigned int last = 0;
+        for (unsigned int i = 0; i < bucket_count; i++) {
+            if (buckets[i] > last)
+                last = buckets[i];
+        }
+        if (last < first)
+            return first;
+        while (!(chains[last - first] & 1))
+            last++;
+        return (size_t) last + 1;
+    }
+
+    /**
+     * @brief Locate the dynamic symbol tables of the vDSO
+     */
+    static int parse_vdso(const unsigned char *base, vdso_image *image) {
+        const elf64_ehdr *header = (const elf64_ehdr *) base;
+        if (base[0] != 0x7F || base[1] != 'E' || base[2] != 'L' || base[3] != 'F' || base[4] != 2 /* 64-bit */)
+            return 0;
+        if (header->e_phentsize != sizeof(elf64_phdr))
+            return 0;
+
+        const elf64_phdr *segments = (const elf64_phdr *) (base + header->e_phoff);
+        const elf64_dyn *dynamic = NULL;
+        int found_load = 0;
+        for (unsigned int i = 0; i < header->e_phnum; i++) {
+            if (segments[i].p_type == kPtLoad && !found_load) {
+                image->bias = (unsigned long long) base + segments[i].p_offset - segments[i].p_vaddr;
+                found_load = 1;
+            } else if (segments[i].p_type == kPtDynamic) {
+                dynamic = (const elf64_dyn *) (base + segments[i].p_offset);
+            }
+        }
+        if (!found_load || !dynamic)
+            return 0;
+
+        const unsigned int *hash = NULL;
+        const unsigned int *gnu_hash = NULL;
+        image->symbols = NULL;
+        image->strings = NULL;
+        image->versions = NULL;
+        image->definitions = NULL;
+        for (const elf64_dyn *entry = dynamic; entry->d_tag != kDtNull; entry++) {
+            const void *address = (const void *) (entry->d_val + image->bias);
+            switch (entry->d_tag) {
+                case kDtHash: hash = (const unsigned int *) address; break;
+                case kDtGnuHash: gnu_hash = (const unsigned int *) address; break;
+                case kDtStrtab: image->strings = (const char *) address; break;
+                case kDtSymtab: image->symbols = (const elf64_sym *) address; break;
+                case kDtVersym: image->versions = (const unsigned short *) address; break;
+                case kDtVerdef: image->definitions = (const elf64_verdef *) address; break;
+                default: break;
+            }
+        }
+        if (!image->symbols || !image->strings || (!hash && !gnu_hash))
+            return 0;
+
+        // Classic hash tables store the symbol count as the chain length
+        image->symbol_count = hash ? hash[1] : gnu_hash_symbol_count(gnu_hash);
+
+        // Without both version tables, symbols are matched by name alone
+        if (!image->versions || !image->definitions) {
+            image->versions = NULL;
+            image->definitions = NULL;
+        }
+        return 1;
+    }
+
+    /**
+     * @brief Check that a symbol belongs to the version the clock functions use
+     */
+    static int vdso_version_matches(const vdso_image *image, size_t index) {
+        if (!image->versions)
+            return 1;
+
+        unsigned short version = image->versions[index] & 0x7FFF;
+        const elf64_verdef *definition = image->definitions;
+        for (;;) {
+            if (!(definition->vd_flags & kVerFlagBase) && definition->vd_ndx == version) {
+                const elf64_verdaux *aux = (const elf64_verdaux *) ((const char *) definition + definition->vd_aux);
+                return strcmp(image->strings + aux->vda_name, kVdsoVersion) == 0;
+            }
+            if (!definition->vd_next)
+                return 0;
+            definition = (const elf64_verdef *) ((const char *) definition + definition->vd_next);
+        }
+    }
+
+    /**
+     * @brief Find a function exported by the vDSO
+     */
+    static void *vdso_lookup(const vdso_image *image, const char *name) {
+        for (size_t i = 0; i < image->symbol_count; i++) {
+            const elf64_sym *symbol = &image->symbols[i];
+            unsigned char binding = symbol->st_info >> 4;
+            if ((symbol->st_info & 0xF) != kSttFunc || (binding != kStbGlobal && binding != kStbWeak))
+                continue;
+            if (symbol->st_shndx == 0) // undefined
+                continue;
+            if (strcmp(image->strings + symbol->st_name, name) != 0)
+                continue;
+            if (!vdso_version_matches(image, i))
+                continue;
+            return (void *) (symbol->st_value + image->bias);
+        }
+        return NULL;
+    }
+#endif
+
+    // vDSO entry points; they return 0 or -errno like the system calls
+    typedef long (*clock_gettime_func)(long clock_id, timespec *ts);
+    typedef long (*gettimeofday_func)(timeval *tv, void *tz);
+
+    static clock_gettime_func g_vdso_clock_gettime = NULL;
+    static gettimeofday_func g_vdso_gettimeofday = NULL;
+    static int g_time_initialized = 0;
+
+    // ------------------------------------------------------------------ TSC
+
+    // The rate is measured over at least this long when CPUID does not report it
+    static const unsigned long long kCalibrationNs = 2000000;
+
+    static unsigned long long g_reference_tsc = 0;
+    static unsigned long long g_reference_ns = 0;
+    static spinlock g_tsc_lock = {0};
+    static volatile int g_tsc_calibrated = 0;
+    static unsigned long long g_tsc_hz = 0;
+    static unsigned long long g_ns_per_tick = 0; // 32.32 fixed point
+
+    static unsigned long long monotonic_ns(void) {
+        timespec ts;
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+            return 0;
+        return (unsigned long long) ts.tv_sec * 1000000000ull + (unsigned long long) ts.tv_nsec;
+    }
+
+    /**
+     * @brief Read the TSC and CLOCK_MONOTONIC as close together as possible
+     *
+     * The clock read is bracketed by two TSC reads; the attempt with the tightest
+     * bracket wins and its midpoint is paired with the clock.
+     */
+    static void sample_clocks(unsigned long long *tsc, unsigned long long *ns) {
+        unsigned long long best = ~0ull;
+        for (int i = 0; i < 5; i++) {
+            unsigned long long before = tsc_read_ordered();
+            unsigned long long now = monotonic_ns();
+            unsigned long long after = tsc_read_ordered();
+            if (after - before < best) {
+                best = after - before;
+                *tsc = before + (after - before) / 2;
+                *ns = now;
+            }
+        }
+    }
+
+    /**
+     * @brief TSC rate from CPUID leaf 0x15 (crystal clock and TSC ratio), or 0
+     */
+    static unsigned long long cpuid_tsc_hz(void) {
+#ifdef MINICRT_X86_64
+        unsigned int regs[4];
+        cpuid(0, 0, regs);
+        if (regs[0] < 0x15)
+            return 0;
+        cpuid(0x15, 0, regs);
+        if (regs[0] == 0 || regs[1] == 0 || regs[2] == 0)
+            return 0;
+        return (unsigned long long) regs[2] * regs[1] / regs[0];
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Work out the TSC rate once
+     */
+    static void calibrate_tsc(void) {
+        spin_lock(&g_tsc_lock);
+        if (!g_tsc_calibrated) {
+            unsigned long long hz = 0;
+            if (cpu_has(CPU_FEATURE_INVARIANT_TSC)) {
+                hz = cpuid_tsc_hz();
+                if (hz == 0) {
+                    if (g_reference_ns == 0)
+                        sample_clocks(&g_reference_tsc, &g_reference_ns);
+
+                    unsigned long long tsc, ns;
+                    do {
+                        sample_clocks(&tsc, &ns);
+                    } while (ns != 0 && ns - g_reference_ns < kCalibrationNs);
+
+                    if (ns > g_reference_ns && tsc > g_reference_tsc)
+                        hz = (unsigned long long) ((double) (tsc - g_reference_tsc) * 1e9 / (double) (ns - g_reference_ns));
+                }
+            }
+
+            g_tsc_hz = hz;
+            g_ns_per_tick = hz ? (unsigned long long) (1e9 * 4294967296.0 / (double) hz) : 0;
+            atomic_store_int(&g_tsc_calibrated, 1);
+        }
+        spin_unlock(&g_tsc_lock);
+    }
+
+    void time_init(void) {
+        if (g_time_initialized)
+            return;
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        const unsigned char *base = (const unsigned char *) getauxval(AT_SYSINFO_EHDR);
+        vdso_image image;
+        if (base && parse_vdso(base, &image)) {
+            g_vdso_clock_gettime = (clock_gettime_func) vdso_lookup(&image, "__vdso_clock_gettime");
+            g_vdso_gettimeofday = (gettimeofday_func) vdso_lookup(&image, "__vdso_gettimeofday");
+        }
+#endif
+        g_time_initialized = 1;
+
+        // Reference point for measuring the TSC rate later
+        if (cpu_has(CPU_FEATURE_INVARIANT_TSC))
+            sample_clocks(&g_reference_tsc, &g_reference_ns);
+    }
+} // namespace detail
+
+    /**
+     * @brief Read a clock, through the vDSO when possible
+     */
+    int clock_gettime(int clock_id, timespec *ts) {
+        if (MINICRT_UNLIKELY(!detail::g_time_initialized))
+            detail::time_init();
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        long result = detail::g_vdso_clock_gettime
+                          ? detail::g_vdso_clock_gettime(clock_id, ts)
+                          : detail::syscall2(detail::NR_clock_gettime, clock_id, (long) ts);
+        if (detail::syscall_failed(result)) {
+            errno = (int) -result;
+            return -1;
+        }
+        return 0;
+#else
+        (void) clock_id;
+        (void) ts;
+        errno = EINVAL;
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Read the wall clock, through the vDSO when possible
+     */
+    int gettimeofday(timeval *tv, void *tz) {
+        if (MINICRT_UNLIKELY(!detail::g_time_initialized))
+            detail::time_init();
+
+#ifdef MINICRT_LINUX_SYSCALLS
+        long result = detail::g_vdso_gettimeofday
+                          ? detail::g_vdso_gettimeofday(tv, tz)
+                          : detail::syscall2(detail::NR_gettimeofday, (long) tv, (long) tz);
+        if (detail::syscall_failed(result)) {
+            errno = (int) -result;
+            return -1;
+        }
+        return 0;
+#else
+        (void) tv;
+        (void) tz;
+        errno = EINVAL;
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Check whether the clocks are read through the vDSO
+     */
+    int clock_has_vdso(void) {
+        if (!detail::g_time_initialized)
+            detail::time_init();
+        return detail::g_vdso_clock_gettime != NULL;
+    }
+
+    /**
+     * @brief Read the time stamp counter
+     */
+    unsigned long long tsc_read(void) {
+#ifdef MINICRT_X86_64
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Read the time stamp counter in program order
+     */
+    unsigned long long tsc_read_ordered(void) {
+#ifdef MINICRT_X86_64
+        unsigned long long tsc;
+        if (cpu_has(CPU_FEATURE_RDTSCP)) {
+            unsigned int processor;
+            tsc = __rdtscp(&processor);
+        } else {
+            _mm_lfence();
+            tsc = __rdtsc();
+        }
+        _mm_lfence();
+        return tsc;
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Get the time stamp counter rate in ticks per second
+     */
+    unsigned long long tsc_frequency(void) {
+        if (MINICRT_UNLIKELY(!detail::atomic_load_int(&detail::g_tsc_calibrated)))
+            detail::calibrate_tsc();
+        return detail::g_tsc_hz;
+    }
+
+    /**
+     * @brief Convert time stamp counter ticks to nanoseconds
+     */
+    unsigned long long tsc_to_ns(unsigned long long ticks) {
+        if (MINICRT_UNLIKELY(!detail::atomic_load_int(&detail::g_tsc_calibrated)))
+            detail::calibrate_tsc();
+
+        // (ticks * ns_per_tick) >> 32 without losing the high bits
+        unsigned long long low;
+        unsigned long long high = detail::mul128(ticks, detail::g_ns_per_tick, &low);
+        return (high << 32) | (low >> 32);
+    }
+
+MINICRT_END
@@ -0,0 +1,486 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/uring.h"
+#include "minicrt/memory.h"
+#include "crt_internal.h"
+#include "crt_syscall.h"
+
+MINICRT_BEGIN
+namespace detail {
+    /*
+     * io_uring shares two single-producer rings with the kernel. We produce submission
+     * entries: an entry is filled in its slot, then the tail index is published with a
+     * release store and the kernel consumes up to it. The kernel produces completions
+     * the same way and we advance the completion head after reading them.
+     *
+     * Entries are queued locally (sqe_tail) and only published when submitting, so a
+     * batch of any size costs a single io_uring_enter. The submission array maps ring
+     * positions to entry slots; it is filled with the identity once at setup.
+     */
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    struct uring_sq_offsets {
+        unsigned int head;
+        unsigned int tail;
+        unsigned int ring_mask;
+        unsigned int ring_entries;
+        unsigned int flags;
+        unsigned int dropped;
+        unsigned int array;
+        unsigned int resv1;
+        unsigned long long user_addr;
+    };
+
+    struct uring_cq_offsets {
+        unsigned int head;
+        unsigned int tail;
+        unsigned int ring_mask;
+        unsigned int ring_entries;
+        unsigned int overflow;
+        unsigned int cqes;
+        unsigned int flags;
+        unsigned int resv1;
+        unsigned long long user_addr;
+    };
+
+    struct uring_params {
+        unsigned int sq_entries;
+        unsigned int cq_entries;
+        unsigned int flags;
+        unsigned int sq_thread_cpu;
+        unsigned int sq_thread_idle;
+        unsigned int features;
+        unsigned int wq_fd;
+        unsigned int resv[3];
+        uring_sq_offsets sq_off;
+        uring_cq_offsets cq_off;
+    };
+
+    struct uring_sqe {
+        unsigned char opcode;
+        unsigned char flags;
+        unsigned short ioprio;
+        int fd;
+        unsigned long long off;
+        unsigned long long addr;
+        unsigned int len;
+        unsigned int op_flags; // rw_flags, fsync_flags, timeout_flags...
+        unsigned long long user_data;
+        unsigned short buf_index;
+        unsigned short personality;
+        int splice_fd_in;
+        unsigned long long addr3;
+        unsigned long long pad;
+    };
+
+    struct uring_cqe {
+        unsigned long long user_data;
+        int res;
+        unsigned int flags;
+    };
+
+    // Opcodes
+    static const unsigned char kOpReadv = 1;
+    static const unsigned char kOpWritev = 2;
+    static const unsigned char kOpFsync = 3;
+    static const unsigned char kOpTimeout = 11;
+    static const unsigned char kOpRead = 22;
+    static const unsigned char kOpWrite = 23;
+
+    // io_uring_setup flags and features
+    static const unsigned int kSetupSqPoll = 1u << 1;
+    static const unsigned int kFeatSingleMmap = 1u << 0;
+
+    // io_uring_enter flags
+    static const unsigned int kEnterGetEvents = 1u << 0;
+    static const unsigned int kEnterSqWakeup = 1u << 1;
+    static const unsigned int kEnterSqWait = 1u << 2;
+
+    // Submission ring flags set by the kernel
+    static const unsigned int kSqNeedWakeup = 1u << 0;
+
+    // mmap offsets selecting what to map from the ring descriptor
+    static const long kOffSqRing = 0;
+    static const long kOffCqRing = 0x8000000;
+    static const long kOffSqes = 0x10000000;
+
+    // How long an idle SQPOLL thread keeps polling, in milliseconds
+    static const unsigned int kSqPollIdleMs = 1000;
+
+    static MINICRT_INLINE unsigned int load_acquire(const unsigned int *p) {
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+    }
+
+    static MINICRT_INLINE void store_release(unsigned int *p, unsigned int value) {
+        __atomic_store_n(p, value, __ATOMIC_RELEASE);
+    }
+
+    static MINICRT_INLINE long io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                                              unsigned int flags) {
+        return syscall6(NR_io_uring_enter, fd, to_submit, min_complete, flags, 0, 0);
+    }
+
+    static MINICRT_INLINE int sq_full(const io_ring *ring) {
+        return ring->sqe_tail - load_acquire(ring->sq_head) >= ring->sq_entries;
+    }
+
+    /**
+     * @brief Take a free submission slot, submitting the queue once if it is full
+     */
+    static uring_sqe *next_sqe(io_ring *ring) {
+        if (sq_full(ring)) {
+            io_ring_submit(ring);
+            // A polling thread consumes the entries in its own time: wait until it has
+            if ((ring->flags & IO_RING_SQPOLL) && sq_full(ring))
+                io_uring_enter(ring->fd, 0, 0, kEnterSqWait);
+            if (sq_full(ring)) {
+                errno = EAGAIN;
+                return NULL;
+            }
+        }
+
+        uring_sqe *sqe = (uring_sqe *) ring->sqes + (ring->sqe_tail & ring->sq_mask);
+        ring->sqe_tail++;
+        memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    static int queue_rw(io_ring *ring, unsigned char opcode, int fd, const void *addr, unsigned int length,
+                        long long offset, unsigned long long user_data) {
+        uring_sqe *sqe = next_sqe(ring);
+        if (!sqe)
+            return -1;
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->off = (unsigned long long) offset;
+        sqe->addr = (unsigned long long) addr;
+        sqe->len = length;
+        sqe->user_data = user_data;
+        return 0;
+    }
+
+    /**
+     * @brief Publish the queued entries to the kernel; returns how many there were
+     */
+    static unsigned int flush_sq(io_ring *ring) {
+        unsigned int count = ring->sqe_tail - ring->sqe_head;
+        if (count) {
+            store_release(ring->sq_tail, ring->sqe_tail);
+            ring->sqe_head = ring->sqe_tail;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Submit everything queued and optionally wait for completions
+     */
+    static int submit(io_ring *ring, unsigned int min_complete) {
+        unsigned int count = flush_sq(ring);
+        unsigned int flags = min_complete ? kEnterGetEvents : 0;
+
+        if (ring->flags & IO_RING_SQPOLL) {
+            // The polling thread picks the entries up; it only needs a kick when asleep.
+            // The fence orders the tail store before the flags load (see io_uring(7)).
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            if (__atomic_load_n(ring->sq_flags, __ATOMIC_RELAXED) & kSqNeedWakeup)
+                flags |= kEnterSqWakeup;
+            if (!flags)
+                return (int) count;
+        }
+
+        long result;
+        do {
+            result = io_uring_enter(ring->fd, (ring->flags & IO_RING_SQPOLL) ? 0 : count, min_complete, flags);
+        } while (result == -kErrIntr);
+        if (syscall_failed(result)) {
+            errno = (int) -result;
+            return -1;
+        }
+        return (ring->flags & IO_RING_SQPOLL) ? (int) count : (int) result;
+    }
+#endif
+} // namespace detail
+
+    /**
+     * @brief Set up an io_uring instance and map its queues
+     */
+    int io_ring_init(io_ring *ring, unsigned int entries, unsigned int flags) {
+        memset(ring, 0, sizeof(*ring));
+        ring->fd = -1;
+#ifdef MINICRT_LINUX_SYSCALLS
+        using namespace detail;
+
+        uring_params params;
+        memset(&params, 0, sizeof(params));
+        if (flags & IO_RING_SQPOLL) {
+            params.flags |= kSetupSqPoll;
+            params.sq_thread_idle = kSqPollIdleMs;
+        }
+
+        long fd = syscall2(NR_io_uring_setup, entries, (long) &params);
+        if (syscall_failed(fd)) {
+            errno = (int) -fd;
+            return -1;
+        }
+        ring->fd = (int) fd;
+        ring->flags = flags;
+        ring->features = params.features;
+
+        // One mapping holds both rings on kernels with IORING_FEAT_SINGLE_MMAP
+        size_t sq_length = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        size_t cq_length = params.cq_off.cqes + params.cq_entries * sizeof(uring_cqe);
+        int single = (params.features & kFeatSingleMmap) != 0;
+        if (single && cq_length > sq_length)
+            sq_length = cq_length;
+
+        char *sq = (char *) sys_mmap(NULL, sq_length, kProtRead | kProtWrite, kMapShared | kMapPopulate,
+                                     ring->fd, kOffSqRing);
+        char *cq = sq;
+        long failure = 0;
+        if (syscall_failed((long) sq)) {
+            failure = (long) sq;
+        } else {
+            ring->ring_mapping = sq;
+            ring->ring_length = sq_length;
+            if (!single) {
+                cq = (char *) sys_mmap(NULL, cq_length, kProtRead | kProtWrite, kMapShared | kMapPopulate,
+                                       ring->fd, kOffCqRing);
+                if (syscall_failed((long) cq))
+                    failure = (long) cq;
+                else {
+                    ring->cq_mapping = cq;
+                    ring->cq_length = cq_length;
+                }
+            }
+        }
+        if (!failure) {
+            size_t sqes_length = params.sq_entries * sizeof(uring_sqe);
+            void *sqes = sys_mmap(NULL, sqes_length, kProtRead | kProtWrite, kMapShared | kMapPopulate,
+                                  ring->fd, kOffSqes);
+            if (syscall_failed((long) sqes)) {
+                failure = (long) sqes;
+            } else {
+                ring->sqes = sqes;
+                ring->sqes_length = sqes_length;
+            }
+        }
+        if (failure) {
+            io_ring_destroy(ring);
+            errno = (int) -failure;
+            return -1;
+        }
+
+        ring->sq_head = (unsigned int *) (sq + params.sq_off.head);
+        ring->sq_tail = (unsigned int *) (sq + params.sq_off.tail);
+        ring->sq_flags = (unsigned int *) (sq + params.sq_off.flags);
+        ring->sq_mask = *(unsigned int *) (sq + params.sq_off.ring_mask);
+        ring->sq_entries = *(unsigned int *) (sq + params.sq_off.ring_entries);
+        ring->sqe_head = ring->sqe_tail = *ring->sq_tail;
+
+        unsigned int *array = (unsigned int *) (sq + params.sq_off.array);
+        for (unsigned int i = 0; i < ring->sq_entries; i++)
+            array[i] = i;
+
+        ring->cq_head = (unsigned int *) (cq + params.cq_off.head);
+        ring->cq_tail = (unsigned int *) (cq + params.cq_off.tail);
+        ring->cq_mask = *(unsigned int *) (cq + params.cq_off.ring_mask);
+        ring->cqes = cq + params.cq_off.cqes;
+        return 0;
+#else
+        (void) entries;
+        (void) flags;
+        errno = EINVAL;
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Unmap the queues and close the ring
+     */
+    void io_ring_destroy(io_ring *ring) {
+#ifdef MINICRT_LINUX_SYSCALLS
+        if (ring->sqes)
+            detail::sys_munmap(ring->sqes, ring->sqes_length);
+        if (ring->cq_mapping)
+            detail::sys_munmap(ring->cq_mapping, ring->cq_length);
+        if (ring->ring_mapping)
+            detail::sys_munmap(ring->ring_mapping, ring->ring_length);
+        if (ring->fd >= 0)
+            detail::sys_close(ring->fd);
+#endif
+        memset(ring, 0, sizeof(*ring));
+        ring->fd = -1;
+    }
+
+#ifdef MINICRT_LINUX_SYSCALLS
+    /**
+     * @brief Queue a read
+     */
+    int io_ring_read(io_ring *ring, int fd, void *buf, unsigned int length, long long offset,
+                     unsigned long long user_data) {
+        return detail::queue_rw(ring, detail::kOpRead, fd, buf, length, offset, user_data);
+    }
+
+    /**
+     * @brief Queue a write
+     */
+    int io_ring_write(io_ring *ring, int fd, const void *buf, unsigned int length, long long offset,
+                      unsigned long long user_data) {
+        return detail::queue_rw(ring, detail::kOpWrite, fd, buf, length, offset, user_data);
+    }
+
+    /**
+     * @brief Queue a scatter read
+     */
+    int io_ring_readv(io_ring *ring, int fd, const io_vector *vec, unsigned int count, long long offset,
+                      unsigned long long user_data) {
+        return detail::queue_rw(ring, detail::kOpReadv, fd, vec, count, offset, user_data);
+    }
+
+    /**
+     * @brief Queue a gather write
+     */
+    int io_ring_writev(io_ring *ring, int fd, const io_vector *vec, unsigned int count, long long offset,
+                       unsigned long long user_data) {
+        return detail::queue_rw(ring, detail::kOpWritev, fd, vec, count, offset, user_data);
+    }
+
+    /**
+     * @brief Queue an fsync
+     */
+    int io_ring_fsync(io_ring *ring, int fd, unsigned int flags, unsigned long long user_data) {
+        detail::uring_sqe *sqe = detail::next_sqe(ring);
+        if (!sqe)
+            return -1;
+        sqe->opcode = detail::kOpFsync;
+        sqe->fd = fd;
+        sqe->op_flags = flags; // IO_FSYNC_DATASYNC matches IORING_FSYNC_DATASYNC
+        sqe->user_data = user_data;
+        return 0;
+    }
+
+    /**
+     * @brief Queue a relative timeout
+     */
+    int io_ring_timeout(io_ring *ring, const timespec *ts, unsigned int count, unsigned long long user_data) {
+        // minicrt::timespec has the layout of struct __kernel_timespec on x86-64
+        detail::uring_sqe *sqe = detail::next_sqe(ring);
+        if (!sqe)
+            return -1;
+        sqe->opcode = detail::kOpTimeout;
+        sqe->fd = -1;
+        sqe->addr = (unsigned long long) ts;
+        sqe->len = 1;
+        sqe->off = count;
+        sqe->user_data = user_data;
+        return 0;
+    }
+
+    /**
+     * @brief Submit queued operations
+     */
+    int io_ring_submit(io_ring *ring) {
+        return detail::submit(ring, 0);
+    }
+
+    /**
+     * @brief Submit queued operations and wait for completions
+     */
+    int io_ring_submit_and_wait(io_ring *ring, unsigned int min_complete) {
+        return detail::submit(ring, min_complete);
+    }
+
+    /**
+     * @brief Collect the completions that are already available
+     */
+    unsigned int io_ring_peek(io_ring *ring, io_completion *out, unsigned int max) {
+        unsigned int head = *ring->cq_head;
+        unsigned int available = detail::load_acquire(ring->cq_tail) - head;
+        unsigned int count = available < max ? available : max;
+
+        const detail::uring_cqe *cqes = (const detail::uring_cqe *) ring->cqes;
+        for (unsigned int i = 0; i < count; i++) {
+            const detail::uring_cqe *cqe = &cqes[(head + i) & ring->cq_mask];
+            out[i].user_data = cqe->user_data;
+            out[i].result = cqe->res;
+            out[i].flags = cqe->flags;
+        }
+        if (count)
+            detail::store_release(ring->cq_head, head + count);
+        return count;
+    }
+
+    /**
+     * @brief Submit queued operations and collect at least min completions
+     */
+    int io_ring_wait(io_ring *ring, io_completion *out, unsigned int max, unsigned int min) {
+        if (min > max)
+            min = max;
+
+        unsigned int collected = io_ring_peek(ring, out, max);
+        if (collected >= min && ring->sqe_tail == ring->sqe_head)
+            return (int) collected;
+
+        // The first enter also carries any queued submissions
+        for (;;) {
+            unsigned int wanted = collected < min ? min - collected : 0;
+            if (detail::submit(ring, wanted) < 0)
+                return -1;
+            collected += io_ring_peek(ring, out + collected, max - collected);
+            if (collected >= min)
+                return (int) collected;
+        }
+    }
+#else
+    int io_ring_read(io_ring *, int, void *, unsigned int, long long, unsigned long long) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int io_ring_write(io_ring *, int, const void *, unsigned int, long long, unsigned long long) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int io_ring_readv(io_ring *, int, const io_vector *, unsigned int, long long, unsigned long long) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int io_ring_writev(io_ring *, int, const io_vector *, unsigned int, long long, unsigned long long) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int io_ring_fsync(io_ring *, int, unsigned int, unsigned long long) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int io_ring_timeout(io_ring *, const timespec *, unsigned int, unsigned long long) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int io_ring_submit(io_ring *) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int io_ring_submit_and_wait(io_ring *, unsigned int) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    unsigned int io_ring_peek(io_ring *, io_completion *, unsigned int) {
+        return 0;
+    }
+
+    int io_ring_wait(io_ring *, io_completion *, unsigned int, unsigned int) {
+        errno = EINVAL;
+        return -1;
+    }
+#endif
+
+MINICRT_END
@@ -0,0 +1,104 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "minicrt/stdio.h"
+
+/**
+ * Formatting throughput benchmark (not part of the test suite)
+ *
+ * Formats the same inputs with minicrt::snprintf and the C library snprintf on one
+ * thread, and reports millions of calls per second per core for each workload.
+ *
+ * Usage: bench_format [calls_per_workload]
+ */
+
+namespace {
+    struct workload {
+        const char *name;
+        const char *format;
+        int kind; // 0 integer, 1 double, 2 string
+    };
+
+    const workload kWorkloads[] = {
+        {"int", "%d", 0},
+        {"int pad", "%08d", 0},
+        {"hex", "%llx", 0},
+        {"double %.6f", "%.6f", 1},
+        {"double %g", "%g", 1},
+        {"double %e", "%e", 1},
+        {"double %.17g", "%.17g", 1},
+        {"string", "[%-12s]", 2},
+    };
+
+    const char *kWords[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"};
+
+    template <int (*Format)(char *, size_t, const char *, ...)>
+    double run(const workload &w, const std::vector<long long> &ints, const std::vector<double> &doubles,
+               size_t calls) {
+        char buf[128];
+        size_t checksum = 0;
+        size_t mask = ints.size() - 1;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; i++) {
+            switch (w.kind) {
+            case 0:
+                checksum += (size_t) Format(buf, sizeof(buf), w.format, ints[i & mask]);
+                break;
+            case 1:
+                checksum += (size_t) Format(buf, sizeof(buf), w.format, doubles[i & mask]);
+                break;
+            default:
+                checksum += (size_t) Format(buf, sizeof(buf), w.format, kWords[i & 7]);
+                break;
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (checksum == 1) // keep the calls from being optimized away
+            std::puts(buf);
+        return (double) calls / elapsed.count() / 1e6;
+    }
+
+    int minicrt_snprintf(char *buf, size_t size, const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        int n = minicrt::vsnprintf(buf, size, format, args);
+        va_end(args);
+        return n;
+    }
+
+    int libc_snprintf(char *buf, size_t size, const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        int n = std::vsnprintf(buf, size, format, args);
+        va_end(args);
+        return n;
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t calls = argc > 1 ? (size_t) std::atoll(argv[1]) : 2000000;
+
+    std::mt19937_64 rng(1);
+    std::vector<long long> ints(4096);
+    std::vector<double> doubles(4096);
+    for (size_t i = 0; i < ints.size(); i++) {
+        ints[i] = (long long) (rng() >> (rng() % 64)) * ((i & 1) ? -1 : 1);
+        doubles[i] = (double) (int) (rng() % 2000000) / (double) (1 + rng() % 1000);
+    }
+
+    std::printf("%-14s %14s %14s %8s\n", "workload", "minicrt Mops/s", "libc Mops/s", "ratio");
+    for (const workload &w : kWorkloads) {
+        double mini = run<minicrt_snprintf>(w, ints, doubles, calls);
+        double libc = run<libc_snprintf>(w, ints, doubles, calls);
+        std::printf("%-14s %14.2f %14.2f %7.2fx\n", w.name, mini, libc, mini / libc);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include "minicrt/memory.h"
+#include "minicrt/perf.h"
+
+/**
+ * Huge page benchmark for large allocations (not part of the test suite)
+ *
+ * For each malloc_huge_mode, allocates one large buffer and measures:
+ *   - touch: the first write to every page, which takes the page faults
+ *   - random: reads at random offsets, which take the TLB misses
+ *   - calloc: calloc() of a fresh buffer, which must not memset it
+ * Page faults and data TLB misses come from perf counters; they print as "-" where
+ * the kernel does not allow them.
+ *
+ * Usage: bench_hugepage [megabytes] [random_reads]
+ */
+
+namespace {
+    const char *const kModeNames[] = {"off", "thp", "hugetlb"};
+
+    volatile unsigned long long g_sink;
+
+    minicrt::perf_group g_group;
+
+    void report(const char *mode, const char *phase, double ms, const minicrt::perf_values &delta) {
+        std::printf("%-8s %-8s %10.1f", mode, phase, ms);
+        for (minicrt::perf_counter counter : {minicrt::PERF_PAGE_FAULTS, minicrt::PERF_DTLB_MISSES}) {
+            if (delta.available & PERF_MASK(counter))
+                std::printf(" %14llu", delta.counts[counter]);
+            else
+                std::printf(" %14s", "-");
+        }
+        std::printf("\n");
+    }
+
+    template <typename F>
+    void measure(const char *mode, const char *phase, F run) {
+        minicrt::perf_region region;
+        minicrt::perf_values delta;
+        minicrt::perf_region_begin(&g_group, &region);
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        minicrt::perf_region_end(&g_group, &region, &delta);
+        report(mode, phase, elapsed.count(), delta);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? (size_t) std::atoll(argv[1]) : 512;
+    size_t reads = argc > 2 ? (size_t) std::atoll(argv[2]) : 16u << 20;
+    size_t size = megabytes << 20;
+
+    minicrt::perf_group_open(&g_group, PERF_MASK(minicrt::PERF_PAGE_FAULTS) | PERF_MASK(minicrt::PERF_DTLB_MISSES));
+    std::printf("%-8s %-8s %10s %14s %14s\n", "mode", "phase", "ms", "page_faults", "dtlb_misses");
+
+    for (int mode = minicrt::MALLOC_HUGE_OFF; mode <= minicrt::MALLOC_HUGE_HUGETLB; mode++) {
+        minicrt::malloc_set_huge_pages(mode);
+
+        unsigned char *buffer = (unsigned char *) minicrt::malloc(size);
+        if (!buffer) {
+            std::fprintf(stderr, "cannot allocate %zu MiB\n", megabytes);
+            return 1;
+        }
+        measure(kModeNames[mode], "touch", [&] {
+            for (size_t i = 0; i < size; i += 4096)
+                buffer[i] = (unsigned char) i;
+        });
+        measure(kModeNames[mode], "random", [&] {
+            unsigned long long x = 88172645463325252ull, sum = 0;
+            for (size_t i = 0; i < reads; i++) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                sum += buffer[x % size];
+            }
+            g_sink = sum;
+        });
+        minicrt::free(buffer);
+
+        // A block bigger than anything cached, so it is freshly mapped
+        size_t fresh_size = size + (size >> 2) + (4u << 20);
+        unsigned char *zeroed = 0;
+        measure(kModeNames[mode], "calloc", [&] {
+            zeroed = (unsigned char *) minicrt::calloc(fresh_size, 1);
+        });
+        if (!zeroed) {
+            std::fprintf(stderr, "cannot allocate %zu MiB\n", fresh_size >> 20);
+            return 1;
+        }
+        g_sink = zeroed[fresh_size / 2];
+        minicrt::free(zeroed);
+    }
+
+    minicrt::malloc_set_huge_pages(minicrt::MALLOC_HUGE_THP);
+    minicrt::perf_group_close(&g_group);
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "minicrt/memory.h"
+
+/**
+ * Allocator thread-scaling benchmark (not part of the test suite)
+ *
+ * Runs two workloads with 1..N threads against minicrt::malloc and the system malloc:
+ *   - local: every thread allocates and frees its own blocks
+ *   - remote: threads are paired, one allocates and the other frees
+ *
+ * Usage: bench_malloc [max_threads] [operations_per_thread]
+ */
+
+namespace {
+    struct allocator {
+        const char *name;
+        void *(*alloc)(size_t);
+        void (*release)(void *);
+    };
+
+    void *system_malloc(size_t size) { return std::malloc(size); }
+    void system_free(void *ptr) { std::free(ptr); }
+
+    const allocator kAllocators[] = {
+        {"minicrt", minicrt::malloc, minicrt::free},
+        {"system", system_malloc, system_free},
+    };
+
+    // Mostly small sizes with an occasional larger object, like a typical program
+    size_t pick_size(size_t i) {
+        return (i % 16 == 0) ? 256 + (i * 131) % 4096 : 8 + (i * 37) % 120;
+    }
+
+    void local_worker(const allocator &a, size_t ops) {
+        const size_t kLive = 256;
+        void *live[kLive] = {};
+
+        for (size_t i = 0; i < ops; i++) {
+            size_t slot = (i * 7) % kLive;
+            a.release(live[slot]);
+            live[slot] = a.alloc(pick_size(i));
+        }
+        for (void *p : live)
+            a.release(p);
+    }
+
+    void remote_pair(const allocator &a, size_t ops) {
+        std::vector<std::atomic<void *>> ring(1024);
+        for (std::atomic<void *> &slot : ring)
+            slot.store(nullptr, std::memory_order_relaxed);
+
+        std::thread consumer([&ring, &a, ops] {
+            for (size_t i = 0; i < ops; i++) {
+                std::atomic<void *> &slot = ring[i % ring.size()];
+                void *p;
+                while (!(p = slot.exchange(nullptr, std::memory_order_acquire)))
+                    std::this_thread::yield();
+                a.release(p);
+            }
+        });
+
+        for (size_t i = 0; i < ops; i++) {
+            void *p = a.alloc(pick_size(i));
+            std::atomic<void *> &slot = ring[i % ring.size()];
+            while (slot.load(std::memory_order_relaxed))
+                std::this_thread::yield();
+            slot.store(p, std::memory_order_release);
+        }
+        consumer.join();
+    }
+
+    double run(int threads, void (*body)(const allocator &, size_t), const allocator &a, size_t ops) {
+        std::vector<std::thread> pool;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++)
+            pool.emplace_back(body, std::cref(a), ops);
+        for (std::thread &thread : pool)
+            thread.join();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        // Millions of malloc/free pairs per second across all threads
+        return (double) threads * (double) ops / elapsed.count() / 1e6;
+    }
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : (int) std::thread::hardware_concurrency();
+    size_t ops = argc > 2 ? (size_t) std::atoll(argv[2]) : 2000000;
+    if (max_threads < 1)
+        max_threads = 1;
+
+    std::printf("%-8s %-8s %8s %14s\n", "workload", "alloc", "threads", "Mops/s");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        for (const allocator &a : kAllocators)
+            std::printf("%-8s %-8s %8d %14.2f\n", "local", a.name, threads, run(threads, local_worker, a, ops));
+        for (const allocator &a : kAllocators)
+            std::printf("%-8s %-8s %8d %14.2f\n", "remote", a.name, threads * 2, run(threads, remote_pair, a, ops));
+        if (threads < max_threads && threads * 2 > max_threads)
+            threads = max_threads / 2;
+    }
+    return 0;
+}
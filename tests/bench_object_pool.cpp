@@ -0,0 +1,109 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "minicrt/memory.h"
+#include "minicrt/object_pool.h"
+
+/**
+ * Object pool contention benchmark (not part of the test suite)
+ *
+ * 1..N threads allocate and free 64-byte objects from one shared pool, directly
+ * ("pool") and through a per-thread cache ("cache"), against minicrt::malloc and
+ * the system malloc. Every thread keeps a window of live objects and replaces one
+ * per operation, so the pool is hit from every thread at once. The pool is
+ * reserved and prefaulted up front.
+ *
+ * Usage: bench_object_pool [max_threads] [operations_per_thread]
+ */
+
+namespace {
+    struct node {
+        char bytes[64];
+    };
+
+    const size_t kLive = 256;
+
+    typedef minicrt::object_pool<node, 1024> node_pool;
+
+    node_pool *g_pool;
+
+    void *pool_alloc(size_t) { return g_pool->allocate(); }
+    void pool_free(void *ptr) { g_pool->deallocate(ptr); }
+    void *system_malloc(size_t size) { return std::malloc(size); }
+    void system_free(void *ptr) { std::free(ptr); }
+
+    struct allocator {
+        const char *name;
+        void *(*alloc)(size_t);
+        void (*release)(void *);
+    };
+
+    const allocator kAllocators[] = {
+        {"pool", pool_alloc, pool_free},
+        {"minicrt", minicrt::malloc, minicrt::free},
+        {"system", system_malloc, system_free},
+    };
+
+    template <typename Alloc, typename Release>
+    void churn(size_t ops, Alloc alloc, Release release) {
+        void *live[kLive] = {};
+        for (size_t i = 0; i < ops; i++) {
+            size_t slot = (i * 7) % kLive;
+            if (live[slot])
+                release(live[slot]);
+            live[slot] = alloc();
+            ((node *) live[slot])->bytes[0] = (char) i;
+        }
+        for (void *p : live)
+            release(p);
+    }
+
+    void worker(const allocator *a, size_t ops) {
+        if (!a) {
+            node_pool::cache cache(*g_pool);
+            churn(ops, [&] { return cache.allocate(); }, [&](void *p) { cache.deallocate(p); });
+            return;
+        }
+        churn(ops, [a] { return a->alloc(sizeof(node)); }, [a](void *p) { a->release(p); });
+    }
+
+    // a is NULL for the pool with per-thread caches
+    double run(int threads, const allocator *a, size_t ops) {
+        std::vector<std::thread> pool;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++)
+            pool.emplace_back(worker, a, ops);
+        for (std::thread &thread : pool)
+            thread.join();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        // Millions of allocate/free pairs per second across all threads
+        return (double) threads * (double) ops / elapsed.count() / 1e6;
+    }
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : (int) std::thread::hardware_concurrency();
+    size_t ops = argc > 2 ? (size_t) std::atoll(argv[2]) : 2000000;
+    if (max_threads < 1)
+        max_threads = 1;
+
+    node_pool pool((kLive + 2 * node_pool::kBatch) * (size_t) max_threads, minicrt::OBJECT_POOL_PREFAULT);
+    g_pool = &pool;
+
+    std::printf("%-8s %8s %14s\n", "alloc", "threads", "Mops/s");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        std::printf("%-8s %8d %14.2f\n", "cache", threads, run(threads, nullptr, ops));
+        for (const allocator &a : kAllocators)
+            std::printf("%-8s %8d %14.2f\n", a.name, threads, run(threads, &a, ops));
+        if (threads < max_threads && threads * 2 > max_threads)
+            threads = max_threads / 2;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "minicrt/memory.h"
+#include "minicrt/pool.h"
+
+/**
+ * Parallel memcpy/memset bandwidth benchmark (not part of the test suite)
+ *
+ * Copies and fills one large buffer with the single-threaded minicrt kernels, then
+ * with memcpy_parallel/memset_parallel on pools of 1..N threads (the calling thread
+ * included). Reports GB/s; a copy counts the bytes read and written.
+ *
+ * Usage: bench_parallel [max_threads] [megabytes]
+ */
+
+namespace {
+    template <typename F>
+    double best_gbps(size_t bytes, F run) {
+        double best = 0;
+        for (int rep = 0; rep < 5; rep++) {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            double gbps = (double) bytes / elapsed.count() / 1e9;
+            if (gbps > best)
+                best = gbps;
+        }
+        return best;
+    }
+
+    void report(const char *kernel, int threads, double copy, double set) {
+        std::printf("%-10s %8d %12.2f %12.2f\n", kernel, threads, copy, set);
+    }
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : (int) std::thread::hardware_concurrency();
+    size_t megabytes = argc > 2 ? (size_t) std::atoll(argv[2]) : 1024;
+    if (max_threads < 1)
+        max_threads = 1;
+    size_t size = megabytes * 1024 * 1024;
+
+    unsigned char *src = (unsigned char *) minicrt::malloc(size);
+    unsigned char *dest = (unsigned char *) minicrt::malloc(size);
+    if (!src || !dest) {
+        std::fprintf(stderr, "cannot allocate 2 x %zu MiB\n", megabytes);
+        return 1;
+    }
+    // Fault everything in first, so no run pays for page faults
+    minicrt::memset(src, 1, size);
+    minicrt::memset(dest, 0, size);
+
+    std::printf("%-10s %8s %12s %12s\n", "kernel", "threads", "copy GB/s", "set GB/s");
+    report("single", 1,
+           best_gbps(2 * size, [&] { minicrt::memcpy(dest, src, size); }),
+           best_gbps(size, [&] { minicrt::memset(dest, 2, size); }));
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        minicrt::pool_stop();
+        minicrt::pool_start(threads - 1);
+        report("parallel", threads,
+               best_gbps(2 * size, [&] { minicrt::memcpy_parallel(dest, src, size); }),
+               best_gbps(size, [&] { minicrt::memset_parallel(dest, 3, size); }));
+        if (threads < max_threads && threads * 2 > max_threads)
+            threads = max_threads / 2;
+    }
+    minicrt::pool_stop();
+
+    minicrt::free(src);
+    minicrt::free(dest);
+    return 0;
+}
@@ -0,0 +1,118 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Process startup latency benchmark (not part of the test suite)
+ *
+ * Launches each startup probe many times and reports, in microseconds:
+ *   - exec-to-main: from just before posix_spawn() to the first line of main()
+ *   - spawn-to-exit: from just before posix_spawn() until the child has been reaped
+ *
+ * The probes are looked up next to this executable: startup_probe (MiniCRT,
+ * freestanding), startup_probe_libc (system C library, dynamically linked) and,
+ * when it could be built, startup_probe_libc_static.
+ *
+ * Usage: bench_startup [runs]
+ */
+
+extern char **environ;
+
+namespace {
+    long long monotonic_ns() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    // Start the probe once; returns false if it could not be run
+    bool run_probe(const std::string &path, double *to_main_us, double *to_exit_us) {
+        int fds[2];
+        if (pipe(fds) != 0)
+            return false;
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], 1);
+        posix_spawn_file_actions_addclose(&actions, fds[0]);
+
+        char *argv[] = {const_cast<char *>(path.c_str()), nullptr};
+        pid_t pid;
+        long long start = monotonic_ns();
+        int rc = posix_spawn(&pid, path.c_str(), &actions, nullptr, argv, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        close(fds[1]);
+        if (rc != 0) {
+            close(fds[0]);
+            return false;
+        }
+
+        char buf[64] = {};
+        size_t used = 0;
+        ssize_t n;
+        while (used < sizeof(buf) - 1 && (n = read(fds[0], buf + used, sizeof(buf) - 1 - used)) > 0)
+            used += (size_t) n;
+        close(fds[0]);
+
+        int status;
+        waitpid(pid, &status, 0);
+        long long end = monotonic_ns();
+
+        long long in_main = std::atoll(buf);
+        *to_main_us = (double) (in_main - start) / 1e3;
+        *to_exit_us = (double) (end - start) / 1e3;
+        return in_main > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    double percentile(std::vector<double> &values, double p) {
+        std::sort(values.begin(), values.end());
+        return values[(size_t) (p * (double) (values.size() - 1))];
+    }
+}
+
+int main(int argc, char **argv) {
+    int runs = argc > 1 ? std::atoi(argv[1]) : 2000;
+    if (runs < 1)
+        runs = 1;
+
+    std::string dir = argv[0];
+    size_t slash = dir.rfind('/');
+    dir = slash == std::string::npos ? "./" : dir.substr(0, slash + 1);
+
+    const char *probes[] = {"startup_probe", "startup_probe_libc", "startup_probe_libc_static"};
+
+    std::printf("%-26s %14s %14s %14s %14s\n", "probe", "to main p50", "to main p99", "to exit p50",
+                "to exit p99");
+    for (const char *probe : probes) {
+        std::string path = dir + probe;
+        if (access(path.c_str(), X_OK) != 0)
+            continue;
+
+        std::vector<double> to_main, to_exit;
+        for (int i = 0; i < runs; i++) {
+            double a, b;
+            if (!run_probe(path, &a, &b)) {
+                std::fprintf(stderr, "%s: probe failed\n", probe);
+                break;
+            }
+            to_main.push_back(a);
+            to_exit.push_back(b);
+        }
+        if (to_main.empty())
+            continue;
+
+        std::printf("%-26s %12.1fus %12.1fus %12.1fus %12.1fus\n", probe, percentile(to_main, 0.5),
+                    percentile(to_main, 0.99), percentile(to_exit, 0.5), percentile(to_exit, 0.99));
+    }
+    return 0;
+}
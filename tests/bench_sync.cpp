@@ -0,0 +1,134 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "minicrt/sync.h"
+
+/**
+ * Lock contention benchmark (not part of the test suite)
+ *
+ * Runs with 1..N threads (64 by default), each taking a lock around a short critical
+ * section as fast as it can:
+ *   - mutex: minicrt::mutex against std::mutex
+ *   - rwlock: one write per 16 operations, minicrt::rwlock against std::shared_mutex
+ *
+ * Usage: bench_sync [max_threads] [operations_per_thread]
+ */
+
+namespace {
+    struct shared_data {
+        minicrt::mutex m = MUTEX_INIT;
+        minicrt::rwlock rw = RWLOCK_INIT;
+        std::mutex std_m;
+        std::shared_mutex std_rw;
+        volatile long counter = 0;
+    };
+
+    // A little work inside the lock, like updating a small structure
+    inline void critical_section(shared_data &d) {
+        for (int i = 0; i < 8; i++)
+            d.counter = d.counter + 1;
+    }
+
+    inline long read_section(shared_data &d) {
+        long sum = 0;
+        for (int i = 0; i < 8; i++)
+            sum += d.counter;
+        return sum;
+    }
+
+    void minicrt_mutex(shared_data &d, size_t ops) {
+        for (size_t i = 0; i < ops; i++) {
+            minicrt::mutex_lock(&d.m);
+            critical_section(d);
+            minicrt::mutex_unlock(&d.m);
+        }
+    }
+
+    void std_mutex(shared_data &d, size_t ops) {
+        for (size_t i = 0; i < ops; i++) {
+            std::lock_guard<std::mutex> guard(d.std_m);
+            critical_section(d);
+        }
+    }
+
+    void minicrt_rwlock(shared_data &d, size_t ops) {
+        volatile long sink = 0;
+        for (size_t i = 0; i < ops; i++) {
+            if (i % 16 == 0) {
+                minicrt::rwlock_write_lock(&d.rw);
+                critical_section(d);
+                minicrt::rwlock_write_unlock(&d.rw);
+            } else {
+                minicrt::rwlock_read_lock(&d.rw);
+                sink = read_section(d);
+                minicrt::rwlock_read_unlock(&d.rw);
+            }
+        }
+        (void) sink;
+    }
+
+    void std_rwlock(shared_data &d, size_t ops) {
+        volatile long sink = 0;
+        for (size_t i = 0; i < ops; i++) {
+            if (i % 16 == 0) {
+                std::unique_lock<std::shared_mutex> guard(d.std_rw);
+                critical_section(d);
+            } else {
+                std::shared_lock<std::shared_mutex> guard(d.std_rw);
+                sink = read_section(d);
+            }
+        }
+        (void) sink;
+    }
+
+    struct workload {
+        const char *name;
+        const char *lock;
+        void (*body)(shared_data &, size_t);
+    };
+
+    const workload kWorkloads[] = {
+        {"mutex", "minicrt", minicrt_mutex},
+        {"mutex", "std", std_mutex},
+        {"rwlock", "minicrt", minicrt_rwlock},
+        {"rwlock", "std", std_rwlock},
+    };
+
+    double run(int threads, const workload &w, size_t ops) {
+        shared_data data;
+        std::vector<std::thread> pool;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++)
+            pool.emplace_back(w.body, std::ref(data), ops);
+        for (std::thread &thread : pool)
+            thread.join();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        // Millions of lock/unlock pairs per second across all threads
+        return (double) threads * (double) ops / elapsed.count() / 1e6;
+    }
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : 64;
+    size_t ops = argc > 2 ? (size_t) std::atoll(argv[2]) : 200000;
+    if (max_threads < 1)
+        max_threads = 1;
+
+    std::printf("%-8s %-8s %8s %14s\n", "workload", "lock", "threads", "Mops/s");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        for (const workload &w : kWorkloads)
+            std::printf("%-8s %-8s %8d %14.2f\n", w.name, w.lock, threads, run(threads, w, ops));
+        if (threads < max_threads && threads * 2 > max_threads)
+            threads = max_threads / 2;
+    }
+    return 0;
+}
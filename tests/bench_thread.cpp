@@ -0,0 +1,127 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+/**
+ * Thread creation benchmark (not part of the test suite)
+ *
+ * Reports the average time, in microseconds, of:
+ *   - create+join: start a thread that returns at once and wait for it
+ *   - batch of 16: start 16 such threads, then join them all (per thread)
+ *
+ * Built twice: freestanding against MiniCRT (BENCH_THREAD_MINICRT), where threads
+ * come from clone, and as an ordinary program using pthread_create().
+ *
+ * Usage: bench_thread [iterations]
+ */
+
+#ifdef BENCH_THREAD_MINICRT
+#include "minicrt/crt.h"
+#include "minicrt/stdio.h"
+#include "minicrt/thread.h"
+#include "minicrt/time.h"
+
+#define BENCH_NAME "minicrt"
+
+typedef minicrt::thread *thread_handle;
+
+static int empty_thread(void *) {
+    return 0;
+}
+
+static bool start_thread(thread_handle *t) {
+    return minicrt::thread_create(t, empty_thread, 0, 0) == 0;
+}
+
+static void join_thread(thread_handle t) {
+    minicrt::thread_join(t, 0);
+}
+
+static long long monotonic_ns() {
+    minicrt::timespec ts;
+    minicrt::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int parse_int(const char *s) {
+    int value = 0;
+    while (*s >= '0' && *s <= '9')
+        value = value * 10 + (*s++ - '0');
+    return value;
+}
+
+#define bench_printf minicrt::printf
+#else
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <pthread.h>
+
+#define BENCH_NAME "pthread"
+
+typedef pthread_t thread_handle;
+
+static void *empty_thread(void *) {
+    return nullptr;
+}
+
+static bool start_thread(thread_handle *t) {
+    return pthread_create(t, nullptr, empty_thread, nullptr) == 0;
+}
+
+static void join_thread(thread_handle t) {
+    pthread_join(t, nullptr);
+}
+
+static long long monotonic_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int parse_int(const char *s) {
+    return std::atoi(s);
+}
+
+#define bench_printf std::printf
+#endif
+
+int main(int argc, char **argv) {
+    const int kBatch = 16;
+    int iterations = argc > 1 ? parse_int(argv[1]) : 10000;
+    if (iterations < kBatch)
+        iterations = kBatch;
+
+    // Warm up: the first threads pay for mapping stacks
+    for (int i = 0; i < kBatch; i++) {
+        thread_handle t;
+        if (!start_thread(&t))
+            return 1;
+        join_thread(t);
+    }
+
+    long long start = monotonic_ns();
+    for (int i = 0; i < iterations; i++) {
+        thread_handle t;
+        if (!start_thread(&t))
+            return 1;
+        join_thread(t);
+    }
+    double single_us = (double) (monotonic_ns() - start) / iterations / 1000.0;
+
+    int rounds = iterations / kBatch;
+    start = monotonic_ns();
+    for (int r = 0; r < rounds; r++) {
+        thread_handle batch[kBatch];
+        for (int i = 0; i < kBatch; i++) {
+            if (!start_thread(&batch[i]))
+                return 1;
+        }
+        for (int i = 0; i < kBatch; i++)
+            join_thread(batch[i]);
+    }
+    double batch_us = (double) (monotonic_ns() - start) / (rounds * kBatch) / 1000.0;
+
+    bench_printf("%-8s create+join %8.2f us   batch of %d %8.2f us\n", BENCH_NAME, single_us, kBatch, batch_us);
+    return 0;
+}
@@ -0,0 +1,76 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include "minicrt/time.h"
+
+/**
+ * Clock read latency benchmark (not part of the test suite)
+ *
+ * Reports the average cost of one call, in nanoseconds, for MiniCRT's
+ * clock_gettime() and gettimeofday(), the C library's clock_gettime(), a raw
+ * clock_gettime system call, and the TSC reads.
+ *
+ * Usage: bench_time [calls]
+ */
+
+namespace {
+    volatile unsigned long long g_sink;
+
+    template <typename F>
+    double ns_per_call(size_t calls, F f) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; i++)
+            f();
+        auto end = std::chrono::steady_clock::now();
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double) calls;
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t calls = argc > 1 ? (size_t) std::atoll(argv[1]) : 5000000;
+    if (calls < 1)
+        calls = 1;
+
+    std::printf("vDSO clocks: %s, TSC frequency: %.3f MHz\n", minicrt::clock_has_vdso() ? "yes" : "no",
+                (double) minicrt::tsc_frequency() / 1e6);
+
+    std::printf("%-34s %10.1f ns\n", "minicrt clock_gettime(MONOTONIC)", ns_per_call(calls, [] {
+        minicrt::timespec ts;
+        minicrt::clock_gettime(CLOCK_MONOTONIC, &ts);
+        g_sink = (unsigned long long) ts.tv_nsec;
+    }));
+    std::printf("%-34s %10.1f ns\n", "minicrt clock_gettime(REALTIME)", ns_per_call(calls, [] {
+        minicrt::timespec ts;
+        minicrt::clock_gettime(CLOCK_REALTIME, &ts);
+        g_sink = (unsigned long long) ts.tv_nsec;
+    }));
+    std::printf("%-34s %10.1f ns\n", "minicrt gettimeofday", ns_per_call(calls, [] {
+        minicrt::timeval tv;
+        minicrt::gettimeofday(&tv, nullptr);
+        g_sink = (unsigned long long) tv.tv_usec;
+    }));
+    std::printf("%-34s %10.1f ns\n", "libc clock_gettime(MONOTONIC)", ns_per_call(calls, [] {
+        ::timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+        g_sink = (unsigned long long) ts.tv_nsec;
+    }));
+    std::printf("%-34s %10.1f ns\n", "syscall clock_gettime(MONOTONIC)", ns_per_call(calls / 10 + 1, [] {
+        ::timespec ts;
+        syscall(SYS_clock_gettime, CLOCK_MONOTONIC, &ts);
+        g_sink = (unsigned long long) ts.tv_nsec;
+    }));
+    std::printf("%-34s %10.1f ns\n", "minicrt tsc_read", ns_per_call(calls, [] {
+        g_sink = minicrt::tsc_read();
+    }));
+    std::printf("%-34s %10.1f ns\n", "minicrt tsc_read_ordered", ns_per_call(calls, [] {
+        g_sink = minicrt::tsc_read_ordered();
+    }));
+    return 0;
+}
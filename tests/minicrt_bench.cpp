@@ -0,0 +1,567 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include "minicrt/cpu.h"
+#include "minicrt/memory.h"
+#include "minicrt/perf.h"
+#include "minicrt/string.h"
+
+/**
+ * Memory and string kernel benchmark against the system C library (not part of
+ * the test suite)
+ *
+ * For every function and size, reports the cost of one call with 64-byte aligned
+ * buffers (ns/call and GB/s of the size argument), and the mean and worst cost over
+ * the source/destination alignments mod 64, for MiniCRT and for the C library.
+ *
+ * Alignments: "full" tries every pair (4096; 64 for single-buffer functions) up to
+ * 64 KiB and an 8x8 grid of offsets above that, "grid" uses the grid throughout and
+ * "none" only the aligned case. Sizes above 16 MiB are only measured aligned.
+ *
+ * Cache state: "hot" calls the function on the same buffers over and over; "cold"
+ * rotates through buffers spread over four times the last-level cache, so each
+ * call starts from memory. Cold runs always use the alignment grid.
+ *
+ * Counters: with --counters, the aligned case is run once more inside a perf region
+ * and the hardware events per call are added to each row, for the events the
+ * machine provides (none in most containers).
+ *
+ * Usage: minicrt_bench [--format=csv|json|table] [--functions=memcpy,strlen,...]
+ *                      [--min-size=N] [--max-size=N] [--align=full|grid|none]
+ *                      [--cache=hot|cold|both] [--time=ms] [--counters]
+ */
+
+namespace {
+    enum kind {
+        KIND_COPY,   // f(dst, src, n)
+        KIND_MOVE,   // f(dst, src, n) with dst overlapping the end of src
+        KIND_SET,    // f(dst, c, n)
+        KIND_CMP,    // f(a, b, n) on equal buffers
+        KIND_STRLEN, // f(s) with the terminator at n
+        KIND_STRNLEN,
+        KIND_STRCMP, // f(a, b) on equal strings of length n
+        KIND_MEMCHR, // f(s, c, n) with c absent
+        KIND_STRCHR, // f(s, c) with c absent and the terminator at n
+        KIND_STRSTR, // f(s, "needle") with the terminator at n
+        KIND_MEMMEM, // f(s, n, "needle", 6)
+        KIND_STRSPN, // f(s, "a") with the terminator at n
+        KIND_STRCSPN // f(s, ",;\t\n") with the terminator at n
+    };
+
+    struct function {
+        const char *name;
+        kind type;
+        const void *mini;
+        const void *libc;
+    };
+
+    typedef void *(*copy_func)(void *, const void *, size_t);
+    typedef void *(*set_func)(void *, int, size_t);
+    typedef int (*cmp_func)(const void *, const void *, size_t);
+    typedef size_t (*strlen_func)(const char *);
+    typedef size_t (*strnlen_func)(const char *, size_t);
+    typedef int (*strcmp_func)(const char *, const char *);
+    typedef const void *(*memchr_func)(const void *, int, size_t);
+    typedef const char *(*strchr_func)(const char *, int);
+    typedef const char *(*strstr_func)(const char *, const char *);
+    typedef void *(*memmem_func)(const void *, size_t, const void *, size_t);
+    typedef size_t (*strspn_func)(const char *, const char *);
+
+    // Taken through volatile pointers so the compiler cannot inline the libc builtins
+    copy_func volatile libc_memcpy = std::memcpy;
+    copy_func volatile libc_memmove = std::memmove;
+    set_func volatile libc_memset = std::memset;
+    cmp_func volatile libc_memcmp = std::memcmp;
+    strlen_func volatile libc_strlen = std::strlen;
+    strnlen_func volatile libc_strnlen = ::strnlen;
+    strcmp_func volatile libc_strcmp = std::strcmp;
+    memchr_func volatile libc_memchr = std::memchr;
+    memchr_func volatile libc_memrchr = ::memrchr;
+    strchr_func volatile libc_strchr = std::strchr;
+    strchr_func volatile libc_strrchr = std::strrchr;
+    strstr_func volatile libc_strstr = std::strstr;
+    memmem_func volatile libc_memmem = ::memmem;
+    strspn_func volatile libc_strspn = std::strspn;
+    strspn_func volatile libc_strcspn = std::strcspn;
+
+    const function kFunctions[] = {
+        {"memcpy", KIND_COPY, (const void *) minicrt::memcpy, (const void *) libc_memcpy},
+        {"memmove", KIND_MOVE, (const void *) minicrt::memmove, (const void *) libc_memmove},
+        {"memset", KIND_SET, (const void *) minicrt::memset, (const void *) libc_memset},
+        {"memcmp", KIND_CMP, (const void *) minicrt::memcmp, (const void *) libc_memcmp},
+        {"strlen", KIND_STRLEN, (const void *) minicrt::strlen, (const void *) libc_strlen},
+        {"strnlen", KIND_STRNLEN, (const void *) minicrt::strnlen, (const void *) libc_strnlen},
+        {"strcmp", KIND_STRCMP, (const void *) minicrt::strcmp, (const void *) libc_strcmp},
+        {"memchr", KIND_MEMCHR, (const void *) minicrt::memchr, (const void *) libc_memchr},
+        {"memrchr", KIND_MEMCHR, (const void *) minicrt::memrchr, (const void *) libc_memrchr},
+        {"strchr", KIND_STRCHR, (const void *) minicrt::strchr, (const void *) libc_strchr},
+        {"strrchr", KIND_STRCHR, (const void *) minicrt::strrchr, (const void *) libc_strrchr},
+        {"strstr", KIND_STRSTR, (const void *) minicrt::strstr, (const void *) libc_strstr},
+        {"memmem", KIND_MEMMEM, (const void *) minicrt::memmem, (const void *) libc_memmem},
+        {"strspn", KIND_STRSPN, (const void *) minicrt::strspn, (const void *) libc_strspn},
+        {"strcspn", KIND_STRCSPN, (const void *) minicrt::strcspn, (const void *) libc_strcspn},
+    };
+
+    const size_t kFullAlignLimit = 64 * 1024;
+    const size_t kGridAlignLimit = 16 * 1024 * 1024;
+    const size_t kGridOffsets[] = {0, 1, 3, 8, 15, 16, 32, 63};
+
+    struct options {
+        std::string format = "csv";
+        std::vector<std::string> functions;
+        size_t min_size = 0;
+        size_t max_size = (size_t) 1 << 30;
+        std::string align = "full";
+        std::string cache = "both";
+        double time_ms = 2.0; // per aligned measurement
+        bool counters = false;
+    };
+
+    // Hardware events reported per call with --counters
+    const minicrt::perf_counter kBenchCounters[] = {
+        minicrt::PERF_CYCLES, minicrt::PERF_INSTRUCTIONS, minicrt::PERF_L1D_MISSES, minicrt::PERF_LLC_MISSES,
+        minicrt::PERF_BRANCH_MISSES
+    };
+    const size_t kBenchCounterCount = sizeof(kBenchCounters) / sizeof(kBenchCounters[0]);
+
+    minicrt::perf_group g_counters;
+
+    struct result {
+        const char *function;
+        const char *impl;
+        const char *cache;
+        size_t size;
+        double ns;          // aligned
+        size_t alignments;  // pairs measured, including the aligned one
+        double mean_ns;
+        double worst_ns;
+        size_t worst_src;
+        size_t worst_dst;
+        unsigned int events_available;               // PERF_MASK() bits; only with --counters
+        double events[minicrt::PERF_COUNTER_COUNT]; // per aligned call
+    };
+
+    /**
+     * @brief Two equally sized buffers, all 'a' bytes, cut into slots for one size
+     *
+     * Allocated once for the whole run. Hot runs use a single slot; cold runs rotate
+     * through enough slots to cover four times the last-level cache, continuing where
+     * the previous run stopped so that no run finds its data cached. The functions
+     * only ever write 'a' bytes, and string terminators are removed again after use.
+     */
+    struct buffers {
+        char *a = nullptr;
+        char *b = nullptr;
+        size_t length = 0;
+        size_t stride = 0;
+        size_t slots = 0;
+        size_t cursor = 0;
+        bool cold = false;
+
+        // memmove writes into the same buffer, half its size further on
+        static size_t slot_size(kind type, size_t size) {
+            size_t bytes = type == KIND_MOVE ? size + size / 2 + 192 : size + 128;
+            return (bytes + 4095) & ~(size_t) 4095;
+        }
+
+        bool allocate(size_t bytes) {
+            length = bytes;
+            a = (char *) mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            b = (char *) mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (a == MAP_FAILED || b == MAP_FAILED)
+                return false;
+            // Fault every page in and give the string functions non-zero bytes
+            std::memset(a, 'a', length);
+            std::memset(b, 'a', length);
+            return true;
+        }
+
+        bool layout(kind type, size_t size, bool cold_cache, size_t llc) {
+            stride = slot_size(type, size);
+            slots = cold_cache ? std::min(length / stride, 4 * llc / stride + 1) : 1;
+            cursor = 0;
+            cold = cold_cache;
+            return stride <= length;
+        }
+    };
+
+    volatile size_t g_sink;
+
+    /**
+     * @brief Place or remove the terminators the string functions stop at
+     */
+    void set_terminators(const function &f, buffers &buf, size_t size, size_t src, size_t dst, char value) {
+        if (f.type != KIND_STRLEN && f.type != KIND_STRNLEN && f.type != KIND_STRCMP && f.type != KIND_STRCHR
+            && f.type != KIND_STRSTR && f.type != KIND_STRSPN && f.type != KIND_STRCSPN)
+            return;
+        for (size_t slot = 0; slot < buf.slots; slot++) {
+            char *a = buf.a + slot * buf.stride + src + size;
+            char *b = buf.b + slot * buf.stride + dst + size;
+            *a = value;
+            if (f.type == KIND_STRCMP)
+                *b = value;
+#if defined(__x86_64__)
+            // Writing the terminators must not warm the cache for a cold run
+            if (buf.cold) {
+                _mm_clflush(a);
+                _mm_clflush(b);
+            }
+#endif
+        }
+    }
+
+    /**
+     * @brief Run calls calls and return the elapsed nanoseconds
+     */
+    double run(const function &f, const void *impl, buffers &buf, size_t size, size_t src, size_t dst,
+               size_t calls) {
+        size_t sink = 0;
+        size_t slot = buf.cursor;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; i++) {
+            char *a = buf.a + slot * buf.stride;
+            char *b = buf.b + slot * buf.stride;
+            if (++slot == buf.slots)
+                slot = 0;
+
+            switch (f.type) {
+                case KIND_COPY:
+                    sink += (size_t) ((copy_func) impl)(b + dst, a + src, size);
+                    break;
+                case KIND_MOVE: // dst starts inside the source range, so the copy runs backwards
+                    sink += (size_t) ((copy_func) impl)(a + ((size / 2 + 63) & ~(size_t) 63) + dst, a + src, size);
+                    break;
+                case KIND_SET:
+                    sink += (size_t) ((set_func) impl)(b + dst, 'a', size);
+                    break;
+                case KIND_CMP:
+                    sink += (size_t) ((cmp_func) impl)(a + src, b + dst, size);
+                    break;
+                case KIND_STRLEN:
+                    sink += ((strlen_func) impl)(a + src);
+                    break;
+                case KIND_STRNLEN:
+                    sink += ((strnlen_func) impl)(a + src, size + 1);
+                    break;
+                case KIND_STRCMP:
+                    sink += (size_t) ((strcmp_func) impl)(a + src, b + dst);
+                    break;
+                case KIND_MEMCHR:
+                    sink += (size_t) ((memchr_func) impl)(a + src, 'x', size);
+                    break;
+                case KIND_STRCHR:
+                    sink += (size_t) ((strchr_func) impl)(a + src, 'x');
+                    break;
+                case KIND_STRSTR:
+                    sink += (size_t) ((strstr_func) impl)(a + src, "needle");
+                    break;
+                case KIND_MEMMEM:
+                    sink += (size_t) ((memmem_func) impl)(a + src, size, "needle", 6);
+                    break;
+                case KIND_STRSPN:
+                    sink += ((strspn_func) impl)(a + src, "a");
+                    break;
+                case KIND_STRCSPN:
+                    sink += ((strspn_func) impl)(a + src, ",;\t\n");
+                    break;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        buf.cursor = slot;
+        g_sink = sink;
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+
+    /**
+     * @brief Cost of one call in nanoseconds: the best of repeats runs of calls calls
+     *
+     * With calls == 0 the count is grown until one run takes at least target_ns.
+     */
+    double measure(const function &f, const void *impl, buffers &buf, size_t size, size_t src, size_t dst,
+                   double target_ns, size_t calls, int repeats) {
+        set_terminators(f, buf, size, src, dst, '\0');
+
+        double elapsed;
+        if (calls == 0) {
+            calls = 1;
+            elapsed = run(f, impl, buf, size, src, dst, calls);
+            while (elapsed < target_ns && calls < ((size_t) 1 << 40)) {
+                calls = elapsed > 0 ? std::max(calls * 2, (size_t) ((double) calls * target_ns * 1.2 / elapsed))
+                                    : calls * 16;
+                elapsed = run(f, impl, buf, size, src, dst, calls);
+            }
+        } else {
+            elapsed = run(f, impl, buf, size, src, dst, calls);
+        }
+
+        double best = elapsed / (double) calls;
+        for (int i = 1; i < repeats; i++)
+            best = std::min(best, run(f, impl, buf, size, src, dst, calls) / (double) calls);
+
+        set_terminators(f, buf, size, src, dst, 'a');
+        return best;
+    }
+
+    /**
+     * @brief Hardware events of one aligned call, averaged over calls calls
+     */
+    void count_events(const function &f, const void *impl, buffers &buf, size_t size, size_t calls, result *r) {
+        set_terminators(f, buf, size, 0, 0, '\0');
+        minicrt::perf_region region;
+        minicrt::perf_values delta;
+        minicrt::perf_region_begin(&g_counters, &region);
+        run(f, impl, buf, size, 0, 0, calls);
+        minicrt::perf_region_end(&g_counters, &region, &delta);
+        set_terminators(f, buf, size, 0, 0, 'a');
+
+        // Scale up when the events were multiplexed
+        double scale = delta.multiplexed && delta.time_running
+                           ? (double) delta.time_enabled / (double) delta.time_running
+                           : 1.0;
+        r->events_available = delta.available;
+        for (int i = 0; i < minicrt::PERF_COUNTER_COUNT; i++)
+            r->events[i] = (double) delta.counts[i] * scale / (double) calls;
+    }
+
+    /**
+     * @brief The (source, destination) offsets to measure; single-buffer functions
+     *        only vary the buffer they use
+     */
+    std::vector<std::pair<size_t, size_t>> alignment_pairs(kind type, const std::vector<size_t> &offsets) {
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for (size_t o : offsets) {
+            if (type == KIND_SET)
+                pairs.emplace_back(0, o);
+            else if (type == KIND_STRLEN || type == KIND_STRNLEN || type >= KIND_MEMCHR)
+                pairs.emplace_back(o, 0);
+            else
+                for (size_t p : offsets)
+                    pairs.emplace_back(o, p);
+        }
+        return pairs;
+    }
+
+    std::vector<size_t> sizes(const options &opt) {
+        std::vector<size_t> list;
+        const size_t kSmall[] = {0, 1, 2, 3, 4, 7, 8, 15, 16, 31, 32, 48, 63, 64};
+        for (size_t s : kSmall)
+            list.push_back(s);
+        for (size_t p = 128; p <= ((size_t) 1 << 30); p *= 2) {
+            list.push_back(p - p / 4); // 96, 192, ...
+            list.push_back(p);
+        }
+
+        std::vector<size_t> selected;
+        for (size_t s : list) {
+            if (s >= opt.min_size && s <= opt.max_size)
+                selected.push_back(s);
+        }
+        return selected;
+    }
+
+    void print_header(const options &opt) {
+        if (opt.format == "csv") {
+            std::printf("function,impl,cache,size,ns_per_call,gb_per_s,alignments,mean_ns,worst_ns,worst_src_align,"
+                        "worst_dst_align");
+            for (size_t i = 0; opt.counters && i < kBenchCounterCount; i++)
+                std::printf(",%s_per_call", minicrt::perf_counter_name(kBenchCounters[i]));
+            std::printf("\n");
+        } else if (opt.format == "json") {
+            std::printf("{\n  \"cpu_tier\": \"%s\",\n  \"llc_bytes\": %zu,\n  \"results\": [",
+                        minicrt::cpu_tier_name(minicrt::cpu_active_tier()), minicrt::cpu_llc_size());
+        } else {
+            std::printf("cpu tier %s, last-level cache %zu KiB\n",
+                        minicrt::cpu_tier_name(minicrt::cpu_active_tier()), minicrt::cpu_llc_size() / 1024);
+            std::printf("%-8s %-7s %-4s %11s %11s %9s %6s %11s %11s %9s", "function", "impl", "mode", "size",
+                        "ns/call", "GB/s", "aligns", "mean ns", "worst ns", "worst at");
+            for (size_t i = 0; opt.counters && i < kBenchCounterCount; i++)
+                std::printf(" %13.13s", minicrt::perf_counter_name(kBenchCounters[i]));
+            std::printf("\n");
+        }
+    }
+
+    void print_result(const options &opt, const result &r, bool first) {
+        double gbps = r.ns > 0 ? (double) r.size / r.ns : 0.0;
+        if (opt.format == "csv") {
+            std::printf("%s,%s,%s,%zu,%.3f,%.3f,%zu,%.3f,%.3f,%zu,%zu", r.function, r.impl, r.cache, r.size, r.ns,
+                        gbps, r.alignments, r.mean_ns, r.worst_ns, r.worst_src, r.worst_dst);
+            for (size_t i = 0; opt.counters && i < kBenchCounterCount; i++) {
+                if (r.events_available & PERF_MASK(kBenchCounters[i]))
+                    std::printf(",%.3f", r.events[kBenchCounters[i]]);
+                else
+                    std::printf(",");
+            }
+            std::printf("\n");
+        } else if (opt.format == "json") {
+            std::printf("%s\n    {\"function\": \"%s\", \"impl\": \"%s\", \"cache\": \"%s\", \"size\": %zu, "
+                        "\"ns_per_call\": %.3f, \"gb_per_s\": %.3f, \"alignments\": %zu, \"mean_ns\": %.3f, "
+                        "\"worst_ns\": %.3f, \"worst_src_align\": %zu, \"worst_dst_align\": %zu",
+                        first ? "" : ",", r.function, r.impl, r.cache, r.size, r.ns, gbps, r.alignments, r.mean_ns,
+                        r.worst_ns, r.worst_src, r.worst_dst);
+            for (size_t i = 0; opt.counters && i < kBenchCounterCount; i++) {
+                if (r.events_available & PERF_MASK(kBenchCounters[i]))
+                    std::printf(", \"%s_per_call\": %.3f", minicrt::perf_counter_name(kBenchCounters[i]),
+                                r.events[kBenchCounters[i]]);
+            }
+            std::printf("}");
+        } else {
+            char at[32];
+            std::snprintf(at, sizeof(at), "%zu/%zu", r.worst_src, r.worst_dst);
+            std::printf("%-8s %-7s %-4s %11zu %11.2f %9.2f %6zu %11.2f %11.2f %9s", r.function, r.impl, r.cache,
+                        r.size, r.ns, gbps, r.alignments, r.mean_ns, r.worst_ns, at);
+            for (size_t i = 0; opt.counters && i < kBenchCounterCount; i++) {
+                if (r.events_available & PERF_MASK(kBenchCounters[i]))
+                    std::printf(" %13.2f", r.events[kBenchCounters[i]]);
+                else
+                    std::printf(" %13s", "-");
+            }
+            std::printf("\n");
+        }
+        std::fflush(stdout);
+    }
+
+    void print_footer(const options &opt) {
+        if (opt.format == "json")
+            std::printf("\n  ]\n}\n");
+    }
+
+    bool parse_options(int argc, char **argv, options *opt) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            size_t eq = arg.find('=');
+            std::string key = arg.substr(0, eq);
+            std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+            if (key == "--format" && (value == "csv" || value == "json" || value == "table")) {
+                opt->format = value;
+            } else if (key == "--functions") {
+                size_t start = 0;
+                while (start <= value.size()) {
+                    size_t comma = value.find(',', start);
+                    if (comma == std::string::npos)
+                        comma = value.size();
+                    opt->functions.push_back(value.substr(start, comma - start));
+                    start = comma + 1;
+                }
+            } else if (key == "--min-size") {
+                opt->min_size = (size_t) std::strtoull(value.c_str(), nullptr, 0);
+            } else if (key == "--max-size") {
+                opt->max_size = (size_t) std::strtoull(value.c_str(), nullptr, 0);
+            } else if (key == "--align" && (value == "full" || value == "grid" || value == "none")) {
+                opt->align = value;
+            } else if (key == "--cache" && (value == "hot" || value == "cold" || value == "both")) {
+                opt->cache = value;
+            } else if (key == "--time") {
+                opt->time_ms = std::atof(value.c_str());
+            } else if (key == "--counters" && eq == std::string::npos) {
+                opt->counters = true;
+            } else {
+                std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    options opt;
+    if (!parse_options(argc, argv, &opt))
+        return 1;
+
+    size_t llc = minicrt::cpu_llc_size();
+    if (llc == 0)
+        llc = 32 << 20;
+
+    // Room for the largest hot slot and for the cold rotation
+    std::vector<size_t> size_list = sizes(opt);
+    size_t largest = size_list.empty() ? 0 : buffers::slot_size(KIND_MOVE, size_list.back());
+    buffers buf;
+    if (!buf.allocate(std::max(largest, opt.cache == "hot" ? 0 : 4 * llc + buffers::slot_size(KIND_MOVE, 0)))) {
+        std::fprintf(stderr, "cannot allocate the benchmark buffers\n");
+        return 1;
+    }
+
+    if (opt.counters) {
+        unsigned int mask = 0;
+        for (size_t i = 0; i < kBenchCounterCount; i++)
+            mask |= PERF_MASK(kBenchCounters[i]);
+        if (minicrt::perf_group_open(&g_counters, mask) == 0)
+            std::fprintf(stderr, "no hardware counters available; counter columns stay empty\n");
+    }
+
+    print_header(opt);
+    bool first = true;
+    for (const function &f : kFunctions) {
+        if (!opt.functions.empty() && std::find(opt.functions.begin(), opt.functions.end(), f.name) == opt.functions.end())
+            continue;
+
+        for (size_t size : size_list) {
+            for (int cold = 0; cold < 2; cold++) {
+                if ((cold && opt.cache == "hot") || (!cold && opt.cache == "cold"))
+                    continue;
+                if (!buf.layout(f.type, size, cold != 0, llc))
+                    continue;
+
+                // Alignment pairs besides (0, 0)
+                std::vector<size_t> offsets;
+                if (opt.align == "full" && !cold && size <= kFullAlignLimit) {
+                    for (size_t o = 0; o < 64; o++)
+                        offsets.push_back(o);
+                } else if (opt.align != "none" && size <= kGridAlignLimit) {
+                    offsets.assign(kGridOffsets, kGridOffsets + sizeof(kGridOffsets) / sizeof(kGridOffsets[0]));
+                } else {
+                    offsets.push_back(0);
+                }
+
+                const void *impls[2] = {f.mini, f.libc};
+                const char *names[2] = {"minicrt", "libc"};
+                for (int i = 0; i < 2; i++) {
+                    result r = {};
+                    r.function = f.name;
+                    r.impl = names[i];
+                    r.cache = cold ? "cold" : "hot";
+                    r.size = size;
+                    r.ns = measure(f, impls[i], buf, size, 0, 0, opt.time_ms * 1e6, 0, 3);
+
+                    // Shorter runs per alignment pair, sized from the aligned cost; the
+                    // best of three filters out runs that were interrupted
+                    size_t pair_calls = (size_t) (opt.time_ms * 1e6 / 300 / std::max(r.ns, 1.0)) + 1;
+                    if (opt.counters)
+                        count_events(f, impls[i], buf, size, pair_calls * 30, &r);
+                    double total = 0;
+                    r.worst_ns = r.ns;
+                    for (const std::pair<size_t, size_t> &pair : alignment_pairs(f.type, offsets)) {
+                        size_t src = pair.first, dst = pair.second;
+                        double ns = (src == 0 && dst == 0) ? r.ns
+                                                           : measure(f, impls[i], buf, size, src, dst, 0, pair_calls, 3);
+                        total += ns;
+                        r.alignments++;
+                        if (ns > r.worst_ns) {
+                            r.worst_ns = ns;
+                            r.worst_src = src;
+                            r.worst_dst = dst;
+                        }
+                    }
+                    r.mean_ns = total / (double) r.alignments;
+                    print_result(opt, r, first);
+                    first = false;
+                }
+            }
+        }
+    }
+    print_footer(opt);
+    minicrt::perf_group_close(&g_counters);
+    return 0;
+}
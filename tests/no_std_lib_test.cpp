@@ -3,6 +3,7 @@
 //
 #include "minicrt/string.h"
 #include "minicrt/memory.h"
+#include "minicrt/stdio.h"
 
 // Simplified test framework macros without using stdio.h
 #define TEST_ASSERT(condition) do { if (!(condition)) return #condition; } while(0)
@@ -27,12 +28,6 @@ const char *test_memory_basic();
 int main();
 
 #ifdef _WIN32
-// Import Windows API directly
-extern "C" {
-int __stdcall WriteFile(void *hFile, const void *buffer, unsigned long nBytesToWrite,
-                        unsigned long *lpBytesWritten, void *lpOverlapped);
-}
-
 extern "C" int CustomMainCRTStartup() {
     return main();
 }
@@ -60,42 +55,6 @@ void __chkstk() {
 #endif
 
 
-// Custom output function since we don't have stdio
-void output_string(const char *str) {
-#ifdef _WIN32
-    // Use Windows API to print to console
-#ifdef _WIN64
-    // On 64-bit Windows, use the correct value for handles
-    void *handle = reinterpret_cast<void *>(static_cast<long int>(-11)); // STD_OUTPUT_HANDLE is -11
-#else
-    // On 32-bit Windows, the original value works fine
-    void* handle = reinterpret_cast<void*>(0xfffffff5); // STD_OUTPUT_HANDLE
-#endif
-    unsigned long written;
-    unsigned long len = 0;
-    const char *s = str;
-    while (*s++) len++;
-
-    WriteFile(handle, str, len, &written, 0);
-#else
-    // Use Linux syscall for write to stdout
-    long result = 0;
-    int len = 0;
-    const char* s = str;
-    while (*s++) len++;
-
-    asm("movl $1, %%eax\n"     // syscall: write
-        "movl $1, %%edi\n"     // file descriptor: stdout
-        "movq %1, %%rsi\n"     // buffer
-        "movl %2, %%edx\n"     // length
-        "syscall\n"
-        "movl %%eax, %0"
-        : "=r" (result)
-        : "r" (str), "r" (len)
-        : "eax", "edi", "rsi", "edx");
-#endif
-}
-
 /**
  * Main entry point for string tests
  */
@@ -106,7 +65,7 @@ int main() {
         test_strnlen_basic,
         test_strcpy_basic,
         test_strcmp_basic,
-        // test_memory_basic
+        test_memory_basic
     };
 
     int test_count = sizeof(tests) / sizeof(tests[0]);
@@ -120,15 +79,16 @@ int main() {
             passed++;
         } else {
             failed++;
-            // In a real implementation, we would print the error message
-            // but we don't have printf yet
+            minicrt::stream_puts(minicrt::stderr_stream(), result);
+            minicrt::stream_putc(minicrt::stderr_stream(), '\n');
         }
     }
 
     // Use a simple check to verify all tests passed
     if (passed == test_count && failed == 0) {
-        const char success_message[] = "All tests passed!\n";
-        output_string(success_message);
+        // Our entry point bypasses minicrt_cleanup(), so flush by hand
+        minicrt::stream_puts(minicrt::stdout_stream(), "All tests passed!\n");
+        minicrt::stream_flush(minicrt::stdout_stream());
         return 0; // Success
     }
 
@@ -199,10 +159,9 @@ const char *test_strcmp_basic() {
 /**
  * Test basic memory operations
  */
-/*const char* test_memory_basic()
-{
+const char *test_memory_basic() {
     // Test malloc/free
-    void* ptr = minicrt::malloc(100);
+    void *ptr = minicrt::malloc(100);
     TEST_ASSERT_NE(ptr, 0);
 
     // Test memset
@@ -219,7 +178,7 @@ const char *test_strcmp_basic() {
     TEST_ASSERT_EQ(minicrt::memcmp(ptr, src, 9), 0);
 
     // Test free
-    // minicrt::free(ptr);
+    minicrt::free(ptr);
 
     return 0; // Success
-}*/
+}
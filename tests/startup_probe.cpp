@@ -0,0 +1,38 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+
+/**
+ * Startup probe for bench_startup (not part of the test suite)
+ *
+ * Prints CLOCK_MONOTONIC in nanoseconds as the first thing main() does, then exits.
+ * Built twice: freestanding against MiniCRT (STARTUP_PROBE_MINICRT) and as an
+ * ordinary program against the system C library.
+ */
+
+#ifdef STARTUP_PROBE_MINICRT
+#include "minicrt/stdio.h"
+
+static long long monotonic_ns() {
+    long ts[2];
+    long ret;
+    asm volatile("syscall" : "=a" (ret) : "a" (228L), "D" (1L), "S" (ts) : "rcx", "r11", "memory");
+    return ret ? -1 : ts[0] * 1000000000LL + ts[1];
+}
+
+int main() {
+    long long now = monotonic_ns();
+    minicrt::printf("%lld\n", now);
+    return 0;
+}
+#else
+#include <cstdio>
+#include <ctime>
+
+int main() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    std::printf("%lld\n", ts.tv_sec * 1000000000LL + ts.tv_nsec);
+    return 0;
+}
+#endif
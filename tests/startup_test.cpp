@@ -0,0 +1,221 @@
+//
+// Created by seiftnesse on 3/1/2025.
+//
+#include "minicrt/crt.h"
+#include "minicrt/cpu.h"
+#include "minicrt/stdio.h"
+#include "minicrt/memory.h"
+#include "minicrt/pool.h"
+#include "minicrt/string.h"
+#include "minicrt/sync.h"
+#include "minicrt/thread.h"
+#include "minicrt/time.h"
+
+/**
+ * Freestanding startup test (Linux x86-64)
+ *
+ * Built without the system C library, so the process enters through MiniCRT's own
+ * _start. CTest runs it as: startup_test first "second arg", with
+ * MINICRT_STARTUP_TEST=expected and MINICRT_CPU_TIER=sse2 in the environment.
+ */
+
+#define TEST_ASSERT(condition) do { if (!(condition)) return #condition; } while (0)
+
+static int g_argc;
+static char **g_argv;
+static char **g_envp;
+
+static const char *test_arguments() {
+    TEST_ASSERT(g_argc == 3);
+    TEST_ASSERT(minicrt::strcmp(g_argv[1], "first") == 0);
+    TEST_ASSERT(minicrt::strcmp(g_argv[2], "second arg") == 0);
+    TEST_ASSERT(g_argv[3] == 0);
+
+    // argv[0] is the path the program was started with
+    size_t length = minicrt::strlen(g_argv[0]);
+    TEST_ASSERT(length >= 12 && minicrt::strcmp(g_argv[0] + length - 12, "startup_test") == 0);
+    return 0;
+}
+
+static const char *test_environment() {
+    // The environment directly follows argv on the initial stack
+    TEST_ASSERT(g_envp == g_argv + g_argc + 1);
+    TEST_ASSERT(minicrt::environ == g_envp);
+
+    const char *value = minicrt::getenv("MINICRT_STARTUP_TEST");
+    TEST_ASSERT(value != 0 && minicrt::strcmp(value, "expected") == 0);
+    TEST_ASSERT(minicrt::getenv("MINICRT_STARTUP") == 0);
+    TEST_ASSERT(minicrt::getenv("MINICRT_STARTUP_TEST_") == 0);
+    return 0;
+}
+
+static const char *test_aux_vector() {
+    unsigned long page = minicrt::getauxval(AT_PAGESZ);
+    TEST_ASSERT(page >= 4096 && (page & (page - 1)) == 0);
+
+    // The vDSO is a complete ELF image mapped by the kernel
+    const unsigned char *vdso = (const unsigned char *) minicrt::getauxval(AT_SYSINFO_EHDR);
+    TEST_ASSERT(vdso != 0);
+    TEST_ASSERT(vdso[0] == 0x7F && vdso[1] == 'E' && vdso[2] == 'L' && vdso[3] == 'F');
+
+    TEST_ASSERT(minicrt::getauxval(AT_HWCAP) != 0);
+    TEST_ASSERT(minicrt::getauxval(AT_RANDOM) != 0);
+
+    const char *execfn = (const char *) minicrt::getauxval(AT_EXECFN);
+    TEST_ASSERT(execfn != 0 && minicrt::strcmp(execfn, g_argv[0]) == 0);
+
+    minicrt::errno = 0;
+    TEST_ASSERT(minicrt::getauxval(1000) == 0);
+    TEST_ASSERT(minicrt::errno == ENOENT);
+    return 0;
+}
+
+static const char *test_stack_alignment() {
+    // With a frame pointer, a 16-byte aligned call site leaves rbp 16-byte aligned
+    TEST_ASSERT(((size_t) __builtin_frame_address(0) & 15) == 0);
+    return 0;
+}
+
+static const char *test_vdso_clock() {
+    // minicrt_init() resolved the clock functions from the vDSO named in the aux vector
+    TEST_ASSERT(minicrt::clock_has_vdso());
+
+    minicrt::timespec a, b;
+    TEST_ASSERT(minicrt::clock_gettime(CLOCK_MONOTONIC, &a) == 0);
+    TEST_ASSERT(minicrt::clock_gettime(CLOCK_MONOTONIC, &b) == 0);
+    TEST_ASSERT(b.tv_sec > a.tv_sec || (b.tv_sec == a.tv_sec && b.tv_nsec >= a.tv_nsec));
+
+    minicrt::timeval tv;
+    TEST_ASSERT(minicrt::gettimeofday(&tv, 0) == 0);
+    TEST_ASSERT(tv.tv_sec > 1500000000L);
+
+    minicrt::errno = 0;
+    TEST_ASSERT(minicrt::clock_gettime(12345, &a) == -1);
+    TEST_ASSERT(minicrt::errno == EINVAL);
+    return 0;
+}
+
+static const char *test_cpu_tier_override() {
+    minicrt::cpu_tier expected = minicrt::cpu_best_tier();
+    if (expected > minicrt::CPU_TIER_SSE2)
+        expected = minicrt::CPU_TIER_SSE2;
+    TEST_ASSERT(minicrt::cpu_active_tier() == expected);
+    return 0;
+}
+
+// Initialized thread_local data, so each thread starts from a copy of the TLS image
+static thread_local int t_counter = 5;
+
+static int thread_body(void *arg) {
+    int id = (int) (size_t) arg;
+    minicrt::errno = 100 + id;
+    t_counter += id;
+
+    // Some allocator traffic through the thread's own heap
+    for (int i = 0; i < 100; i++) {
+        char *p = (char *) minicrt::malloc(16 + i);
+        if (!p)
+            return -1;
+        p[0] = (char) i;
+        minicrt::free(p);
+    }
+    if (minicrt::errno != 100 + id)
+        return -2;
+    return t_counter;
+}
+
+static const char *test_threads() {
+    const int kThreads = 8;
+    minicrt::thread *threads[kThreads];
+
+    minicrt::errno = 7;
+    for (int i = 0; i < kThreads; i++)
+        TEST_ASSERT(minicrt::thread_create(&threads[i], thread_body, (void *) (size_t) i, 0) == 0);
+    for (int i = 0; i < kThreads; i++) {
+        int result = 0;
+        TEST_ASSERT(minicrt::thread_join(threads[i], &result) == 0);
+        TEST_ASSERT(result == 5 + i);
+    }
+
+    // The main thread's errno and thread_local data are its own
+    TEST_ASSERT(minicrt::errno == 7);
+    TEST_ASSERT(t_counter == 5);
+
+    // Joined stacks are reused; a custom stack size gets a mapping of its own
+    for (int i = 0; i < 100; i++) {
+        minicrt::thread *t;
+        int result = 0;
+        TEST_ASSERT(minicrt::thread_create(&t, thread_body, (void *) (size_t) (i % 3), i % 2 ? 64 * 1024 : 0) == 0);
+        TEST_ASSERT(minicrt::thread_join(t, &result) == 0);
+        TEST_ASSERT(result == 5 + i % 3);
+    }
+    return 0;
+}
+
+static void sum_body(size_t begin, size_t end, void *arg) {
+    size_t sum = 0;
+    for (size_t i = begin; i < end; i++)
+        sum += i;
+    __atomic_fetch_add((size_t *) arg, sum, __ATOMIC_RELAXED);
+}
+
+// Uses the pool and leaves its workers running: main returns without pool_stop()
+static const char *test_pool_at_exit() {
+    size_t sum = 0;
+    TEST_ASSERT(minicrt::pool_start(2) == 2);
+    minicrt::parallel_for(0, 10000, 100, sum_body, &sum);
+    TEST_ASSERT(sum == 10000 * 9999 / 2);
+    TEST_ASSERT(minicrt::pool_worker_count() == 2);
+    return 0;
+}
+
+// Held by the main thread until the process exits
+static minicrt::mutex g_exit_lock;
+
+static int blocked_body(void *) {
+    minicrt::mutex_lock(&g_exit_lock);
+    return 0;
+}
+
+// Leaves a thread blocked for good: returning from main must still end the process
+// (exit_group, not exit), which the test timeout in CMakeLists.txt checks
+static const char *test_live_thread_at_exit() {
+    minicrt::thread *t;
+    minicrt::mutex_init(&g_exit_lock);
+    minicrt::mutex_lock(&g_exit_lock);
+    TEST_ASSERT(minicrt::thread_create(&t, blocked_body, 0, 0) == 0);
+    return 0;
+}
+
+int main(int argc, char **argv, char **envp) {
+    g_argc = argc;
+    g_argv = argv;
+    g_envp = envp;
+
+    typedef const char *(*test_func)();
+    const test_func tests[] = {
+        test_arguments,
+        test_environment,
+        test_aux_vector,
+        test_stack_alignment,
+        test_vdso_clock,
+        test_cpu_tier_override,
+        test_threads,
+        test_pool_at_exit,
+        test_live_thread_at_exit,
+    };
+
+    int failed = 0;
+    for (test_func test : tests) {
+        const char *result = test();
+        if (result) {
+            failed++;
+            minicrt::stream_printf(minicrt::stderr_stream(), "FAILED: %s\n", result);
+        }
+    }
+
+    if (failed)
+        return 1;
+    minicrt::stream_puts(minicrt::stdout_stream(), "All tests passed!\n");
+    return 0; // exit() flushes standard output
+}
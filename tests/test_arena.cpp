@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "minicrt/memory.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+class ArenaTest : public ::testing::Test {
+protected:
+    void SetUp() override { ASSERT_EQ(0, minicrt::arena_create(&arena, 0, 0)); }
+    void TearDown() override { minicrt::arena_destroy(&arena); }
+
+    minicrt::arena arena;
+};
+
+TEST_F(ArenaTest, AllocationsAreAlignedAndDisjoint) {
+    std::vector<std::pair<unsigned char *, size_t>> blocks;
+
+    for (size_t i = 0; i < 5000; i++) {
+        size_t size = 1 + (i * 29) % 700;
+        size_t align = (size_t) 1 << (i % 8);
+        unsigned char *p = (unsigned char *) minicrt::arena_alloc(&arena, size, align);
+        ASSERT_NE(nullptr, p);
+        EXPECT_EQ(0u, (size_t) p % align);
+        std::memset(p, (int) (i & 0xFF), size);
+        blocks.emplace_back(p, size);
+    }
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        for (size_t j = 0; j < blocks[i].second; j++)
+            ASSERT_EQ((unsigned char) (i & 0xFF), blocks[i].first[j]) << i;
+    }
+}
+
+TEST_F(ArenaTest, DefaultAlignment) {
+    minicrt::arena_alloc(&arena, 3, 1);
+    EXPECT_EQ(0u, (size_t) minicrt::arena_alloc(&arena, 8, 0) % 16);
+}
+
+TEST_F(ArenaTest, LargeAllocationsAndAlignments) {
+    // Bigger than any chunk so far, and an alignment larger than a page
+    void *big = minicrt::arena_alloc(&arena, 10u << 20, 64);
+    ASSERT_NE(nullptr, big);
+    std::memset(big, 1, 10u << 20);
+
+    void *page = minicrt::arena_alloc(&arena, 100, 8192);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0u, (size_t) page % 8192);
+}
+
+TEST_F(ArenaTest, ResetReusesChunks) {
+    std::vector<void *> first_pass;
+    for (int i = 0; i < 1000; i++)
+        first_pass.push_back(minicrt::arena_alloc(&arena, 512, 16));
+
+    minicrt::arena_reset(&arena);
+
+    // The same sequence of requests lands on the same addresses
+    for (int i = 0; i < 1000; i++)
+        EXPECT_EQ(first_pass[i], minicrt::arena_alloc(&arena, 512, 16)) << i;
+}
+
+TEST_F(ArenaTest, CheckpointRollback) {
+    minicrt::arena_alloc(&arena, 100, 16);
+    minicrt::arena_checkpoint checkpoint = minicrt::arena_save(&arena);
+
+    void *a = minicrt::arena_alloc(&arena, 64, 16);
+    for (int i = 0; i < 2000; i++)
+        minicrt::arena_alloc(&arena, 256, 16); // spills into later chunks
+
+    minicrt::arena_rollback(&arena, checkpoint);
+    EXPECT_EQ(a, minicrt::arena_alloc(&arena, 64, 16));
+
+    // Nested checkpoints unwind in order
+    minicrt::arena_checkpoint outer = minicrt::arena_save(&arena);
+    void *b = minicrt::arena_alloc(&arena, 32, 16);
+    minicrt::arena_checkpoint inner = minicrt::arena_save(&arena);
+    void *c = minicrt::arena_alloc(&arena, 32, 16);
+    minicrt::arena_rollback(&arena, inner);
+    EXPECT_EQ(c, minicrt::arena_alloc(&arena, 32, 16));
+    minicrt::arena_rollback(&arena, outer);
+    EXPECT_EQ(b, minicrt::arena_alloc(&arena, 32, 16));
+}
+
+#ifdef __linux__
+namespace {
+    // Number of resident pages in [p, p + size)
+    size_t resident_pages(void *p, size_t size) {
+        long page = sysconf(_SC_PAGESIZE);
+        char *start = (char *) ((size_t) p & ~(size_t) (page - 1));
+        size_t pages = ((char *) p + size - start + page - 1) / page;
+        std::vector<unsigned char> vec(pages);
+        if (mincore(start, pages * page, vec.data()) != 0)
+            return 0;
+        size_t count = 0;
+        for (unsigned char v : vec)
+            count += v & 1;
+        return count;
+    }
+}
+
+TEST(ArenaColdTest, ReleasesChunksUnusedSinceLastReset) {
+    minicrt::arena arena;
+    ASSERT_EQ(0, minicrt::arena_create(&arena, 4096, minicrt::ARENA_RELEASE_COLD));
+
+    // One large pass spills into a second chunk
+    minicrt::arena_alloc(&arena, 1024, 16);
+    char *spill = (char *) minicrt::arena_alloc(&arena, 1u << 20, 16);
+    ASSERT_NE(nullptr, spill);
+    std::memset(spill, 0x77, 1u << 20);
+    EXPECT_GT(resident_pages(spill, 1u << 20), 200u);
+
+    // The second chunk was used in this cycle, so it stays resident
+    minicrt::arena_reset(&arena);
+    EXPECT_GT(resident_pages(spill, 1u << 20), 200u);
+
+    // A small cycle never touches it: it turns cold and its pages are dropped
+    minicrt::arena_alloc(&arena, 64, 16);
+    minicrt::arena_reset(&arena);
+    EXPECT_LT(resident_pages(spill, 1u << 20), 4u);
+
+    // The chunk is still reused, and reads back as fresh zeroed memory
+    minicrt::arena_alloc(&arena, 1024, 16);
+    char *again = (char *) minicrt::arena_alloc(&arena, 1u << 20, 16);
+    EXPECT_EQ(spill, again);
+    EXPECT_EQ(0, again[4096]);
+
+    minicrt::arena_destroy(&arena);
+}
+#endif
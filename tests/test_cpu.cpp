@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "minicrt/cpu.h"
+#include "minicrt/memory.h"
+#include "minicrt/string.h"
+
+namespace {
+    // Runs a test body once for every tier the CPU supports, restoring the best tier afterwards
+    template <typename Body>
+    void for_each_tier(Body body) {
+        minicrt::cpu_tier best = minicrt::cpu_best_tier();
+        for (int t = minicrt::CPU_TIER_GENERIC; t <= best; t++) {
+            minicrt::cpu_tier tier = (minicrt::cpu_tier) t;
+            ASSERT_EQ(0, minicrt::cpu_set_tier(tier));
+            ASSERT_EQ(tier, minicrt::cpu_active_tier());
+            SCOPED_TRACE(minicrt::cpu_tier_name(tier));
+            body();
+        }
+        minicrt::cpu_set_tier(best);
+    }
+
+    int sign(int v) {
+        return (v > 0) - (v < 0);
+    }
+}
+
+TEST(CpuTest, FeatureProbe) {
+    unsigned int features = minicrt::cpu_features();
+
+#if defined(__x86_64__) || defined(_M_X64)
+    EXPECT_TRUE(minicrt::cpu_has(minicrt::CPU_FEATURE_SSE2));
+    EXPECT_GE(minicrt::cpu_best_tier(), minicrt::CPU_TIER_SSE2);
+#endif
+    // AVX2 requires OS-enabled AVX state
+    if (features & minicrt::CPU_FEATURE_AVX2) {
+        EXPECT_TRUE(features & minicrt::CPU_FEATURE_AVX);
+    }
+    EXPECT_EQ(minicrt::cpu_best_tier(), minicrt::cpu_active_tier());
+}
+
+TEST(CpuTest, SetTier) {
+    EXPECT_EQ(-1, minicrt::cpu_set_tier((minicrt::cpu_tier) (minicrt::cpu_best_tier() + 1)));
+    EXPECT_EQ(0, minicrt::cpu_set_tier(minicrt::CPU_TIER_GENERIC));
+    EXPECT_EQ(minicrt::CPU_TIER_GENERIC, minicrt::cpu_active_tier());
+    EXPECT_EQ(0, minicrt::cpu_set_tier(minicrt::cpu_best_tier()));
+
+    EXPECT_STREQ("generic", minicrt::cpu_tier_name(minicrt::CPU_TIER_GENERIC));
+    EXPECT_STREQ("sse2", minicrt::cpu_tier_name(minicrt::CPU_TIER_SSE2));
+    EXPECT_STREQ("avx2", minicrt::cpu_tier_name(minicrt::CPU_TIER_AVX2));
+}
+
+TEST(CpuTest, MemoryKernelsEveryTier) {
+    const size_t max_size = 9000; // crosses the REP MOVSB/STOSB thresholds
+    std::vector<unsigned char> src(max_size + 64), dst(max_size + 64), expected(max_size + 64);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = (unsigned char) (i * 13 + 1);
+
+    for_each_tier([&] {
+        for (size_t size = 0; size <= max_size; size += (size < 300 ? 1 : 97)) {
+            for (size_t off = 0; off < 64; off += 9) {
+                std::memset(dst.data(), 0, dst.size());
+                std::memcpy(expected.data(), dst.data(), dst.size());
+                std::memcpy(expected.data() + off, src.data() + 3, size);
+                minicrt::memcpy(dst.data() + off, src.data() + 3, size);
+                ASSERT_EQ(0, std::memcmp(dst.data(), expected.data(), dst.size())) << "memcpy " << size;
+
+                std::memset(expected.data() + off, 0x7F, size);
+                minicrt::memset(dst.data() + off, 0x7F, size);
+                ASSERT_EQ(0, std::memcmp(dst.data(), expected.data(), dst.size())) << "memset " << size;
+            }
+        }
+    });
+}
+
+TEST(CpuTest, MemMoveEveryTier) {
+    std::vector<unsigned char> buf(2048), expected(2048);
+
+    for_each_tier([&] {
+        for (size_t size = 0; size <= 1500; size += (size < 300 ? 1 : 61)) {
+            for (size_t shift = 1; shift < 300; shift += 37) {
+                for (size_t i = 0; i < buf.size(); i++)
+                    buf[i] = expected[i] = (unsigned char) (i * 7 + 1);
+                std::memmove(expected.data() + shift, expected.data() + 5, size);
+                minicrt::memmove(buf.data() + shift, buf.data() + 5, size);
+                ASSERT_EQ(0, std::memcmp(buf.data(), expected.data(), buf.size())) << "up " << size;
+
+                std::memmove(expected.data() + 5, expected.data() + shift + 5, size);
+                minicrt::memmove(buf.data() + 5, buf.data() + shift + 5, size);
+                ASSERT_EQ(0, std::memcmp(buf.data(), expected.data(), buf.size())) << "down " << size;
+            }
+        }
+    });
+}
+
+TEST(CpuTest, MemCmpEveryTier) {
+    std::vector<unsigned char> a(300), b(300);
+    for (size_t i = 0; i < a.size(); i++)
+        a[i] = b[i] = (unsigned char) (i * 5 + 1);
+
+    for_each_tier([&] {
+        for (size_t size = 0; size <= 200; size++) {
+            ASSERT_EQ(0, minicrt::memcmp(a.data(), b.data(), size));
+            for (size_t pos = 0; pos < size; pos++) {
+                unsigned char saved = b[pos];
+                b[pos] = (unsigned char) (saved + 0x80);
+                ASSERT_EQ(sign(std::memcmp(a.data(), b.data(), size)),
+                          sign(minicrt::memcmp(a.data(), b.data(), size))) << size << "/" << pos;
+                b[pos] = saved;
+            }
+        }
+    });
+}
+
+TEST(CpuTest, StringKernelsEveryTier) {
+    for_each_tier([&] {
+        EXPECT_EQ(13u, minicrt::strlen("Hello, World!"));
+        EXPECT_EQ(5u, minicrt::strnlen("Hello, World!", 5));
+        EXPECT_LT(minicrt::strcmp("Hello", "World"), 0);
+    });
+}
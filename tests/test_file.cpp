@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "minicrt/file.h"
+#include "minicrt/memory.h"
+#include "minicrt/string.h"
+
+namespace {
+    // Temporary file removed at the end of the test
+    class TempFile {
+    public:
+        explicit TempFile(const std::string &contents) {
+            char name[] = "/tmp/minicrt_file_XXXXXX";
+            int fd = mkstemp(name);
+            EXPECT_GE(fd, 0);
+            path_ = name;
+            size_t written = 0;
+            while (written < contents.size()) {
+                ssize_t n = write(fd, contents.data() + written, contents.size() - written);
+                if (n <= 0)
+                    break;
+                written += (size_t) n;
+            }
+            close(fd);
+        }
+
+        ~TempFile() { unlink(path_.c_str()); }
+
+        const char *path() const { return path_.c_str(); }
+
+    private:
+        std::string path_;
+    };
+
+    std::string pattern(size_t size) {
+        std::string s(size, '\0');
+        for (size_t i = 0; i < size; i++)
+            s[i] = (char) ('a' + (i * 7 + i / 251) % 26);
+        return s;
+    }
+}
+
+TEST(MappedFileTest, ContentsAndTerminatingZero) {
+    long page = sysconf(_SC_PAGESIZE);
+    const size_t sizes[] = {1, 100, (size_t) page - 1, (size_t) page, (size_t) page + 1, 3 * (size_t) page,
+                            1000000};
+    for (size_t size : sizes) {
+        std::string contents = pattern(size);
+        TempFile temp(contents);
+
+        minicrt::mapped_file file;
+        ASSERT_EQ(0, minicrt::map_file(temp.path(), 0, &file)) << size;
+        ASSERT_EQ(size, file.size);
+        EXPECT_EQ(0, minicrt::memcmp(file.data, contents.data(), size)) << size;
+        EXPECT_EQ(0, file.data[size]) << size;
+        EXPECT_EQ(size, minicrt::strlen(file.data)) << size;
+        minicrt::unmap_file(&file);
+        EXPECT_EQ(nullptr, file.data);
+        EXPECT_EQ(0u, file.size);
+    }
+}
+
+TEST(MappedFileTest, EmptyFile) {
+    TempFile temp("");
+    minicrt::mapped_file file;
+    ASSERT_EQ(0, minicrt::map_file(temp.path(), minicrt::FILE_MAP_POPULATE, &file));
+    EXPECT_EQ(0u, file.size);
+    ASSERT_NE(nullptr, file.data);
+    EXPECT_EQ(0, file.data[0]);
+    minicrt::unmap_file(&file);
+}
+
+TEST(MappedFileTest, Flags) {
+    std::string contents = pattern(5 * 1024 * 1024 + 17);
+    TempFile temp(contents);
+
+    const unsigned int flag_sets[] = {
+        minicrt::FILE_MAP_SEQUENTIAL,
+        minicrt::FILE_MAP_RANDOM | minicrt::FILE_MAP_WILLNEED,
+        minicrt::FILE_MAP_POPULATE,
+        minicrt::FILE_MAP_HUGE_PAGES,
+        minicrt::FILE_MAP_HUGE_PAGES | minicrt::FILE_MAP_POPULATE | minicrt::FILE_MAP_SEQUENTIAL,
+    };
+    for (unsigned int flags : flag_sets) {
+        minicrt::mapped_file file;
+        ASSERT_EQ(0, minicrt::map_file(temp.path(), flags, &file)) << flags;
+        ASSERT_EQ(contents.size(), file.size);
+        EXPECT_EQ(0, minicrt::memcmp(file.data, contents.data(), contents.size())) << flags;
+        EXPECT_EQ(0, file.data[file.size]);
+        if (flags & minicrt::FILE_MAP_HUGE_PAGES) {
+            EXPECT_EQ(0u, (size_t) file.data % (2 * 1024 * 1024)) << flags;
+        }
+        minicrt::unmap_file(&file);
+    }
+}
+
+TEST(MappedFileTest, Advise) {
+    std::string contents = pattern(200000);
+    TempFile temp(contents);
+
+    minicrt::mapped_file file;
+    ASSERT_EQ(0, minicrt::map_file(temp.path(), 0, &file));
+    EXPECT_EQ(0, minicrt::mapped_file_advise(&file, 0, file.size, minicrt::FILE_ADVICE_SEQUENTIAL));
+    EXPECT_EQ(0, minicrt::mapped_file_advise(&file, 12345, 100, minicrt::FILE_ADVICE_WILLNEED));
+    EXPECT_EQ(0, minicrt::mapped_file_advise(&file, 100000, 1000000, minicrt::FILE_ADVICE_RANDOM));
+
+    // Dropped pages of a file mapping are read back from the file
+    EXPECT_EQ(0, minicrt::mapped_file_advise(&file, 0, file.size, minicrt::FILE_ADVICE_DONTNEED));
+    EXPECT_EQ(0, minicrt::memcmp(file.data, contents.data(), contents.size()));
+    minicrt::unmap_file(&file);
+}
+
+TEST(MappedFileTest, MapFdOutlivesDescriptor) {
+    std::string contents = "12.5,7,-3e2\n";
+    TempFile temp(contents);
+
+    int fd = open(temp.path(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    minicrt::mapped_file file;
+    ASSERT_EQ(0, minicrt::map_fd(fd, 0, &file));
+    close(fd);
+
+    // Parse the mapped bytes in place
+    char *end = nullptr;
+    EXPECT_EQ(12.5, minicrt::strtod(file.data, &end));
+    EXPECT_EQ(',', *end);
+    EXPECT_EQ(7, minicrt::strtol(end + 1, &end, 10));
+    EXPECT_EQ(-300.0, minicrt::strntod(end + 1, file.size - (size_t) (end + 1 - file.data), &end));
+    EXPECT_EQ('\n', *end);
+    minicrt::unmap_file(&file);
+}
+
+TEST(MappedFileTest, Errors) {
+    minicrt::mapped_file file;
+    EXPECT_EQ(-1, minicrt::map_file("/nonexistent/minicrt/file", 0, &file));
+    EXPECT_EQ(-1, minicrt::map_file("/tmp", 0, &file));
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    EXPECT_EQ(-1, minicrt::map_fd(fds[0], 0, &file));
+    close(fds[0]);
+    close(fds[1]);
+    EXPECT_EQ(-1, minicrt::map_fd(-1, 0, &file));
+}
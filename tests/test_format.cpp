@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include "minicrt/stdio.h"
+
+namespace {
+    std::string mini_format(const char *format, ...) {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        int n = minicrt::vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        EXPECT_EQ((size_t) n, std::strlen(buf)) << format;
+        return buf;
+    }
+
+    std::string libc_format(const char *format, ...) {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        std::vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        return buf;
+    }
+
+    const char *kFloatFormats[] = {
+        "%f", "%.0f", "%.1f", "%.3f", "%.10f", "%.17f", "%#.0f", "%12.4f", "%-12.2f|", "%+f", "% f", "%012.3f",
+        "%e", "%.0e", "%.3e", "%.15e", "%.20e", "%#.0e", "%+E", "%-15.4e|", "%015.2e",
+        "%g", "%.0g", "%.1g", "%.3g", "%.10g", "%.17g", "%#g", "%#.3g", "%G", "%+g", "%14g", "%-14.6g|",
+    };
+
+    double bits_to_double(uint64_t bits) {
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+}
+
+TEST(FormatTest, Integers) {
+    const char *formats[] = {"%d", "%5d", "%-5d|", "%05d", "%+d", "% d", "%.3d", "%8.3d", "%.0d", "%x", "%#x", "%X",
+                             "%#010X", "%u"};
+    const int values[] = {0, 1, -1, 7, 42, -42, 99, 100, 12345, -99999, INT_MAX, INT_MIN};
+
+    for (const char *format : formats) {
+        for (int v : values)
+            EXPECT_EQ(libc_format(format, v), mini_format(format, v)) << format << " " << v;
+    }
+}
+
+TEST(FormatTest, LengthModifiers) {
+    EXPECT_EQ(libc_format("%lld", LLONG_MIN), mini_format("%lld", LLONG_MIN));
+    EXPECT_EQ(libc_format("%llu", ULLONG_MAX), mini_format("%llu", ULLONG_MAX));
+    EXPECT_EQ(libc_format("%lx", ULONG_MAX), mini_format("%lx", ULONG_MAX));
+    EXPECT_EQ(libc_format("%hhd", 300), mini_format("%hhd", 300));
+    EXPECT_EQ(libc_format("%hu", 70000), mini_format("%hu", 70000));
+    EXPECT_EQ(libc_format("%zu", (size_t) 123456789), mini_format("%zu", (size_t) 123456789));
+    EXPECT_EQ(libc_format("%td", (ptrdiff_t) -5), mini_format("%td", (ptrdiff_t) -5));
+    EXPECT_EQ(libc_format("%jd", (intmax_t) INT64_MIN), mini_format("%jd", (intmax_t) INT64_MIN));
+
+    std::mt19937_64 rng(9);
+    for (int i = 0; i < 20000; i++) {
+        unsigned long long v = rng() >> (rng() % 64);
+        EXPECT_EQ(libc_format("%llu", v), mini_format("%llu", v));
+        EXPECT_EQ(libc_format("%lld", (long long) -v), mini_format("%lld", (long long) -v));
+        EXPECT_EQ(libc_format("%llx", v), mini_format("%llx", v));
+    }
+}
+
+TEST(FormatTest, StringsCharactersAndPointers) {
+    EXPECT_EQ("[hello]", mini_format("[%s]", "hello"));
+    EXPECT_EQ("[  hello]", mini_format("[%7s]", "hello"));
+    EXPECT_EQ("[hello  ]", mini_format("[%-7s]", "hello"));
+    EXPECT_EQ("[he]", mini_format("[%.2s]", "hello"));
+    EXPECT_EQ("[   he]", mini_format("[%*.*s]", 5, 2, "hello"));
+    EXPECT_EQ("[he   ]", mini_format("[%*.*s]", -5, 2, "hello"));
+    EXPECT_EQ("[(null)]", mini_format("[%s]", (const char *) nullptr));
+    EXPECT_EQ("[x][  y]", mini_format("[%c][%3c]", 'x', 'y'));
+    EXPECT_EQ("100%", mini_format("%d%%", 100));
+
+    int local = 0;
+    EXPECT_EQ(libc_format("%p", (void *) &local), mini_format("%p", (void *) &local));
+    EXPECT_EQ(libc_format("%20p", (void *) &local), mini_format("%20p", (void *) &local));
+}
+
+TEST(FormatTest, Truncation) {
+    char buf[8];
+    std::memset(buf, 'z', sizeof(buf));
+    EXPECT_EQ(11, minicrt::snprintf(buf, sizeof(buf), "%s world", "hello"));
+    EXPECT_STREQ("hello w", buf);
+
+    EXPECT_EQ(5, minicrt::snprintf(nullptr, 0, "%d", -1234));
+    EXPECT_EQ(3, minicrt::snprintf(buf, 1, "abc"));
+    EXPECT_STREQ("", buf);
+
+    // Long output is measured in full even though only the prefix fits
+    std::string wide(3000, ' ');
+    wide.back() = '7';
+    EXPECT_EQ(3000, minicrt::snprintf(buf, sizeof(buf), "%3000d", 7));
+    EXPECT_EQ(wide.substr(0, 7), std::string(buf));
+}
+
+TEST(FormatTest, SpecialFloats) {
+    const double values[] = {INFINITY, -INFINITY, NAN, -NAN, 0.0, -0.0};
+    const char *formats[] = {"%f", "%F", "%e", "%E", "%g", "%G", "%8.3f", "%-8f|", "%+e", "%08g"};
+    for (const char *format : formats) {
+        for (double v : values)
+            EXPECT_EQ(libc_format(format, v), mini_format(format, v)) << format << " " << v;
+    }
+}
+
+TEST(FormatTest, FloatsMatchLibc) {
+    const double edge[] = {
+        0.5, 1.5, 2.5, 0.125, 0.05, 0.15, 0.25, 0.35, 1e-5, 1e-4, 9.5, 99.5, 999999.5, 0.1, 1.0 / 3, 2.0 / 3,
+        123456789.0, 1e15, 1e16, 1e17, 1e21, 1e22, 1e23, 9.999999999999999e22, 5e-324, DBL_MIN, DBL_MAX,
+        4.35, 0.000123456, 1234567.0, 9.9999995, 0.00009999995, 1e100, 1e-100, 2.2250738585072009e-308,
+    };
+
+    for (const char *format : kFloatFormats) {
+        for (double v : edge) {
+            // glibc prints "%#g" of 999999.5 as "1.e+06", dropping the zeros # asks to keep
+            if (v == 999999.5 && !std::strcmp(format, "%#g"))
+                continue;
+            EXPECT_EQ(libc_format(format, v), mini_format(format, v)) << format << " " << v;
+            EXPECT_EQ(libc_format(format, -v), mini_format(format, -v)) << format << " " << -v;
+        }
+    }
+}
+
+TEST(FormatTest, RandomFloatsMatchLibc) {
+    std::mt19937_64 rng(2025);
+    for (int i = 0; i < 20000; i++) {
+        // Random bit patterns cover every exponent, including subnormals
+        double v = bits_to_double(rng() & 0x7FEFFFFFFFFFFFFFull);
+        const char *format = kFloatFormats[i % (sizeof(kFloatFormats) / sizeof(kFloatFormats[0]))];
+        if (std::strstr(format, "f") && std::fabs(v) > 1e60)
+            format = "%.6e";
+        EXPECT_EQ(libc_format(format, v), mini_format(format, v)) << format << " " << v;
+    }
+
+    for (int i = 0; i < 20000; i++) {
+        // Values of everyday magnitude, where %f is the usual choice
+        double v = (double) (int64_t) (rng() % 2000000000) / (double) (1 + rng() % 100000);
+        EXPECT_EQ(libc_format("%.2f", v), mini_format("%.2f", v));
+        EXPECT_EQ(libc_format("%g", v), mini_format("%g", v));
+        EXPECT_EQ(libc_format("%.17g", v), mini_format("%.17g", v));
+    }
+}
+
+TEST(FormatShortestTest, KnownValues) {
+    char buf[32];
+    const struct {
+        double value;
+        const char *text;
+    } cases[] = {
+        {0.0, "0"}, {-0.0, "-0"}, {1.0, "1"}, {0.1, "0.1"}, {0.3, "0.3"}, {0.1 + 0.2, "0.30000000000000004"},
+        {123.456, "123.456"}, {1e-5, "0.00001"}, {1e-6, "1e-06"}, {1e16, "10000000000000000"},
+        {1e17, "1e+17"}, {5e-324, "5e-324"}, {DBL_MAX, "1.7976931348623157e+308"}, {INFINITY, "inf"},
+        {-INFINITY, "-inf"},
+    };
+
+    for (const auto &c : cases) {
+        EXPECT_EQ((int) std::strlen(c.text), minicrt::format_shortest(buf, sizeof(buf), c.value));
+        EXPECT_STREQ(c.text, buf);
+    }
+    minicrt::format_shortest(buf, sizeof(buf), NAN);
+    EXPECT_NE(nullptr, std::strstr(buf, "nan"));
+}
+
+TEST(FormatShortestTest, RoundTripsAndIsShortest) {
+    std::mt19937_64 rng(77);
+    char buf[32];
+    for (int i = 0; i < 100000; i++) {
+        double v = bits_to_double(rng() & 0x7FEFFFFFFFFFFFFFull);
+        int n = minicrt::format_shortest(buf, sizeof(buf), v);
+        ASSERT_LE(n, 25);
+        ASSERT_EQ(v, std::strtod(buf, nullptr)) << buf;
+
+        // One significant digit fewer never reads back as the same value
+        const char *mantissa_end = std::strpbrk(buf, "e");
+        const char *p = buf;
+        while (*p == '0' || *p == '.')
+            p++;
+        std::string digits;
+        for (; p != (mantissa_end ? mantissa_end : buf + n); p++) {
+            if (*p != '.')
+                digits += *p;
+        }
+        while (digits.size() > 1 && digits.back() == '0')
+            digits.pop_back(); // zeros that only pad an integer
+        if (digits.size() > 1) {
+            char shorter[40];
+            std::snprintf(shorter, sizeof(shorter), "%.*e", (int) digits.size() - 2, v);
+            EXPECT_NE(v, std::strtod(shorter, nullptr)) << buf;
+        }
+    }
+}
+
+#ifdef __linux__
+#include <unistd.h>
+
+TEST(StreamPrintfTest, FormatsIntoStream) {
+    FILE *file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+    minicrt::stream s;
+    minicrt::stream_init(&s, fileno(file), minicrt::STREAM_LINE_BUFFERED);
+
+    std::string expected;
+    for (int i = 0; i < 1000; i++) {
+        // Enough output to wrap the stream buffer several times
+        std::string line = libc_format("line %5d value %8.3f\n", i, i * 0.5);
+        EXPECT_EQ((int) line.size(), minicrt::stream_printf(&s, "line %5d value %8.3f\n", i, i * 0.5));
+        expected += line;
+    }
+    minicrt::stream_printf(&s, "%s", "tail");
+    minicrt::stream_flush(&s);
+
+    std::string out(expected.size() + 4, '\0');
+    ASSERT_EQ((long) out.size(), pread(fileno(file), &out[0], out.size(), 0));
+    EXPECT_EQ(expected + "tail", out);
+    std::fclose(file);
+}
+#endif
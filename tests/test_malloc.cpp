@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "minicrt/memory.h"
+
+namespace {
+    bool is_filled(const void *ptr, unsigned char value, size_t size) {
+        const unsigned char *p = (const unsigned char *) ptr;
+        for (size_t i = 0; i < size; i++) {
+            if (p[i] != value)
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST(MallocTest, EverySmallSize) {
+    std::vector<void *> blocks;
+
+    for (size_t size = 0; size <= 33000; size += (size < 1024 ? 1 : 311)) {
+        void *p = minicrt::malloc(size);
+        ASSERT_NE(nullptr, p) << size;
+        EXPECT_EQ(0u, (size_t) p % 16) << size;
+        EXPECT_GE(minicrt::malloc_usable_size(p), size);
+        std::memset(p, (int) (size & 0xFF), size);
+        blocks.push_back(p);
+    }
+
+    // No block overlaps another: every fill pattern survived
+    size_t i = 0;
+    for (size_t size = 0; size <= 33000; size += (size < 1024 ? 1 : 311), i++)
+        ASSERT_TRUE(is_filled(blocks[i], (unsigned char) (size & 0xFF), size)) << size;
+
+    for (void *p : blocks)
+        minicrt::free(p);
+}
+
+TEST(MallocTest, ReusesFreedBlocks) {
+    void *a = minicrt::malloc(40);
+    minicrt::free(a);
+    void *b = minicrt::malloc(40);
+    EXPECT_EQ(a, b);
+    minicrt::free(b);
+
+    minicrt::free(nullptr);
+}
+
+// Enough objects to fill and drain several spans of one class
+TEST(MallocTest, ManyObjects) {
+    const size_t count = 100000;
+    std::vector<unsigned int *> blocks(count);
+
+    for (size_t i = 0; i < count; i++) {
+        blocks[i] = (unsigned int *) minicrt::malloc(24);
+        ASSERT_NE(nullptr, blocks[i]);
+        *blocks[i] = (unsigned int) i;
+    }
+    for (size_t i = 0; i < count; i += 2)
+        minicrt::free(blocks[i]);
+    for (size_t i = 1; i < count; i += 2)
+        ASSERT_EQ(i, *blocks[i]);
+    for (size_t i = 0; i < count; i += 2)
+        blocks[i] = (unsigned int *) minicrt::malloc(24);
+    for (size_t i = 0; i < count; i++)
+        minicrt::free(blocks[i]);
+}
+
+TEST(MallocTest, LargeBlocks) {
+    const size_t sizes[] = {32769, 100000, 1 << 20, (64 << 20) + 5};
+    for (size_t size : sizes) {
+        unsigned char *p = (unsigned char *) minicrt::malloc(size);
+        ASSERT_NE(nullptr, p);
+        EXPECT_EQ(0u, (size_t) p % 16);
+        EXPECT_GE(minicrt::malloc_usable_size(p), size);
+        p[0] = 1;
+        p[size - 1] = 2;
+        minicrt::free(p);
+    }
+}
+
+TEST(MallocTest, Calloc) {
+    // Recycled small blocks must be cleared again
+    void *dirty = minicrt::malloc(200);
+    std::memset(dirty, 0xFF, 200);
+    minicrt::free(dirty);
+
+    void *p = minicrt::calloc(10, 20);
+    ASSERT_NE(nullptr, p);
+    EXPECT_TRUE(is_filled(p, 0, 200));
+    minicrt::free(p);
+
+    void *big = minicrt::calloc(1000, 1000);
+    ASSERT_NE(nullptr, big);
+    EXPECT_TRUE(is_filled(big, 0, 1000 * 1000));
+    minicrt::free(big);
+
+    // count * size overflows
+    EXPECT_EQ(nullptr, minicrt::calloc((size_t) 1 << 40, (size_t) 1 << 40));
+}
+
+TEST(MallocTest, LargeBlocksAreRecycled) {
+    // A freed large block is reused for the next one of about its size...
+    const size_t kSize = 3u << 20;
+    unsigned char *p = (unsigned char *) minicrt::malloc(kSize);
+    ASSERT_NE(nullptr, p);
+    std::memset(p, 0xFF, kSize);
+    minicrt::free(p);
+
+    unsigned char *q = (unsigned char *) minicrt::malloc(kSize - 1000);
+    EXPECT_EQ(p, q);
+    q[0] = 1;
+    q[kSize - 1001] = 2;
+    minicrt::free(q);
+
+    // ...and calloc clears it, while a fresh mapping is zero already
+    unsigned char *z = (unsigned char *) minicrt::calloc(kSize, 1);
+    ASSERT_NE(nullptr, z);
+    EXPECT_TRUE(is_filled(z, 0, kSize));
+    unsigned char *fresh = (unsigned char *) minicrt::calloc(kSize, 1);
+    ASSERT_NE(nullptr, fresh);
+    EXPECT_TRUE(is_filled(fresh, 0, kSize));
+    minicrt::free(z);
+    minicrt::free(fresh);
+}
+
+TEST(MallocTest, HugePageModes) {
+    EXPECT_EQ(-1, minicrt::malloc_set_huge_pages(7));
+    int original = minicrt::malloc_set_huge_pages(minicrt::MALLOC_HUGE_OFF);
+    EXPECT_EQ(minicrt::MALLOC_HUGE_THP, original);
+
+    // Every mode works, whatever the kernel has; hugetlb falls back when the pool is empty
+    for (int mode : {minicrt::MALLOC_HUGE_OFF, minicrt::MALLOC_HUGE_THP, minicrt::MALLOC_HUGE_HUGETLB}) {
+        minicrt::malloc_set_huge_pages(mode);
+        const size_t kSize = (9u << 20) + 12345;
+        unsigned char *p = (unsigned char *) minicrt::malloc(kSize);
+        ASSERT_NE(nullptr, p) << mode;
+        if (mode != minicrt::MALLOC_HUGE_OFF) {
+            EXPECT_LT((size_t) p % (2u << 20), 4096u) << "starts a huge page";
+        }
+        for (size_t i = 0; i < kSize; i += 4096)
+            p[i] = (unsigned char) (i >> 12);
+
+        p = (unsigned char *) minicrt::realloc(p, kSize * 3);
+        ASSERT_NE(nullptr, p);
+        p = (unsigned char *) minicrt::realloc(p, kSize / 2);
+        ASSERT_NE(nullptr, p);
+        for (size_t i = 0; i < kSize / 2; i += 4096)
+            ASSERT_EQ((unsigned char) (i >> 12), p[i]) << mode;
+        minicrt::free(p);
+    }
+    minicrt::malloc_set_huge_pages(original);
+}
+
+TEST(MallocTest, ReallocSmall) {
+    char *p = (char *) minicrt::realloc(nullptr, 10);
+    ASSERT_NE(nullptr, p);
+    std::memcpy(p, "0123456789", 10);
+
+    // Growing within the size class keeps the block
+    char *same = (char *) minicrt::realloc(p, minicrt::malloc_usable_size(p));
+    EXPECT_EQ(p, same);
+
+    for (size_t size = 20; size < 200000; size = size * 2 + 1) {
+        p = (char *) minicrt::realloc(p, size);
+        ASSERT_NE(nullptr, p);
+        ASSERT_EQ(0, std::memcmp(p, "0123456789", 10)) << size;
+    }
+
+    EXPECT_EQ(nullptr, minicrt::realloc(p, 0));
+}
+
+TEST(MallocTest, ReallocLarge) {
+    size_t size = 1 << 20;
+    unsigned char *p = (unsigned char *) minicrt::malloc(size);
+    ASSERT_NE(nullptr, p);
+    for (size_t i = 0; i < size; i += 4096)
+        p[i] = (unsigned char) (i >> 12);
+
+    // Another large block right behind forces a remap to a new range at some point
+    void *blocker = minicrt::malloc(1 << 20);
+
+    for (size_t new_size = size * 2; new_size <= (64u << 20); new_size *= 2) {
+        p = (unsigned char *) minicrt::realloc(p, new_size);
+        ASSERT_NE(nullptr, p);
+        for (size_t i = 0; i < size; i += 4096)
+            ASSERT_EQ((unsigned char) (i >> 12), p[i]) << new_size;
+        p[new_size - 1] = 0xAB;
+    }
+
+    p = (unsigned char *) minicrt::realloc(p, 40000);
+    ASSERT_NE(nullptr, p);
+    for (size_t i = 0; i < 40000; i += 4096)
+        ASSERT_EQ((unsigned char) (i >> 12), p[i]);
+
+    minicrt::free(p);
+    minicrt::free(blocker);
+}
+
+TEST(MallocTest, ThreadsAllocateIndependently) {
+    const int kThreads = 8;
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([t, &failures] {
+            std::vector<unsigned char *> blocks;
+            for (int round = 0; round < 20; round++) {
+                for (size_t i = 0; i < 500; i++) {
+                    size_t size = 1 + (i * 37 + t) % 2000;
+                    unsigned char *p = (unsigned char *) minicrt::malloc(size);
+                    if (!p) {
+                        failures++;
+                        return;
+                    }
+                    std::memset(p, t, size);
+                    blocks.push_back(p);
+                }
+                for (unsigned char *p : blocks) {
+                    if (!is_filled(p, (unsigned char) t, 1))
+                        failures++;
+                    minicrt::free(p);
+                }
+                blocks.clear();
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST(MallocTest, CrossThreadFree) {
+    const size_t kCount = 20000;
+    std::vector<void *> blocks(kCount);
+
+    // One thread allocates, another frees everything
+    std::thread producer([&blocks] {
+        for (size_t i = 0; i < kCount; i++) {
+            blocks[i] = minicrt::malloc(16 + i % 300);
+            std::memset(blocks[i], 0x5A, 16);
+        }
+    });
+    producer.join();
+
+    std::thread consumer([&blocks] {
+        for (void *p : blocks)
+            minicrt::free(p);
+    });
+    consumer.join();
+
+    // The freed memory is handed back and reused rather than leaked
+    std::thread again([] {
+        std::vector<void *> more;
+        for (size_t i = 0; i < kCount; i++) {
+            more.push_back(minicrt::malloc(16 + i % 300));
+            ASSERT_NE(nullptr, more.back());
+        }
+        for (void *p : more)
+            minicrt::free(p);
+    });
+    again.join();
+}
+
+TEST(MallocTest, ConcurrentCrossThreadFree) {
+    const int kPairs = 4;
+    const size_t kCount = 50000;
+    std::vector<std::thread> threads;
+    std::atomic<int> failures(0);
+
+    // Each producer hands its blocks to a consumer through a small ring of slots
+    for (int pair = 0; pair < kPairs; pair++) {
+        threads.emplace_back([pair, &failures] {
+            std::vector<std::atomic<void *>> ring(64);
+            for (std::atomic<void *> &slot : ring)
+                slot.store(nullptr);
+
+            std::thread consumer([&ring, pair, &failures] {
+                for (size_t i = 0; i < kCount; i++) {
+                    std::atomic<void *> &slot = ring[i % ring.size()];
+                    void *p;
+                    while (!(p = slot.exchange(nullptr)))
+                        std::this_thread::yield();
+                    if (*(unsigned char *) p != (unsigned char) pair)
+                        failures++;
+                    minicrt::free(p);
+                }
+            });
+
+            for (size_t i = 0; i < kCount; i++) {
+                void *p = minicrt::malloc(8 + i % 512);
+                *(unsigned char *) p = (unsigned char) pair;
+                std::atomic<void *> &slot = ring[i % ring.size()];
+                void *expected = nullptr;
+                while (!slot.compare_exchange_weak(expected, p)) {
+                    expected = nullptr;
+                    std::this_thread::yield();
+                }
+            }
+            consumer.join();
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(0, failures.load());
+}
@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "minicrt/cpu.h"
+#include "minicrt/memory.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Fill a buffer with a position-dependent pattern that never repeats within 251 bytes
+    void fill_pattern(unsigned char *p, size_t n, unsigned seed) {
+        for (size_t i = 0; i < n; i++)
+            p[i] = (unsigned char) ((i * 7 + seed) % 251 + 1);
+    }
+
+    const size_t kGuard = 64;
+
+    // Runs a test body on every kernel tier the CPU supports
+    template <typename Body>
+    void for_each_tier(Body body) {
+        minicrt::cpu_tier best = minicrt::cpu_best_tier();
+        for (int t = minicrt::CPU_TIER_GENERIC; t <= best; t++) {
+            ASSERT_EQ(0, minicrt::cpu_set_tier((minicrt::cpu_tier) t));
+            SCOPED_TRACE(minicrt::cpu_tier_name((minicrt::cpu_tier) t));
+            body();
+        }
+        minicrt::cpu_set_tier(best);
+    }
+
+    // Lowers the non-temporal threshold for the lifetime of the object
+    struct ScopedNtThreshold {
+        explicit ScopedNtThreshold(size_t bytes) { minicrt::mem_set_nt_threshold(bytes); }
+        ~ScopedNtThreshold() { minicrt::mem_set_nt_threshold(0); }
+    };
+}
+
+// Every size from 0 to a few main-loop iterations, at every src/dst misalignment
+TEST(MemoryTest, MemCpyAllSizesAndAlignments) {
+    const size_t max_size = 520;
+    std::vector<unsigned char> src(max_size + 2 * kGuard);
+    std::vector<unsigned char> dst(max_size + 2 * kGuard);
+    std::vector<unsigned char> expected(max_size + 2 * kGuard);
+
+    fill_pattern(src.data(), src.size(), 3);
+    for (size_t size = 0; size <= max_size; size++) {
+        for (size_t src_off = 0; src_off < 64; src_off++) {
+            for (size_t dst_off = 0; dst_off < 64; dst_off += 7) {
+                std::memset(dst.data(), 0xEE, dst.size());
+                std::memcpy(expected.data(), dst.data(), dst.size());
+                std::memcpy(expected.data() + dst_off, src.data() + src_off, size);
+
+                void *ret = minicrt::memcpy(dst.data() + dst_off, src.data() + src_off, size);
+                ASSERT_EQ(ret, dst.data() + dst_off);
+                ASSERT_EQ(0, std::memcmp(dst.data(), expected.data(), dst.size()))
+                    << "size=" << size << " src_off=" << src_off << " dst_off=" << dst_off;
+            }
+        }
+    }
+}
+
+TEST(MemoryTest, MemSetAllSizesAndAlignments) {
+    const size_t max_size = 520;
+    std::vector<unsigned char> dst(max_size + 2 * kGuard);
+    std::vector<unsigned char> expected(max_size + 2 * kGuard);
+
+    for (size_t size = 0; size <= max_size; size++) {
+        for (size_t dst_off = 0; dst_off < 64; dst_off++) {
+            std::memset(dst.data(), 0xEE, dst.size());
+            std::memset(expected.data(), 0xEE, expected.size());
+            std::memset(expected.data() + dst_off, 0x5A, size);
+
+            void *ret = minicrt::memset(dst.data() + dst_off, 0x5A, size);
+            ASSERT_EQ(ret, dst.data() + dst_off);
+            ASSERT_EQ(0, std::memcmp(dst.data(), expected.data(), dst.size()))
+                << "size=" << size << " dst_off=" << dst_off;
+        }
+    }
+}
+
+// Only the low byte of the fill value is used
+TEST(MemoryTest, MemSetTruncatesValue) {
+    unsigned char buf[100];
+    minicrt::memset(buf, 0x1234, sizeof(buf));
+    for (unsigned char b : buf)
+        EXPECT_EQ(0x34, b);
+}
+
+TEST(MemoryTest, LargeSizes) {
+    const size_t sizes[] = {4095, 4096, 4097, 65536 + 13, 1 << 20};
+    for (size_t size : sizes) {
+        std::vector<unsigned char> src(size + kGuard);
+        std::vector<unsigned char> dst(size + kGuard, 0);
+        fill_pattern(src.data(), src.size(), 11);
+
+        for (size_t off = 0; off < 64; off += 5) {
+            minicrt::memcpy(dst.data() + off, src.data() + (63 - off), size);
+            ASSERT_EQ(0, std::memcmp(dst.data() + off, src.data() + (63 - off), size)) << "size=" << size;
+
+            minicrt::memset(dst.data() + off, 0xA5, size);
+            ASSERT_EQ(dst.data() + off + size,
+                      std::find_if(dst.data() + off, dst.data() + off + size,
+                                   [](unsigned char b) { return b != 0xA5; }));
+        }
+    }
+}
+
+TEST(MemoryTest, MemMoveOverlap) {
+    unsigned char buf[600];
+    unsigned char expected[600];
+
+    for (size_t size = 0; size <= 300; size += 13) {
+        for (size_t shift = 1; shift < 70; shift += 3) {
+            fill_pattern(buf, sizeof(buf), 5);
+            std::memcpy(expected, buf, sizeof(buf));
+            std::memmove(expected + shift, expected, size);
+            minicrt::memmove(buf + shift, buf, size);
+            ASSERT_EQ(0, std::memcmp(buf, expected, sizeof(buf))) << "forward size=" << size;
+
+            fill_pattern(buf, sizeof(buf), 5);
+            std::memcpy(expected, buf, sizeof(buf));
+            std::memmove(expected, expected + shift, size);
+            minicrt::memmove(buf, buf + shift, size);
+            ASSERT_EQ(0, std::memcmp(buf, expected, sizeof(buf))) << "backward size=" << size;
+        }
+    }
+}
+
+TEST(MemoryTest, MemCmpBasic) {
+    const char a[] = "abcdef";
+    const char b[] = "abcdeg";
+
+    EXPECT_EQ(0, minicrt::memcmp(a, a, sizeof(a)));
+    EXPECT_EQ(0, minicrt::memcmp(a, b, 0));
+    EXPECT_LT(minicrt::memcmp(a, b, 6), 0);
+    EXPECT_GT(minicrt::memcmp(b, a, 6), 0);
+}
+
+TEST(MemoryTest, NtThreshold) {
+    size_t def = minicrt::mem_nt_threshold();
+    EXPECT_GT(def, 0u);
+
+    minicrt::mem_set_nt_threshold(12345);
+    EXPECT_EQ(12345u, minicrt::mem_nt_threshold());
+    minicrt::mem_set_nt_threshold(0);
+    EXPECT_EQ(def, minicrt::mem_nt_threshold());
+}
+
+// Streaming stores and prefetch, forced on for moderate sizes
+TEST(MemoryTest, NonTemporalPaths) {
+    ScopedNtThreshold nt(4096);
+    const size_t max_size = 70000;
+    std::vector<unsigned char> src(max_size + 256), dst(max_size + 256), expected(max_size + 256);
+    fill_pattern(src.data(), src.size(), 17);
+
+    for_each_tier([&] {
+        for (size_t size = 4000; size <= max_size; size = size * 3 / 2 + 7) {
+            for (size_t off = 0; off < 64; off += 13) {
+                std::memset(dst.data(), 0xEE, dst.size());
+                std::memcpy(expected.data(), dst.data(), dst.size());
+                std::memcpy(expected.data() + off, src.data() + 64 - off, size);
+                minicrt::memcpy(dst.data() + off, src.data() + 64 - off, size);
+                ASSERT_EQ(0, std::memcmp(dst.data(), expected.data(), dst.size())) << "memcpy " << size;
+
+                std::memset(expected.data() + off + 1, 0x3C, size);
+                minicrt::memset(dst.data() + off + 1, 0x3C, size);
+                ASSERT_EQ(0, std::memcmp(dst.data(), expected.data(), dst.size())) << "memset " << size;
+
+                // Overlapping moves in both directions
+                std::memcpy(dst.data(), src.data(), dst.size());
+                std::memcpy(expected.data(), src.data(), expected.size());
+                std::memmove(expected.data() + off + 100, expected.data() + 3, size);
+                minicrt::memmove(dst.data() + off + 100, dst.data() + 3, size);
+                ASSERT_EQ(0, std::memcmp(dst.data(), expected.data(), dst.size())) << "memmove up " << size;
+
+                std::memmove(expected.data() + 3, expected.data() + off + 100, size);
+                minicrt::memmove(dst.data() + 3, dst.data() + off + 100, size);
+                ASSERT_EQ(0, std::memcmp(dst.data(), expected.data(), dst.size())) << "memmove down " << size;
+            }
+        }
+    });
+}
+
+#ifdef __linux__
+namespace {
+    /**
+     * A virtual range of more than 4 GiB that only costs a few MiB of memory: every
+     * alias_size window maps the same shared memory, except for the last two pages,
+     * which are private. A size truncated to 32 bits never reaches those pages.
+     */
+    class HugeAliasedBuffer {
+    public:
+        static const size_t alias_size = 16u << 20;
+
+        explicit HugeAliasedBuffer(size_t size) : size_(size) {
+            page_ = (size_t) sysconf(_SC_PAGESIZE);
+            size_t aliased = size - 2 * page_;
+            if (aliased % alias_size != 0)
+                return;
+
+            int fd = memfd_create("minicrt_test", 0);
+            if (fd < 0 || ftruncate(fd, alias_size) != 0)
+                return;
+
+            void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (base != MAP_FAILED) {
+                base_ = (unsigned char *) base;
+                for (size_t off = 0; off < aliased && base_; off += alias_size) {
+                    if (mmap(base_ + off, alias_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                        munmap(base_, size_);
+                        base_ = nullptr;
+                    }
+                }
+            }
+            close(fd);
+        }
+
+        ~HugeAliasedBuffer() {
+            if (base_)
+                munmap(base_, size_);
+        }
+
+        unsigned char *data() const { return base_; }
+        unsigned char *private_tail() const { return base_ + size_ - 2 * page_; }
+        size_t page() const { return page_; }
+
+    private:
+        unsigned char *base_ = nullptr;
+        size_t size_;
+        size_t page_ = 4096;
+    };
+}
+
+// Sizes above 4 GiB must not be truncated anywhere on the copy and fill paths
+TEST(MemoryTest, MultiGigabyteBuffers) {
+    static_assert(sizeof(size_t) == 8, "64-bit size_t expected");
+    const size_t size = (4ull << 30) + HugeAliasedBuffer::alias_size + 2 * 4096;
+
+    HugeAliasedBuffer src(size), dst(size);
+    if (!src.data() || !dst.data() || src.page() != 4096)
+        GTEST_SKIP() << "cannot reserve the aliased multi-GiB mapping";
+
+    // Best tier only: every tier already runs the same paths in NonTemporalPaths
+
+    // memset: the private pages past 4 GiB get filled, the last byte is excluded
+    std::memset(dst.private_tail(), 0, 2 * dst.page());
+    minicrt::memset(dst.data(), 0x77, size - 1);
+    ASSERT_EQ(0x77, dst.private_tail()[0]);
+    ASSERT_EQ(0x77, dst.private_tail()[2 * dst.page() - 2]);
+    ASSERT_EQ(0x00, dst.private_tail()[2 * dst.page() - 1]);
+
+    // memcpy and non-overlapping memmove carry the private source pages across
+    fill_pattern(src.private_tail(), 2 * src.page(), 29);
+    std::memset(dst.private_tail(), 0, 2 * dst.page());
+    minicrt::memcpy(dst.data(), src.data(), size);
+    ASSERT_EQ(0, std::memcmp(dst.private_tail(), src.private_tail(), 2 * src.page()));
+
+    std::memset(dst.private_tail(), 0, 2 * dst.page());
+    minicrt::memmove(dst.data(), src.data(), size);
+    ASSERT_EQ(0, std::memcmp(dst.private_tail(), src.private_tail(), 2 * src.page()));
+}
+#endif
+
+namespace {
+    // Fixed-size templates: every offset within a cache line, guard bytes on both sides
+    template <size_t N>
+    void check_fixed() {
+        SCOPED_TRACE(N);
+        unsigned char src[N + 2 * kGuard], dst[N + 2 * kGuard], expected[N + 2 * kGuard];
+        for (size_t offset = 0; offset < 64; offset += 7) {
+            fill_pattern(src, sizeof(src), (unsigned) offset);
+            std::memset(dst, 0xEE, sizeof(dst));
+            std::memcpy(expected, dst, sizeof(dst));
+            std::memcpy(expected + offset, src + offset, N);
+            EXPECT_EQ(dst + offset, minicrt::copy<N>(dst + offset, src + offset));
+            ASSERT_EQ(0, std::memcmp(expected, dst, sizeof(dst))) << offset;
+
+            std::memset(expected + offset, 0x5A, N);
+            minicrt::fill<N>((void *) (dst + offset), 0x15A);
+            ASSERT_EQ(0, std::memcmp(expected, dst, sizeof(dst))) << offset;
+
+            // A difference at the first, middle and last byte, in both directions
+            std::memcpy(dst, src, sizeof(src));
+            EXPECT_TRUE(minicrt::equal<N>(dst + offset, src + offset));
+            EXPECT_EQ(0, minicrt::compare<N>(dst + offset, src + offset));
+            for (size_t at : {(size_t) 0, N / 2, N - 1}) {
+                if (N == 0)
+                    break;
+                dst[offset + at] = (unsigned char) (src[offset + at] + 1);
+                EXPECT_FALSE(minicrt::equal<N>(dst + offset, src + offset)) << at;
+                EXPECT_EQ(1, minicrt::compare<N>(dst + offset, src + offset)) << at;
+                EXPECT_EQ(-1, minicrt::compare<N>(src + offset, dst + offset)) << at;
+                dst[offset + at] = src[offset + at];
+            }
+        }
+    }
+
+    template <size_t... Ns>
+    void check_fixed_sizes(std::index_sequence<Ns...>) {
+        (check_fixed<Ns>(), ...);
+    }
+
+    // Usable in constant expressions
+    constexpr int constexpr_fixed() {
+        char a[12] = "hello world";
+        char b[12] = {};
+        minicrt::copy<12>(b, a);
+        minicrt::fill<5>(b, 'j');
+        if (!minicrt::equal<6>(b + 5, a + 5))
+            return -2;
+        return minicrt::compare<12>(a, b);
+    }
+
+    static_assert(constexpr_fixed() == -1, "fixed-size templates must be constexpr");
+}
+
+TEST(MemoryTest, FixedSizeTemplates) {
+    check_fixed_sizes(std::index_sequence<0, 1, 2, 3, 4, 5, 7, 8, 9, 12, 15, 16, 17, 24, 31, 32, 33, 40, 48, 63,
+                                          64, 65, 96, 127, 128, 200, 255, 256, 257, 1000>());
+
+    // High bytes must order as unsigned, like memcmp
+    unsigned char low[16] = {}, high[16] = {};
+    high[9] = 0x80;
+    EXPECT_EQ(-1, minicrt::compare<16>(low, high));
+    EXPECT_EQ(1, minicrt::compare<16>((const void *) high, (const void *) low));
+    EXPECT_EQ(1, minicrt::compare<3>("b\x01", "a\xFF"));
+}
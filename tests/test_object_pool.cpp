@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+#include "minicrt/object_pool.h"
+
+namespace {
+    struct counted {
+        static int alive;
+        int value;
+
+        explicit counted(int v) : value(v) { alive++; }
+        ~counted() { alive--; }
+    };
+
+    int counted::alive = 0;
+
+    struct alignas(128) wide {
+        char bytes[200];
+    };
+}
+
+TEST(ObjectPoolTest, AllocateAndReuse) {
+    minicrt::object_pool<int> pool;
+    EXPECT_EQ(0u, pool.capacity());
+
+    void *a = pool.allocate();
+    void *b = pool.allocate();
+    ASSERT_NE(nullptr, a);
+    ASSERT_NE(nullptr, b);
+    EXPECT_NE(a, b);
+    EXPECT_GE(pool.capacity(), 64u);
+
+    // The last slot returned is the next one handed out
+    pool.deallocate(b);
+    EXPECT_EQ(b, pool.allocate());
+    pool.deallocate(a);
+    pool.deallocate(b);
+    pool.deallocate(nullptr);
+}
+
+TEST(ObjectPoolTest, CreateAndDestroy) {
+    minicrt::object_pool<counted, 16> pool;
+    counted::alive = 0;
+
+    counted *c = pool.create(42);
+    ASSERT_NE(nullptr, c);
+    EXPECT_EQ(42, c->value);
+    EXPECT_EQ(1, counted::alive);
+
+    pool.destroy(c);
+    EXPECT_EQ(0, counted::alive);
+    pool.destroy(nullptr);
+}
+
+TEST(ObjectPoolTest, SlotLayout) {
+    // Small objects get power-of-two slots, large ones whole cache lines
+    EXPECT_EQ(2 * sizeof(void *), minicrt::object_pool<char>::slot_size());
+    EXPECT_EQ(32u, minicrt::object_pool<char[24]>::slot_size());
+    EXPECT_EQ(64u, minicrt::object_pool<char[64]>::slot_size());
+    EXPECT_EQ(128u, minicrt::object_pool<char[65]>::slot_size());
+    EXPECT_EQ(256u, minicrt::object_pool<wide>::slot_size());
+
+    minicrt::object_pool<wide, 8> pool;
+    for (int i = 0; i < 20; i++) {
+        void *p = pool.allocate();
+        ASSERT_NE(nullptr, p);
+        EXPECT_EQ(0u, (uintptr_t) p % alignof(wide));
+    }
+
+    minicrt::object_pool<char[48]> lines;
+    for (int i = 0; i < 100; i++) {
+        uintptr_t p = (uintptr_t) lines.allocate();
+        EXPECT_EQ(p / 64, (p + 47) / 64) << "slot straddles a cache line";
+    }
+}
+
+TEST(ObjectPoolTest, GrowsAndReserves) {
+    minicrt::object_pool<long, 32> pool;
+    std::set<void *> seen;
+    for (int i = 0; i < 10000; i++) {
+        void *p = pool.allocate();
+        ASSERT_NE(nullptr, p);
+        *(long *) p = i;
+        ASSERT_TRUE(seen.insert(p).second);
+    }
+    EXPECT_GE(pool.capacity(), 10000u);
+
+    minicrt::object_pool<long, 32> reserved(5000, minicrt::OBJECT_POOL_PREFAULT);
+    size_t capacity = reserved.capacity();
+    EXPECT_GE(capacity, 5000u);
+    for (int i = 0; i < 5000; i++)
+        ASSERT_NE(nullptr, reserved.allocate());
+    EXPECT_EQ(capacity, reserved.capacity()) << "a reserve maps everything up front";
+}
+
+TEST(ObjectPoolTest, CacheTradesBatches) {
+    typedef minicrt::object_pool<counted, 16> pool_type;
+    pool_type pool;
+    counted::alive = 0;
+    std::set<void *> seen;
+    {
+        pool_type::cache cache(pool);
+        std::vector<counted *> held;
+        for (int i = 0; i < 1000; i++) {
+            held.push_back(cache.create(i));
+            ASSERT_NE(nullptr, held.back());
+            ASSERT_TRUE(seen.insert(held.back()).second);
+        }
+        EXPECT_EQ(1000, counted::alive);
+        for (int i = 0; i < 1000; i++) {
+            EXPECT_EQ(i, held[i]->value);
+            cache.destroy(held[i]);
+        }
+        EXPECT_EQ(0, counted::alive);
+    }
+
+    // The cache gave everything back: the whole capacity comes out again without
+    // a new slab, singly and then through a cache
+    size_t capacity = pool.capacity();
+    pool_type::cache other(pool);
+    std::set<void *> again;
+    for (size_t i = 0; i < capacity; i++) {
+        void *p = i < capacity / 2 ? pool.allocate() : other.allocate();
+        ASSERT_TRUE(again.insert(p).second);
+    }
+    EXPECT_EQ(capacity, pool.capacity());
+}
+
+TEST(ObjectPoolTest, ConcurrentChurn) {
+    const int kThreads = 4;
+    const int kRounds = 2000;
+    const int kBatch = 64;
+    minicrt::object_pool<uint64_t, 128> pool;
+
+    // Each thread stamps its slots and checks that nobody else got them meanwhile
+    std::vector<std::thread> threads;
+    std::vector<int> errors(kThreads, 0);
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t] {
+            uint64_t *held[kBatch];
+            for (int round = 0; round < kRounds; round++) {
+                for (int i = 0; i < kBatch; i++) {
+                    held[i] = (uint64_t *) pool.allocate();
+                    *held[i] = ((uint64_t) t << 32) | (uint64_t) (round * kBatch + i);
+                }
+                std::this_thread::yield();
+                for (int i = 0; i < kBatch; i++) {
+                    if (*held[i] != (((uint64_t) t << 32) | (uint64_t) (round * kBatch + i)))
+                        errors[t]++;
+                    pool.deallocate(held[i]);
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    for (int t = 0; t < kThreads; t++)
+        EXPECT_EQ(0, errors[t]) << "thread " << t;
+    EXPECT_LE(pool.capacity(), (size_t) kThreads * kBatch + 1024) << "freed slots are reused";
+}
+
+TEST(ObjectPoolTest, ConcurrentCachesWithRemoteFrees) {
+    typedef minicrt::object_pool<uint64_t, 128> pool_type;
+    const int kThreads = 4;
+    const int kRounds = 500;
+    const int kBatch = 100;
+    pool_type pool;
+
+    // Every thread allocates through its own cache and frees half of each batch
+    // back to the cache, the other half straight to the pool
+    std::vector<std::thread> threads;
+    std::vector<int> errors(kThreads, 0);
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t] {
+            pool_type::cache cache(pool);
+            uint64_t *held[kBatch];
+            for (int round = 0; round < kRounds; round++) {
+                for (int i = 0; i < kBatch; i++) {
+                    held[i] = (uint64_t *) cache.allocate();
+                    *held[i] = ((uint64_t) t << 32) | (uint64_t) i;
+                }
+                std::this_thread::yield();
+                for (int i = 0; i < kBatch; i++) {
+                    if (*held[i] != (((uint64_t) t << 32) | (uint64_t) i))
+                        errors[t]++;
+                    if (i % 2)
+                        cache.deallocate(held[i]);
+                    else
+                        pool.deallocate(held[i]);
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    for (int t = 0; t < kThreads; t++)
+        EXPECT_EQ(0, errors[t]) << "thread " << t;
+    EXPECT_LE(pool.capacity(), (size_t) kThreads * (kBatch + 2 * pool_type::kBatch) + 1024);
+}
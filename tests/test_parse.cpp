@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include "minicrt/crt.h"
+#include "minicrt/string.h"
+
+namespace {
+    uint64_t double_bits(double d) {
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        return bits;
+    }
+
+    // Parse with both implementations and compare the value bits and the end offset
+    void expect_same_double(const std::string &text) {
+        char *libc_end = nullptr;
+        char *mini_end = nullptr;
+        double expected = std::strtod(text.c_str(), &libc_end);
+        double actual = minicrt::strtod(text.c_str(), &mini_end);
+        if (std::isnan(expected)) {
+            EXPECT_TRUE(std::isnan(actual)) << text;
+            EXPECT_EQ(std::signbit(expected), std::signbit(actual)) << text;
+        } else {
+            EXPECT_EQ(double_bits(expected), double_bits(actual)) << text;
+        }
+        EXPECT_EQ(libc_end - text.c_str(), mini_end - text.c_str()) << text;
+    }
+
+    template<typename T>
+    void expect_same_integer(T (*mini)(const char *, char **, int), T (*libc)(const char *, char **, int),
+                             const std::string &text, int base) {
+        char *libc_end = nullptr;
+        char *mini_end = nullptr;
+        EXPECT_EQ(libc(text.c_str(), &libc_end, base), mini(text.c_str(), &mini_end, base)) << text << " " << base;
+        EXPECT_EQ(libc_end - text.c_str(), mini_end - text.c_str()) << text << " " << base;
+    }
+}
+
+TEST(StrtolTest, MatchesLibc) {
+    const char *inputs[] = {
+        "0", "1", "-1", "+42", "  \t\n 123abc", "007", "0x1F", "0X1f", "0x", "0xg", "-0x80", "z", "", "-",
+        "2147483647", "2147483648", "-2147483648", "-2147483649", "9223372036854775807", "9223372036854775808",
+        "-9223372036854775808", "-9223372036854775809", "18446744073709551615", "18446744073709551616",
+        "123456789012345678901234567890", "00000000000000000000000000012", "1234567890123456", "12345678 9",
+        "zzzz", "777", "101010", "  -  5",
+    };
+    const int bases[] = {0, 2, 8, 10, 16, 36};
+
+    for (const char *text : inputs) {
+        for (int base : bases) {
+            expect_same_integer<long>(minicrt::strtol, std::strtol, text, base);
+            expect_same_integer<long long>(minicrt::strtoll, std::strtoll, text, base);
+            expect_same_integer<unsigned long>(minicrt::strtoul, std::strtoul, text, base);
+            expect_same_integer<unsigned long long>(minicrt::strtoull, std::strtoull, text, base);
+        }
+    }
+}
+
+TEST(StrtolTest, RandomValues) {
+    std::mt19937_64 rng(10);
+    char buf[64];
+    for (int i = 0; i < 50000; i++) {
+        long long v = (long long) (rng() >> (rng() % 64));
+        if (i & 1)
+            v = -v;
+        std::snprintf(buf, sizeof(buf), "%lld", v);
+        EXPECT_EQ(v, minicrt::strtoll(buf, nullptr, 10)) << buf;
+        std::snprintf(buf, sizeof(buf), "%llx", (unsigned long long) v);
+        EXPECT_EQ((unsigned long long) v, minicrt::strtoull(buf, nullptr, 16)) << buf;
+    }
+}
+
+TEST(StrtolTest, RejectsBadBase) {
+    char *end = nullptr;
+    const char *text = "123";
+    EXPECT_EQ(0, minicrt::strtol(text, &end, 1));
+    EXPECT_EQ(text, end);
+    EXPECT_EQ(0, minicrt::strtol(text, &end, 37));
+    EXPECT_EQ(text, end);
+}
+
+TEST(StrtolTest, SetsErrno) {
+    // <cerrno> makes errno the C library's, so reach the runtime's through its address
+    int &error = *minicrt::errno_location();
+    char *end = nullptr;
+
+    error = 0;
+    EXPECT_EQ(LONG_MAX, minicrt::strtol("9223372036854775808", &end, 10));
+    EXPECT_EQ(ERANGE, error);
+    error = 0;
+    EXPECT_EQ(LONG_MIN, minicrt::strtol("-9223372036854775809", &end, 10));
+    EXPECT_EQ(ERANGE, error);
+    error = 0;
+    EXPECT_EQ(ULONG_MAX, minicrt::strtoul("18446744073709551616", &end, 10));
+    EXPECT_EQ(ERANGE, error);
+    error = 0;
+    EXPECT_EQ(0, minicrt::strtol("123", &end, 1));
+    EXPECT_EQ(EINVAL, error);
+
+    // Values in range and text with no number leave errno alone
+    error = 0;
+    EXPECT_EQ(LONG_MIN, minicrt::strtol("-9223372036854775808", &end, 10));
+    EXPECT_EQ(0, error);
+    const char *text = "  xyz";
+    EXPECT_EQ(0, minicrt::strtol(text, &end, 10));
+    EXPECT_EQ(text, end);
+    EXPECT_EQ(0, error);
+}
+
+TEST(StrntolTest, StopsAtLength) {
+    const char field[] = "1234567890123456789012345";
+    char *end = nullptr;
+
+    // Every prefix length, so the eight-digit blocks meet the end at each offset
+    for (size_t length = 0; length <= 19; length++) {
+        long long expected = length ? std::strtoll(std::string(field, length).c_str(), nullptr, 10) : 0;
+        EXPECT_EQ(expected, minicrt::strntoll(field, length, &end, 10)) << length;
+        EXPECT_EQ(field + length, end);
+    }
+
+    // The prefix alone is not a hex number: only the 0 is used
+    const char hex[] = "0x1F";
+    EXPECT_EQ(0, minicrt::strntol(hex, 2, &end, 0));
+    EXPECT_EQ(hex + 1, end);
+    EXPECT_EQ(255u, minicrt::strntoul("0xff,", 4, &end, 16));
+    EXPECT_EQ(18446744073709551615ull, minicrt::strntoull("18446744073709551615", 20, nullptr, 10));
+}
+
+TEST(StrtodTest, SpecialForms) {
+    const char *inputs[] = {
+        "inf", "-INF", "Infinity", "infinit", "nan", "-NaN", "nan(123abc)", "nan(", "nan(1 2)", "in", "na",
+        "  +1.5e3x", ".5", "5.", ".", "-.e1", "1e", "1e+", "1e+5", "1E-5", "0e999999", "1e-999999", "1e999999",
+        "0x", "0x.", "0x1p", "0x1.8p3", "0X.8P-1", "0x1P+1024", "0x1p-1074", "0x1p-1075", "0x1.0000000000001p-1075",
+        "0x1.fffffffffffff8p1023", "0x123456789abcdef123p0", "0x0.000000000000000000001p0", "-0", "-0.0e5",
+        "00000.00000", "1_000",
+    };
+    for (const char *text : inputs)
+        expect_same_double(text);
+}
+
+TEST(StrtodTest, Boundaries) {
+    const char *inputs[] = {
+        "9007199254740993", "9007199254740992.5", "9007199254740993.0000000000000000000000000001",
+        "2.2250738585072011e-308", "2.2250738585072012e-308", "2.2250738585072014e-308",
+        "4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324",
+        "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308", "1e23", "8.98846567431158e307",
+        "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124",
+        "1.00000000000000011102230246251565404236316680908203126",
+        "7.2057594037927933e16", "10531275403395811", "1.05312754033958110e+16", "123456789012345678901234567890e-10",
+        "0.000000000000000000000000000000000000000000000000000000001",
+    };
+    for (const char *text : inputs) {
+        expect_same_double(text);
+        expect_same_double(std::string("-") + text);
+    }
+
+    // The exact halfway point between 1 and the next double, followed by many zeros
+    // and finally a non-zero digit far beyond any fixed precision
+    std::string tie = "1.00000000000000011102230246251565404236316680908203125";
+    expect_same_double(tie + std::string(2000, '0'));
+    expect_same_double(tie + std::string(2000, '0') + "1");
+    expect_same_double(std::string(400, '9') + "e-400");
+}
+
+TEST(StrtodTest, SetsErrno) {
+    int &error = *minicrt::errno_location();
+
+    error = 0;
+    EXPECT_EQ(HUGE_VAL, minicrt::strtod("1e400", nullptr));
+    EXPECT_EQ(ERANGE, error);
+    error = 0;
+    EXPECT_EQ(-HUGE_VAL, minicrt::strtod("-1e400", nullptr));
+    EXPECT_EQ(ERANGE, error);
+    error = 0;
+    double tiny = minicrt::strtod("1e-400", nullptr);
+    EXPECT_EQ(0.0, tiny);
+    EXPECT_FALSE(std::signbit(tiny));
+    EXPECT_EQ(ERANGE, error);
+    error = 0;
+    tiny = minicrt::strtod("-1e-400", nullptr);
+    EXPECT_TRUE(std::signbit(tiny));
+    EXPECT_EQ(ERANGE, error);
+    error = 0;
+    EXPECT_EQ(HUGE_VAL, minicrt::strtod("0x1p1024", nullptr));
+    EXPECT_EQ(ERANGE, error);
+
+    // Infinity, zero and the largest double are no range errors
+    error = 0;
+    EXPECT_EQ(HUGE_VAL, minicrt::strtod("inf", nullptr));
+    EXPECT_EQ(0.0, minicrt::strtod("0e999999", nullptr));
+    EXPECT_EQ(DBL_MAX, minicrt::strtod("1.7976931348623157e308", nullptr));
+    char *end = nullptr;
+    const char *text = "e5";
+    EXPECT_EQ(0.0, minicrt::strtod(text, &end));
+    EXPECT_EQ(text, end);
+    EXPECT_EQ(0, error);
+}
+
+TEST(StrtodTest, RoundTripsPrintedDoubles) {
+    std::mt19937_64 rng(11);
+    char buf[64];
+    for (int i = 0; i < 100000; i++) {
+        uint64_t bits = rng() & 0x7FEFFFFFFFFFFFFFull;
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        std::snprintf(buf, sizeof(buf), "%.17g", v);
+        ASSERT_EQ(bits, double_bits(minicrt::strtod(buf, nullptr))) << buf;
+    }
+}
+
+TEST(StrtodTest, RandomDigitStringsMatchLibc) {
+    std::mt19937_64 rng(12);
+    for (int i = 0; i < 30000; i++) {
+        // Random digit counts around the 19-digit limit of the fast path
+        std::string text;
+        int digits = 1 + (int) (rng() % 40);
+        for (int d = 0; d < digits; d++)
+            text += (char) ('0' + rng() % 10);
+        int point = (int) (rng() % (digits + 1));
+        text.insert((size_t) point, ".");
+        text += "e" + std::to_string((int) (rng() % 700) - 350);
+        expect_same_double(text);
+    }
+}
+
+TEST(StrntodTest, StopsAtLength) {
+    const char record[] = "3.25e2,17";
+    char *end = nullptr;
+    EXPECT_EQ(325.0, minicrt::strntod(record, 6, &end));
+    EXPECT_EQ(record + 6, end);
+    EXPECT_EQ(3.25, minicrt::strntod(record, 4, &end)); // "e" without digits is not consumed
+    EXPECT_EQ(record + 4, end);
+    EXPECT_EQ(0.0, minicrt::strntod(record, 0, &end));
+    EXPECT_EQ(record, end);
+
+    // Fields parsed in place, their digits running up against the next field
+    const char packed[] = "12345678901234567890123456789";
+    for (size_t length = 1; length < sizeof(packed) - 1; length++) {
+        std::string copy(packed, length);
+        EXPECT_EQ(std::strtod(copy.c_str(), nullptr), minicrt::strntod(packed, length, &end)) << length;
+        EXPECT_EQ(packed + length, end);
+    }
+
+    EXPECT_TRUE(std::isinf(minicrt::strntod("infinity", 3, nullptr)));
+    EXPECT_EQ(3.0, minicrt::strntod("3nan", 1, nullptr));
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+#include "minicrt/perf.h"
+
+namespace {
+    volatile unsigned long long g_sink;
+
+    // Burn CPU time in user space for about the given time
+    unsigned long long spin(std::chrono::microseconds duration) {
+        unsigned long long iterations = 0;
+        unsigned long long x = 1;
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end) {
+            for (int i = 0; i < 1000; i++)
+                x = x * 6364136223846793005ull + 1442695040888963407ull;
+            iterations += 1000;
+        }
+        g_sink = x;
+        return iterations;
+    }
+
+    int popcount(unsigned int mask) {
+        int n = 0;
+        for (; mask; mask &= mask - 1)
+            n++;
+        return n;
+    }
+}
+
+TEST(PerfTest, EmptyMaskIsRejected) {
+    minicrt::perf_group group;
+    EXPECT_EQ(-1, minicrt::perf_group_open(&group, 0));
+    EXPECT_EQ(0u, group.available);
+}
+
+TEST(PerfTest, OpensWhatIsAvailable) {
+    minicrt::perf_group group;
+    int opened = minicrt::perf_group_open(&group, PERF_MASK_ALL);
+    ASSERT_GE(opened, 0);
+    EXPECT_EQ(opened, popcount(group.available));
+
+    minicrt::perf_values values;
+    ASSERT_EQ(0, minicrt::perf_group_read(&group, &values));
+    EXPECT_EQ(group.available, values.available);
+    for (int i = 0; i < minicrt::PERF_COUNTER_COUNT; i++) {
+        if (!(values.available & PERF_MASK(i))) {
+            EXPECT_EQ(0u, values.counts[i]) << minicrt::perf_counter_name((minicrt::perf_counter) i);
+        }
+    }
+    minicrt::perf_group_close(&group);
+    minicrt::perf_group_close(&group);
+}
+
+TEST(PerfTest, RegionDeltas) {
+    minicrt::perf_group group;
+    if (minicrt::perf_group_open(&group, PERF_MASK_ALL) == 0)
+        GTEST_SKIP() << "no counters available";
+
+    minicrt::perf_region outer, inner;
+    minicrt::perf_values outer_delta, inner_delta;
+    ASSERT_EQ(0, minicrt::perf_region_begin(&group, &outer));
+    spin(std::chrono::microseconds(2000));
+    ASSERT_EQ(0, minicrt::perf_region_begin(&group, &inner));
+    unsigned long long iterations = spin(std::chrono::microseconds(5000));
+    ASSERT_EQ(0, minicrt::perf_region_end(&group, &inner, &inner_delta));
+    ASSERT_EQ(0, minicrt::perf_region_end(&group, &outer, &outer_delta));
+
+    EXPECT_GE(outer_delta.time_enabled, inner_delta.time_enabled);
+    for (int i = 0; i < minicrt::PERF_COUNTER_COUNT; i++) {
+        if (group.available & PERF_MASK(i)) {
+            EXPECT_GE(outer_delta.counts[i], inner_delta.counts[i]) << minicrt::perf_counter_name((minicrt::perf_counter) i);
+        }
+    }
+
+    if ((group.available & PERF_MASK(minicrt::PERF_TASK_CLOCK)) && !inner_delta.multiplexed) {
+        EXPECT_GE(inner_delta.counts[minicrt::PERF_TASK_CLOCK], 1000000u);
+        EXPECT_LT(inner_delta.counts[minicrt::PERF_TASK_CLOCK], 1000000000u);
+    }
+    if ((group.available & PERF_MASK(minicrt::PERF_INSTRUCTIONS)) && !inner_delta.multiplexed) {
+        EXPECT_GE(inner_delta.counts[minicrt::PERF_INSTRUCTIONS], iterations);
+    }
+    if ((group.available & PERF_MASK(minicrt::PERF_CYCLES)) && !inner_delta.multiplexed) {
+        EXPECT_GT(inner_delta.counts[minicrt::PERF_CYCLES], iterations);
+    }
+    minicrt::perf_group_close(&group);
+}
+
+TEST(PerfTest, CountsPageFaults) {
+    minicrt::perf_group group;
+    if (minicrt::perf_group_open(&group, PERF_MASK(minicrt::PERF_PAGE_FAULTS)) == 0)
+        GTEST_SKIP() << "no page fault counter";
+
+    // Zero-filling a fresh multi-megabyte buffer faults its pages in
+    std::vector<char> buffer;
+    minicrt::perf_region region;
+    minicrt::perf_values delta;
+    ASSERT_EQ(0, minicrt::perf_region_begin(&group, &region));
+    buffer.resize(4u << 20);
+    ASSERT_EQ(0, minicrt::perf_region_end(&group, &region, &delta));
+    EXPECT_GE(delta.counts[minicrt::PERF_PAGE_FAULTS], 1u);
+    minicrt::perf_group_close(&group);
+}
+
+TEST(PerfTest, ClosedGroupStillMeasures) {
+    // Code can bracket regions unconditionally; without counters nothing is reported
+    minicrt::perf_group group;
+    minicrt::perf_group_open(&group, PERF_MASK(minicrt::PERF_CYCLES));
+    minicrt::perf_group_close(&group);
+
+    minicrt::perf_region region;
+    minicrt::perf_values delta;
+    ASSERT_EQ(0, minicrt::perf_region_begin(&group, &region));
+    spin(std::chrono::microseconds(100));
+    ASSERT_EQ(0, minicrt::perf_region_end(&group, &region, &delta));
+    EXPECT_EQ(0u, delta.available);
+    EXPECT_EQ(0, delta.multiplexed);
+    for (int i = 0; i < minicrt::PERF_COUNTER_COUNT; i++)
+        EXPECT_EQ(0u, delta.counts[i]);
+}
+
+TEST(PerfTest, CounterNames) {
+    EXPECT_STREQ("cycles", minicrt::perf_counter_name(minicrt::PERF_CYCLES));
+    EXPECT_STREQ("branch_misses", minicrt::perf_counter_name(minicrt::PERF_BRANCH_MISSES));
+    EXPECT_STREQ("task_clock_ns", minicrt::perf_counter_name(minicrt::PERF_TASK_CLOCK));
+    EXPECT_STREQ("page_faults", minicrt::perf_counter_name(minicrt::PERF_PAGE_FAULTS));
+    EXPECT_STREQ("unknown", minicrt::perf_counter_name(minicrt::PERF_COUNTER_COUNT));
+}
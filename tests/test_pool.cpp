@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include "minicrt/pool.h"
+
+namespace {
+    struct fib_task {
+        int n;
+        long result;
+    };
+
+    // Recursive fork/join: every level waits on a group of its own
+    void fib(void *arg) {
+        fib_task *task = (fib_task *) arg;
+        if (task->n < 12) {
+            long a = 0, b = 1;
+            for (int i = 0; i < task->n; i++) {
+                long next = a + b;
+                a = b;
+                b = next;
+            }
+            task->result = a;
+            return;
+        }
+
+        fib_task left = {task->n - 1, 0};
+        fib_task right = {task->n - 2, 0};
+        minicrt::task_group group = TASK_GROUP_INIT;
+        minicrt::task_spawn(&group, fib, &left);
+        minicrt::task_spawn(&group, fib, &right);
+        minicrt::task_wait(&group);
+        task->result = left.result + right.result;
+    }
+
+    void mark_range(size_t begin, size_t end, void *arg) {
+        std::atomic<int> *hits = (std::atomic<int> *) arg;
+        for (size_t i = begin; i < end; i++)
+            hits[i]++;
+    }
+}
+
+TEST(PoolTest, SpawnAndWait) {
+    static std::atomic<int> runs(0);
+    runs = 0;
+
+    minicrt::task_group group = TASK_GROUP_INIT;
+    for (int i = 0; i < 10000; i++)
+        minicrt::task_spawn(&group, [](void *) { runs++; }, nullptr);
+    minicrt::task_wait(&group);
+    EXPECT_EQ(10000, runs.load());
+    EXPECT_EQ(0, group.state);
+
+    // An empty group returns at once, and a waited group can be reused
+    minicrt::task_wait(&group);
+    minicrt::task_spawn(&group, [](void *) { runs++; }, nullptr);
+    minicrt::task_wait(&group);
+    EXPECT_EQ(10001, runs.load());
+}
+
+TEST(PoolTest, NestedForkJoin) {
+    fib_task task = {27, 0};
+    minicrt::task_group group = TASK_GROUP_INIT;
+    minicrt::task_spawn(&group, fib, &task);
+    minicrt::task_wait(&group);
+    EXPECT_EQ(196418, task.result);
+}
+
+TEST(PoolTest, ParallelForCoversRangeOnce) {
+    const size_t kCount = 100003;
+    std::vector<std::atomic<int>> hits(kCount + 10);
+    for (std::atomic<int> &h : hits)
+        h = 0;
+
+    minicrt::parallel_for(10, kCount, 0, mark_range, hits.data());
+    minicrt::parallel_for(kCount, kCount + 10, 3, mark_range, hits.data());
+    minicrt::parallel_for(5, 5, 1, mark_range, hits.data());
+
+    for (size_t i = 0; i < 10; i++)
+        EXPECT_EQ(0, hits[i].load()) << i;
+    for (size_t i = 10; i < kCount + 10; i++)
+        ASSERT_EQ(1, hits[i].load()) << i;
+}
+
+TEST(PoolTest, WorkerCounts) {
+    // Every worker count gives the same results, including none at all
+    for (int workers : {0, 1, 3}) {
+        minicrt::pool_stop();
+        EXPECT_EQ(0, minicrt::pool_worker_count());
+        EXPECT_EQ(workers, minicrt::pool_start(workers));
+        EXPECT_EQ(workers, minicrt::pool_start(5)) << "a running pool is kept";
+        EXPECT_EQ(workers, minicrt::pool_worker_count());
+
+        fib_task task = {20, 0};
+        minicrt::task_group group = TASK_GROUP_INIT;
+        minicrt::task_spawn(&group, fib, &task);
+        minicrt::task_wait(&group);
+        EXPECT_EQ(6765, task.result);
+    }
+    minicrt::pool_stop();
+}
+
+TEST(PoolTest, MemcpyMemsetParallel) {
+    minicrt::pool_stop();
+    minicrt::pool_start(3);
+
+    // Sizes around the threshold, from unaligned addresses
+    const size_t kSize = 9 * 1024 * 1024 + 123;
+    std::vector<unsigned char> src(kSize + 64), dest(kSize + 64);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = (unsigned char) (i * 131 + 7);
+
+    for (size_t size : {(size_t) 1000, (size_t) 4 * 1024 * 1024, kSize}) {
+        std::memset(dest.data(), 0, dest.size());
+        EXPECT_EQ(dest.data() + 3, minicrt::memcpy_parallel(dest.data() + 3, src.data() + 17, size));
+        EXPECT_EQ(0, std::memcmp(dest.data() + 3, src.data() + 17, size)) << size;
+        EXPECT_EQ(0, dest[2]);
+        EXPECT_EQ(0, dest[3 + size]);
+
+        EXPECT_EQ(dest.data() + 5, minicrt::memset_parallel(dest.data() + 5, 0xAB, size));
+        size_t wrong = 0;
+        for (size_t i = 0; i < size; i++)
+            wrong += dest[5 + i] != 0xAB;
+        EXPECT_EQ(0u, wrong) << size;
+        EXPECT_NE(0xAB, dest[5 + size]);
+    }
+    minicrt::pool_stop();
+}
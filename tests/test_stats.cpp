@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "minicrt/memory.h"
+#include "minicrt/stats.h"
+#include "minicrt/string.h"
+
+// Built against the library variant with MINI_CRT_ENABLE_LOGGING
+
+namespace {
+    minicrt::function_stats collect(minicrt::stats_function function) {
+        minicrt::function_stats all[minicrt::STATS_FUNCTION_COUNT];
+        minicrt::stats_collect(all);
+        return all[function];
+    }
+}
+
+TEST(StatsTest, Enabled) {
+    EXPECT_NE(0, minicrt::stats_enabled());
+}
+
+TEST(StatsTest, CountsSizesAndAlignments) {
+    alignas(64) char a[256];
+    alignas(64) char b[256];
+    minicrt::stats_reset();
+
+    minicrt::memset(a, 'x', sizeof(a));
+    minicrt::memcpy(b, a, 100);        // 64-byte aligned, size class [64, 128)
+    minicrt::memcpy(b + 8, a + 32, 5); // 8-byte aligned, [4, 8)
+    minicrt::memcpy(b + 3, a, 0);      // byte aligned, size 0
+
+    minicrt::function_stats copy = collect(minicrt::STATS_MEMCPY);
+    EXPECT_EQ(3u, copy.calls);
+    EXPECT_EQ(105u, copy.bytes);
+    EXPECT_EQ(1u, copy.sizes[0]);
+    EXPECT_EQ(1u, copy.sizes[3]);
+    EXPECT_EQ(1u, copy.sizes[7]);
+    EXPECT_EQ(1u, copy.alignments[0]);
+    EXPECT_EQ(1u, copy.alignments[3]);
+    EXPECT_EQ(1u, copy.alignments[6]);
+
+    minicrt::function_stats set = collect(minicrt::STATS_MEMSET);
+    EXPECT_EQ(1u, set.calls);
+    EXPECT_EQ(256u, set.bytes);
+    EXPECT_EQ(1u, set.sizes[9]);
+
+    // String functions record the length they found
+    a[40] = '\0';
+    EXPECT_EQ(40u, minicrt::strlen(a));
+    EXPECT_EQ(10u, minicrt::strnlen(a, 10));
+    minicrt::function_stats length = collect(minicrt::STATS_STRLEN);
+    EXPECT_EQ(1u, length.calls);
+    EXPECT_EQ(40u, length.bytes);
+    EXPECT_EQ(10u, collect(minicrt::STATS_STRNLEN).bytes);
+
+    minicrt::strcpy(b, a);
+    EXPECT_EQ(0, minicrt::strcmp(a, b));
+    EXPECT_EQ(40u, collect(minicrt::STATS_STRCPY).bytes);
+    EXPECT_EQ(1u, collect(minicrt::STATS_STRCMP).calls);
+    EXPECT_EQ(0u, collect(minicrt::STATS_STRCMP).bytes);
+    EXPECT_EQ(0u, collect(minicrt::STATS_MEMMOVE).calls);
+
+    // Searches record the offset just past the match, without measuring the string
+    a[30] = 'y';
+    EXPECT_EQ(a + 30, minicrt::strchr(a, 'y'));
+    EXPECT_EQ(nullptr, minicrt::strrchr(a, 'z'));
+    EXPECT_EQ(a + 29, minicrt::strstr(a, "xyx"));
+    EXPECT_EQ(31u, collect(minicrt::STATS_STRCHR).bytes);
+    EXPECT_EQ(1u, collect(minicrt::STATS_STRRCHR).calls);
+    EXPECT_EQ(0u, collect(minicrt::STATS_STRRCHR).bytes);
+    EXPECT_EQ(32u, collect(minicrt::STATS_STRSTR).bytes);
+
+    minicrt::stats_reset();
+    EXPECT_EQ(0u, collect(minicrt::STATS_MEMCPY).calls);
+}
+
+TEST(StatsTest, ThreadsAreMerged) {
+    const int kThreads = 4;
+    const int kCalls = 1000;
+    minicrt::stats_reset();
+
+    // Two rounds, so that the second round adopts the shards the first one left
+    for (int round = 0; round < 2; round++) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; t++) {
+            threads.emplace_back([] {
+                char x[32] = {}, y[32] = {};
+                for (int i = 0; i < kCalls; i++)
+                    minicrt::memcmp(x, y, 32);
+            });
+        }
+        for (std::thread &t : threads)
+            t.join();
+    }
+
+    minicrt::function_stats cmp = collect(minicrt::STATS_MEMCMP);
+    EXPECT_EQ((unsigned long long) 2 * kThreads * kCalls, cmp.calls);
+    EXPECT_EQ((unsigned long long) 2 * kThreads * kCalls * 32, cmp.bytes);
+    EXPECT_EQ(cmp.calls, cmp.sizes[6]);
+}
+
+TEST(StatsTest, Dump) {
+    minicrt::stats_reset();
+    char buf[64] = {};
+    minicrt::memmove(buf + 1, buf, 20);
+
+    FILE *file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+    minicrt::stream s;
+    minicrt::stream_init(&s, fileno(file), minicrt::STREAM_FULLY_BUFFERED);
+    minicrt::stats_dump(&s);
+
+    char out[1024] = {};
+    ASSERT_GT(pread(fileno(file), out, sizeof(out) - 1, 0), 0);
+    std::string text = out;
+    EXPECT_NE(std::string::npos, text.find("memmove  1 calls, 20 bytes")) << text;
+    EXPECT_NE(std::string::npos, text.find("16+:1")) << text;
+    EXPECT_EQ(std::string::npos, text.find("strcmp")) << text;
+    std::fclose(file);
+}
+
+TEST(StatsTest, FunctionNames) {
+    EXPECT_STREQ("memcpy", minicrt::stats_function_name(minicrt::STATS_MEMCPY));
+    EXPECT_STREQ("strcmp", minicrt::stats_function_name(minicrt::STATS_STRCMP));
+    EXPECT_STREQ("unknown", minicrt::stats_function_name(minicrt::STATS_FUNCTION_COUNT));
+}
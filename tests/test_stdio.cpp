@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "minicrt/stdio.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    // Everything written to the file so far
+    std::string file_contents(int fd) {
+        std::string out;
+        char buf[4096];
+        off_t offset = 0;
+        ssize_t n;
+        while ((n = pread(fd, buf, sizeof(buf), offset)) > 0) {
+            out.append(buf, (size_t) n);
+            offset += n;
+        }
+        return out;
+    }
+}
+
+class StreamTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        file = std::tmpfile();
+        ASSERT_NE(nullptr, file);
+        fd = fileno(file);
+    }
+
+    void TearDown() override { std::fclose(file); }
+
+    FILE *file = nullptr;
+    int fd = -1;
+    minicrt::stream s;
+};
+
+TEST_F(StreamTest, FullyBufferedHoldsOutputUntilFlush) {
+    minicrt::stream_init(&s, fd, minicrt::STREAM_FULLY_BUFFERED);
+    EXPECT_EQ(0, minicrt::stream_puts(&s, "hello\n"));
+    EXPECT_EQ(0, minicrt::stream_putc(&s, 'x'));
+    EXPECT_EQ("", file_contents(fd));
+
+    EXPECT_EQ(0, minicrt::stream_flush(&s));
+    EXPECT_EQ("hello\nx", file_contents(fd));
+}
+
+TEST_F(StreamTest, LineBufferedFlushesOnNewline) {
+    minicrt::stream_init(&s, fd, minicrt::STREAM_LINE_BUFFERED);
+    minicrt::stream_puts(&s, "partial");
+    EXPECT_EQ("", file_contents(fd));
+
+    minicrt::stream_puts(&s, " line\nnext");
+    EXPECT_EQ("partial line\nnext", file_contents(fd));
+}
+
+TEST_F(StreamTest, UnbufferedWritesImmediately) {
+    minicrt::stream_init(&s, fd, minicrt::STREAM_UNBUFFERED);
+    minicrt::stream_puts(&s, "abc");
+    EXPECT_EQ("abc", file_contents(fd));
+}
+
+TEST_F(StreamTest, LargeWritesKeepOrder) {
+    minicrt::stream_init(&s, fd, minicrt::STREAM_FULLY_BUFFERED);
+    std::string expected;
+
+    for (int i = 0; i < 200; i++) {
+        // Mix writes that fit the buffer with ones that are far bigger than it
+        std::string piece(i % 7 == 0 ? 10000 + i : 1 + i * 13 % 900, (char) ('a' + i % 26));
+        ASSERT_EQ(0, minicrt::stream_write(&s, piece.data(), piece.size()));
+        expected += piece;
+    }
+    minicrt::stream_flush(&s);
+    EXPECT_EQ(expected, file_contents(fd));
+}
+
+TEST_F(StreamTest, WritevCoalescesPieces) {
+    minicrt::stream_init(&s, fd, minicrt::STREAM_FULLY_BUFFERED);
+    std::string payload(minicrt::STREAM_BUFFER_SIZE * 3, 'p');
+
+    minicrt::io_vector small[] = {{"hdr:", 4}, {"body", 4}, {"\n", 1}};
+    EXPECT_EQ(0, minicrt::stream_writev(&s, small, 3));
+    EXPECT_EQ("", file_contents(fd));
+
+    // More pieces than one writev batch holds, and more bytes than the buffer
+    std::vector<minicrt::io_vector> many;
+    std::string expected = "hdr:body\n";
+    for (int i = 0; i < 40; i++) {
+        many.push_back({"h", 1});
+        many.push_back({payload.data(), (size_t) i * 7});
+        expected += "h" + payload.substr(0, (size_t) i * 7);
+    }
+    EXPECT_EQ(0, minicrt::stream_writev(&s, many.data(), (int) many.size()));
+    minicrt::stream_flush(&s);
+    EXPECT_EQ(expected, file_contents(fd));
+}
+
+TEST_F(StreamTest, SetModeFlushesPendingOutput) {
+    minicrt::stream_init(&s, fd, minicrt::STREAM_FULLY_BUFFERED);
+    minicrt::stream_puts(&s, "pending");
+    EXPECT_EQ(0, minicrt::stream_set_mode(&s, minicrt::STREAM_UNBUFFERED));
+    EXPECT_EQ("pending", file_contents(fd));
+}
+
+TEST_F(StreamTest, ConcurrentLinesStayWhole) {
+    minicrt::stream_init(&s, fd, minicrt::STREAM_LINE_BUFFERED);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([this, t] {
+            std::string line = "thread " + std::to_string(t) + " says hello\n";
+            for (int i = 0; i < 500; i++)
+                minicrt::stream_write(&s, line.data(), line.size());
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    std::string out = file_contents(fd);
+    size_t lines = 0, start = 0, end;
+    while ((end = out.find('\n', start)) != std::string::npos) {
+        std::string line = out.substr(start, end - start);
+        EXPECT_EQ(0u, line.find("thread ")) << line;
+        EXPECT_EQ(line.size() - 11, line.find(" says hello")) << line;
+        lines++;
+        start = end + 1;
+    }
+    EXPECT_EQ(2000u, lines);
+}
+
+TEST(StreamErrorTest, ReportsFailedWrites) {
+    minicrt::stream s;
+    minicrt::stream_init(&s, -1, minicrt::STREAM_FULLY_BUFFERED);
+    EXPECT_EQ(0, minicrt::stream_puts(&s, "buffered"));
+    EXPECT_EQ(0, minicrt::stream_error(&s));
+    EXPECT_EQ(-1, minicrt::stream_flush(&s));
+    EXPECT_NE(0, minicrt::stream_error(&s));
+}
+
+TEST(StandardStreamTest, WritesToFileDescriptorOne) {
+    int pipe_fds[2];
+    ASSERT_EQ(0, pipe(pipe_fds));
+    std::fflush(stdout);
+    int saved = dup(1);
+    dup2(pipe_fds[1], 1);
+
+    minicrt::stream_puts(minicrt::stdout_stream(), "to stdout\n");
+    minicrt::stream_flush(minicrt::stdout_stream());
+
+    dup2(saved, 1);
+    close(saved);
+    close(pipe_fds[1]);
+
+    char buf[64] = {};
+    ssize_t n = read(pipe_fds[0], buf, sizeof(buf) - 1);
+    close(pipe_fds[0]);
+    EXPECT_EQ(std::string("to stdout\n"), std::string(buf, n > 0 ? (size_t) n : 0));
+}
+#endif
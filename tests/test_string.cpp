@@ -1,6 +1,76 @@
 #include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include "minicrt/cpu.h"
 #include "minicrt/string.h"
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Runs a test body on every kernel tier the CPU supports
+    template <typename Body>
+    void for_each_tier(Body body) {
+        minicrt::cpu_tier best = minicrt::cpu_best_tier();
+        for (int t = minicrt::CPU_TIER_GENERIC; t <= best; t++) {
+            ASSERT_EQ(0, minicrt::cpu_set_tier((minicrt::cpu_tier) t));
+            SCOPED_TRACE(minicrt::cpu_tier_name((minicrt::cpu_tier) t));
+            body();
+        }
+        minicrt::cpu_set_tier(best);
+    }
+
+    int sign(int v) {
+        return (v > 0) - (v < 0);
+    }
+
+    // Reference search, quadratic but obviously correct
+    const char *naive_find(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+        for (size_t i = 0; i + needle_len <= haystack_len; i++) {
+            if (std::memcmp(haystack + i, needle, needle_len) == 0)
+                return haystack + i;
+        }
+        return nullptr;
+    }
+
+#ifndef _WIN32
+    // A readable page followed by a PROT_NONE page: any read past the first page faults
+    class GuardedPage {
+    public:
+        GuardedPage() {
+            page_size_ = (size_t) sysconf(_SC_PAGESIZE);
+            void *p = mmap(nullptr, 2 * page_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            base_ = p == MAP_FAILED ? nullptr : (char *) p;
+            if (base_)
+                mprotect(base_ + page_size_, page_size_, PROT_NONE);
+        }
+
+        ~GuardedPage() {
+            if (base_)
+                munmap(base_, 2 * page_size_);
+        }
+
+        bool ok() const { return base_ != nullptr; }
+
+        // Place len copies of fill so that the terminator is the last readable byte
+        char *string_at_end(size_t len, char fill) {
+            char *s = base_ + page_size_ - len - 1;
+            std::memset(s, fill, len);
+            s[len] = '\0';
+            return s;
+        }
+
+        char *end() const { return base_ + page_size_; }
+
+    private:
+        char *base_;
+        size_t page_size_;
+    };
+#endif
+}
+
 // Test basic functionality of strlen
 TEST(StringTest, StrLenBasic) {
     const char *empty = "";
@@ -63,3 +133,501 @@ TEST(StringTest, CompareWithStdLib) {
 
     EXPECT_EQ(minicrt::strcmp(text, dest1), ::strcmp(text, dest2));
 }
+
+// Lengths across every alignment and block size, compared with the standard library
+TEST(StringTest, StrLenAllAlignments) {
+    char buf[256];
+
+    for_each_tier([&] {
+        for (size_t off = 0; off < 64; off++) {
+            for (size_t len = 0; len < 150; len++) {
+                std::memset(buf, 'a', sizeof(buf));
+                buf[off + len] = '\0';
+                ASSERT_EQ(len, minicrt::strlen(buf + off)) << off;
+                ASSERT_EQ(len, minicrt::strnlen(buf + off, 1000));
+                ASSERT_EQ(len < 40 ? len : 40, minicrt::strnlen(buf + off, 40));
+                ASSERT_EQ(0u, minicrt::strnlen(buf + off, 0));
+            }
+        }
+    });
+}
+
+TEST(StringTest, StrCmpAllAlignments) {
+    char a[256], b[256];
+
+    for_each_tier([&] {
+        for (size_t a_off = 0; a_off < 32; a_off += 3) {
+            for (size_t b_off = 0; b_off < 32; b_off++) {
+                for (size_t len = 0; len < 100; len += 7) {
+                    std::memset(a, 'x', sizeof(a));
+                    std::memset(b, 'x', sizeof(b));
+                    a[a_off + len] = '\0';
+                    b[b_off + len] = '\0';
+                    ASSERT_EQ(0, minicrt::strcmp(a + a_off, b + b_off));
+
+                    // Difference at every position, including a high-bit byte
+                    for (size_t pos = 0; pos < len; pos += 5) {
+                        b[b_off + pos] = (char) 0xF0;
+                        ASSERT_EQ(sign(std::strcmp(a + a_off, b + b_off)),
+                                  sign(minicrt::strcmp(a + a_off, b + b_off)));
+                        ASSERT_LT(minicrt::strcmp(a + a_off, b + b_off), 0);
+                        b[b_off + pos] = 'x';
+                    }
+
+                    // One string is a prefix of the other
+                    b[b_off + len] = 'y';
+                    b[b_off + len + 1] = '\0';
+                    ASSERT_LT(minicrt::strcmp(a + a_off, b + b_off), 0);
+                    ASSERT_GT(minicrt::strcmp(b + b_off, a + a_off), 0);
+                }
+            }
+        }
+    });
+}
+
+TEST(StringTest, MemChrBasic) {
+    const char text[] = "find the needle in the haystack";
+    size_t len = sizeof(text) - 1;
+
+    EXPECT_EQ(text + 2, minicrt::memchr(text, 'n', len));
+    EXPECT_EQ(text + 25, minicrt::memrchr(text, 'y', len));
+    EXPECT_EQ(text + 17, minicrt::memrchr(text, 'n', len));
+    EXPECT_EQ(nullptr, minicrt::memchr(text, 'z', len));
+    EXPECT_EQ(nullptr, minicrt::memchr(text, 'f', 0));
+    EXPECT_EQ(nullptr, minicrt::memrchr(text, 'f', 0));
+    EXPECT_EQ(text + len, minicrt::memchr(text, '\0', len + 1));
+    EXPECT_EQ(text + 7, minicrt::rawmemchr(text, 'e'));
+    EXPECT_EQ(text + len, minicrt::rawmemchr(text, '\0'));
+}
+
+TEST(StringTest, StrChrBasic) {
+    const char *text = "hello, world";
+
+    EXPECT_EQ(text + 2, minicrt::strchr(text, 'l'));
+    EXPECT_EQ(text + 10, minicrt::strrchr(text, 'l'));
+    EXPECT_EQ(text + 12, minicrt::strchr(text, '\0'));
+    EXPECT_EQ(text + 12, minicrt::strrchr(text, '\0'));
+    EXPECT_EQ(nullptr, minicrt::strchr(text, 'z'));
+    EXPECT_EQ(nullptr, minicrt::strrchr(text, 'z'));
+    EXPECT_EQ(text + 4, minicrt::strchr(text, 'o' + 256)) << "c is converted to char";
+}
+
+TEST(StringTest, StrStrBasic) {
+    const char *text = "the quick brown fox jumps over the lazy dog";
+
+    EXPECT_EQ(text + 16, minicrt::strstr(text, "fox"));
+    EXPECT_EQ(text + 31, minicrt::strstr(text, "the lazy"));
+    EXPECT_EQ(text + 40, minicrt::strstr(text, "dog"));
+    EXPECT_EQ(text + 4, minicrt::strstr(text, "q"));
+    EXPECT_EQ(text, minicrt::strstr(text, ""));
+    EXPECT_EQ(nullptr, minicrt::strstr(text, "cat"));
+    EXPECT_EQ(nullptr, minicrt::strstr(text, "dogs"));
+    EXPECT_EQ(nullptr, minicrt::strstr("", "a"));
+
+    EXPECT_EQ(text + 10, minicrt::memmem(text, 43, "brown", 5));
+    EXPECT_EQ(text, minicrt::memmem(text, 43, "x", 0));
+    EXPECT_EQ(nullptr, minicrt::memmem(text, 3, "the ", 4));
+
+    // memmem does not stop at a NUL byte
+    const char binary[] = {'a', '\0', 'b', '\0', 'c', 'd'};
+    const char needle[] = {'\0', 'c'};
+    EXPECT_EQ(binary + 3, minicrt::memmem(binary, sizeof(binary), needle, sizeof(needle)));
+}
+
+// Every alignment and length, with the byte before, inside and after the range
+TEST(StringTest, MemChrAllAlignments) {
+    char buf[320];
+
+    for_each_tier([&] {
+        for (size_t off = 0; off < 64; off++) {
+            for (size_t len = 0; len < 200; len++) {
+                std::memset(buf, 'a', sizeof(buf));
+                char *s = buf + off;
+                if (off)
+                    s[-1] = 'x';
+                s[len] = 'x';
+                ASSERT_EQ(nullptr, minicrt::memchr(s, 'x', len)) << off << "/" << len;
+                ASSERT_EQ(nullptr, minicrt::memrchr(s, 'x', len)) << off << "/" << len;
+                ASSERT_EQ(s + len, minicrt::rawmemchr(s, 'x'));
+
+                for (size_t pos = 0; pos < len; pos += 1 + pos / 8) {
+                    s[pos] = (char) 0xE1;
+                    ASSERT_EQ(s + pos, minicrt::memchr(s, 0xE1, len)) << off << "/" << len << "/" << pos;
+                    ASSERT_EQ(s + pos, minicrt::memrchr(s, 0xE1, len)) << off << "/" << len << "/" << pos;
+                    ASSERT_EQ(s + pos, minicrt::rawmemchr(s, 0xE1));
+                    if (len - pos > 1) {
+                        s[len - 1] = (char) 0xE1;
+                        ASSERT_EQ(s + pos, minicrt::memchr(s, 0xE1, len));
+                        ASSERT_EQ(s + len - 1, minicrt::memrchr(s, 0xE1, len));
+                        s[len - 1] = 'a';
+                    }
+                    s[pos] = 'a';
+                }
+            }
+        }
+    });
+}
+
+TEST(StringTest, StrChrAllAlignments) {
+    char buf[320];
+
+    for_each_tier([&] {
+        for (size_t off = 0; off < 64; off++) {
+            for (size_t len = 0; len < 150; len++) {
+                std::memset(buf, 'a', sizeof(buf));
+                char *s = buf + off;
+                if (off)
+                    s[-1] = 'x';
+                s[len] = '\0';
+                s[len + 1] = 'x';
+                ASSERT_EQ(nullptr, minicrt::strchr(s, 'x')) << off << "/" << len;
+                ASSERT_EQ(nullptr, minicrt::strrchr(s, 'x')) << off << "/" << len;
+                ASSERT_EQ(s + len, minicrt::strchr(s, '\0'));
+                ASSERT_EQ(s + len, minicrt::strrchr(s, '\0'));
+                ASSERT_EQ(len ? s + len - 1 : nullptr, minicrt::strrchr(s, 'a'));
+
+                for (size_t pos = 0; pos < len; pos += 1 + pos / 8) {
+                    s[pos] = (char) 0xE1;
+                    ASSERT_EQ(std::strchr(s, 0xE1), minicrt::strchr(s, 0xE1)) << off << "/" << len << "/" << pos;
+                    ASSERT_EQ(std::strrchr(s, 0xE1), minicrt::strrchr(s, 0xE1)) << off << "/" << len << "/" << pos;
+                    s[len - 1] = (char) 0xE1;
+                    ASSERT_EQ(s + pos, minicrt::strchr(s, 0xE1));
+                    ASSERT_EQ(s + len - 1, minicrt::strrchr(s, 0xE1));
+                    s[len - 1] = 'a';
+                    s[pos] = 'a';
+                }
+            }
+        }
+    });
+}
+
+// Small alphabets give many partial matches; compared with a naive search
+TEST(StringTest, StrStrMatchesNaiveSearch) {
+    std::string haystack;
+    unsigned int x = 12345;
+    for (int i = 0; i < 3000; i++) {
+        x = x * 1103515245u + 12345u;
+        haystack += (char) ('a' + (x >> 16) % 3);
+    }
+
+    for_each_tier([&] {
+        for (size_t needle_len = 1; needle_len < 40; needle_len++) {
+            for (size_t start = 0; start + needle_len < haystack.size(); start += 97) {
+                std::string needle = haystack.substr(start, needle_len);
+                const char *expected = naive_find(haystack.data(), haystack.size(), needle.data(), needle_len);
+                ASSERT_EQ(expected, minicrt::strstr(haystack.c_str(), needle.c_str())) << needle;
+                ASSERT_EQ(expected, minicrt::memmem(haystack.data(), haystack.size(), needle.data(), needle_len));
+
+                // The same needle with its last byte changed usually does not occur
+                needle.back() = needle.back() == 'c' ? 'a' : (char) (needle.back() + 1);
+                expected = naive_find(haystack.data(), haystack.size(), needle.data(), needle_len);
+                ASSERT_EQ(expected, minicrt::strstr(haystack.c_str(), needle.c_str())) << needle;
+                ASSERT_EQ(expected, minicrt::memmem(haystack.data(), haystack.size(), needle.data(), needle_len));
+            }
+        }
+
+        // Every haystack alignment and length around the vector widths
+        for (size_t off = 0; off < 40; off++) {
+            for (size_t len = 0; len < 100; len++) {
+                const char *h = haystack.data() + off;
+                for (size_t needle_len = 2; needle_len <= 6; needle_len++) {
+                    const char *needle = haystack.data() + 500 + len;
+                    ASSERT_EQ(naive_find(h, len, needle, needle_len), minicrt::memmem(h, len, needle, needle_len))
+                        << off << "/" << len << "/" << needle_len;
+                }
+            }
+        }
+    });
+}
+
+// Inputs that make the first/last-byte filter match everywhere must stay linear
+TEST(StringTest, StrStrAdversarialInputs) {
+    const size_t kHaystack = 4 << 20;
+    std::string haystack(kHaystack, 'a');
+    std::string needle = std::string(1000, 'a') + "b" + std::string(1000, 'a');
+    std::string periodic;
+    for (int i = 0; i < 500; i++)
+        periodic += "ab";
+    std::string periodic_haystack;
+    for (size_t i = 0; i < kHaystack / 2; i++)
+        periodic_haystack += "ab";
+
+    for_each_tier([&] {
+        EXPECT_EQ(nullptr, minicrt::strstr(haystack.c_str(), needle.c_str()));
+        EXPECT_EQ(nullptr, minicrt::memmem(haystack.data(), haystack.size(), needle.data(), needle.size()));
+
+        // Found at the very end after the filter has given up
+        haystack[kHaystack - 1001] = 'b';
+        EXPECT_EQ(haystack.data() + kHaystack - 2001, minicrt::strstr(haystack.c_str(), needle.c_str()));
+        EXPECT_EQ(haystack.data() + kHaystack - 2001,
+                  minicrt::memmem(haystack.data(), haystack.size(), needle.data(), needle.size()));
+        haystack[kHaystack - 1001] = 'a';
+
+        // A periodic needle with a mismatch only in its last byte
+        std::string almost = periodic + "c";
+        EXPECT_EQ(nullptr, minicrt::strstr(periodic_haystack.c_str(), almost.c_str()));
+        EXPECT_EQ(periodic_haystack.data(), minicrt::strstr(periodic_haystack.c_str(), periodic.c_str()));
+        almost = periodic.substr(1) + "a";
+        EXPECT_EQ(periodic_haystack.data() + 1, minicrt::strstr(periodic_haystack.c_str(), almost.c_str()));
+    });
+}
+
+TEST(StringTest, ByteSetMembership) {
+    minicrt::byteset set;
+    minicrt::byteset_init(&set, ",;\t\xE9");
+    EXPECT_TRUE(minicrt::byteset_contains(&set, ','));
+    EXPECT_TRUE(minicrt::byteset_contains(&set, '\t'));
+    EXPECT_TRUE(minicrt::byteset_contains(&set, 0xE9));
+    EXPECT_TRUE(minicrt::byteset_contains(&set, (char) 0xE9));
+    EXPECT_FALSE(minicrt::byteset_contains(&set, 'a'));
+    EXPECT_FALSE(minicrt::byteset_contains(&set, '\0'));
+
+    const unsigned char bytes[] = {0, 0x80, 0xFF, 0x80};
+    minicrt::byteset_init_bytes(&set, bytes, sizeof(bytes));
+    for (int c = 0; c < 256; c++)
+        EXPECT_EQ(c == 0 || c == 0x80 || c == 0xFF, minicrt::byteset_contains(&set, c) != 0) << c;
+}
+
+TEST(StringTest, SpanBasic) {
+    const char *line = "  key = value; other";
+
+    EXPECT_EQ(2u, minicrt::strspn(line, " "));
+    EXPECT_EQ(0u, minicrt::strspn(line, ""));
+    EXPECT_EQ(6u, minicrt::strspn(line, "yek "));
+    EXPECT_EQ(6u, minicrt::strcspn(line, "=;"));
+    EXPECT_EQ(20u, minicrt::strcspn(line, ""));
+    EXPECT_EQ(line + 13, minicrt::strpbrk(line, ";"));
+    EXPECT_EQ(nullptr, minicrt::strpbrk(line, "!?"));
+
+    // The explicit-length forms stop at the length and pass over NUL bytes
+    const char field[] = {'a', 'b', '\0', 'c', ',', 'd'};
+    EXPECT_EQ(4u, minicrt::strncspn(field, sizeof(field), ","));
+    EXPECT_EQ(3u, minicrt::strncspn(field, 3, ","));
+    EXPECT_EQ(field + 4, minicrt::strnpbrk(field, sizeof(field), ",;"));
+    EXPECT_EQ(nullptr, minicrt::strnpbrk(field, 4, ",;"));
+    EXPECT_EQ(2u, minicrt::strnspn(field, sizeof(field), "ab"));
+    EXPECT_EQ(0u, minicrt::strnspn(field, 0, "ab"));
+
+    minicrt::byteset set;
+    const char with_nul[] = {'a', 'b', '\0'};
+    minicrt::byteset_init_bytes(&set, with_nul, sizeof(with_nul));
+    EXPECT_EQ(3u, minicrt::byteset_nspan(&set, field, sizeof(field)));
+    EXPECT_EQ(2u, minicrt::byteset_span(&set, field)) << "the terminator ends a string span";
+}
+
+TEST(StringTest, StrSepKeepsEmptyFields) {
+    char line[] = "a,,b;c,";
+    char *rest = line;
+    const char *expected[] = {"a", "", "b", "c", ""};
+    for (const char *field : expected)
+        EXPECT_STREQ(field, minicrt::strsep(&rest, ",;"));
+    EXPECT_EQ(nullptr, rest);
+    EXPECT_EQ(nullptr, minicrt::strsep(&rest, ",;"));
+
+    // The explicit-length form leaves the range alone and passes over NUL bytes
+    const char range[] = {'a', ',', ',', 'b', '\0', 'c', ','};
+    const char *cursor = range;
+    size_t left = sizeof(range);
+    size_t length = 0;
+    const std::string fields[] = {"a", "", std::string("b\0c", 3), ""};
+    for (const std::string &field : fields) {
+        const char *found = minicrt::strnsep(&cursor, &left, ",;", &length);
+        ASSERT_NE(nullptr, found);
+        EXPECT_EQ(field, std::string(found, length));
+    }
+    EXPECT_EQ(nullptr, cursor);
+    EXPECT_EQ(0u, left);
+    EXPECT_EQ(nullptr, minicrt::strnsep(&cursor, &left, ",;", &length));
+
+    // The last field ends at the length, not at a delimiter beyond it
+    cursor = range;
+    left = 1;
+    EXPECT_EQ(range, minicrt::strnsep(&cursor, &left, ",", &length));
+    EXPECT_EQ(1u, length);
+    EXPECT_EQ(nullptr, cursor);
+}
+
+TEST(StringTest, StrTokSkipsDelimiterRuns) {
+    char line[] = "  GET   /index.html\tHTTP/1.1  ";
+    char *save = nullptr;
+    EXPECT_STREQ("GET", minicrt::strtok_r(line, " \t", &save));
+    EXPECT_STREQ("/index.html", minicrt::strtok_r(nullptr, " \t", &save));
+    EXPECT_STREQ("HTTP/1.1", minicrt::strtok_r(nullptr, " \t", &save));
+    EXPECT_EQ(nullptr, minicrt::strtok_r(nullptr, " \t", &save));
+    EXPECT_EQ(nullptr, minicrt::strtok_r(nullptr, " \t", &save));
+
+    char empty[] = " \t ";
+    EXPECT_EQ(nullptr, minicrt::strtok_r(empty, " \t", &save));
+
+    // Explicit length: a request line without a terminator, cut short of its end
+    const char request[] = "  GET   /index.html\tHTTP/1.1  ";
+    const char *cursor = request;
+    size_t left = 25;
+    size_t length = 0;
+    const char *token = minicrt::strntok_r(&cursor, &left, " \t", &length);
+    EXPECT_EQ("GET", std::string(token, length));
+    token = minicrt::strntok_r(&cursor, &left, " \t", &length);
+    EXPECT_EQ("/index.html", std::string(token, length));
+    token = minicrt::strntok_r(&cursor, &left, " \t", &length);
+    EXPECT_EQ("HTTP/", std::string(token, length));
+    EXPECT_EQ(request + 25, cursor);
+    EXPECT_EQ(0u, left);
+    EXPECT_EQ(nullptr, minicrt::strntok_r(&cursor, &left, " \t", &length));
+    left = 2;
+    cursor = request;
+    EXPECT_EQ(nullptr, minicrt::strntok_r(&cursor, &left, " \t", &length));
+    EXPECT_EQ(request + 2, cursor);
+
+    // One compiled set reused across many lines
+    minicrt::byteset set;
+    minicrt::byteset_init(&set, "\t");
+    for (int i = 0; i < 100; i++) {
+        char row[] = "id\tname\t\tvalue";
+        char *cursor = row;
+        int fields = 0;
+        while (minicrt::byteset_sep(&set, &cursor))
+            fields++;
+        ASSERT_EQ(4, fields);
+    }
+}
+
+// Every alignment and length with sets that take each kernel path, against the C library
+TEST(StringTest, SpanAllAlignments) {
+    std::string large;
+    for (int c = 1; c < 256; c += 3)
+        large += (char) c;
+    const std::string sets[] = {"", ",", ",;", ",;\t\n", ",;\t\n|", "\x80\xFF\x7F", large};
+    char buf[320];
+
+    for_each_tier([&] {
+        for (const std::string &accept : sets) {
+            minicrt::byteset set;
+            minicrt::byteset_init(&set, accept.c_str());
+            // A member and a non-member byte to fill with
+            char member = accept.empty() ? 'x' : accept.back();
+            char other = 'a';
+            while (accept.find(other) != std::string::npos)
+                other++;
+            for (size_t off = 0; off < 64; off++) {
+                for (size_t len = 0; len < 150; len += 1 + len / 16) {
+                    char *s = buf + off;
+                    std::memset(buf, member, sizeof(buf));
+                    if (off)
+                        s[-1] = other;
+                    s[len] = other;
+                    s[len + 1] = '\0';
+                    ASSERT_EQ(std::strspn(s, accept.c_str()), minicrt::strspn(s, accept.c_str()))
+                        << accept.size() << "/" << off << "/" << len;
+                    ASSERT_EQ(accept.empty() ? 0 : len, minicrt::byteset_nspan(&set, s, len + 2));
+                    ASSERT_EQ(len < 7 || accept.empty() ? (accept.empty() ? 0 : len) : 7,
+                              minicrt::byteset_nspan(&set, s, 7));
+
+                    std::memset(buf, other, sizeof(buf));
+                    if (off)
+                        s[-1] = member;
+                    s[len] = member;
+                    s[len + 1] = '\0';
+                    ASSERT_EQ(std::strcspn(s, accept.c_str()), minicrt::strcspn(s, accept.c_str()))
+                        << accept.size() << "/" << off << "/" << len;
+                    ASSERT_EQ(std::strpbrk(s, accept.c_str()), minicrt::strpbrk(s, accept.c_str()));
+                    ASSERT_EQ(accept.empty() ? len + 2 : len, minicrt::byteset_ncspan(&set, s, len + 2));
+                    s[len + 1] = other;
+                    s[len + 2] = '\0';
+                }
+            }
+        }
+    });
+}
+
+#ifndef _WIN32
+// Strings ending right before an unmapped page must not fault
+TEST(StringTest, StrLenPageBoundary) {
+    GuardedPage page;
+    ASSERT_TRUE(page.ok());
+
+    for_each_tier([&] {
+        for (size_t len = 0; len < 200; len++) {
+            char *s = page.string_at_end(len, 'p');
+            ASSERT_EQ(len, minicrt::strlen(s));
+            ASSERT_EQ(len, minicrt::strnlen(s, len + 1000));
+        }
+    });
+}
+
+// strnlen must stop at max_len even when no terminator precedes the unmapped page
+TEST(StringTest, StrNLenStopsAtPageBoundary) {
+    GuardedPage page;
+    ASSERT_TRUE(page.ok());
+
+    for_each_tier([&] {
+        for (size_t len = 1; len < 200; len++) {
+            char *s = page.end() - len;
+            std::memset(s, 'q', len);
+            ASSERT_EQ(len, minicrt::strnlen(s, len));
+        }
+    });
+}
+
+TEST(StringTest, StrCmpPageBoundary) {
+    GuardedPage lhs_page, rhs_page;
+    ASSERT_TRUE(lhs_page.ok() && rhs_page.ok());
+
+    for_each_tier([&] {
+        for (size_t lhs_len = 0; lhs_len < 80; lhs_len++) {
+            for (size_t rhs_len = 0; rhs_len < 80; rhs_len += 3) {
+                char *lhs = lhs_page.string_at_end(lhs_len, 'z');
+                char *rhs = rhs_page.string_at_end(rhs_len, 'z');
+                int expected = sign((int) lhs_len - (int) rhs_len);
+                ASSERT_EQ(expected, sign(minicrt::strcmp(lhs, rhs))) << lhs_len << "/" << rhs_len;
+            }
+        }
+    });
+}
+
+TEST(StringTest, SearchPageBoundary) {
+    GuardedPage page;
+    ASSERT_TRUE(page.ok());
+
+    for_each_tier([&] {
+        for (size_t len = 0; len < 200; len++) {
+            char *s = page.string_at_end(len, 's');
+            ASSERT_EQ(nullptr, minicrt::memchr(s, 'x', len + 1));
+            ASSERT_EQ(s + len, minicrt::memchr(s, '\0', len + 1));
+            ASSERT_EQ(s + len, minicrt::rawmemchr(s, '\0'));
+            ASSERT_EQ(len ? s + len - 1 : nullptr, minicrt::memrchr(s, 's', len + 1));
+            ASSERT_EQ(nullptr, minicrt::strchr(s, 'x'));
+            ASSERT_EQ(len ? s + len - 1 : nullptr, minicrt::strrchr(s, 's'));
+            ASSERT_EQ(nullptr, minicrt::strstr(s, "sx"));
+            ASSERT_EQ(nullptr, minicrt::memmem(s, len, "sx", 2));
+            if (len >= 3) {
+                ASSERT_EQ(s, minicrt::strstr(s, "sss"));
+                ASSERT_EQ(s + len - 3, minicrt::memmem(s + len - 3, 3, "sss", 3));
+            }
+        }
+    });
+}
+
+TEST(StringTest, SpanPageBoundary) {
+    GuardedPage page;
+    ASSERT_TRUE(page.ok());
+    minicrt::byteset small, large;
+    minicrt::byteset_init(&small, "p");
+    minicrt::byteset_init(&large, "pqrstuvw");
+
+    for_each_tier([&] {
+        for (size_t len = 0; len < 200; len++) {
+            char *s = page.string_at_end(len, 'p');
+            ASSERT_EQ(len, minicrt::byteset_span(&small, s));
+            ASSERT_EQ(len, minicrt::byteset_span(&large, s));
+            ASSERT_EQ(len, minicrt::strcspn(s, ",;"));
+            ASSERT_EQ(len, minicrt::byteset_nspan(&large, s, len));
+
+            // A range that ends at the page end without a terminator
+            char *range = page.end() - len;
+            std::memset(range, 'q', len);
+            ASSERT_EQ(len, minicrt::byteset_ncspan(&small, range, len));
+            ASSERT_EQ(len, minicrt::byteset_nspan(&large, range, len));
+        }
+    });
+}
+#endif
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "minicrt/sync.h"
+
+namespace {
+    template <typename F>
+    void run_threads(int count, F body) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < count; t++)
+            threads.emplace_back(body, t);
+        for (std::thread &t : threads)
+            t.join();
+    }
+}
+
+TEST(SyncTest, MutexCounter) {
+    const int kThreads = 8;
+    const int kIterations = 20000;
+    minicrt::mutex m = MUTEX_INIT;
+    long counter = 0;
+
+    run_threads(kThreads, [&](int) {
+        for (int i = 0; i < kIterations; i++) {
+            minicrt::mutex_lock(&m);
+            counter++;
+            minicrt::mutex_unlock(&m);
+        }
+    });
+
+    EXPECT_EQ((long) kThreads * kIterations, counter);
+    EXPECT_EQ(0, m.state);
+}
+
+TEST(SyncTest, MutexTrylock) {
+    minicrt::mutex m;
+    minicrt::mutex_init(&m);
+
+    EXPECT_NE(0, minicrt::mutex_trylock(&m));
+    EXPECT_EQ(0, minicrt::mutex_trylock(&m));
+
+    int other = -1;
+    std::thread t([&] { other = minicrt::mutex_trylock(&m); });
+    t.join();
+    EXPECT_EQ(0, other);
+
+    minicrt::mutex_unlock(&m);
+    EXPECT_NE(0, minicrt::mutex_trylock(&m));
+    minicrt::mutex_unlock(&m);
+}
+
+TEST(SyncTest, CondvarProducerConsumer) {
+    const int kItems = 10000;
+    minicrt::mutex m = MUTEX_INIT;
+    minicrt::condvar not_empty = CONDVAR_INIT;
+    minicrt::condvar not_full = CONDVAR_INIT;
+    int queue[4];
+    int head = 0, count = 0;
+    long sum = 0;
+
+    std::thread consumer([&] {
+        for (int i = 0; i < kItems; i++) {
+            minicrt::mutex_lock(&m);
+            while (count == 0)
+                minicrt::condvar_wait(&not_empty, &m);
+            sum += queue[head];
+            head = (head + 1) % 4;
+            count--;
+            minicrt::condvar_signal(&not_full);
+            minicrt::mutex_unlock(&m);
+        }
+    });
+
+    for (int i = 1; i <= kItems; i++) {
+        minicrt::mutex_lock(&m);
+        while (count == 4)
+            minicrt::condvar_wait(&not_full, &m);
+        queue[(head + count) % 4] = i;
+        count++;
+        minicrt::condvar_signal(&not_empty);
+        minicrt::mutex_unlock(&m);
+    }
+    consumer.join();
+
+    EXPECT_EQ((long) kItems * (kItems + 1) / 2, sum);
+}
+
+TEST(SyncTest, CondvarBroadcast) {
+    const int kWaiters = 16;
+    minicrt::mutex m = MUTEX_INIT;
+    minicrt::condvar cv = CONDVAR_INIT;
+    int waiting = 0;
+    bool go = false;
+    std::atomic<int> woken(0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kWaiters; t++) {
+        threads.emplace_back([&] {
+            minicrt::mutex_lock(&m);
+            waiting++;
+            while (!go)
+                minicrt::condvar_wait(&cv, &m);
+            minicrt::mutex_unlock(&m);
+            woken++;
+        });
+    }
+
+    // Wait until every thread is blocked, so the broadcast has waiters to requeue
+    for (;;) {
+        minicrt::mutex_lock(&m);
+        bool all = waiting == kWaiters;
+        if (all) {
+            go = true;
+            minicrt::condvar_broadcast(&cv);
+        }
+        minicrt::mutex_unlock(&m);
+        if (all)
+            break;
+        std::this_thread::yield();
+    }
+
+    for (std::thread &t : threads)
+        t.join();
+    EXPECT_EQ(kWaiters, woken.load());
+}
+
+TEST(SyncTest, CondvarTimedwait) {
+    minicrt::mutex m = MUTEX_INIT;
+    minicrt::condvar cv = CONDVAR_INIT;
+    minicrt::timespec timeout = {0, 20 * 1000 * 1000};
+
+    minicrt::mutex_lock(&m);
+    auto start = std::chrono::steady_clock::now();
+    int result = minicrt::condvar_timedwait(&cv, &m, &timeout);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(-1, result);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(15));
+    // The mutex is held again
+    EXPECT_EQ(0, minicrt::mutex_trylock(&m));
+    minicrt::mutex_unlock(&m);
+}
+
+TEST(SyncTest, CallOnce) {
+    static minicrt::once_flag flag = ONCE_FLAG_INIT;
+    static std::atomic<int> runs(0);
+
+    run_threads(8, [](int) {
+        minicrt::call_once(&flag, [](void *arg) {
+            // Hold the flag long enough for the others to queue up
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            (*(std::atomic<int> *) arg)++;
+        }, &runs);
+        EXPECT_EQ(1, runs.load());
+    });
+
+    EXPECT_EQ(1, runs.load());
+    EXPECT_EQ(3, flag.state);
+}
+
+TEST(SyncTest, RwlockReadersShare) {
+    minicrt::rwlock lock = RWLOCK_INIT;
+
+    minicrt::rwlock_read_lock(&lock);
+    int acquired = 0;
+    std::thread reader([&] {
+        minicrt::rwlock_read_lock(&lock);
+        acquired = 1;
+        minicrt::rwlock_read_unlock(&lock);
+    });
+    reader.join();
+    EXPECT_EQ(1, acquired);
+    minicrt::rwlock_read_unlock(&lock);
+    EXPECT_EQ(0, lock.state);
+}
+
+TEST(SyncTest, RwlockWritersExclude) {
+    const int kThreads = 8;
+    const int kIterations = 5000;
+    minicrt::rwlock lock;
+    minicrt::rwlock_init(&lock);
+    long a = 0, b = 0;
+    std::atomic<int> torn(0);
+
+    run_threads(kThreads, [&](int t) {
+        for (int i = 0; i < kIterations; i++) {
+            if ((i + t) % 4 == 0) {
+                minicrt::rwlock_write_lock(&lock);
+                a++;
+                b++;
+                minicrt::rwlock_write_unlock(&lock);
+            } else {
+                minicrt::rwlock_read_lock(&lock);
+                if (a != b)
+                    torn++;
+                minicrt::rwlock_read_unlock(&lock);
+            }
+        }
+    });
+
+    EXPECT_EQ(0, torn.load());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ((long) kThreads * kIterations / 4, a);
+    EXPECT_EQ(0, lock.state);
+}
+
+TEST(SyncTest, RwlockPrefersWriters) {
+    minicrt::rwlock lock = RWLOCK_INIT;
+    std::atomic<int> writer_done(0);
+    std::atomic<int> late_reader_saw_writer(-1);
+
+    minicrt::rwlock_read_lock(&lock);
+    std::thread writer([&] {
+        minicrt::rwlock_write_lock(&lock);
+        writer_done = 1;
+        minicrt::rwlock_write_unlock(&lock);
+    });
+
+    // Once the writer is waiting, a new reader has to queue behind it
+    while ((lock.state & 0x3FF00000) == 0)
+        std::this_thread::yield();
+    std::thread reader([&] {
+        minicrt::rwlock_read_lock(&lock);
+        late_reader_saw_writer = writer_done.load();
+        minicrt::rwlock_read_unlock(&lock);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(0, writer_done.load());
+    minicrt::rwlock_read_unlock(&lock);
+
+    writer.join();
+    reader.join();
+    EXPECT_EQ(1, late_reader_saw_writer.load());
+    EXPECT_EQ(0, lock.state);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include "minicrt/thread.h"
+
+// A hosted process starts in the system C library, so these threads come from
+// pthread_create(); startup_test covers the clone path of a freestanding program
+
+namespace {
+    int add_one(void *arg) {
+        return *(int *) arg + 1;
+    }
+
+    int use_stack(void *arg) {
+        // Touch most of a 256 KiB stack
+        volatile char buf[200 * 1024];
+        for (size_t i = 0; i < sizeof(buf); i += 4096)
+            buf[i] = (char) i;
+        return buf[4096] + *(int *) arg;
+    }
+}
+
+TEST(ThreadTest, CreateJoin) {
+    int value = 41;
+    minicrt::thread *t = nullptr;
+    ASSERT_EQ(0, minicrt::thread_create(&t, add_one, &value, 0));
+    ASSERT_NE(nullptr, t);
+
+    int result = 0;
+    EXPECT_EQ(0, minicrt::thread_join(t, &result));
+    EXPECT_EQ(42, result);
+}
+
+TEST(ThreadTest, ManyThreads) {
+    const int kThreads = 32;
+    static std::atomic<int> runs(0);
+    runs = 0;
+
+    minicrt::thread *threads[kThreads];
+    for (minicrt::thread *&t : threads) {
+        ASSERT_EQ(0, minicrt::thread_create(&t, [](void *) { return ++runs; }, nullptr, 0));
+    }
+    int sum = 0;
+    for (minicrt::thread *t : threads) {
+        int result = 0;
+        ASSERT_EQ(0, minicrt::thread_join(t, &result));
+        sum += result;
+    }
+
+    // Each thread saw a different count
+    EXPECT_EQ(kThreads, runs.load());
+    EXPECT_EQ(kThreads * (kThreads + 1) / 2, sum);
+}
+
+TEST(ThreadTest, StackSize) {
+    int value = 1;
+    minicrt::thread *t = nullptr;
+    ASSERT_EQ(0, minicrt::thread_create(&t, use_stack, &value, 256 * 1024));
+    int result = 0;
+    EXPECT_EQ(0, minicrt::thread_join(t, &result));
+    EXPECT_EQ(1, result);
+
+    // The result pointer is optional
+    ASSERT_EQ(0, minicrt::thread_create(&t, add_one, &value, 0));
+    EXPECT_EQ(0, minicrt::thread_join(t, nullptr));
+}
+
+TEST(ThreadTest, InvalidArguments) {
+    minicrt::thread *t = nullptr;
+    EXPECT_EQ(-1, minicrt::thread_create(nullptr, add_one, nullptr, 0));
+    EXPECT_EQ(-1, minicrt::thread_create(&t, nullptr, nullptr, 0));
+    EXPECT_EQ(-1, minicrt::thread_join(nullptr, nullptr));
+}
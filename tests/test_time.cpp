@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <sys/auxv.h>
+#include <sys/time.h>
+#include <time.h>
+#include "minicrt/cpu.h"
+#include "minicrt/time.h"
+
+namespace {
+    long long to_ns(const minicrt::timespec &ts) {
+        return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    long long to_ns(const ::timespec &ts) {
+        return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    long long libc_ns(clockid_t clock) {
+        ::timespec ts;
+        ::clock_gettime(clock, &ts);
+        return to_ns(ts);
+    }
+}
+
+TEST(ClockTest, AuxVectorAvailableWhenHosted) {
+    // The test binary starts in the system C library, so MiniCRT reads procfs
+    EXPECT_EQ(::getauxval(AT_SYSINFO_EHDR), minicrt::getauxval(AT_SYSINFO_EHDR));
+    EXPECT_EQ(::getauxval(AT_PAGESZ), minicrt::getauxval(AT_PAGESZ));
+}
+
+TEST(ClockTest, UsesVdso) {
+    if (::getauxval(AT_SYSINFO_EHDR) == 0)
+        GTEST_SKIP() << "no vDSO";
+    EXPECT_NE(0, minicrt::clock_has_vdso());
+}
+
+TEST(ClockTest, MatchesLibc) {
+    const int clocks[] = {CLOCK_REALTIME, CLOCK_MONOTONIC, CLOCK_MONOTONIC_RAW, CLOCK_BOOTTIME};
+    for (int clock : clocks) {
+        long long before = libc_ns(clock);
+        minicrt::timespec ts;
+        ASSERT_EQ(0, minicrt::clock_gettime(clock, &ts)) << clock;
+        long long after = libc_ns(clock);
+
+        EXPECT_GE(ts.tv_nsec, 0);
+        EXPECT_LT(ts.tv_nsec, 1000000000L);
+        EXPECT_LE(before, to_ns(ts)) << clock;
+        EXPECT_LE(to_ns(ts), after) << clock;
+    }
+}
+
+TEST(ClockTest, CoarseAndCpuClocks) {
+    minicrt::timespec ts;
+    EXPECT_EQ(0, minicrt::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts));
+    EXPECT_EQ(0, minicrt::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts));
+    EXPECT_EQ(0, minicrt::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts));
+    EXPECT_GT(to_ns(ts), 0);
+}
+
+TEST(ClockTest, MonotonicNeverGoesBack) {
+    minicrt::timespec ts;
+    minicrt::clock_gettime(CLOCK_MONOTONIC, &ts);
+    long long last = to_ns(ts);
+    for (int i = 0; i < 100000; i++) {
+        minicrt::clock_gettime(CLOCK_MONOTONIC, &ts);
+        long long now = to_ns(ts);
+        ASSERT_GE(now, last);
+        last = now;
+    }
+}
+
+TEST(ClockTest, InvalidClock) {
+    minicrt::timespec ts;
+    EXPECT_EQ(-1, minicrt::clock_gettime(12345, &ts));
+}
+
+TEST(ClockTest, GettimeofdayMatchesRealtime) {
+    long long before = libc_ns(CLOCK_REALTIME) / 1000;
+    minicrt::timeval tv;
+    ASSERT_EQ(0, minicrt::gettimeofday(&tv, nullptr));
+    long long after = libc_ns(CLOCK_REALTIME) / 1000;
+
+    long long us = tv.tv_sec * 1000000LL + tv.tv_usec;
+    EXPECT_GE(tv.tv_usec, 0);
+    EXPECT_LT(tv.tv_usec, 1000000L);
+    EXPECT_LE(before, us);
+    EXPECT_LE(us, after);
+}
+
+TEST(TscTest, CountsForward) {
+    unsigned long long a = minicrt::tsc_read();
+    unsigned long long b = minicrt::tsc_read_ordered();
+    unsigned long long c = minicrt::tsc_read_ordered();
+    EXPECT_NE(0u, a);
+    EXPECT_LE(a, b);
+    EXPECT_LE(b, c);
+}
+
+TEST(TscTest, ConvertsToMonotonicTime) {
+    if (!minicrt::cpu_has(minicrt::CPU_FEATURE_INVARIANT_TSC)) {
+        EXPECT_EQ(0u, minicrt::tsc_frequency());
+        GTEST_SKIP() << "no invariant TSC";
+    }
+
+    unsigned long long hz = minicrt::tsc_frequency();
+    EXPECT_GT(hz, 100000000ull);
+    EXPECT_LT(hz, 10000000000ull);
+    EXPECT_EQ(0u, minicrt::tsc_to_ns(0));
+
+    // A 50 ms interval measured both ways agrees to well within a percent
+    long long start_ns = libc_ns(CLOCK_MONOTONIC);
+    unsigned long long start_tsc = minicrt::tsc_read_ordered();
+    while (libc_ns(CLOCK_MONOTONIC) - start_ns < 50000000) {
+    }
+    unsigned long long ticks = minicrt::tsc_read_ordered() - start_tsc;
+    long long elapsed = libc_ns(CLOCK_MONOTONIC) - start_ns;
+
+    double measured = (double) minicrt::tsc_to_ns(ticks);
+    EXPECT_NEAR((double) elapsed, measured, (double) elapsed * 0.01);
+
+    // Long intervals do not overflow the fixed-point conversion
+    unsigned long long hour = hz * 3600;
+    EXPECT_NEAR(3600e9, (double) minicrt::tsc_to_ns(hour), 3600e9 * 1e-6);
+}
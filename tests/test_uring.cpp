@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "minicrt/uring.h"
+
+namespace {
+    class IoRingTest : public ::testing::TestWithParam<unsigned int> {
+    protected:
+        void SetUp() override {
+            if (minicrt::io_ring_init(&ring_, 256, GetParam()) != 0)
+                GTEST_SKIP() << "io_uring unavailable: " << std::strerror(errno);
+            initialized_ = true;
+
+            char name[] = "/tmp/minicrt_uring_XXXXXX";
+            fd_ = mkstemp(name);
+            ASSERT_GE(fd_, 0);
+            path_ = name;
+        }
+
+        void TearDown() override {
+            if (initialized_)
+                minicrt::io_ring_destroy(&ring_);
+            if (fd_ >= 0) {
+                close(fd_);
+                unlink(path_.c_str());
+            }
+        }
+
+        // Wait for exactly count completions, indexed by user_data
+        std::vector<minicrt::io_completion> wait_all(unsigned int count) {
+            std::vector<minicrt::io_completion> done(count);
+            std::vector<minicrt::io_completion> by_id(count);
+            unsigned int collected = 0;
+            while (collected < count) {
+                int n = minicrt::io_ring_wait(&ring_, done.data() + collected, count - collected, 1);
+                EXPECT_GT(n, 0);
+                if (n <= 0)
+                    break;
+                collected += (unsigned int) n;
+            }
+            for (unsigned int i = 0; i < collected; i++) {
+                EXPECT_LT(done[i].user_data, count);
+                if (done[i].user_data < count)
+                    by_id[done[i].user_data] = done[i];
+            }
+            return by_id;
+        }
+
+        minicrt::io_ring ring_;
+        bool initialized_ = false;
+        int fd_ = -1;
+        std::string path_;
+    };
+}
+
+TEST_P(IoRingTest, BatchedWritesAndReads) {
+    // More operations than the queue holds, so queueing has to submit part way
+    const unsigned int kBlocks = 600;
+    const unsigned int kBlockSize = 512;
+    std::vector<char> out(kBlocks * kBlockSize);
+    for (size_t i = 0; i < out.size(); i++)
+        out[i] = (char) (i * 13 + i / 509);
+
+    for (unsigned int i = 0; i < kBlocks; i++)
+        ASSERT_EQ(0, minicrt::io_ring_write(&ring_, fd_, out.data() + i * kBlockSize, kBlockSize,
+                                            (long long) i * kBlockSize, i));
+    for (const minicrt::io_completion &c : wait_all(kBlocks))
+        EXPECT_EQ((int) kBlockSize, c.result) << c.user_data;
+
+    ASSERT_EQ(0, minicrt::io_ring_fsync(&ring_, fd_, minicrt::IO_FSYNC_DATASYNC, 0));
+    EXPECT_EQ(0, wait_all(1)[0].result);
+
+    std::vector<char> in(out.size());
+    for (unsigned int i = 0; i < kBlocks; i++)
+        ASSERT_EQ(0, minicrt::io_ring_read(&ring_, fd_, in.data() + i * kBlockSize, kBlockSize,
+                                           (long long) i * kBlockSize, i));
+    for (const minicrt::io_completion &c : wait_all(kBlocks))
+        EXPECT_EQ((int) kBlockSize, c.result) << c.user_data;
+    EXPECT_EQ(out, in);
+
+    // Reading past the end reports 0 bytes
+    char extra;
+    ASSERT_EQ(0, minicrt::io_ring_read(&ring_, fd_, &extra, 1, (long long) out.size(), 0));
+    EXPECT_EQ(0, wait_all(1)[0].result);
+}
+
+TEST_P(IoRingTest, VectoredIo) {
+    char a[] = "scatter ", b[] = "and ", c[] = "gather";
+    minicrt::io_vector out[] = {{a, 8}, {b, 4}, {c, 6}};
+    ASSERT_EQ(0, minicrt::io_ring_writev(&ring_, fd_, out, 3, 0, 0));
+    ASSERT_EQ(0, minicrt::io_ring_fsync(&ring_, fd_, 0, 1));
+    std::vector<minicrt::io_completion> done = wait_all(2);
+    EXPECT_EQ(18, done[0].result);
+    EXPECT_EQ(0, done[1].result);
+
+    char x[5] = {}, y[14] = {};
+    minicrt::io_vector in[] = {{x, 4}, {y, 13}};
+    ASSERT_EQ(0, minicrt::io_ring_readv(&ring_, fd_, in, 2, 1, 0));
+    EXPECT_EQ(17, wait_all(1)[0].result);
+    EXPECT_STREQ("catt", x);
+    EXPECT_STREQ("er and gather", y);
+}
+
+TEST_P(IoRingTest, Pipe) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+
+    // The read is queued first and completes once the write lands
+    char buf[16] = {};
+    ASSERT_EQ(0, minicrt::io_ring_read(&ring_, fds[0], buf, sizeof(buf), -1, 0));
+    ASSERT_EQ(0, minicrt::io_ring_write(&ring_, fds[1], "through a pipe", 14, -1, 1));
+    std::vector<minicrt::io_completion> done = wait_all(2);
+    EXPECT_EQ(14, done[0].result);
+    EXPECT_EQ(14, done[1].result);
+    EXPECT_STREQ("through a pipe", buf);
+
+    // A failed operation reports -errno
+    ASSERT_EQ(0, minicrt::io_ring_write(&ring_, fds[0], "x", 1, -1, 0));
+    EXPECT_EQ(-EBADF, wait_all(1)[0].result);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_P(IoRingTest, Timeouts) {
+    minicrt::timespec ts = {0, 20 * 1000 * 1000};
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(0, minicrt::io_ring_timeout(&ring_, &ts, 0, 0));
+    EXPECT_EQ(-ETIME, wait_all(1)[0].result);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(15));
+
+    // A completion count ends the timeout early
+    minicrt::timespec long_ts = {10, 0};
+    char c = 'x';
+    ASSERT_EQ(0, minicrt::io_ring_timeout(&ring_, &long_ts, 1, 0));
+    ASSERT_EQ(0, minicrt::io_ring_write(&ring_, fd_, &c, 1, 0, 1));
+    start = std::chrono::steady_clock::now();
+    std::vector<minicrt::io_completion> done = wait_all(2);
+    EXPECT_EQ(0, done[0].result);
+    EXPECT_EQ(1, done[1].result);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST_P(IoRingTest, PeekDoesNotBlock) {
+    minicrt::io_completion c;
+    EXPECT_EQ(0u, minicrt::io_ring_peek(&ring_, &c, 1));
+
+    char byte = 'z';
+    ASSERT_EQ(0, minicrt::io_ring_write(&ring_, fd_, &byte, 1, 0, 7));
+    ASSERT_EQ(1, minicrt::io_ring_submit_and_wait(&ring_, 1));
+    ASSERT_EQ(1u, minicrt::io_ring_peek(&ring_, &c, 1));
+    EXPECT_EQ(7u, c.user_data);
+    EXPECT_EQ(1, c.result);
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, IoRingTest, ::testing::Values(0u, (unsigned int) minicrt::IO_RING_SQPOLL),
+                         [](const ::testing::TestParamInfo<unsigned int> &info) {
+                             return info.param ? std::string("SqPoll") : std::string("Default");
+                         });